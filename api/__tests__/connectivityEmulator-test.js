@@ -0,0 +1,292 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const h5 = require('../simulation/h5');
+const ConnectivityEmulator = require('../simulation/connectivityEmulator');
+const FaultyWire = require('../simulation/faultyWire');
+const serialization = require('../simulation/serialization');
+
+// A minimal host side of the H5 link, records the packets received from the emulator
+function createHost(emulator) {
+    const host = { packets: [], invalid: [] };
+    const decoder = new h5.SlipDecoder(frame => {
+        const packet = h5.decode(frame);
+
+        if (packet.error) {
+            host.invalid.push(packet.error);
+        } else {
+            host.packets.push(packet);
+        }
+    });
+
+    emulator.on('data', data => decoder.push(data));
+    host.send = packet => emulator.write(h5.slipEncode(h5.encode(packet)));
+    host.reliable = () => host.packets.filter(packet => packet.type === h5.packetType.VENDOR_SPECIFIC);
+
+    return host;
+}
+
+function establishLink(host) {
+    host.send({ type: h5.packetType.LINK_CONTROL, payload: h5.controlPacket.SYNC });
+    host.send({ type: h5.packetType.LINK_CONTROL, payload: h5.controlPacket.CONFIG });
+}
+
+function command(seq, opcode, data) {
+    return {
+        type: h5.packetType.VENDOR_SPECIFIC,
+        seq,
+        ack: 0,
+        reliable: true,
+        crc: true,
+        payload: [ConnectivityEmulator.serializationPacketType.COMMAND, opcode].concat(data || []),
+    };
+}
+
+describe('H5 framing', () => {
+    it('computes the CRC-CCITT of the connectivity firmware', () => {
+        expect(h5.crc16(Buffer.from('123456789'), 9)).toEqual(0x29B1);
+    });
+
+    it('decodes what it encodes', () => {
+        const payload = Buffer.from(new Array(300).fill(0).map((value, index) => index & 0xFF));
+        const packet = h5.decode(h5.encode({
+            type: h5.packetType.VENDOR_SPECIFIC, seq: 5, ack: 3, reliable: true, crc: true, payload,
+        }));
+
+        expect(packet).toEqual({
+            type: h5.packetType.VENDOR_SPECIFIC, seq: 5, ack: 3, reliable: true, crc: true, payload,
+        });
+    });
+
+    it('rejects corrupted packets', () => {
+        const encoded = h5.encode({ type: h5.packetType.VENDOR_SPECIFIC, crc: true, payload: [1, 2, 3] });
+
+        const badHeader = Buffer.from(encoded);
+        badHeader[0] ^= 0x01;
+        expect(h5.decode(badHeader).error).toEqual('header-checksum');
+
+        const badPayload = Buffer.from(encoded);
+        badPayload[5] ^= 0x01;
+        expect(h5.decode(badPayload).error).toEqual('crc');
+
+        expect(h5.decode(encoded.slice(0, encoded.length - 1)).error).toEqual('length');
+    });
+
+    it('escapes the SLIP delimiters', () => {
+        const frames = [];
+        const decoder = new h5.SlipDecoder(frame => frames.push(frame));
+        const packet = Buffer.from([0xC0, 0xDB, 0x01, 0xC0]);
+
+        const frame = h5.slipEncode(packet);
+        expect(frame).toEqual(Buffer.from([0xC0, 0xDB, 0xDC, 0xDB, 0xDD, 0x01, 0xDB, 0xDC, 0xC0]));
+
+        decoder.push(frame.slice(0, 4));
+        decoder.push(frame.slice(4));
+        expect(frames).toEqual([packet]);
+    });
+});
+
+describe('Connectivity emulator', () => {
+    let emulator;
+
+    beforeEach(() => {
+        emulator = new ConnectivityEmulator({
+            retransmissionInterval: 10,
+            maxRetransmissions: 2,
+            script: { responses: { 0x60: { result: 0x07, data: [0xAB] } } },
+        });
+    });
+
+    afterEach(() => emulator.close());
+
+    it('establishes the link', () => {
+        const host = createHost(emulator);
+        establishLink(host);
+
+        expect(host.packets.map(packet => Array.from(packet.payload))).toEqual([
+            h5.controlPacket.SYNC_RSP,
+            h5.controlPacket.CONFIG_RSP,
+        ]);
+        expect(emulator.state).toEqual('active');
+    });
+
+    it('answers commands from the script', () => {
+        const host = createHost(emulator);
+        establishLink(host);
+
+        host.send(command(0, 0x60, [1, 2]));
+        host.send(command(1, 0x61));
+
+        // Acknowledge the first response so the second one is sent
+        host.send({ type: h5.packetType.ACK, ack: 1 });
+
+        expect(host.reliable().map(packet => Array.from(packet.payload))).toEqual([
+            [1, 0x60, 0x07, 0, 0, 0, 0xAB],
+            [1, 0x61, 0, 0, 0, 0],
+        ]);
+        expect(emulator.stats.commands).toEqual(2);
+    });
+
+    it('drops duplicate commands and acknowledges them again', () => {
+        const host = createHost(emulator);
+        establishLink(host);
+
+        host.send(command(0, 0x60));
+        host.send(command(0, 0x60));
+
+        const acks = host.packets.filter(packet => packet.type === h5.packetType.ACK).map(packet => packet.ack);
+        expect(acks).toEqual([1, 1]);
+        expect(emulator.stats.commands).toEqual(1);
+        expect(emulator.stats.duplicates).toEqual(1);
+    });
+
+    it('retransmits unacknowledged responses', done => {
+        const host = createHost(emulator);
+        establishLink(host);
+        host.send(command(0, 0x60));
+
+        setTimeout(() => {
+            expect(host.reliable().length).toEqual(3);
+            expect(emulator.stats.retransmissions).toEqual(2);
+            expect(emulator.stats.dropped).toEqual(1);
+            done();
+        }, 100);
+    });
+
+    it('counts corrupted frames', () => {
+        const host = createHost(emulator);
+        establishLink(host);
+
+        const frame = h5.slipEncode(h5.encode(command(0, 0x60)));
+        frame[frame.length - 2] ^= 0x01;
+        emulator.write(frame);
+
+        expect(emulator.stats.invalidFrames.crc).toEqual(1);
+        expect(emulator.stats.commands).toEqual(0);
+    });
+});
+
+describe('Faulty wire', () => {
+    it('paces bytes at the baud rate', done => {
+        const wire = new FaultyWire({ baudRate: 100000 });
+        const start = Date.now();
+
+        wire.on('data', data => {
+            expect(data.length).toEqual(500);
+            expect(Date.now() - start).toBeGreaterThanOrEqual(45);
+            done();
+        });
+
+        // 500 bytes of 10 bits take 50 ms at 100 kBaud
+        wire.write(Buffer.alloc(500));
+    });
+
+    it('loses and corrupts bytes reproducibly', done => {
+        const options = { loss: 0.1, corruption: 0.1, seed: 42 };
+        const first = new FaultyWire(options);
+        const second = new FaultyWire(options);
+        const received = [];
+
+        const onData = data => {
+            received.push(data);
+
+            if (received.length === 2) {
+                expect(received[0]).toEqual(received[1]);
+                expect(first.stats.bytesLost).toBeGreaterThan(0);
+                expect(first.stats.bytesCorrupted).toBeGreaterThan(0);
+                expect(first.stats.bytesDelivered).toEqual(1000 - first.stats.bytesLost);
+                done();
+            }
+        };
+
+        first.on('data', onData);
+        second.on('data', onData);
+        first.write(Buffer.alloc(1000));
+        second.write(Buffer.alloc(1000));
+    });
+});
+
+describe('Event encoding', () => {
+    it('encodes an advertising report with the address least significant byte first', () => {
+        const event = serialization.encodeAdvertisingReport({
+            address: 'C0:FF:EE:00:00:01',
+            rssi: -50,
+            data: [0x02, 0x01, 0x06],
+        });
+
+        expect(event).toEqual([
+            0x1D, 0x00, // BLE_GAP_EVT_ADV_REPORT
+            0xFF, 0xFF, // BLE_CONN_HANDLE_INVALID
+            0x02, 0x01, 0x00, 0x00, 0xEE, 0xFF, 0xC0, // peer_addr, random static
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // direct_addr
+            0xCE, // rssi
+            0x1E, // ADV_NONCONN_IND, dlen 3
+            0x02, 0x01, 0x06,
+        ]);
+    });
+
+    it('encodes a notification', () => {
+        const event = serialization.encodeHandleValue({ connHandle: 1, handle: 0x0010, data: [0xAA, 0xBB] });
+
+        expect(event).toEqual([
+            0x39, 0x00, // BLE_GATTC_EVT_HVX
+            0x01, 0x00, // conn_handle
+            0x00, 0x00, // gatt_status
+            0x00, 0x00, // error_handle
+            0x10, 0x00, // handle
+            0x01, // BLE_GATT_HVX_NOTIFICATION
+            0x02, 0x00, // len
+            0xAA, 0xBB,
+        ]);
+    });
+
+    it('is sent by the emulator as a reliable event packet', () => {
+        const emulator = new ConnectivityEmulator();
+        const host = createHost(emulator);
+
+        establishLink(host);
+        emulator.sendEvent(serialization.encodeHandleValue({ connHandle: 0, handle: 0x0010, data: [0x01] }));
+
+        const events = host.reliable();
+        expect(events.length).toEqual(1);
+        expect(events[0].payload[0]).toEqual(ConnectivityEmulator.serializationPacketType.EVENT);
+        expect(events[0].payload[1]).toEqual(0x39);
+
+        emulator.close();
+    });
+});
@@ -0,0 +1,244 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const EventEmitter = require('events');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+const Adapter = require('../adapter');
+const GattCache = require('../gattCache');
+
+// Core specification sample data for the random address hash function ah
+const IRK = Buffer.from('ec0234a357c8ad05341010a60a397d9b', 'hex').reverse();
+const RESOLVABLE_ADDRESS = '70:81:94:0D:FB:AA';
+
+const SERVICES = [{
+    uuid: '1801',
+    startHandle: 1,
+    endHandle: 5,
+    characteristics: [{
+        uuid: '2A05',
+        declarationHandle: 2,
+        valueHandle: 3,
+        properties: { indicate: true },
+        descriptors: [{ uuid: '2902', handle: 4 }],
+    }],
+}];
+
+function device(address, addressType) {
+    return { address, addressType };
+}
+
+describe('GattCache.resolvePrivateAddress', () => {
+    it('resolves an address generated from the IRK', () => {
+        expect(GattCache.resolvePrivateAddress(RESOLVABLE_ADDRESS, IRK.toString('hex'))).toEqual(true);
+    });
+
+    it('does not resolve an address with another hash', () => {
+        expect(GattCache.resolvePrivateAddress('70:81:94:0D:FB:AB', IRK.toString('hex'))).toEqual(false);
+    });
+
+    it('does not resolve addresses that are not resolvable private addresses', () => {
+        expect(GattCache.resolvePrivateAddress('F0:81:94:0D:FB:AA', IRK.toString('hex'))).toEqual(false);
+    });
+});
+
+describe('GattCache', () => {
+    const peer = device('C0:00:00:00:00:01', 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC');
+
+    it('returns undefined for unknown devices', () => {
+        const cache = new GattCache();
+        expect(cache.lookup(peer)).toBeUndefined();
+    });
+
+    it('stores and invalidates entries by address', () => {
+        const cache = new GattCache();
+        cache.store(peer, SERVICES, [0xAB, 0xCD]);
+
+        expect(cache.lookup(peer)).toEqual({ irk: null, databaseHash: 'ABCD', services: SERVICES });
+        expect(cache.lookup(device(peer.address, 'BLE_GAP_ADDR_TYPE_PUBLIC'))).toBeUndefined();
+
+        cache.invalidate(peer);
+        expect(cache.lookup(peer)).toBeUndefined();
+    });
+
+    it('finds bonded devices reconnecting with a new resolvable private address', () => {
+        const cache = new GattCache();
+        const bonding = device('4F:00:00:00:00:02', 'BLE_GAP_ADDR_TYPE_RANDOM_PRIVATE_RESOLVABLE');
+
+        cache.store(bonding, SERVICES);
+        cache.setIdentity(bonding, {
+            id_info: { irk: Array.from(IRK) },
+            id_addr_info: { address: 'C0:00:00:00:00:03', type: 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC' },
+        });
+
+        const reconnected = device(RESOLVABLE_ADDRESS, 'BLE_GAP_ADDR_TYPE_RANDOM_PRIVATE_RESOLVABLE');
+        expect(cache.lookup(reconnected).services).toEqual(SERVICES);
+        expect(cache.lookup(reconnected).irk).toEqual(IRK.toString('hex').toUpperCase());
+    });
+
+    it('records bonded devices', () => {
+        const cache = new GattCache();
+        const bonding = device('4F:00:00:00:00:02', 'BLE_GAP_ADDR_TYPE_RANDOM_PRIVATE_RESOLVABLE');
+
+        expect(cache.isBonded(peer)).toEqual(false);
+
+        cache.setBonded(peer);
+        cache.setBonded(bonding, {
+            id_info: { irk: Array.from(IRK) },
+            id_addr_info: { address: 'C0:00:00:00:00:03', type: 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC' },
+        });
+
+        expect(cache.isBonded(peer)).toEqual(true);
+        expect(cache.isBonded(device('C0:00:00:00:00:03', 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC'))).toEqual(true);
+        expect(cache.isBonded(device('C0:00:00:00:00:04', 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC'))).toEqual(false);
+    });
+
+    it('persists entries and bonds to the given path', done => {
+        const cachePath = path.join(fs.mkdtempSync(path.join(os.tmpdir(), 'gatt-cache-')), 'cache.json');
+        const cache = new GattCache({ path: cachePath });
+
+        cache.store(peer, SERVICES, [0x01]);
+        cache.setBonded(peer);
+
+        cache.flush(err => {
+            expect(err).toBeNull();
+
+            const loaded = new GattCache({ path: cachePath });
+            expect(loaded.lookup(peer).services).toEqual(SERVICES);
+            expect(loaded.isBonded(peer)).toEqual(true);
+            done();
+        });
+    });
+
+    it('coalesces writes requested while a write is in progress', done => {
+        const cachePath = path.join(fs.mkdtempSync(path.join(os.tmpdir(), 'gatt-cache-')), 'cache.json');
+        const cache = new GattCache({ path: cachePath });
+        const writeFile = jest.spyOn(fs, 'writeFile');
+
+        cache.store(peer, SERVICES, [0x01]);
+        cache.store(peer, SERVICES, [0x02]);
+        cache.store(peer, SERVICES, [0x03]);
+
+        cache.flush(() => {
+            expect(writeFile).toHaveBeenCalledTimes(2);
+            writeFile.mockRestore();
+
+            expect(new GattCache({ path: cachePath }).lookup(peer).databaseHash).toEqual('03');
+            done();
+        });
+    });
+
+    it('discards a corrupt cache file', () => {
+        const cachePath = path.join(fs.mkdtempSync(path.join(os.tmpdir(), 'gatt-cache-')), 'cache.json');
+        fs.writeFileSync(cachePath, '{ not json');
+
+        expect(new GattCache({ path: cachePath }).lookup(peer)).toBeUndefined();
+    });
+});
+
+describe('Adapter restoring attributes from the GATT cache', () => {
+    const DATABASE_HASH = Array.from({ length: 16 }, (value, index) => index);
+    const CACHED_SERVICES = SERVICES.concat([{
+        uuid: '1801',
+        startHandle: 6,
+        endHandle: 7,
+        characteristics: [{
+            uuid: '2B2A',
+            declarationHandle: 6,
+            valueHandle: 7,
+            properties: { read: true },
+            value: DATABASE_HASH,
+            descriptors: [],
+        }],
+    }]);
+    const peer = { instanceId: 'peer', address: 'E3:1F:6A:50:2B:C4', encrypted: false };
+
+    let adapter;
+    let serviceAdded;
+
+    beforeEach(() => {
+        adapter = Object.create(Adapter.prototype);
+        EventEmitter.call(adapter);
+        adapter._services = {};
+        adapter._characteristics = {};
+        adapter._descriptors = {};
+        adapter._gattCache = {
+            lookup: () => ({ databaseHash: Buffer.from(DATABASE_HASH).toString('hex').toUpperCase(), services: CACHED_SERVICES }),
+            invalidate: jest.fn(),
+            isBonded: () => false,
+        };
+        adapter._readRemoteValue = jest.fn();
+        adapter._enableServiceChangedIndications = jest.fn();
+
+        serviceAdded = jest.fn();
+        adapter.on('serviceAdded', serviceAdded);
+    });
+
+    it('adds nothing before the Database Hash is read', () => {
+        adapter._restoreAttributesFromGattCache(peer, () => {});
+
+        expect(adapter._readRemoteValue).toHaveBeenCalledTimes(1);
+        expect(adapter._readRemoteValue.mock.calls[0][1]).toEqual(7);
+        expect(adapter._services).toEqual({});
+        expect(adapter._characteristics).toEqual({});
+        expect(serviceAdded).not.toHaveBeenCalled();
+    });
+
+    it('adds the cached attributes when the Database Hash is unchanged', () => {
+        const restored = jest.fn();
+        adapter._restoreAttributesFromGattCache(peer, restored);
+        adapter._readRemoteValue.mock.calls[0][3](undefined, DATABASE_HASH);
+
+        expect(Object.keys(restored.mock.calls[0][0].services).length).toEqual(2);
+        expect(Object.keys(adapter._services).length).toEqual(2);
+        expect(serviceAdded).toHaveBeenCalledTimes(2);
+    });
+
+    it('discards the cached attributes when the Database Hash changed', () => {
+        const restored = jest.fn();
+        adapter._restoreAttributesFromGattCache(peer, restored);
+        adapter._readRemoteValue.mock.calls[0][3](undefined, DATABASE_HASH.slice().reverse());
+
+        expect(restored).toHaveBeenCalledWith();
+        expect(adapter._gattCache.invalidate).toHaveBeenCalledWith(peer);
+        expect(adapter._services).toEqual({});
+        expect(serviceAdded).not.toHaveBeenCalled();
+    });
+});
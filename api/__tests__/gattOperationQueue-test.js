@@ -0,0 +1,120 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const GattOperationQueue = require('../gattOperationQueue');
+
+function startOrder(queue, deviceInstanceId) {
+    const order = [];
+    let operation = queue.dequeue(deviceInstanceId);
+    while (operation) {
+        operation.start();
+        order.push(operation.id);
+        operation = queue.dequeue(deviceInstanceId);
+    }
+    return order;
+}
+
+describe('GattOperationQueue', () => {
+    it('starts operations with equal priority in the order they were queued', () => {
+        const queue = new GattOperationQueue();
+        const started = [];
+        queue.enqueue('device', () => started.push('a'), () => {});
+        queue.enqueue('device', () => started.push('b'), () => {});
+        queue.enqueue('device', () => started.push('c'), () => {});
+
+        startOrder(queue, 'device');
+        expect(started).toEqual(['a', 'b', 'c']);
+        expect(queue.length('device')).toEqual(0);
+    });
+
+    it('starts operations with higher priority first', () => {
+        const queue = new GattOperationQueue();
+        const started = [];
+        queue.enqueue('device', () => started.push('low'), () => {}, -1);
+        queue.enqueue('device', () => started.push('normal'), () => {});
+        queue.enqueue('device', () => started.push('high'), () => {}, 1);
+        queue.enqueue('device', () => started.push('normal2'), () => {});
+
+        startOrder(queue, 'device');
+        expect(started).toEqual(['high', 'normal', 'normal2', 'low']);
+    });
+
+    it('keeps the queues of different devices apart', () => {
+        const queue = new GattOperationQueue();
+        queue.enqueue('a', () => {}, () => {});
+        queue.enqueue('b', () => {}, () => {});
+        queue.enqueue('b', () => {}, () => {});
+
+        expect(queue.length('a')).toEqual(1);
+        expect(queue.length('b')).toEqual(2);
+        expect(queue.dequeue('c')).toBeUndefined();
+    });
+
+    it('cancels a queued operation with an error', () => {
+        const queue = new GattOperationQueue();
+        const errors = [];
+        queue.enqueue('device', () => {}, () => {});
+        const id = queue.enqueue('device', () => {}, error => errors.push(error.message));
+
+        expect(queue.cancel(id, new Error('cancelled'))).toEqual(true);
+        expect(errors).toEqual(['cancelled']);
+        expect(queue.length('device')).toEqual(1);
+        expect(queue.cancel(id, new Error('cancelled'))).toEqual(false);
+    });
+
+    it('does not cancel an operation that has been started', () => {
+        const queue = new GattOperationQueue();
+        const id = queue.enqueue('device', () => {}, () => {});
+        queue.dequeue('device');
+
+        expect(queue.cancel(id, new Error('cancelled'))).toEqual(false);
+    });
+
+    it('cancels all operations queued for a device', () => {
+        const queue = new GattOperationQueue();
+        const errors = [];
+        queue.enqueue('a', () => {}, error => errors.push(`a1 ${error.message}`));
+        queue.enqueue('a', () => {}, error => errors.push(`a2 ${error.message}`));
+        queue.enqueue('b', () => {}, () => errors.push('b'));
+
+        queue.cancelAll('a', new Error('disconnected'));
+        expect(errors).toEqual(['a1 disconnected', 'a2 disconnected']);
+        expect(queue.length('a')).toEqual(0);
+        expect(queue.length('b')).toEqual(1);
+    });
+});
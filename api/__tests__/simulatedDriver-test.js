@@ -0,0 +1,171 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const Adapter = require('../adapter');
+const ServiceFactory = require('../serviceFactory');
+const simulatedDriver = require('../simulation/simulatedDriver');
+
+const RADIO = 'simulatedDriver-test';
+
+function call(object, method) {
+    const args = Array.prototype.slice.call(arguments, 2);
+
+    return new Promise((resolve, reject) => {
+        object[method].apply(object, args.concat((err, result) => (err ? reject(err) : resolve(result))));
+    });
+}
+
+function createAdapter(instanceId) {
+    return new Adapter(simulatedDriver, new simulatedDriver.Adapter(), instanceId, RADIO);
+}
+
+describe('Simulated driver', () => {
+    const peripheral = createAdapter('peripheral');
+    const central = createAdapter('central');
+    const serviceFactory = new ServiceFactory();
+    let characteristic;
+    let device;
+    let remoteCharacteristic;
+
+    beforeAll(async () => {
+        await call(peripheral, 'open', {});
+        await call(central, 'open', {});
+
+        const service = serviceFactory.createService('6E400001B5A3F393E0A9E50E24DCCA9E');
+        characteristic = serviceFactory.createCharacteristic(
+            service,
+            '6E400002B5A3F393E0A9E50E24DCCA9E',
+            [1, 2, 3],
+            { read: true, write: true, notify: true },
+            { maxLength: 20, readPerm: ['open'], writePerm: ['open'], variableLength: true });
+        serviceFactory.createDescriptor(characteristic, '2902', [0, 0], {
+            maxLength: 2,
+            readPerm: ['open'],
+            writePerm: ['open'],
+            variableLength: false,
+        });
+
+        await call(peripheral, 'setServices', [service]);
+    });
+
+    afterAll(async () => {
+        await call(central, 'close');
+        await call(peripheral, 'close');
+    });
+
+    it('reports advertising data to scanners on the same radio', async () => {
+        await call(peripheral, 'setAdvertisingData', { completeLocalName: 'SIM', flags: ['leGeneralDiscMode'] }, {});
+        await call(peripheral, 'startAdvertising', { interval: 100, timeout: 0 });
+
+        const discovered = new Promise(resolve => central.once('deviceDiscovered', resolve));
+        await call(central, 'startScan', { active: false, interval: 100, window: 50, timeout: 0 });
+        const found = await discovered;
+        await call(central, 'stopScan');
+
+        expect(found.name).toEqual('SIM');
+        expect(found.address).toEqual(peripheral.state.address);
+    });
+
+    it('connects a central to a connectable advertiser', async () => {
+        const connected = Promise.all([
+            new Promise(resolve => central.once('deviceConnected', resolve)),
+            new Promise(resolve => peripheral.once('deviceConnected', resolve)),
+        ]);
+
+        await call(central, 'connect', peripheral.state.address, {
+            scanParams: { active: false, interval: 100, window: 50, timeout: 1 },
+            connParams: { min_conn_interval: 7.5, max_conn_interval: 7.5, slave_latency: 0, conn_sup_timeout: 4000 },
+        });
+
+        const devices = await connected;
+        device = devices[0];
+
+        expect(device.role).toEqual('peripheral');
+        expect(devices[1].role).toEqual('central');
+        expect(peripheral.state.advertising).toEqual(false);
+    });
+
+    it('discovers the services and characteristics of the peer', async () => {
+        const services = await call(central, 'getServices', device.instanceId);
+        expect(services.map(service => service.uuid)).toEqual(['1800', '1801', '6E400001B5A3F393E0A9E50E24DCCA9E']);
+
+        const characteristics = await call(central, 'getCharacteristics', services[2].instanceId);
+        remoteCharacteristic = characteristics[0];
+        expect(remoteCharacteristic.uuid).toEqual('6E400002B5A3F393E0A9E50E24DCCA9E');
+        expect(remoteCharacteristic.value).toEqual([1, 2, 3]);
+        expect(remoteCharacteristic.valueHandle).toEqual(characteristic.valueHandle);
+
+        const descriptors = await call(central, 'getDescriptors', remoteCharacteristic.instanceId);
+        expect(descriptors.map(descriptor => descriptor.uuid)).toEqual(['2902']);
+    });
+
+    it('writes and reads a characteristic value', async () => {
+        await call(central, 'writeCharacteristicValue', remoteCharacteristic.instanceId, [4, 5], true);
+        expect(characteristic.value).toEqual([4, 5]);
+
+        const value = await call(central, 'readCharacteristicValue', remoteCharacteristic.instanceId);
+        expect(value).toEqual([4, 5]);
+    });
+
+    it('notifies subscribed centrals', async () => {
+        await call(central, 'startCharacteristicsNotifications', remoteCharacteristic.instanceId, false);
+
+        const changed = new Promise(resolve => central.once('characteristicValueChanged', resolve));
+        await call(peripheral, 'writeCharacteristicValue', characteristic.instanceId, [6, 7, 8], false);
+
+        expect((await changed).value).toEqual([6, 7, 8]);
+    });
+
+    it('exchanges ATT_MTU', async () => {
+        peripheral.once('attMtuRequest', (peer, mtu) => peripheral.attMtuReply(peer.instanceId, mtu));
+
+        expect(await call(central, 'requestAttMtu', device.instanceId, 247)).toEqual(247);
+    });
+
+    it('disconnects both sides', async () => {
+        const disconnected = Promise.all([
+            new Promise(resolve => central.once('deviceDisconnected', resolve)),
+            new Promise(resolve => peripheral.once('deviceDisconnected', resolve)),
+        ]);
+
+        await call(central, 'disconnect', device.instanceId);
+        await disconnected;
+
+        expect(Object.keys(central.getDevices())).toEqual([]);
+    });
+});
@@ -0,0 +1,202 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const Adapter = require('../adapter');
+const ServiceFactory = require('../serviceFactory');
+const simulatedDriver = require('../simulation/simulatedDriver');
+
+function call(object, method) {
+    const args = Array.prototype.slice.call(arguments, 2);
+
+    return new Promise((resolve, reject) => {
+        object[method].apply(object, args.concat((err, result) => (err ? reject(err) : resolve(result))));
+    });
+}
+
+function bytes(length) {
+    return Array.from({ length }, (value, index) => index & 0xFF);
+}
+
+// Connects a central to a peripheral with a characteristic that accepts write commands. Without native
+// streaming the central's AddOn behaves like the one for SoftDevice API v2.
+async function connect(radio, nativeStream) {
+    const peripheralAdapter = new simulatedDriver.Adapter();
+    const centralAdapter = new simulatedDriver.Adapter();
+
+    if (!nativeStream) {
+        centralAdapter.gattcWriteStream = undefined;
+    }
+
+    const peripheral = new Adapter(simulatedDriver, peripheralAdapter, 'peripheral', radio);
+    const central = new Adapter(simulatedDriver, centralAdapter, 'central', radio);
+    const serviceFactory = new ServiceFactory();
+
+    await call(peripheral, 'open', {});
+    await call(central, 'open', {});
+
+    const service = serviceFactory.createService('6E400001B5A3F393E0A9E50E24DCCA9E');
+    const characteristic = serviceFactory.createCharacteristic(
+        service,
+        '6E400002B5A3F393E0A9E50E24DCCA9E',
+        [0],
+        { writeWoResp: true },
+        { maxLength: 20, readPerm: ['open'], writePerm: ['open'], variableLength: true });
+
+    await call(peripheral, 'setServices', [service]);
+    await call(peripheral, 'startAdvertising', { interval: 100, timeout: 0 });
+
+    const connected = new Promise(resolve => central.once('deviceConnected', resolve));
+    await call(central, 'connect', peripheral.state.address, {
+        scanParams: { active: false, interval: 100, window: 50, timeout: 1 },
+        connParams: { min_conn_interval: 7.5, max_conn_interval: 7.5, slave_latency: 0, conn_sup_timeout: 4000 },
+    });
+    const device = await connected;
+
+    const services = await call(central, 'getServices', device.instanceId);
+    const characteristics = await call(central, 'getCharacteristics', services[2].instanceId);
+
+    // Every write command the peripheral receives, in order. The stream can complete before the
+    // peripheral has handled the last packets.
+    const received = [];
+    let waiting;
+
+    peripheral.on('characteristicValueChanged', attribute => {
+        if (attribute.instanceId === characteristic.instanceId) {
+            received.push(attribute.value.slice());
+
+            if (waiting && received.length >= waiting.count) {
+                waiting.resolve(received);
+            }
+        }
+    });
+
+    const receive = count => new Promise(resolve => {
+        if (received.length >= count) {
+            resolve(received);
+        } else {
+            waiting = { count, resolve };
+        }
+    });
+
+    return { peripheral, central, device, remoteCharacteristic: characteristics[0], received, receive };
+}
+
+async function disconnect(link) {
+    await call(link.central, 'disconnect', link.device.instanceId);
+    await call(link.central, 'close');
+    await call(link.peripheral, 'close');
+}
+
+[
+    { name: 'native write command stream', nativeStream: true },
+    { name: 'sequential write commands (SoftDevice API v2)', nativeStream: false },
+].forEach(mode => {
+    describe(`writeCharacteristicValueStream with ${mode.name}`, () => {
+        let link;
+
+        beforeAll(async () => {
+            link = await connect(`writeStream-test-${mode.nativeStream ? 'native' : 'sequential'}`, mode.nativeStream);
+        });
+
+        afterAll(async () => {
+            await disconnect(link);
+        });
+
+        beforeEach(() => {
+            link.received.length = 0;
+        });
+
+        it('splits a value into packets of ATT_MTU - 3 bytes', async () => {
+            const value = bytes(45);
+            const stats = await call(link.central, 'writeCharacteristicValueStream', link.remoteCharacteristic.instanceId, value);
+
+            expect(await link.receive(3)).toEqual([value.slice(0, 20), value.slice(20, 40), value.slice(40)]);
+            expect(link.remoteCharacteristic.value).toEqual(value.slice(40));
+            expect(stats.bytes).toEqual(45);
+            expect(stats.packets).toEqual(3);
+        });
+
+        if (mode.nativeStream) {
+            it('passes a value to the AddOn as one buffer with the ATT_MTU', async () => {
+                const gattcWriteStream = jest.spyOn(link.central._adapter, 'gattcWriteStream');
+                const value = bytes(45);
+
+                await call(link.central, 'writeCharacteristicValueStream', link.remoteCharacteristic.instanceId, value);
+                await link.receive(3);
+
+                const args = gattcWriteStream.mock.calls[0];
+                gattcWriteStream.mockRestore();
+
+                expect(Buffer.isBuffer(args[2])).toEqual(true);
+                expect(Array.from(args[2])).toEqual(value);
+                expect(args[3]).toEqual({ att_mtu: 23 });
+            });
+        }
+
+        it('sends chunks as given', async () => {
+            const chunks = [[1, 2], [3, 4, 5], [6]];
+            const stats = await call(link.central, 'writeCharacteristicValueStream', link.remoteCharacteristic.instanceId, chunks);
+
+            expect(await link.receive(3)).toEqual(chunks);
+            expect(link.remoteCharacteristic.value).toEqual([6]);
+            expect(stats.bytes).toEqual(6);
+            expect(stats.packets).toEqual(3);
+        });
+
+        it('reports the throughput of the stream', async () => {
+            const stats = await call(link.central, 'writeCharacteristicValueStream', link.remoteCharacteristic.instanceId, bytes(200));
+
+            expect(stats.packets).toEqual(10);
+            expect((await link.receive(10)).length).toEqual(10);
+            expect(stats.duration).toBeGreaterThanOrEqual(0);
+
+            if (stats.duration > 0) {
+                expect(stats.bytesPerSecond).toBeCloseTo((stats.bytes * 1000) / stats.duration);
+            } else {
+                expect(stats.bytesPerSecond).toEqual(0);
+            }
+        });
+
+        it('rejects chunks longer than ATT_MTU - 3 bytes', () => {
+            expect(() => link.central.writeCharacteristicValueStream(link.remoteCharacteristic.instanceId, [bytes(21)], () => {}))
+                .toThrow('Chunk length must be between 1 and 20');
+            expect(() => link.central.writeCharacteristicValueStream(link.remoteCharacteristic.instanceId, [], () => {}))
+                .toThrow('No data to write');
+        });
+    });
+});
@@ -50,9 +50,16 @@ const ToText = require('./util/toText');
 const logLevel = require('./util/logLevel');
 const Security = require('./security');
 const HexConv = require('./util/hexConv');
+const GattOperationQueue = require('./gattOperationQueue');
+const ReadMultiple = require('./util/readMultiple');
+const SimulatedLink = require('./simulation/simulatedLink');
 
 const MAX_SUPPORTED_ATT_MTU = 247;
 
+// GATT service characteristics used to validate the GATT cache
+const SERVICE_CHANGED_UUID = '2A05';
+const DATABASE_HASH_UUID = '2B2A';
+
 /** Class to mediate error conditions. */
 class Error {
     /**
@@ -143,6 +150,13 @@ class Adapter extends EventEmitter {
 
         this._keys = null;
         this._attMtuMap = {};
+        this._gattCache = null;
+
+        this._openOptions = null;
+        this._enableBLEParams = null;
+        this._bleConfigs = [];
+        this._localServices = null;
+        this._simulatedLink = null;
 
         this._init();
     }
@@ -157,6 +171,7 @@ class Adapter extends EventEmitter {
 
         this._gapOperationsMap = {};
         this._gattOperationsMap = {};
+        this._gattOperationQueue = new GattOperationQueue();
 
         this._preparedWritesMap = {};
 
@@ -213,6 +228,14 @@ class Adapter extends EventEmitter {
         return this._notSupportedMessage;
     }
 
+    /**
+     * Get the simulated physical layer of this adapter.
+     * @returns {SimulatedLink} The link if the adapter was opened with the `simulation` option, otherwise null.
+     */
+    get simulatedLink() {
+        return this._simulatedLink;
+    }
+
     _maxReadPayloadSize(deviceInstanceId) {
         return this.getCurrentAttMtu(deviceInstanceId) - 1;
     }
@@ -221,10 +244,6 @@ class Adapter extends EventEmitter {
         return this.getCurrentAttMtu(deviceInstanceId) - 3;
     }
 
-    _maxLongWritePayloadSize(deviceInstanceId) {
-        return this.getCurrentAttMtu(deviceInstanceId) - 5;
-    }
-
     _generateKeyPair() {
         if (this._keys === null) {
             this._keys = this._security.generateKeyPair();
@@ -403,10 +422,20 @@ class Adapter extends EventEmitter {
      * <li>{string} [flowControl='none']: Whether flow control should be configured with this adapter's serial port.
      * <li>{number} [eventInterval=0]: Interval to use for sending BLE driver events to JavaScript.
      *                                 If `0`, events will be sent as soon as they are received from the BLE driver.
+     * <li>{number} [eventMaxDelay=0]: Only used when `eventInterval` is `0`. If not `0`, events are sent as soon as
+     *                                 they are received while JavaScript keeps up, and coalesced for at most this
+     *                                 many milliseconds under load. Higher values favour throughput over latency.
+     * <li>{number} [eventMaxBatchSize=32]: Number of coalesced events that are sent to JavaScript without waiting
+     *                                      for `eventMaxDelay`. Maximum is 32.
      * <li>{string} [logLevel='info']: The verbosity of logging the developer wants with this adapter.
      * <li>{number} [retransmissionInterval=250]: The time interval to wait between retransmitted packets.
      * <li>{number} [responseTimeout=1500]: Response timeout of the data link layer.
      * <li>{boolean} [enableBLE=true]: Whether the BLE stack should be initialized and enabled.
+     * <li>{Object|boolean} [simulation]: Open a simulated physical layer instead of the serial port, a
+     *                                    pseudo-terminal with an emulated connectivity firmware on the far end, see
+     *                                    <code>SimulatedLink.open()</code> for the options. The link is available as
+     *                                    <code>simulatedLink</code> until the adapter is closed. Needs Linux and
+     *                                    python3.
      * </ul>
      * @param {function(Error)} [callback] Callback signature: err => {}.
      * @returns {void}
@@ -436,6 +465,8 @@ class Adapter extends EventEmitter {
                 parity: 'none',
                 flowControl: 'none',
                 eventInterval: 0,
+                eventMaxDelay: 0,
+                eventMaxBatchSize: 32,
                 logLevel: 'info',
                 retransmissionInterval: 250,
                 responseTimeout: 1500,
@@ -446,6 +477,8 @@ class Adapter extends EventEmitter {
             if (!options.parity) options.parity = 'none';
             if (!options.flowControl) options.flowControl = 'none';
             if (!options.eventInterval) options.eventInterval = 0;
+            if (!options.eventMaxDelay) options.eventMaxDelay = 0;
+            if (!options.eventMaxBatchSize) options.eventMaxBatchSize = 32;
             if (!options.logLevel) options.logLevel = 'info';
             if (!options.retransmissionInterval) options.retransmissionInterval = 250;
             if (!options.responseTimeout) options.responseTimeout = 1500;
@@ -464,8 +497,37 @@ class Adapter extends EventEmitter {
         options.statusCallback = this._statusCallback.bind(this);
         options.enableBLEParams = options.enableBLEParams || this._getDefaultEnableBLEParams();
 
-        this._adapter.open(this._state.port, options, err => {
+        // Kept for warmRestart
+        this._openOptions = options;
+        this._enableBLEParams = options.enableBLE ? options.enableBLEParams : null;
+        this._bleConfigs = [];
+        this._localServices = null;
+
+        if (!options.simulation) {
+            this._openPort(this._state.port, options, callback);
+            return;
+        }
+
+        const simulation = Object.assign(
+            { baudRate: options.baudRate, parity: options.parity },
+            options.simulation === true ? {} : options.simulation);
+
+        SimulatedLink.open(simulation, (err, link) => {
+            if (err) {
+                this._changeState({ opening: false });
+                this._checkAndPropagateError(err, 'Error occurred creating the simulated link.', callback);
+                return;
+            }
+
+            this._simulatedLink = link;
+            this._openPort(link.path, options, callback);
+        });
+    }
+
+    _openPort(port, options, callback) {
+        this._adapter.open(port, options, err => {
             this._changeState({ opening: false });
+            if (err) { this._closeSimulatedLink(); }
             if (this._checkAndPropagateError(err, 'Error occurred opening serial port.', callback)) { return; }
             this._changeState({ available: true });
 
@@ -515,6 +577,8 @@ class Adapter extends EventEmitter {
             });
 
             this._adapter.close(error => {
+                this._closeSimulatedLink();
+
                 /**
                  * Adapter closed event.
                  *
@@ -528,6 +592,13 @@ class Adapter extends EventEmitter {
         });
     }
 
+    _closeSimulatedLink() {
+        if (this._simulatedLink) {
+            this._simulatedLink.close();
+            this._simulatedLink = null;
+        }
+    }
+
     /**
      * @summary Reset the connectivity device
      *
@@ -547,6 +618,121 @@ class Adapter extends EventEmitter {
         });
     }
 
+    /**
+     * @summary Restart the adapter without tearing down the transport.
+     *
+     * Intended for recovering after the connectivity device has been reset. The serial port is closed and
+     * opened again, reusing the transport layers created by <code>open</code>, instead of a full
+     * <code>close</code> and <code>open</code>. The BLE configuration, enable BLE parameters and services
+     * from the previous session are then applied again. Connections and GATT operations of the previous
+     * session are dropped, <code>deviceDisconnected</code> is emitted with reason <code>restarted</code> for
+     * each device that was connected.
+     *
+     * @param {function(Error, Object)} [callback] Callback signature: (err, timing) => {}. <code>timing</code> has
+     *                                             the time in milliseconds spent in each step: <code>close</code>,
+     *                                             <code>open</code>, <code>bleConfig</code>, <code>enableBLE</code>,
+     *                                             <code>services</code>, and <code>total</code>, the time to ready.
+     * @returns {void}
+     */
+    warmRestart(callback) {
+        if (!this._openOptions) {
+            if (callback) callback(_makeError('The adapter has not been opened.'));
+            return;
+        }
+
+        if (this.state.opening) {
+            if (callback) callback(_makeError('The adapter is being opened.'));
+            return;
+        }
+
+        const start = Date.now();
+        const timing = {};
+        let stepStart;
+
+        const step = name => {
+            const now = Date.now();
+            if (name) { timing[name] = now - stepStart; }
+            stepStart = now;
+        };
+
+        const toPromise = (fn, userMessage) => new Promise((resolve, reject) => {
+            fn(err => (this._checkAndPropagateError(err, userMessage, reject) || resolve()));
+        });
+
+        // Operations in progress will never complete, fail them before their state is dropped
+        const restartError = _makeError('Adapter restarted', 'The connectivity device session was restarted');
+        Object.keys(this._gattOperationsMap).forEach(deviceInstanceId => {
+            const callback = this._gattOperationsMap[deviceInstanceId].callback;
+            delete this._gattOperationsMap[deviceInstanceId];
+            if (callback) { callback(restartError); }
+        });
+        Object.keys(this._devices).forEach(deviceInstanceId => {
+            this._gattOperationQueue.cancelAll(deviceInstanceId, restartError);
+        });
+
+        this._changeState({ opening: true, available: false, bleEnabled: false });
+
+        new Promise((resolve, reject) => {
+            this._adapter.reopen((err, reopenTiming) => {
+                if (this._checkAndPropagateError(err, 'Error occurred reopening serial port.', reject)) { return; }
+                Object.assign(timing, reopenTiming);
+                resolve();
+            });
+        })
+            .then(() => {
+                // Connections of the previous session are gone, without disconnected events from the SoftDevice
+                Object.keys(this._devices).forEach(deviceInstanceId => {
+                    const device = this._devices[deviceInstanceId];
+                    if (device.connectionHandle === null || device.connectionHandle === undefined) { return; }
+
+                    device.connected = false;
+                    this.emit('deviceDisconnected', device, 'restarted', undefined);
+                });
+
+                // Devices, attributes and GATT operations of the previous session are gone
+                this._init();
+                this._changeState({ opening: false, available: true });
+
+                step();
+                return this._bleConfigs.reduce((previous, bleConfig) => (
+                    previous.then(() => this._setBleConfig(bleConfig))
+                ), Promise.resolve());
+            })
+            .then(() => {
+                step('bleConfig');
+                if (!this._enableBLEParams) { return undefined; }
+
+                return toPromise(done => this._adapter.enableBLE(this._enableBLEParams, done), 'Enabling BLE failed.')
+                    .then(() => this._changeState({ bleEnabled: true }));
+            })
+            .then(() => {
+                step('enableBLE');
+                if (!this._localServices) { return undefined; }
+
+                // setServices emits its own errors
+                const services = this._localServices;
+                return new Promise((resolve, reject) => {
+                    this.setServices(services, err => (err ? reject(err) : resolve()));
+                });
+            })
+            .then(() => {
+                step('services');
+                timing.total = Date.now() - start;
+
+                if (this._enableBLEParams) {
+                    this.getState(getStateError => {
+                        this._checkAndPropagateError(getStateError, 'Error retrieving adapter state.');
+                    });
+                }
+
+                if (callback) { callback(undefined, timing); }
+            })
+            .catch(err => {
+                this._changeState({ opening: false });
+                if (callback) { callback(err); }
+            });
+    }
+
     /**
      * This function is for debugging purposes. It will return an object with these members:
      * <ul>
@@ -554,6 +740,12 @@ class Adapter extends EventEmitter {
      * <li>{number} eventCallbackTotalCount
      * <li>{number} eventCallbackBatchMaxCount
      * <li>{number} eventCallbackBatchAvgCount
+     * <li>{Object} maskedEvents: number of masked events handled natively, keyed by event ID
+     * <li>{Object} eventLatency: latency histograms keyed by event name, e.g. `BLE_GATTC_EVT_HVX`. Each entry has
+     *                           the event `id` and the segments `queuePush` (SoftDevice event callback to event
+     *                           queue), `queueResidence` (time spent in the event queue), `conversion` (native to
+     *                           JavaScript conversion) and `callback` (JavaScript event callback). Each segment has
+     *                           `count`, and `min`, `max`, `mean`, `p50`, `p99` and `p999` in microseconds.
      * </ul>
      *
      * @returns {Object} This adapters stats.
@@ -562,6 +754,85 @@ class Adapter extends EventEmitter {
         return this._adapter.getStats();
     }
 
+    /**
+     * Reset the statistics returned by `getStats()`.
+     *
+     * @returns {void}
+     */
+    resetStats() {
+        this._adapter.resetStats();
+    }
+
+    /**
+     * @summary Get latency and throughput statistics for commands sent to the SoftDevice.
+     *
+     * The statistics are collected for all adapters in this process and keyed by command name, e.g. `GattcWrite`.
+     * Each command has these members:
+     * <ul>
+     * <li>{number} count: Number of completed calls.
+     * <li>{number} errorCount: Number of calls the SoftDevice returned an error for.
+     * <li>{number} perSecond: Completed calls per second since the statistics were last reset.
+     * <li>{Object} queue: Time from the JavaScript call until a worker thread started the command.
+     * <li>{Object} softDevice: Time spent waiting for the SoftDevice call to return.
+     * <li>{Object} dispatch: Time from the SoftDevice return until the result was picked up by the NodeJS thread.
+     * <li>{Object} callback: Time spent in the JavaScript callback.
+     * <li>{Object} total: Time from the JavaScript call until the JavaScript callback returned.
+     * </ul>
+     * Latencies have `count`, and `min`, `max`, `mean`, `p50`, `p99` and `p999` in microseconds, like in `getStats()`.
+     *
+     * @returns {Object} Command statistics.
+     */
+    getCommandStats() {
+        return this._bleDriver.getCommandStats();
+    }
+
+    /**
+     * Reset the statistics returned by `getCommandStats()`.
+     *
+     * @returns {void}
+     */
+    resetCommandStats() {
+        this._bleDriver.resetCommandStats();
+    }
+
+    /**
+     * @summary Set a function that is called for every completed command sent to the SoftDevice.
+     *
+     * Use this to export command latencies to a metrics system without polling `getCommandStats()`.
+     * The sink is shared by all adapters in this process.
+     *
+     * @param {function(Object)|null} sink Callback signature: sample => {}, where sample has `command`, `result`,
+     *                                     `queue`, `softDevice`, `dispatch`, `callback` and `total` (microseconds).
+     *                                     `null` removes the sink.
+     * @returns {void}
+     */
+    setCommandStatsSink(sink) {
+        this._bleDriver.setCommandStatsSink(sink);
+    }
+
+    /**
+     * @summary Stop events of the given types from being sent to JavaScript.
+     *
+     * Masked events are handled by the native AddOn and never converted to JavaScript objects. Events the
+     * SoftDevice or the peer expects a reply to (e.g. `BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST`,
+     * `BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST` and `BLE_GATTS_EVT_SYS_ATTR_MISSING`) are answered with a default
+     * reply, all other masked events are dropped. Calling this function replaces the previous mask, use an
+     * empty array to receive all events again.
+     *
+     * Available options:
+     * <ul>
+     * <li>{boolean} autoReply: Reply to masked requests with a default reply. Default is true.
+     * <li>{number} attMtu: ATT MTU used when replying to a masked MTU exchange request (SoftDevice API v5).
+     * </ul>
+     *
+     * @param {Array<number>} eventIds Event IDs to mask, e.g. `this.driver.BLE_GAP_EVT_RSSI_CHANGED`.
+     * @param {Object} [options] Options for the native default handlers.
+     * @returns {void}
+     */
+    setEventMask(eventIds, options) {
+        this._adapter.setEventMask(eventIds, options);
+    }
+
     /**
      * @summary Enable the BLE stack.
      *
@@ -606,6 +877,7 @@ class Adapter extends EventEmitter {
             options,
             err => {
                 if (this._checkAndPropagateError(err, 'Enabling BLE failed.', callback)) { return; }
+                this._enableBLEParams = options;
                 this._changeState({ bleEnabled: true });
                 if (callback) {
                     callback();
@@ -614,9 +886,17 @@ class Adapter extends EventEmitter {
     }
 
     setBleConfig(ble_cfg, callback) {
+        this._setBleConfig(ble_cfg).then(() => {
+            // Replayed by warmRestart before BLE is enabled again
+            this._bleConfigs.push(ble_cfg);
+            if (callback) { callback(); }
+        });
+    }
+
+    _setBleConfig(ble_cfg) {
         const { conn_cfg, common_cfg, gap_cfg, gatts_cfg } = ble_cfg;
 
-        (async () => {
+        return (async () => {
             const setOneCfg = (configId, cfg) => new Promise((resolve, reject) => {
                 this._adapter.setBleConfig(this._bleDriver[configId], cfg, err => (
                     this._checkAndPropagateError(err, `Set BLE config ${configId} failed.`, reject) || resolve()
@@ -669,7 +949,7 @@ class Adapter extends EventEmitter {
                     await setOneCfg('BLE_GATTS_CFG_ATTR_TAB_SIZE', { gatts_cfg: { attr_tab_size } });
                 }
             }
-        })().then(callback);
+        })();
     }
 
     _statusCallback(status) {
@@ -806,7 +1086,7 @@ class Adapter extends EventEmitter {
                     this._parseGattcReadResponseEvent(event);
                     break;
                 case this._bleDriver.BLE_GATTC_EVT_CHAR_VALS_READ_RSP:
-                    // Not needed, characteristic discovery is not using the related function.
+                    this._parseGattcCharacteristicValuesReadResponseEvent(event);
                     break;
                 case this._bleDriver.BLE_GATTC_EVT_WRITE_RSP:
                     this._parseGattcWriteResponseEvent(event);
@@ -940,6 +1220,9 @@ class Adapter extends EventEmitter {
             }
         }
 
+        this._gattOperationQueue.cancelAll(device.instanceId,
+            _makeError('Device disconnected', 'Device with address ' + device.address + ' disconnected'));
+
         delete this._devices[device.instanceId];
 
         /**
@@ -1011,6 +1294,7 @@ class Adapter extends EventEmitter {
 
     _parseConnSecUpdateEvent(event) {
         const device = this._getDeviceByConnectionHandle(event.conn_handle);
+        device.encrypted = event.conn_sec.sec_mode.sm === 1 && event.conn_sec.sec_mode.lv >= 2;
 
         /**
          * Connection security updated.
@@ -1042,6 +1326,13 @@ class Adapter extends EventEmitter {
         const device = this._getDeviceByConnectionHandle(event.conn_handle);
         device.ownPeriphInitiatedPairingPending = false;
 
+        // Bonded peers are trusted without a Database Hash, and found through their IRK if they use resolvable
+        // private addresses
+        if (this._gattCache && event.bonded) {
+            const keysPeer = event.keyset && event.keyset.keys_peer;
+            this._gattCache.setBonded(device, keysPeer ? keysPeer.id_key : undefined);
+        }
+
         /**
          * Authentication procedure completed with status.
          *
@@ -1350,7 +1641,7 @@ class Adapter extends EventEmitter {
                     }
                 }
 
-                delete this._gattOperationsMap[device.instanceId];
+                this._releaseGattOperation(device);
                 gattOperation.callback(undefined, callbackServices);
             } else {
                 for (let handle in gattOperation.pendingHandleReads) {
@@ -1431,7 +1722,7 @@ class Adapter extends EventEmitter {
                     }
                 }
 
-                delete this._gattOperationsMap[device.instanceId];
+                this._releaseGattOperation(device);
                 gattOperation.callback(undefined, callbackCharacteristics);
             } else {
                 for (let handle in gattOperation.pendingHandleReads) {
@@ -1518,7 +1809,7 @@ class Adapter extends EventEmitter {
                     }
                 }
 
-                delete this._gattOperationsMap[device.instanceId];
+                this._releaseGattOperation(device);
                 gattOperation.callback(undefined, callbackDescriptors);
             } else {
                 for (let handle in gattOperation.pendingHandleReads) {
@@ -1630,7 +1921,7 @@ class Adapter extends EventEmitter {
                         }
                     }
 
-                    delete this._gattOperationsMap[device.instanceId];
+                    this._releaseGattOperation(device);
                     gattOperation.callback(undefined, callbackServices);
                 }
             } else if (attribute instanceof Characteristic) {
@@ -1665,7 +1956,7 @@ class Adapter extends EventEmitter {
                         }
                     }
 
-                    delete this._gattOperationsMap[device.instanceId];
+                    this._releaseGattOperation(device);
                     gattOperation.callback(undefined, callbackCharacteristics);
                 }
             } else if (attribute instanceof Descriptor) {
@@ -1690,7 +1981,7 @@ class Adapter extends EventEmitter {
                         }
                     }
 
-                    delete this._gattOperationsMap[device.instanceId];
+                    this._releaseGattOperation(device);
                     gattOperation.callback(undefined, callbackDescriptors);
                 }
             }
@@ -1708,105 +1999,46 @@ class Adapter extends EventEmitter {
                 });
                 break;
             }
-        } else {
-            if (event.gatt_status !== this._bleDriver.BLE_GATT_STATUS_SUCCESS) {
-                delete this._gattOperationsMap[device.instanceId];
-                gattOperation.callback(_makeError(`Read operation failed: ${event.gatt_status_name} (0x${HexConv.numberToHexString(event.gatt_status)})`));
-                return;
-            }
+        }
+    }
 
-            gattOperation.readBytes = gattOperation.readBytes ? gattOperation.readBytes.concat(event.data) : event.data;
+    _parseGattcCharacteristicValuesReadResponseEvent(event) {
+        const device = this._getDeviceByConnectionHandle(event.conn_handle);
+        const gattOperation = device ? this._gattOperationsMap[device.instanceId] : undefined;
+        if (!gattOperation || !gattOperation.readMultiple) {
+            return;
+        }
 
-            if (event.data.length < this._maxReadPayloadSize(device.instanceId)) {
-                delete this._gattOperationsMap[device.instanceId];
-                gattOperation.callback(undefined, gattOperation.readBytes);
-            } else if (event.data.length === this._maxReadPayloadSize(device.instanceId)) {
-                // We need to read more:
-                this._adapter.gattcRead(event.conn_handle, event.handle, gattOperation.readBytes.length, err => {
-                    if (err) {
-                        delete this._gattOperationsMap[device.instanceId];
-                        this.emit('error', _makeError('Read value failed', err));
-                        gattOperation.callback('Failed reading at byte #' + gattOperation.readBytes.length);
-                    }
-                });
-            } else {
-                delete this._gattOperationsMap[device.instanceId];
-                this.emit('error', 'Length of Read response is > mtu');
-                gattOperation.callback('Invalid read response length. (> mtu)');
-            }
+        this._releaseGattOperation(device);
+
+        if (event.gatt_status !== this._bleDriver.BLE_GATT_STATUS_SUCCESS) {
+            gattOperation.callback(_makeError(`Read multiple operation failed: ${event.gatt_status_name} (0x${HexConv.numberToHexString(event.gatt_status)})`));
+            return;
         }
+
+        gattOperation.callback(undefined, event.values);
     }
 
     _parseGattcWriteResponseEvent(event) {
-        // 1. Check if there is a long write in progress for this device
-        // 2a. If there is check if it is done after next write
-        // 2ai. If it is done after next write
-        //      Perform the last write and if success, exec write on fail, cancel write
-        //      callback, delete callback, delete pending write, emit
-        // 2aii. if not done, issue one more PREPARED_WRITE, update pendingwrite
-
+        // Long writes run natively in gattcWriteLong and never reach this handler
         // TODO: Do more checking of write response?
         const device = this._getDeviceByConnectionHandle(event.conn_handle);
         const handle = event.handle;
         const gattOperation = this._gattOperationsMap[device.instanceId];
 
         if (!device) {
-            delete this._gattOperationsMap[device.instanceId];
+            this._releaseGattOperation(device);
             this.emit('error', 'Failed to handle write event, no device with handle ' + device.instanceId + 'found.');
             gattOperation.callback(_makeError('Failed to handle write event, no device with connection handle ' + event.conn_handle + 'found'));
             return;
         }
 
         if (event.write_op === this._bleDriver.BLE_GATT_OP_WRITE_CMD) {
-            gattOperation.attribute.value = gattOperation.value;
-        } else if (event.write_op === this._bleDriver.BLE_GATT_OP_PREP_WRITE_REQ) {
-
-            const writeParameters = {
-                write_op: 0,
-                flags: 0,
-                handle: handle,
-                offset: 0,
-                len: 0,
-                value: [],
-            };
-
-            if (gattOperation.bytesWritten < gattOperation.value.length) {
-                const value = gattOperation.value.slice(gattOperation.bytesWritten, gattOperation.bytesWritten + this._maxLongWritePayloadSize(device.instanceId));
-
-                writeParameters.write_op = this._bleDriver.BLE_GATT_OP_PREP_WRITE_REQ;
-                writeParameters.handle = handle;
-                writeParameters.offset = gattOperation.bytesWritten;
-                writeParameters.len = value.length;
-                writeParameters.value = value;
-                gattOperation.bytesWritten += value.length;
-
-                this._adapter.gattcWrite(device.connectionHandle, writeParameters, err => {
-
-                    if (err) {
-                        this._longWriteCancel(device, gattOperation.attribute);
-                        this.emit('error', _makeError('Failed to write value to device/handle ' + device.instanceId + '/' + handle, err));
-                        return;
-                    }
-                });
-            } else {
-                writeParameters.write_op = this._bleDriver.BLE_GATT_OP_EXEC_WRITE_REQ;
-                writeParameters.flags = this._bleDriver.BLE_GATT_EXEC_WRITE_FLAG_PREPARED_WRITE;
-
-                this._adapter.gattcWrite(device.connectionHandle, writeParameters, err => {
-
-                    if (err) {
-                        this._longWriteCancel(device, gattOperation.attribute);
-                        this.emit('error', _makeError('Failed to write value to device/handle ' + device.instanceId + '/' + handle, err));
-                        return;
-                    }
-                });
-            }
-
+            // Writes without response do not hold the GATT operation of the device, they complete on TX complete
             return;
-        } else if (event.write_op === this._bleDriver.BLE_GATT_OP_WRITE_REQ ||
-                   event.write_op === this._bleDriver.BLE_GATT_OP_EXEC_WRITE_REQ) {
+        } else if (event.write_op === this._bleDriver.BLE_GATT_OP_WRITE_REQ) {
             gattOperation.attribute.value = gattOperation.value;
-            delete this._gattOperationsMap[device.instanceId];
+            this._releaseGattOperation(device);
             if (event.gatt_status !== this._bleDriver.BLE_GATT_STATUS_SUCCESS) {
                 gattOperation.callback(_makeError(`Write operation failed: ${event.gatt_status_name} (0x${HexConv.numberToHexString(event.gatt_status)})`));
                 return;
@@ -1925,6 +2157,30 @@ class Adapter extends EventEmitter {
 
         characteristic.value = event.data;
         this.emit('characteristicValueChanged', characteristic);
+
+        if (characteristic.uuid === SERVICE_CHANGED_UUID) {
+            this._parseServiceChanged(device, event.data);
+        }
+    }
+
+    _parseServiceChanged(device, data) {
+        if (this._gattCache) {
+            this._gattCache.invalidate(device);
+        }
+
+        // The discovered attributes may no longer match the peer's GATT database
+        this._clearDeviceFromDiscoveredServices(device.instanceId);
+
+        /**
+         * The GATT database of a peer changed, its attributes must be discovered again.
+         *
+         * @event Adapter#gattDatabaseChanged
+         * @type {Object}
+         * @property {Device} device - The <code>Device</code> instance representing the BLE peer we're connected to.
+         * @property {number} startHandle - Start of the affected attribute handle range.
+         * @property {number} endHandle - End of the affected attribute handle range.
+         */
+        this.emit('gattDatabaseChanged', device, data[0] | (data[1] << 8), data[2] | (data[3] << 8));
     }
 
     _parseGattcExchangeMtuResponseEvent(event) {
@@ -1932,6 +2188,10 @@ class Adapter extends EventEmitter {
         const gattOperation = this._gattOperationsMap[device.instanceId];
 
         const previousMtu = this._attMtuMap[device.instanceId];
+        if (!gattOperation || gattOperation.clientRxMtu === undefined) {
+            return;
+        }
+
         const newMtu = Math.min(event.server_rx_mtu, gattOperation.clientRxMtu);
 
         this._attMtuMap[device.instanceId] = newMtu;
@@ -1949,11 +2209,10 @@ class Adapter extends EventEmitter {
             this.emit('attMtuChanged', device, newMtu);
         }
 
-        if (gattOperation && gattOperation.callback) {
+        this._releaseGattOperation(device);
 
+        if (gattOperation.callback) {
             gattOperation.callback(null, newMtu);
-
-            delete this._gattOperationsMap[device.instanceId];
         }
     }
 
@@ -1968,7 +2227,7 @@ class Adapter extends EventEmitter {
                 gattOperation.callback(error);
             }
 
-            delete this._gattOperationsMap[device.instanceId];
+            this._releaseGattOperation(device);
         }
     }
 
@@ -2130,8 +2389,14 @@ class Adapter extends EventEmitter {
 
         this._pendingNotificationsAndIndications.remainingIndicationConfirmations--;
         if (this._sendingNotificationsAndIndicationsComplete()) {
-            this._pendingNotificationsAndIndications.completeCallback(undefined, characteristic);
+            const { completeCallback, hvxError } = this._pendingNotificationsAndIndications;
             this._pendingNotificationsAndIndications = {};
+
+            if (hvxError) {
+                completeCallback(_makeError('Failed to send notification or indication', hvxError));
+            } else {
+                completeCallback(undefined, characteristic);
+            }
         }
     }
 
@@ -2767,6 +3032,37 @@ class Adapter extends EventEmitter {
         return this._attMtuMap[deviceInstanceId];
     }
 
+    /**
+     * Get the CCCD values a connected device has written to the local GATT server.
+     *
+     * The values are tracked by the addon, including the ones restored with <code>gattsSystemAttributeSet</code>
+     * when a bonded device reconnects.
+     *
+     * Only for GATT server role.
+     *
+     * @param {string} deviceInstanceId The device's unique Id.
+     * @returns {undefined|Object} CCCD value keyed by the unique ID of each local characteristic with a CCCD.
+     */
+    getSubscriptions(deviceInstanceId) {
+        const device = this.getDevice(deviceInstanceId);
+
+        if (!device) {
+            return;
+        }
+
+        const subscriptions = {};
+
+        for (let cccd of this._adapter.gattsGetCccdValues(device.connectionHandle)) {
+            const characteristic = this._getCharacteristicByValueHandle('local.server', cccd.value_handle);
+
+            if (characteristic) {
+                subscriptions[characteristic.instanceId] = cccd.value;
+            }
+        }
+
+        return subscriptions;
+    }
+
     /**
      * @summary Start an ATT_MTU exchange by sending an Exchange MTU Request to the server.
      *
@@ -2778,6 +3074,8 @@ class Adapter extends EventEmitter {
      *
      *     However, the SoftDevice never sets ATT_MTU lower than `GATT_MTU_SIZE_DEFAULT` == 23.
      *
+     * If a GATT operation is already in progress with the device, the request is queued until it has completed.
+     *
      * @param {string} deviceInstanceId The device's unique Id.
      * @param {number} mtu Requested ATT_MTU. Default ATT_MTU is 23. Valid range is between 24 and 247.
      * @param {function(Error, number)} [callback] Callback signature: (err, mtu) => {} where `mtu` is the updated
@@ -2798,19 +3096,16 @@ class Adapter extends EventEmitter {
             return;
         }
 
-        if (this._gattOperationsMap[device.instanceId]) {
-            this.emit('error', _makeError('Failed to request att mtu. A GATT operation already in progress.'));
-            return;
-        }
-
-        this._adapter.gattcExchangeMtuRequest(device.connectionHandle, mtu, err => {
-            if (err) {
-                const errorObject = _makeError(`Failed to request att mtu: ${err.message}`);
-                if (callback) callback(errorObject);
-                return;
-            }
-
+        this._scheduleGattOperation(device, undefined, callback, () => {
             this._gattOperationsMap[device.instanceId] = { callback, clientRxMtu: mtu };
+
+            this._adapter.gattcExchangeMtuRequest(device.connectionHandle, mtu, err => {
+                if (err) {
+                    this._releaseGattOperation(device);
+                    const errorObject = _makeError(`Failed to request att mtu: ${err.message}`);
+                    if (callback) callback(errorObject);
+                }
+            });
         });
     }
 
@@ -3405,6 +3700,7 @@ class Adapter extends EventEmitter {
         // is propagated to all promises.
         promiseSequencer(promises, {}).then(data => {
             // TODO: Ierate over all servicses, descriptors, characterstics from parameter services
+            this._localServices = services;
             if (callback) { callback(); }
         }).catch(err => {
             this.emit('error', err);
@@ -3435,10 +3731,13 @@ class Adapter extends EventEmitter {
         // TODO: Implement something for when device is local
         const device = this.getDevice(deviceInstanceId);
 
-        if (this._gattOperationsMap[device.instanceId]) {
-            this.emit('error', _makeError('Failed to get services, a GATT operation already in progress'));
-            return;
-        }
+        this._scheduleGattOperation(device, undefined, callback, () => {
+            this._getServices(device, callback);
+        });
+    }
+
+    _getServices(device, callback) {
+        const deviceInstanceId = device.instanceId;
 
         // TODO: Should we remove old services and do new discovery?
         const alreadyFoundServices = _.filter(this._services, service => {
@@ -3450,9 +3749,24 @@ class Adapter extends EventEmitter {
             return;
         }
 
+        if (this._gattCache && this._gattCache.lookup(device)) {
+            this._restoreAttributesFromGattCache(device, cachedData => {
+                if (cachedData) {
+                    if (callback) { callback(undefined, _.values(cachedData.services)); }
+                    return;
+                }
+
+                // The cache entry was discarded, discover the services
+                this.getServices(deviceInstanceId, callback);
+            });
+
+            return;
+        }
+
         this._gattOperationsMap[device.instanceId] = { callback: callback, pendingHandleReads: {}, parent: device };
         this._adapter.gattcDiscoverPrimaryServices(device.connectionHandle, 1, null, (err, services) => {
             if (err) {
+                this._releaseGattOperation(device);
                 this.emit('error', _makeError('Failed to get services', err));
                 if (callback) { callback(err); }
                 return;
@@ -3492,10 +3806,13 @@ class Adapter extends EventEmitter {
 
         const device = this.getDevice(service.deviceInstanceId);
 
-        if (this._gattOperationsMap[device.instanceId]) {
-            this._checkAndPropagateError(undefined, 'Failed to get characteristics, a gatt operation already in progress', callback);
-            return;
-        }
+        this._scheduleGattOperation(device, undefined, callback, () => {
+            this._getCharacteristics(device, service, callback);
+        });
+    }
+
+    _getCharacteristics(device, service, callback) {
+        const serviceId = service.instanceId;
 
         const alreadyFoundCharacteristics = _.filter(this._characteristics, characteristic => {
             return serviceId === characteristic.serviceInstanceId;
@@ -3518,8 +3835,9 @@ class Adapter extends EventEmitter {
         };
 
         this._adapter.gattcDiscoverCharacteristics(device.connectionHandle, handleRange, err => {
-            if (this._checkAndPropagateError(err, 'Failed to get Characteristics', callback)) {
-                return;
+            if (err) {
+                this._releaseGattOperation(device);
+                this._checkAndPropagateError(err, 'Failed to get Characteristics', callback);
             }
         });
     }
@@ -3608,10 +3926,13 @@ class Adapter extends EventEmitter {
         const service = this.getService(characteristic.serviceInstanceId);
         const device = this.getDevice(service.deviceInstanceId);
 
-        if (this._gattOperationsMap[device.instanceId]) {
-            this.emit('error', _makeError('Failed to get descriptors, a gatt operation already in progress', undefined));
-            return;
-        }
+        this._scheduleGattOperation(device, undefined, callback, () => {
+            this._getDescriptors(device, service, characteristic, callback);
+        });
+    }
+
+    _getDescriptors(device, service, characteristic, callback) {
+        const characteristicId = characteristic.instanceId;
 
         const alreadyFoundDescriptor = _.filter(this._descriptors, descriptor => {
             return characteristicId === descriptor.characteristicInstanceId;
@@ -3625,7 +3946,10 @@ class Adapter extends EventEmitter {
         const handleRange = { start_handle: characteristic.valueHandle + 1, end_handle: service.endHandle };
         this._gattOperationsMap[device.instanceId] = { callback, pendingHandleReads: {}, parent: characteristic };
         this._adapter.gattcDiscoverDescriptors(device.connectionHandle, handleRange, err => {
-            //this._checkAndPropagateError('Failed to get descriptors', err, callback);
+            if (err) {
+                this._releaseGattOperation(device);
+                this._checkAndPropagateError(err, 'Failed to get descriptors', callback);
+            }
         });
     }
 
@@ -3699,6 +4023,9 @@ class Adapter extends EventEmitter {
     /**
      * Discovers information about a range of attributes on a GATT server.
      *
+     * When nothing has been discovered on the device yet, the whole attribute tree is discovered and read by the
+     * native addon in one procedure.
+     *
      * @param {string} deviceInstanceId The device's unique Id.
      * @param {function(Error, Object)} [callback] Callback signature: (err, attributes) => {} where `attributes` contains
      *                                           the device's GATT attributes (services, characteristics and
@@ -3706,13 +4033,304 @@ class Adapter extends EventEmitter {
      * @returns {void}
      */
     getAttributes(deviceInstanceId, callback) {
-        let data = { 'services': {} };
-
-        this._getServicesPromise(deviceInstanceId).then(services => {
-            let p = Promise.resolve(data);
+        const device = this.getDevice(deviceInstanceId);
 
-            for (let service of services) {
-                data.services[service.instanceId] = service;
+        const alreadyFoundServices = _.filter(this._services, service => {
+            return deviceInstanceId === service.deviceInstanceId;
+        });
+
+        // The stepwise discovery resolves attributes that are already discovered from the cache
+        if (!device || !_.isEmpty(alreadyFoundServices)) {
+            this._getAttributesStepwise(deviceInstanceId, callback);
+            return;
+        }
+
+        this._restoreAttributesFromGattCache(device, cachedData => {
+            if (cachedData) {
+                if (callback) { callback(undefined, cachedData); }
+                return;
+            }
+
+            this._scheduleGattOperation(device, undefined, callback, () => {
+                this._discoverAllAttributes(device, callback);
+            });
+        });
+    }
+
+    _discoverAllAttributes(device, callback) {
+        const alreadyFoundServices = _.filter(this._services, service => {
+            return device.instanceId === service.deviceInstanceId;
+        });
+
+        // Services may have been discovered by an operation that was queued before this one
+        if (!_.isEmpty(alreadyFoundServices)) {
+            this._getAttributesStepwise(device.instanceId, callback);
+            return;
+        }
+
+        const gattOperation = { callback, parent: device };
+        this._gattOperationsMap[device.instanceId] = gattOperation;
+
+        // The whole attribute tree, including 128-bit UUIDs and values, is discovered natively in one call
+        // Long values are read with Read Blob requests, without a negotiated ATT_MTU the native side uses the default of 23
+        const attMtu = this.getCurrentAttMtu(device.instanceId);
+        const discoverOptions = attMtu === undefined ? {} : { att_mtu: attMtu };
+        this._adapter.gattcDiscoverAll(device.connectionHandle, true, discoverOptions, (err, services) => {
+            // A GATT timeout or disconnect has already completed the operation
+            if (this._gattOperationsMap[device.instanceId] !== gattOperation) {
+                return;
+            }
+
+            this._releaseGattOperation(device);
+
+            if (err) {
+                this.emit('error', _makeError('Failed to get attributes', err));
+                if (callback) { callback(err); }
+                return;
+            }
+
+            const data = this._addDiscoveredAttributes(device, services);
+            this._storeAttributesInGattCache(device, data);
+
+            if (callback) { callback(undefined, data); }
+        });
+    }
+
+    _discoveredAttributeUuid(uuid, uuid128) {
+        if (uuid128) {
+            return HexConv.arrayTo128BitUuid(uuid128);
+        }
+
+        if (uuid.type >= this._bleDriver.BLE_UUID_TYPE_VENDOR_BEGIN) {
+            return this._converter.lookupVsUuid(uuid);
+        }
+
+        if (uuid.type === this._bleDriver.BLE_UUID_TYPE_UNKNOWN) {
+            return null;
+        }
+
+        return HexConv.numberTo16BitUuid(uuid.uuid);
+    }
+
+    _addDiscoveredAttributes(device, services) {
+        const data = this._addAttributes(device, services.map(service => ({
+            uuid: this._discoveredAttributeUuid(service.uuid, service.uuid128),
+            startHandle: service.handle_range.start_handle,
+            endHandle: service.handle_range.end_handle,
+            characteristics: service.characteristics.map(characteristic => ({
+                uuid: this._discoveredAttributeUuid(characteristic.uuid, characteristic.uuid128),
+                declarationHandle: characteristic.handle_decl,
+                valueHandle: characteristic.handle_value,
+                properties: characteristic.char_props,
+                value: characteristic.value,
+                descriptors: characteristic.descriptors.map(descriptor => ({
+                    uuid: this._discoveredAttributeUuid(descriptor.uuid) || 'Unknown 128 bit descriptor uuid ',
+                    handle: descriptor.handle,
+                    value: descriptor.value,
+                })),
+            })),
+        })));
+
+        this._emitAttributesAdded(data);
+        return data;
+    }
+
+    _addAttributes(device, services) {
+        const data = { 'services': {} };
+
+        services.forEach(service => {
+            const newService = new Service(device.instanceId, service.uuid);
+            newService.startHandle = service.startHandle;
+            newService.endHandle = service.endHandle;
+            newService.characteristics = {};
+            this._services[newService.instanceId] = newService;
+            data.services[newService.instanceId] = newService;
+
+            service.characteristics.forEach(characteristic => {
+                const newCharacteristic = new Characteristic(newService.instanceId, characteristic.uuid, characteristic.value || [], characteristic.properties);
+                newCharacteristic.declarationHandle = characteristic.declarationHandle;
+                newCharacteristic.valueHandle = characteristic.valueHandle;
+                newCharacteristic.descriptors = [];
+                this._characteristics[newCharacteristic.instanceId] = newCharacteristic;
+                newService.characteristics[newCharacteristic.instanceId] = newCharacteristic;
+
+                characteristic.descriptors.forEach(descriptor => {
+                    const newDescriptor = new Descriptor(newCharacteristic.instanceId, descriptor.uuid, descriptor.value || null);
+                    newDescriptor.handle = descriptor.handle;
+                    this._descriptors[newDescriptor.instanceId] = newDescriptor;
+                    newCharacteristic.descriptors.push(newDescriptor);
+                });
+            });
+        });
+
+        return data;
+    }
+
+    _emitAttributesAdded(data) {
+        _.each(data.services, service => {
+            if (service.uuid) {
+                this.emit('serviceAdded', service);
+            }
+
+            _.each(service.characteristics, characteristic => {
+                if (characteristic.uuid) {
+                    this.emit('characteristicAdded', characteristic);
+                }
+
+                characteristic.descriptors.forEach(descriptor => this.emit('descriptorAdded', descriptor));
+            });
+        });
+    }
+
+    /**
+     * Set the cache used to restore the GATT databases of peer devices when they reconnect.
+     *
+     * When set, <code>getServices</code> and <code>getAttributes</code> restore the attributes of a reconnecting
+     * device from the cache instead of discovering them. The attributes stored by <code>getAttributes</code> are
+     * reused as long as the peer's Database Hash is unchanged, or, for bonded peers without a Database Hash, while the
+     * link is encrypted and until the peer sends a Service Changed indication. Service Changed indications are
+     * enabled on every restore. Restored attributes have the values read when the attributes were discovered.
+     *
+     * @param {GattCache|null} gattCache The cache to use, or null to disable caching.
+     * @returns {void}
+     */
+    setGattCache(gattCache) {
+        this._gattCache = gattCache;
+    }
+
+    _findCharacteristicByUuid(data, uuid) {
+        for (const serviceInstanceId in data.services) {
+            const characteristic = _.find(data.services[serviceInstanceId].characteristics, c => c.uuid === uuid);
+
+            if (characteristic) {
+                return characteristic;
+            }
+        }
+
+        return undefined;
+    }
+
+    _findCachedCharacteristicByUuid(services, uuid) {
+        for (const service of services) {
+            const characteristic = _.find(service.characteristics, c => c.uuid === uuid);
+
+            if (characteristic) {
+                return characteristic;
+            }
+        }
+
+        return undefined;
+    }
+
+    _restoreAttributesFromGattCache(device, callback) {
+        const entry = this._gattCache ? this._gattCache.lookup(device) : undefined;
+
+        if (!entry) {
+            callback();
+            return;
+        }
+
+        // The cached attributes are only added to the device once the cache entry is validated, the Database Hash
+        // is read by its handle without adding its characteristic
+        const databaseHash = this._findCachedCharacteristicByUuid(entry.services, DATABASE_HASH_UUID);
+
+        const useCachedAttributes = () => {
+            const data = this._addAttributes(device, entry.services);
+            this._emitAttributesAdded(data);
+            this._enableServiceChangedIndications(device, data);
+            callback(data);
+        };
+
+        const discardCachedAttributes = reason => {
+            this.emit('logMessage', logLevel.DEBUG, `GATT cache for device ${device.address} discarded: ${reason}.`);
+            this._gattCache.invalidate(device);
+            callback();
+        };
+
+        if (!entry.databaseHash || !databaseHash) {
+            // Without a Database Hash the cache is only trusted for bonded peers, they send Service Changed indications
+            if (!this._gattCache.isBonded(device)) {
+                discardCachedAttributes('no Database Hash to validate the cache with and the device is not bonded');
+            } else if (!device.encrypted) {
+                // Service Changed indications are only sent once the bond is in use, keep the entry for later
+                this.emit('logMessage', logLevel.DEBUG, `GATT cache for device ${device.address} not used: link is not encrypted.`);
+                callback();
+            } else {
+                useCachedAttributes();
+            }
+
+            return;
+        }
+
+        this._readRemoteValue(device, databaseHash.valueHandle, 'Read characteristic value failed', (err, value) => {
+            if (err) {
+                discardCachedAttributes('failed to read Database Hash');
+                return;
+            }
+
+            if (Buffer.from(value).toString('hex').toUpperCase() !== entry.databaseHash) {
+                discardCachedAttributes('Database Hash changed');
+                return;
+            }
+
+            useCachedAttributes();
+        });
+    }
+
+    _enableServiceChangedIndications(device, data) {
+        const serviceChanged = this._findCharacteristicByUuid(data, SERVICE_CHANGED_UUID);
+        const cccd = serviceChanged ? this._getCCCDOfCharacteristic(serviceChanged.instanceId) : undefined;
+
+        if (!cccd) {
+            return;
+        }
+
+        // Without discovery nothing else enables the indications that invalidate the cache
+        this.writeDescriptorValue(cccd.instanceId, [0x02, 0x00], true, err => {
+            if (err) {
+                this.emit('logMessage', logLevel.WARNING, `Failed to enable Service Changed indications for device ${device.address}, GATT cache entry discarded.`);
+                this._gattCache.invalidate(device);
+            }
+        });
+    }
+
+    _storeAttributesInGattCache(device, data) {
+        if (!this._gattCache) {
+            return;
+        }
+
+        const services = _.map(data.services, service => ({
+            uuid: service.uuid,
+            startHandle: service.startHandle,
+            endHandle: service.endHandle,
+            characteristics: _.map(service.characteristics, characteristic => ({
+                uuid: characteristic.uuid,
+                declarationHandle: characteristic.declarationHandle,
+                valueHandle: characteristic.valueHandle,
+                properties: characteristic.properties,
+                value: characteristic.value,
+                descriptors: (characteristic.descriptors || []).map(descriptor => ({
+                    uuid: descriptor.uuid,
+                    handle: descriptor.handle,
+                    value: descriptor.value,
+                })),
+            })),
+        }));
+
+        const databaseHash = this._findCharacteristicByUuid(data, DATABASE_HASH_UUID);
+        const databaseHashValue = databaseHash && databaseHash.value && databaseHash.value.length === 16 ? databaseHash.value : undefined;
+
+        this._gattCache.store(device, services, databaseHashValue);
+    }
+
+    _getAttributesStepwise(deviceInstanceId, callback) {
+        let data = { 'services': {} };
+
+        this._getServicesPromise(deviceInstanceId).then(services => {
+            let p = Promise.resolve(data);
+
+            for (let service of services) {
+                data.services[service.instanceId] = service;
 
                 p = p.then(data => {
                     return this._getCharacteristicsPromise()(data, service);
@@ -3721,7 +4339,16 @@ class Adapter extends EventEmitter {
 
             return p;
         })
-            .then(data => { if (callback) callback(undefined, data); })
+            .then(data => {
+                const device = this.getDevice(deviceInstanceId);
+
+                // Attributes restored from a valid cache entry are not stored again
+                if (this._gattCache && !this._gattCache.lookup(device)) {
+                    this._storeAttributesInGattCache(device, data);
+                }
+
+                if (callback) callback(undefined, data);
+            })
             .catch(error => { if (callback) callback(error); });
     }
 
@@ -3732,9 +4359,11 @@ class Adapter extends EventEmitter {
      * @param {function(Error, number[])} [callback] Callback signature: (err, readBytes) => {} where `readBytes` is an
      *                                             array of numbers corresponding to the value of the GATT
      *                                             characteristic.
-     * @returns {void}
+     * @param {Object} [options] Options for the operation: {priority}, see <code>GattOperationQueue</code>.
+     * @returns {number|undefined} Id of the GATT operation, which can be passed to <code>cancelGattOperation</code>
+     *                             while the operation is queued.
      */
-    readCharacteristicValue(characteristicId, callback) {
+    readCharacteristicValue(characteristicId, callback, options) {
         const characteristic = this.getCharacteristic(characteristicId);
         if (!characteristic) {
             throw new Error('Characteristic value read failed: Could not get characteristic with id ' + characteristicId);
@@ -3750,16 +4379,139 @@ class Adapter extends EventEmitter {
             throw new Error('Characteristic value read failed: Could not get device');
         }
 
-        if (this._gattOperationsMap[device.instanceId]) {
-            throw new Error('Characteristic value read failed: A gatt operation already in progress with device id ' + device.instanceId);
+        return this._readRemoteValue(device, characteristic.valueHandle, 'Read characteristic value failed', callback, options);
+    }
+
+    /**
+     * Reads the values of several GATT characteristics.
+     *
+     * Characteristics with a fixed value length on the same device are read together with Read Multiple requests,
+     * as many as fit in the negotiated ATT_MTU. Characteristics with a variable value length, and characteristics the
+     * device fails to read that way, are read one by one. If any of the characteristics is unknown nothing is read and
+     * the callback is called with an error.
+     *
+     * @param {string[]} characteristicIds Unique IDs of the GATT characteristics.
+     * @param {function(Error, Array)} [callback] Callback signature: (err, values) => {} where `values` is an array
+     *                                          with the value (array of bytes) of each characteristic, in the order
+     *                                          of `characteristicIds`.
+     * @param {Object} [options] Options for the operations: {priority, lengths} where `lengths` maps characteristic
+     *                           IDs to the fixed value length of application specific characteristics.
+     * @returns {void}
+     */
+    readCharacteristicValues(characteristicIds, callback, options) {
+        const values = new Array(characteristicIds.length);
+        const readMultipleEntries = {};
+        const reads = [];
+
+        const readOne = index => new Promise((resolve, reject) => {
+            this.readCharacteristicValue(characteristicIds[index], (err, value) => {
+                if (err) {
+                    reject(err);
+                    return;
+                }
+
+                values[index] = value;
+                resolve();
+            }, options);
+        });
+
+        // Every id is checked before any read is scheduled, so a bad id never leaves reads behind without a listener
+        const readPlans = [];
+
+        for (const characteristicId of characteristicIds) {
+            const characteristic = this.getCharacteristic(characteristicId);
+            if (!characteristic) {
+                if (callback) { callback(_makeError('Characteristic values read failed: Could not get characteristic with id ' + characteristicId)); }
+                return;
+            }
+
+            let device;
+
+            if (!this._instanceIdIsOnLocalDevice(characteristicId)) {
+                try {
+                    device = this._getDeviceByCharacteristicId(characteristicId);
+                } catch (err) {
+                    if (callback) { callback(_makeError('Characteristic values read failed: ' + err.message)); }
+                    return;
+                }
+            }
+
+            readPlans.push({ characteristic, device });
         }
 
-        this._gattOperationsMap[device.instanceId] = { callback: callback, readBytes: [] };
+        readPlans.forEach(({ characteristic, device }, index) => {
+            const characteristicId = characteristicIds[index];
+            const explicitLength = options && options.lengths ? options.lengths[characteristicId] : undefined;
+            const length = explicitLength !== undefined ? explicitLength : ReadMultiple.fixedValueLength(characteristic.uuid);
 
-        this._adapter.gattcRead(device.connectionHandle, characteristic.valueHandle, 0, err => {
-            if (err) {
-                this.emit('error', _makeError('Read characteristic value failed', err));
+            if (!device || length === undefined) {
+                reads.push(readOne(index));
+                return;
+            }
+
+            if (!readMultipleEntries[device.instanceId]) {
+                readMultipleEntries[device.instanceId] = [];
             }
+
+            readMultipleEntries[device.instanceId].push({ index, handle: characteristic.valueHandle, length });
+        });
+
+        for (const deviceInstanceId in readMultipleEntries) {
+            const device = this.getDevice(deviceInstanceId);
+            const groups = ReadMultiple.groupByPayloadSize(readMultipleEntries[deviceInstanceId],
+                this._maxReadPayloadSize(deviceInstanceId));
+
+            for (const group of groups) {
+                if (group.length === 1) {
+                    reads.push(readOne(group[0].index));
+                    continue;
+                }
+
+                reads.push(this._readMultiple(device, group, options)
+                    .then(groupValues => {
+                        group.forEach((entry, i) => { values[entry.index] = groupValues[i]; });
+                    })
+                    .catch(err => {
+                        this.emit('logMessage', logLevel.DEBUG, `Read multiple failed, reading characteristics one by one: ${err.message}`);
+                        return Promise.all(group.map(entry => readOne(entry.index)));
+                    }));
+            }
+        }
+
+        Promise.all(reads)
+            .then(() => { if (callback) { callback(undefined, values); } })
+            .catch(err => { if (callback) { callback(err); } });
+    }
+
+    _readMultiple(device, group, options) {
+        const handles = group.map(entry => entry.handle);
+
+        return new Promise((resolve, reject) => {
+            const callback = (err, readBytes) => {
+                if (err) {
+                    reject(err);
+                    return;
+                }
+
+                const groupValues = ReadMultiple.splitValues(readBytes, group.map(entry => entry.length));
+                if (!groupValues) {
+                    reject(_makeError('Read multiple response does not match the expected value lengths'));
+                    return;
+                }
+
+                resolve(groupValues);
+            };
+
+            this._scheduleGattOperation(device, options, callback, () => {
+                this._gattOperationsMap[device.instanceId] = { callback, readMultiple: true };
+
+                this._adapter.gattcReadCharacteristicValues(device.connectionHandle, handles, handles.length, err => {
+                    if (err) {
+                        this._releaseGattOperation(device);
+                        callback(err);
+                    }
+                });
+            });
         });
     }
 
@@ -3771,9 +4523,13 @@ class Adapter extends EventEmitter {
      * @param {boolean} ack Require acknowledge from device, irrelevant in GATTS role.
      * @param {function(Error)} completeCallback Callback signature: err => {}
      * @param {function} deviceNotifiedOrIndicated TODO
-     * @returns {void}
+     * @param {Object} [options] Options for the operation: {priority, reliable}, see <code>GattOperationQueue</code>.
+     *                            <code>reliable</code> verifies each prepared part of a long write before executing it.
+     *                           Writes without response are not queued.
+     * @returns {number|undefined} Id of the GATT operation, which can be passed to <code>cancelGattOperation</code>
+     *                             while the operation is queued.
      */
-    writeCharacteristicValue(characteristicId, value, ack, completeCallback, deviceNotifiedOrIndicated) {
+    writeCharacteristicValue(characteristicId, value, ack, completeCallback, deviceNotifiedOrIndicated, options) {
         const characteristic = this.getCharacteristic(characteristicId);
         if (!characteristic) {
             throw new Error('Characteristic value write failed: Could not get characteristic with id ' + characteristicId);
@@ -3789,26 +4545,107 @@ class Adapter extends EventEmitter {
             throw new Error('Characteristic value write failed: Could not get device');
         }
 
-        if (this._gattOperationsMap[device.instanceId]) {
-            throw new Error('Characteristic value write failed: A gatt operation already in progress with device id ' + device.instanceId);
+        return this._writeRemoteValue(device, characteristic, value, ack, completeCallback, options);
+    }
+
+    /**
+     * Streams data to a GATT characteristic on a remote device using writes without response.
+     *
+     * The write command TX queue of the SoftDevice is kept full, instead of waiting for a TX complete event after
+     * each packet. A value is split into packets of (ATT MTU - 3) bytes, an array of chunks is sent as given.
+     *
+     * @param {string} characteristicId Unique ID of the GATT characteristic.
+     * @param {array} value The value (array of bytes), or an array of chunks (arrays of bytes) to be written.
+     * @param {function(Error, Object)} callback Callback signature: (err, stats) => {} where stats is
+     *                                           {bytes, packets, duration, bytesPerSecond}, duration in milliseconds.
+     * @param {Object} [options] Options for the operation: {priority}, see <code>GattOperationQueue</code>.
+     * @returns {number} Id of the GATT operation, which can be passed to <code>cancelGattOperation</code> while the
+     *                   operation is queued.
+     */
+    writeCharacteristicValueStream(characteristicId, value, callback, options) {
+        const characteristic = this.getCharacteristic(characteristicId);
+        if (!characteristic) {
+            throw new Error('Characteristic value stream failed: Could not get characteristic with id ' + characteristicId);
         }
 
-        this._gattOperationsMap[device.instanceId] = { callback: completeCallback, bytesWritten: 0, value: value.slice(), attribute: characteristic };
+        if (this._instanceIdIsOnLocalDevice(characteristicId)) {
+            throw new Error('Characteristic value stream failed: Characteristic is on the local device');
+        }
 
-        if (value.length > this._maxShortWritePayloadSize(device.instanceId)) {
-            if (!ack) {
-                delete this._gattOperationsMap[device.instanceId];
-                throw new Error('Long writes do not support BLE_GATT_OP_WRITE_CMD');
+        const device = this._getDeviceByCharacteristicId(characteristicId);
+        if (!device) {
+            throw new Error('Characteristic value stream failed: Could not get device');
+        }
+
+        if (value.length === 0) {
+            throw new Error('Characteristic value stream failed: No data to write');
+        }
+
+        const chunked = Array.isArray(value[0]);
+
+        if (chunked) {
+            const maxChunkSize = this._maxShortWritePayloadSize(device.instanceId);
+
+            value.forEach(chunk => {
+                if (chunk.length === 0 || chunk.length > maxChunkSize) {
+                    throw new Error(`Characteristic value stream failed: Chunk length must be between 1 and ${maxChunkSize}`);
+                }
+            });
+        }
+
+        return this._scheduleGattOperation(device, options, callback, () => {
+            this._writeStream(device, characteristic, value, chunked, callback);
+        });
+    }
+
+    /**
+     * Cancels a queued GATT operation.
+     *
+     * GATT operations requested while another operation is in progress with the same device are queued. A queued
+     * operation can be cancelled until it is started, its callback is then called with an error.
+     *
+     * @param {number} operationId Id returned by the method that requested the operation.
+     * @returns {boolean} True if the operation was cancelled, false if it has already been started or completed.
+     */
+    cancelGattOperation(operationId) {
+        return this._gattOperationQueue.cancel(operationId, _makeError('GATT operation cancelled'));
+    }
+
+    _scheduleGattOperation(device, options, callback, start) {
+        const priority = options ? options.priority : undefined;
+        const operationId = this._gattOperationQueue.enqueue(device.instanceId, start, err => {
+            if (callback) { callback(err); }
+        }, priority);
+
+        this._startNextGattOperation(device.instanceId);
+
+        return operationId;
+    }
+
+    _startNextGattOperation(deviceInstanceId) {
+        // Operations that complete without ATT traffic leave the device idle, so keep going until one is in progress
+        while (!this._gattOperationsMap[deviceInstanceId]) {
+            const operation = this._gattOperationQueue.dequeue(deviceInstanceId);
+            if (!operation) {
+                return;
             }
 
-            this._gattOperationsMap[device.instanceId].bytesWritten = this._maxLongWritePayloadSize(device.instanceId);
-            this._longWrite(device, characteristic, value, completeCallback);
-        } else {
-            this._gattOperationsMap[device.instanceId].bytesWritten = value.length;
-            this._shortWrite(device, characteristic, value, ack, completeCallback);
+            try {
+                operation.start();
+            } catch (err) {
+                delete this._gattOperationsMap[deviceInstanceId];
+                operation.cancel(err);
+            }
         }
     }
 
+    _releaseGattOperation(device) {
+        delete this._gattOperationsMap[device.instanceId];
+
+        // Callbacks of the completed operation run before the next queued operation is started
+        process.nextTick(() => this._startNextGattOperation(device.instanceId));
+    }
+
     _getDeviceByDescriptorId(descriptorId) {
         const descriptor = this._descriptors[descriptorId];
         if (!descriptor) {
@@ -3862,9 +4699,11 @@ class Adapter extends EventEmitter {
      * @param {function(Error, number[])} [callback] Callback signature: (err, readBytes) => {} where `readBytes` is an
      *                                             array of numbers corresponding to the value of the GATT
      *                                             descriptor.
-     * @returns {void}
+     * @param {Object} [options] Options for the operation: {priority}, see <code>GattOperationQueue</code>.
+     * @returns {number|undefined} Id of the GATT operation, which can be passed to <code>cancelGattOperation</code>
+     *                             while the operation is queued.
      */
-    readDescriptorValue(descriptorId, callback) {
+    readDescriptorValue(descriptorId, callback, options) {
         const descriptor = this.getDescriptor(descriptorId);
         if (!descriptor) {
             throw new Error('Descriptor read failed: could not get descriptor with id ' + descriptorId);
@@ -3880,16 +4719,34 @@ class Adapter extends EventEmitter {
             throw new Error('Descriptor read failed: Could not get device');
         }
 
-        if (this._gattOperationsMap[device.instanceId]) {
-            throw new Error('Descriptor read failed: A gatt operation already in progress with device with id ' + device.instanceId);
-        }
+        return this._readRemoteValue(device, descriptor.handle, 'Read descriptor value failed', callback, options);
+    }
 
-        this._gattOperationsMap[device.instanceId] = { callback: callback, readBytes: [] };
+    _readRemoteValue(device, handle, errorMessage, callback, options) {
+        return this._scheduleGattOperation(device, options, callback, () => {
+            const gattOperation = { callback };
+            this._gattOperationsMap[device.instanceId] = gattOperation;
 
-        this._adapter.gattcRead(device.connectionHandle, descriptor.handle, 0, err => {
-            if (err) {
-                this.emit('error', _makeError('Read descriptor value failed', err));
-            }
+            // Read Blob requests for long values are issued natively, the whole value arrives in one buffer
+            // Without a negotiated ATT_MTU the native side uses the default of 23
+            const attMtu = this.getCurrentAttMtu(device.instanceId);
+            const readOptions = attMtu === undefined ? {} : { att_mtu: attMtu };
+            this._adapter.gattcReadLong(device.connectionHandle, handle, readOptions, (err, value) => {
+                // A GATT timeout or disconnect has already completed the operation
+                if (this._gattOperationsMap[device.instanceId] !== gattOperation) {
+                    return;
+                }
+
+                this._releaseGattOperation(device);
+
+                if (err) {
+                    this.emit('error', _makeError(errorMessage, err));
+                    if (callback) { callback(err); }
+                    return;
+                }
+
+                if (callback) { callback(undefined, Array.from(value)); }
+            });
         });
     }
 
@@ -3901,10 +4758,13 @@ class Adapter extends EventEmitter {
      * @param {boolean} ack Require acknowledge from device, irrelevant in GATTS role.
      * @param {function(Error)} [callback] Callback signature: err => {}.
      *                                   (not called until ack is received if `requireAck`).
-     *                                   options: {ack, long, offset}
-     * @returns {void}
+     * @param {Object} [options] Options for the operation: {priority, reliable}, see <code>GattOperationQueue</code>.
+     *                            <code>reliable</code> verifies each prepared part of a long write before executing it.
+     *                           Writes without response are not queued.
+     * @returns {number|undefined} Id of the GATT operation, which can be passed to <code>cancelGattOperation</code>
+     *                             while the operation is queued.
      */
-    writeDescriptorValue(descriptorId, value, ack, callback) {
+    writeDescriptorValue(descriptorId, value, ack, callback, options) {
         // Does not support reliable write
         const descriptor = this.getDescriptor(descriptorId);
         if (!descriptor) {
@@ -3921,24 +4781,36 @@ class Adapter extends EventEmitter {
             throw new Error('Descriptor write failed: Could not get device');
         }
 
-        if (this._gattOperationsMap[device.instanceId]) {
-            throw new Error('Descriptor write failed: A gatt operation already in progress with device with id ' + device.instanceId);
-        }
-
-        this._gattOperationsMap[device.instanceId] = { callback: callback, bytesWritten: 0, value: value.slice(), attribute: descriptor };
+        return this._writeRemoteValue(device, descriptor, value, ack, callback, options);
+    }
 
+    _writeRemoteValue(device, attribute, value, ack, callback, options) {
         if (value.length > this._maxShortWritePayloadSize(device.instanceId)) {
             if (!ack) {
-                delete this._gattOperationsMap[device.instanceId];
                 throw new Error('Long writes do not support BLE_GATT_OP_WRITE_CMD');
             }
 
-            this._gattOperationsMap[device.instanceId].bytesWritten = this._maxLongWritePayloadSize(device.instanceId);
-            this._longWrite(device, descriptor, value, callback);
-        } else {
-            this._gattOperationsMap[device.instanceId].bytesWritten = value.length;
-            this._shortWrite(device, descriptor, value, ack, callback);
+            return this._scheduleGattOperation(device, options, callback, () => {
+                this._longWrite(device, attribute, value, callback, options);
+            });
+        }
+
+        // Writes without response have no ATT response to wait for, they are sent alongside queued requests
+        if (!ack) {
+            this._shortWrite(device, attribute, value, ack, callback);
+            return undefined;
         }
+
+        return this._scheduleGattOperation(device, options, callback, () => {
+            this._gattOperationsMap[device.instanceId] = {
+                callback,
+                bytesWritten: value.length,
+                value: value.slice(),
+                attribute,
+            };
+
+            this._shortWrite(device, attribute, value, ack, callback);
+        });
     }
 
     _shortWrite(device, attribute, value, ack, callback) {
@@ -3958,13 +4830,15 @@ class Adapter extends EventEmitter {
                 }
                 return this._shortWriteWithoutResponse(device, writeParameters)
                     .then(() => {
-                        delete this._gattOperationsMap[device.instanceId];
                         attribute.value = value;
                         if (callback) { callback(undefined, attribute); }
                     });
             })
             .catch(err => {
-                delete this._gattOperationsMap[device.instanceId];
+                if (ack) {
+                    this._releaseGattOperation(device);
+                }
+
                 const error = _makeError(`Failed to write to attribute with handle: ${attribute.handle}: ${err.message}`);
                 this.emit('error', error);
                 if (callback) callback(error);
@@ -4008,51 +4882,116 @@ class Adapter extends EventEmitter {
         ]);
     }
 
-    _longWrite(device, attribute, value, callback) {
-        if (value.length < this._maxShortWritePayloadSize(device.instanceId)) {
-            throw new Error('Wrong write method. Use regular write for payload sizes < ' + this._maxShortWritePayloadSize(device.instanceId));
-        }
+    _longWrite(device, attribute, value, callback, options) {
+        const gattOperation = { callback, value: value.slice(), attribute };
+        this._gattOperationsMap[device.instanceId] = gattOperation;
 
-        const writeParameters = {
-            write_op: this._bleDriver.BLE_GATT_OP_PREP_WRITE_REQ,
-            flags: this._bleDriver.BLE_GATT_EXEC_WRITE_FLAG_PREPARED_WRITE,
-            handle: attribute.handle,
-            offset: 0,
-            len: this._maxLongWritePayloadSize(device.instanceId),
-            value: value.slice(0, this._maxLongWritePayloadSize(device.instanceId)),
+        const writeOptions = {
+            reliable: !!(options && options.reliable),
+            att_mtu: this.getCurrentAttMtu(device.instanceId),
         };
 
-        this._adapter.gattcWrite(device.connectionHandle, writeParameters, err => {
+        // The Prepare Write and Execute Write requests are issued natively without returning here in between
+        this._adapter.gattcWriteLong(device.connectionHandle, attribute.handle, Buffer.from(value), writeOptions, err => {
+            // A GATT timeout or disconnect has already completed the operation
+            if (this._gattOperationsMap[device.instanceId] !== gattOperation) {
+                return;
+            }
+
+            this._releaseGattOperation(device);
+
             if (err) {
-                this._longWriteCancel(device, attribute);
                 this.emit('error', _makeError('Failed to write value to device/handle ' + device.instanceId + '/' + attribute.handle, err));
+                if (callback) { callback(err); }
                 return;
             }
 
+            attribute.value = gattOperation.value;
+            this._emitAttributeValueChanged(attribute);
+
+            if (callback) { callback(undefined, attribute); }
         });
     }
 
-    _longWriteCancel(device, attribute) {
-        const gattOperation = this._gattOperationsMap[device.instanceId];
-        const writeParameters = {
-            write_op: this._bleDriver.BLE_GATT_OP_EXEC_WRITE_REQ,
-            flags: this._bleDriver.BLE_GATT_EXEC_WRITE_FLAG_PREPARED_CANCEL,
-            handle: attribute.handle,
-            offset: 0,
-            len: 0,
-            value: [],
-        };
+    _writeStream(device, attribute, value, chunked, callback) {
+        const gattOperation = { callback, attribute };
+        this._gattOperationsMap[device.instanceId] = gattOperation;
 
-        this._adapter.gattcWrite(device.connectionHandle, writeParameters, err => {
-            delete this._gattOperationsMap[device.instanceId];
+        // The ATT_MTU can change while the operation is queued, a value is split when the operation starts
+        const maxChunkSize = this._maxShortWritePayloadSize(device.instanceId);
+        const lastChunk = chunked ?
+            value[value.length - 1] :
+            value.slice(Math.floor((value.length - 1) / maxChunkSize) * maxChunkSize);
+
+        const streamComplete = (err, stats) => {
+            // A disconnect has already completed the operation
+            if (this._gattOperationsMap[device.instanceId] !== gattOperation) {
+                return;
+            }
+
+            this._releaseGattOperation(device);
 
             if (err) {
-                this.emit('error', _makeError('Failed to cancel failed long write', err));
-                gattOperation.callback('Failed to write and failed to cancel write');
+                const error = _makeError(`Failed to stream to attribute with handle: ${attribute.handle}`, err);
+                this.emit('error', error);
+                if (callback) { callback(error); }
+                return;
+            }
+
+            attribute.value = lastChunk;
+            if (callback) { callback(undefined, stats); }
+        };
+
+        if (!this._adapter.gattcWriteStream) {
+            const chunks = [];
+
+            if (chunked) {
+                chunks.push(...value);
             } else {
-                gattOperation.callback('Failed to write value to device/handle ' + device.instanceId + '/' + attribute.handle);
+                for (let i = 0; i < value.length; i += maxChunkSize) {
+                    chunks.push(value.slice(i, i + maxChunkSize));
+                }
             }
-        });
+
+            this._writeStreamSequentially(device, attribute, chunks, streamComplete);
+            return;
+        }
+
+        // Packets are handed to the SoftDevice natively as write command TX queue space is released.
+        // A value is passed as one buffer, the AddOn splits it into packets of (ATT_MTU - 3) bytes.
+        const data = chunked ? value.map(chunk => Buffer.from(chunk)) : Buffer.from(value);
+        this._adapter.gattcWriteStream(device.connectionHandle, attribute.handle, data,
+            { att_mtu: this.getCurrentAttMtu(device.instanceId) }, streamComplete);
+    }
+
+    _writeStreamSequentially(device, attribute, chunks, callback) {
+        // SoftDevice API v2 has no write command TX complete event, each packet waits for BLE_EVT_TX_COMPLETE
+        const start = Date.now();
+        let bytes = 0;
+
+        chunks.reduce((previous, chunk) => previous.then(() => {
+            const writeParameters = {
+                write_op: this._bleDriver.BLE_GATT_OP_WRITE_CMD,
+                flags: 0,
+                handle: attribute.handle,
+                offset: 0,
+                len: chunk.length,
+                value: chunk,
+            };
+
+            return this._shortWriteWithoutResponse(device, writeParameters)
+                .then(() => { bytes += chunk.length; });
+        }), Promise.resolve())
+            .then(() => {
+                const duration = Date.now() - start;
+                callback(undefined, {
+                    bytes,
+                    packets: chunks.length,
+                    duration,
+                    bytesPerSecond: duration > 0 ? (bytes * 1000) / duration : 0,
+                });
+            })
+            .catch(err => callback(err));
     }
 
     _sendingNotificationsAndIndicationsComplete() {
@@ -4114,102 +5053,73 @@ class Adapter extends EventEmitter {
             return;
         }
 
-        // TODO: Figure out if we should use hvx?
-        const cccdDescriptor = this._getCCCDOfCharacteristic(attribute.instanceId);
-        let sentHvx = false;
+        if (this._getCCCDOfCharacteristic(attribute.instanceId)) {
+            this._notifyAll(attribute, value, offset, completeCallback, deviceNotifiedOrIndicated);
+            return;
+        }
+
+        this._adapter.gattsSetValue(this._bleDriver.BLE_CONN_HANDLE_INVALID, attribute.handle, writeParameters, (err, writeResult) => {
+            if (err) {
+                this.emit('error', _makeError('Failed to write local value', err));
+                completeCallback(err, undefined);
+                return;
+            }
+
+            this._setAttributeValueWithOffset(attribute, value, offset);
+            completeCallback(undefined, attribute);
+        });
+    }
+
+    _notifyAll(characteristic, value, offset, completeCallback, deviceNotifiedOrIndicated) {
+        // Subscribers are sent the whole value, merge a write at an offset into the current value first
+        const fullValue = characteristic.value.slice(0, offset).concat(value);
+
+        // The native side keeps the CCCD values of every connection and sends to all subscribers in one call
+        this._adapter.gattsNotifyAll(characteristic.valueHandle, Buffer.from(fullValue), (err, results) => {
+            if (err) {
+                this.emit('error', _makeError('Failed to write local value', err));
+                completeCallback(err, undefined);
+                return;
+            }
+
+            characteristic.value = fullValue;
+
+            if (results.length === 0) {
+                completeCallback(undefined, characteristic);
+                return;
+            }
 
-        if (cccdDescriptor) {
-            // TODO: This is probably way to simple, do we need a map of devices indication is sent to?
             this._pendingNotificationsAndIndications = {
                 completeCallback,
                 deviceNotifiedOrIndicated,
-                sentAllNotificationsAndIndications: false,
+                sentAllNotificationsAndIndications: true,
                 remainingNotificationCallbacks: 0,
                 remainingIndicationConfirmations: 0,
             };
 
-            for (let deviceInstanceId in this._devices) {
-                const cccdValue = cccdDescriptor.value[deviceInstanceId][0];
-                const sendIndication = cccdValue & 2;
-                const sendNotification = !sendIndication && (cccdValue & 1);
+            for (let result of results) {
+                const device = this._getDeviceByConnectionHandle(result.conn_handle);
 
-                if (sendNotification || sendIndication) {
-                    const device = this._devices[deviceInstanceId];
-                    const hvxParams = {
-                        handle: attribute.valueHandle,
-                        type: sendIndication || sendNotification,
-                        offset: offset,
-                        len: value.length,
-                        data: value,
-                    };
-                    sentHvx = true;
-
-                    if (sendNotification) {
-                        this._pendingNotificationsAndIndications.remainingNotificationCallbacks++;
-                    } else if (sendIndication) {
-                        this._pendingNotificationsAndIndications.remainingIndicationConfirmations++;
+                if (result.error) {
+                    this._pendingNotificationsAndIndications.hvxError = result.error;
+                    this.emit('error', _makeError('Failed to send notification', result.error));
+                } else if (result.type === this._bleDriver.BLE_GATT_HVX_INDICATION) {
+                    // Completed when the confirmation arrives, see _parseGattsHvcEvent
+                    this._pendingNotificationsAndIndications.remainingIndicationConfirmations++;
+                } else {
+                    if (deviceNotifiedOrIndicated) {
+                        deviceNotifiedOrIndicated(device, characteristic);
                     }
 
-                    this._adapter.gattsHVX(device.connectionHandle, hvxParams, err => {
-                        if (err) {
-                            if (sendNotification) {
-                                this._pendingNotificationsAndIndications.remainingNotificationCallbacks--;
-                            } else if (sendIndication) {
-                                this._pendingNotificationsAndIndications.remainingIndicationConfirmations--;
-                            }
-
-                            this.emit('error', _makeError('Failed to send notification', err));
-
-                            if (this._sendingNotificationsAndIndicationsComplete()) {
-                                completeCallback(_makeError('Failed to send notification or indication', err));
-                                this._pendingNotificationsAndIndications = {};
-                            }
-
-                            return;
-                        }
-
-                        this._setAttributeValueWithOffset(attribute, value, offset);
-
-                        if (sendNotification) {
-                            if (deviceNotifiedOrIndicated) {
-                                deviceNotifiedOrIndicated(device, attribute);
-                            }
-
-                            this.emit('deviceNotifiedOrIndicated', device, attribute);
-
-                            this._pendingNotificationsAndIndications.remainingNotificationCallbacks--;
-                            if (this._sendingNotificationsAndIndicationsComplete()) {
-                                completeCallback(undefined);
-                                this._pendingNotificationsAndIndications = {};
-                            }
-                        } else if (sendIndication) {
-                            return;
-                        }
-                    });
+                    this.emit('deviceNotifiedOrIndicated', device, characteristic);
                 }
             }
 
-            this._pendingNotificationsAndIndications.sentAllNotificationsAndIndications = true;
-        }
-
-        if (sentHvx) {
             if (this._sendingNotificationsAndIndicationsComplete()) {
-                completeCallback(undefined);
+                const { hvxError } = this._pendingNotificationsAndIndications;
                 this._pendingNotificationsAndIndications = {};
+                completeCallback(hvxError ? _makeError('Failed to send notification or indication', hvxError) : undefined);
             }
-
-            return;
-        }
-
-        this._adapter.gattsSetValue(this._bleDriver.BLE_CONN_HANDLE_INVALID, attribute.handle, writeParameters, (err, writeResult) => {
-            if (err) {
-                this.emit('error', _makeError('Failed to write local value', err));
-                completeCallback(err, undefined);
-                return;
-            }
-
-            this._setAttributeValueWithOffset(attribute, value, offset);
-            completeCallback(undefined, attribute);
         });
     }
 
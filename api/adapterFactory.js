@@ -40,12 +40,13 @@ const os = require('os');
 
 const _bleDriverV2 = require('bindings')('pc-ble-driver-js-sd_api_v2');
 const _bleDriverV5 = require('bindings')('pc-ble-driver-js-sd_api_v5');
+const _simulatedDriver = require('./simulation/simulatedDriver');
 
 const Adapter = require('./adapter');
 const logLevel = require('./util/logLevel');
 const EventEmitter = require('events');
 
-const _bleDrivers = { v2: _bleDriverV2, v5: _bleDriverV5 };
+const _bleDrivers = { v2: _bleDriverV2, v5: _bleDriverV5, sim: _simulatedDriver };
 const _singleton = Symbol('Ensure that only one instance of AdapterFactory ever exists.');
 
 /** @constant {number} Update interval, in milliseconds, at which PC shall be checked for new connected adapters. */
@@ -309,13 +310,18 @@ class AdapterFactory extends EventEmitter {
     /**
      * Create Adapter with custom serialport
      *
-     * @param sdVersion {string} Softdevice API version: 'v2' or 'v5'.
-     * @param path {string} Serialport name (eg. 'COM7' on windows).
+     * Use the SoftDevice API version 'sim' to create an adapter on the simulated driver, a JavaScript stand-in for
+     * the AddOn meant for fast unit tests. The path is then the name of the virtual radio the adapter joins,
+     * adapters created with the same path can see and connect to each other. To run the AddOn itself without a
+     * connectivity device, open a 'v5' adapter with the <code>simulation</code> option of <code>Adapter.open()</code>.
+     *
+     * @param sdVersion {string} Softdevice API version: 'v2', 'v5' or 'sim'.
+     * @param path {string} Serialport name (eg. 'COM7' on windows), or virtual radio name for 'sim'.
      * @param instanceId {string} The unique Id that identifies this Adapter instance.
      * @returns {Adapter} Created adapter.
      */
     createAdapter(sdVersion, path, instanceId) {
-        if (sdVersion !== 'v2' && sdVersion !== 'v5') {
+        if (sdVersion !== 'v2' && sdVersion !== 'v5' && sdVersion !== 'sim') {
             throw new Error('Unsupported soft-device version!');
         }
         if (typeof path === 'undefined') {
@@ -325,13 +331,57 @@ class AdapterFactory extends EventEmitter {
             throw new Error('Missing parameter: instanceId!');
         }
 
-        const selectedDriver = this._bleDrivers[sdVersion];
+        const selectedDriver = this._bleDrivers[sdVersion] || _bleDrivers[sdVersion];
         const addOnAdapter = new selectedDriver.Adapter();
         const newAdapter = new Adapter(selectedDriver, addOnAdapter, instanceId, path);
         this.adapterList = [...this.adapterList, newAdapter]
 
         return newAdapter
     }
+
+    /**
+     * Open several adapters in parallel.
+     *
+     * Each adapter is opened with its own copy of `options`, see `Adapter.open`. Opening is done in the
+     * libuv thread pool, so at most `UV_THREADPOOL_SIZE` (default 4) adapters go through the transport
+     * handshake at the same time. Increase it to bring up more adapters at once.
+     *
+     * @param {Array<Adapter>} adapters Adapters to open.
+     * @param {Object} [options] Options to open each adapter with, see `Adapter.open`.
+     * @param {function(Error, Array)} [callback] Callback signature: (err, results) => {}, called when all adapters
+     *                                           have been opened or have failed. `results` has one entry
+     *                                           {adapter, error, duration} for each adapter in the order given,
+     *                                           duration is the time to open in milliseconds. `err` is set if any
+     *                                           adapter failed to open.
+     * @returns {void}
+     */
+    openMany(adapters, options, callback) {
+        const start = Date.now();
+
+        const opened = adapters.map(adapter => new Promise(resolve => {
+            const adapterOptions = options ? Object.assign({}, options) : undefined;
+
+            try {
+                adapter.open(adapterOptions, error => {
+                    resolve({ adapter, error, duration: Date.now() - start });
+                });
+            } catch (error) {
+                resolve({ adapter, error, duration: Date.now() - start });
+            }
+        }));
+
+        Promise.all(opened).then(results => {
+            const failed = results.filter(result => result.error);
+            const err = failed.length > 0
+                ? new Error(`Failed to open ${failed.length} of ${results.length} adapters.`)
+                : undefined;
+
+            // Outside the promise chain, so an exception thrown by the callback is not swallowed
+            if (callback && (typeof callback === 'function')) {
+                process.nextTick(() => callback(err, results));
+            }
+        });
+    }
 }
 
 module.exports = AdapterFactory;
@@ -101,6 +101,7 @@ class Device {
         this.connectionSupervisionTimeout = null;
 
         this.paired = false;
+        this.encrypted = false; // Link encrypted with a key, see Adapter#connSecUpdate
 
         // local adapter peripheral initiated a pairing procedure
         this.ownPeriphInitiatedPairingPending = false;
@@ -0,0 +1,347 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const crypto = require('crypto');
+const fs = require('fs');
+
+const CACHE_FORMAT_VERSION = 1;
+
+function addressKey(address, addressType) {
+    return `${addressType}/${address}`;
+}
+
+function addressToBytes(address) {
+    return address.split(':').map(byte => parseInt(byte, 16));
+}
+
+function bytesToHex(bytes) {
+    return Buffer.from(bytes).toString('hex').toUpperCase();
+}
+
+/**
+ * Check if a resolvable private address was generated from an identity resolving key.
+ *
+ * @param {string} address Resolvable private address, 'AA:BB:CC:DD:EE:FF' with the most significant byte first.
+ * @param {string} irk Identity resolving key as a hex string, least significant byte first as in the SoftDevice
+ *                     key set.
+ * @returns {boolean} True if the address resolves with the key.
+ */
+function resolvePrivateAddress(address, irk) {
+    const addressBytes = addressToBytes(address);
+
+    if (addressBytes.length !== 6 || (addressBytes[0] & 0xC0) !== 0x40) {
+        return false;
+    }
+
+    // ah(k, r) = e(k, padding || prand), the hash is the least significant 24 bits of the result
+    const key = Buffer.from(irk, 'hex').reverse();
+    const plaintext = Buffer.alloc(16);
+    plaintext.set(addressBytes.slice(0, 3), 13);
+
+    const cipher = crypto.createCipheriv('aes-128-ecb', key, null);
+    cipher.setAutoPadding(false);
+    const encrypted = Buffer.concat([cipher.update(plaintext), cipher.final()]);
+
+    return encrypted[13] === addressBytes[3]
+        && encrypted[14] === addressBytes[4]
+        && encrypted[15] === addressBytes[5];
+}
+
+/**
+ * Class that caches the GATT databases of peer devices between connections.
+ *
+ * Entries are keyed by the peer identity address. Bonded peers that use resolvable private addresses are found
+ * through their identity resolving key. An entry is only reused if the Database Hash of the peer is unchanged, or,
+ * for bonded peers without a Database Hash characteristic, until a Service Changed indication is received.
+ *
+ * Changes are written to the cache file asynchronously. Writes requested while one is in progress are coalesced
+ * into a single write of the latest state.
+ */
+class GattCache {
+    /**
+     * Create a GATT cache.
+     *
+     * @constructor
+     * @param {Object} [options] GATT cache options:
+     *                           <ul>
+     *                           <li>{string} [path]: File the cache is persisted to. If not set the cache is only kept
+     *                                                in memory.
+     *                           </ul>
+     */
+    constructor(options) {
+        this._path = options && options.path;
+        this._entries = {};
+        this._identities = {};
+        this._bonded = {};
+
+        this._saving = false;
+        this._savePending = false;
+        this._saveError = null;
+        this._flushCallbacks = [];
+
+        this._load();
+    }
+
+    /**
+     * Find the cached GATT database of a device.
+     *
+     * @param {Device} device The peer device.
+     * @returns {Object|undefined} The cache entry, or undefined if the device is not cached.
+     */
+    lookup(device) {
+        return this._entries[this._keyOf(device)];
+    }
+
+    /**
+     * Store the GATT database of a device.
+     *
+     * @param {Device} device The peer device.
+     * @param {Object[]} services Services with their characteristics and descriptors.
+     * @param {number[]} [databaseHash] Value of the peer's Database Hash characteristic.
+     * @returns {void}
+     */
+    store(device, services, databaseHash) {
+        const key = this._keyOf(device);
+        const identity = this._identities[addressKey(device.address, device.addressType)];
+        const previous = this._entries[key];
+
+        this._entries[key] = {
+            irk: identity ? identity.irk : (previous && previous.irk) || null,
+            databaseHash: databaseHash ? bytesToHex(databaseHash) : null,
+            services,
+        };
+
+        this._save();
+    }
+
+    /**
+     * Record the identity of a bonded device, so its entry is found when it reconnects with a new resolvable
+     * private address.
+     *
+     * @param {Device} device The peer device.
+     * @param {Object} idKey The peer identity key (`keyset.keys_peer.id_key` from the authStatus event).
+     * @returns {void}
+     */
+    setIdentity(device, idKey) {
+        if (!idKey || !idKey.id_info || !idKey.id_addr_info) {
+            return;
+        }
+
+        const currentKey = this._keyOf(device);
+        const identityKey = addressKey(idKey.id_addr_info.address, idKey.id_addr_info.type);
+        const irk = bytesToHex(idKey.id_info.irk);
+
+        this._identities[addressKey(device.address, device.addressType)] = { key: identityKey, irk };
+
+        const entry = this._entries[currentKey] || this._entries[identityKey];
+
+        if (this._bonded[currentKey] && currentKey !== identityKey) {
+            delete this._bonded[currentKey];
+            this._bonded[identityKey] = true;
+        }
+
+        if (entry) {
+            delete this._entries[currentKey];
+            entry.irk = irk;
+            this._entries[identityKey] = entry;
+        }
+
+        this._save();
+    }
+
+    /**
+     * Record that a device bonded. Entries of bonded devices are trusted without a Database Hash, as the device
+     * sends Service Changed indications when its GATT database changes.
+     *
+     * @param {Device} device The peer device.
+     * @param {Object} [idKey] The peer identity key (`keyset.keys_peer.id_key` from the authStatus event), if the
+     *                         peer distributed one.
+     * @returns {void}
+     */
+    setBonded(device, idKey) {
+        this.setIdentity(device, idKey);
+
+        const key = this._keyOf(device);
+
+        if (!this._bonded[key]) {
+            this._bonded[key] = true;
+            this._save();
+        }
+    }
+
+    /**
+     * Check if a device has bonded, see <code>setBonded</code>.
+     *
+     * @param {Device} device The peer device.
+     * @returns {boolean} True if the device has bonded.
+     */
+    isBonded(device) {
+        return this._bonded[this._keyOf(device)] === true;
+    }
+
+    /**
+     * Remove the cached GATT database of a device.
+     *
+     * @param {Device} device The peer device.
+     * @returns {void}
+     */
+    invalidate(device) {
+        const key = this._keyOf(device);
+
+        if (this._entries[key]) {
+            delete this._entries[key];
+            this._save();
+        }
+    }
+
+    /**
+     * Remove all cached GATT databases.
+     *
+     * @returns {void}
+     */
+    clear() {
+        this._entries = {};
+        this._identities = {};
+        this._bonded = {};
+        this._save();
+    }
+
+    /**
+     * Wait until all changes are written to the cache file.
+     *
+     * @param {function(Error)} [callback] Callback signature: err => {}, with the error of the last write if it
+     *                                     failed.
+     * @returns {void}
+     */
+    flush(callback) {
+        const done = callback || (() => {});
+
+        if (!this._saving) {
+            process.nextTick(() => done(this._saveError));
+            return;
+        }
+
+        this._flushCallbacks.push(done);
+    }
+
+    _keyOf(device) {
+        const currentKey = addressKey(device.address, device.addressType);
+        const identity = this._identities[currentKey];
+
+        if (identity) {
+            return identity.key;
+        }
+
+        if (device.addressType === 'BLE_GAP_ADDR_TYPE_RANDOM_PRIVATE_RESOLVABLE') {
+            for (const key in this._entries) {
+                const irk = this._entries[key].irk;
+
+                if (irk && resolvePrivateAddress(device.address, irk)) {
+                    this._identities[currentKey] = { key, irk };
+                    return key;
+                }
+            }
+        }
+
+        return currentKey;
+    }
+
+    _load() {
+        if (!this._path || !fs.existsSync(this._path)) {
+            return;
+        }
+
+        try {
+            const content = JSON.parse(fs.readFileSync(this._path, 'utf8'));
+
+            if (content.version === CACHE_FORMAT_VERSION && content.entries) {
+                this._entries = content.entries;
+                this._bonded = content.bonded || {};
+            }
+        } catch (error) {
+            // A corrupt cache is discarded, the peers are discovered again
+            this._entries = {};
+            this._bonded = {};
+        }
+    }
+
+    _save() {
+        if (!this._path) {
+            return;
+        }
+
+        if (this._saving) {
+            this._savePending = true;
+            return;
+        }
+
+        this._saving = true;
+        this._savePending = false;
+
+        // Write to a temporary file first so a crash never leaves a truncated cache behind
+        const temporaryPath = `${this._path}.tmp`;
+        const content = JSON.stringify({ version: CACHE_FORMAT_VERSION, entries: this._entries, bonded: this._bonded });
+
+        fs.writeFile(temporaryPath, content, writeError => {
+            if (writeError) {
+                this._saved(writeError);
+                return;
+            }
+
+            fs.rename(temporaryPath, this._path, renameError => this._saved(renameError));
+        });
+    }
+
+    _saved(error) {
+        this._saving = false;
+        this._saveError = error || null;
+
+        if (this._savePending) {
+            this._save();
+            return;
+        }
+
+        const callbacks = this._flushCallbacks;
+        this._flushCallbacks = [];
+        callbacks.forEach(callback => callback(this._saveError));
+    }
+}
+
+GattCache.resolvePrivateAddress = resolvePrivateAddress;
+
+module.exports = GattCache;
@@ -0,0 +1,173 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+'use strict';
+
+/**
+ * Default priority of queued GATT operations. Operations with a higher priority are started first, operations with
+ * equal priority are started in the order they were queued.
+ */
+const DEFAULT_PRIORITY = 0;
+
+/**
+ * @class GattOperationQueue
+ * @classdesc Queues GATT client operations per device.
+ *
+ * Only one ATT request may be outstanding on a connection, so operations that are requested while another is in
+ * progress are held here and started as soon as the previous one has completed.
+ */
+class GattOperationQueue {
+    constructor() {
+        this._queues = {};
+        this._operations = {};
+        this._nextId = 1;
+    }
+
+    /**
+     * Queue an operation for a device.
+     *
+     * @param {string} deviceInstanceId The device's unique Id.
+     * @param {function()} start Function that starts the operation.
+     * @param {function(Error)} cancel Function called with an error if the operation is cancelled before it starts.
+     * @param {number} [priority=0] Priority of the operation, higher priorities are started first.
+     * @returns {number} Id of the queued operation, used to cancel it.
+     */
+    enqueue(deviceInstanceId, start, cancel, priority) {
+        const operation = {
+            id: this._nextId++,
+            deviceInstanceId,
+            start,
+            cancel,
+            priority: priority === undefined ? DEFAULT_PRIORITY : priority,
+        };
+
+        if (!this._queues[deviceInstanceId]) {
+            this._queues[deviceInstanceId] = [];
+        }
+
+        const queue = this._queues[deviceInstanceId];
+        let index = queue.length;
+
+        while (index > 0 && queue[index - 1].priority < operation.priority) {
+            index--;
+        }
+
+        queue.splice(index, 0, operation);
+        this._operations[operation.id] = operation;
+
+        return operation.id;
+    }
+
+    /**
+     * Remove the next operation to start for a device from the queue.
+     *
+     * @param {string} deviceInstanceId The device's unique Id.
+     * @returns {Object|undefined} The operation, or undefined if no operations are queued for the device.
+     */
+    dequeue(deviceInstanceId) {
+        const queue = this._queues[deviceInstanceId];
+        if (!queue) {
+            return undefined;
+        }
+
+        const operation = queue.shift();
+        if (queue.length === 0) {
+            delete this._queues[deviceInstanceId];
+        }
+
+        delete this._operations[operation.id];
+        return operation;
+    }
+
+    /**
+     * Get the number of operations queued for a device.
+     *
+     * @param {string} deviceInstanceId The device's unique Id.
+     * @returns {number} Number of queued operations.
+     */
+    length(deviceInstanceId) {
+        const queue = this._queues[deviceInstanceId];
+        return queue ? queue.length : 0;
+    }
+
+    /**
+     * Cancel a queued operation. Operations that have already been started can not be cancelled.
+     *
+     * @param {number} operationId Id returned by <code>enqueue</code>.
+     * @param {Error} error Error passed to the cancel function of the operation.
+     * @returns {boolean} True if the operation was cancelled.
+     */
+    cancel(operationId, error) {
+        const operation = this._operations[operationId];
+        if (!operation) {
+            return false;
+        }
+
+        const queue = this._queues[operation.deviceInstanceId];
+        queue.splice(queue.indexOf(operation), 1);
+        if (queue.length === 0) {
+            delete this._queues[operation.deviceInstanceId];
+        }
+
+        delete this._operations[operationId];
+        operation.cancel(error);
+        return true;
+    }
+
+    /**
+     * Cancel all operations queued for a device.
+     *
+     * @param {string} deviceInstanceId The device's unique Id.
+     * @param {Error} error Error passed to the cancel function of each operation.
+     * @returns {void}
+     */
+    cancelAll(deviceInstanceId, error) {
+        const queue = this._queues[deviceInstanceId];
+        if (!queue) {
+            return;
+        }
+
+        delete this._queues[deviceInstanceId];
+
+        for (const operation of queue) {
+            delete this._operations[operation.id];
+            operation.cancel(error);
+        }
+    }
+}
+
+module.exports = GattOperationQueue;
@@ -0,0 +1,475 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const EventEmitter = require('events');
+const h5 = require('./h5');
+
+// Serialization packet types, the first byte of a reliable H5 payload
+const serializationPacketType = {
+    COMMAND: 0,
+    RESPONSE: 1,
+    EVENT: 2,
+    DTM_COMMAND: 3,
+    DTM_RESPONSE: 4,
+    RESET_COMMAND: 5,
+};
+
+const linkState = {
+    UNINITIALIZED: 'uninitialized',
+    INITIALIZED: 'initialized',
+    ACTIVE: 'active',
+};
+
+const NRF_SUCCESS = 0;
+
+function nextSequenceNumber(seq) {
+    return (seq + 1) & 0x07;
+}
+
+/**
+ * @class ConnectivityEmulator
+ * @classdesc The far end of the serial port, a scripted stand-in for the connectivity firmware.
+ *
+ * The emulator runs the three-wire UART (H5) link layer like the firmware does: it answers link establishment
+ * (SYNC and CONFIG), acknowledges reliable packets, drops duplicates and packets with a bad header checksum or
+ * CRC, and retransmits its own reliable packets until they are acknowledged. It does not decode SoftDevice
+ * commands. Each command is answered with a response carrying the command's opcode and the result code and data
+ * the script gives for it, optionally followed by encoded events.
+ *
+ * The script is either a function `command => reply` or an object
+ * `{ defaultResult, processingTime, responses: { <opcode>: reply } }`. A reply is
+ * `{ result, data, processingTime, events }`: `data` is appended to the response after the result code,
+ * `processingTime` delays the response in milliseconds, and `events` is a list of encoded events, without the
+ * packet type, sent after the response. Commands without a reply are answered with `defaultResult` and no data.
+ *
+ * Bytes from the host are given to `write()`, bytes to the host are emitted as 'data' events.
+ *
+ * @fires ConnectivityEmulator#data
+ * @fires ConnectivityEmulator#command
+ * @fires ConnectivityEmulator#reset
+ * @fires ConnectivityEmulator#stateChanged
+ */
+class ConnectivityEmulator extends EventEmitter {
+    /**
+     * @constructor
+     * @param {Object} [options] Options.
+     * @param {Object|function} [options.script] The script, see class description. Answers all commands with
+     *                                           NRF_SUCCESS if not given.
+     * @param {number} [options.retransmissionInterval=250] Milliseconds before an unacknowledged reliable packet
+     *                                                      is sent again.
+     * @param {number} [options.maxRetransmissions=20] Retransmissions of a packet before it is dropped.
+     */
+    constructor(options) {
+        super();
+
+        options = options || {};
+        this._script = options.script || {};
+        this._retransmissionInterval = options.retransmissionInterval || 250;
+        this._maxRetransmissions = options.maxRetransmissions === undefined ? 20 : options.maxRetransmissions;
+
+        this._decoder = new h5.SlipDecoder(frame => this._onFrame(frame), error => this._countInvalid(error));
+        this._timers = new Set();
+        this._closed = false;
+
+        this._stats = {
+            framesReceived: 0,
+            framesSent: 0,
+            invalidFrames: {
+                slip: 0,
+                length: 0,
+                'header-checksum': 0,
+                crc: 0,
+            },
+            duplicates: 0,
+            acknowledgements: 0,
+            retransmissions: 0,
+            dropped: 0,
+            commands: 0,
+            commandBytes: 0,
+            linkEstablishments: 0,
+        };
+
+        this._reset();
+    }
+
+    /**
+     * The state of the H5 link, 'uninitialized', 'initialized' or 'active'.
+     *
+     * @returns {string} The state.
+     */
+    get state() {
+        return this._state;
+    }
+
+    /**
+     * Counters of the link layer and of the commands received.
+     *
+     * @returns {Object} The counters.
+     */
+    get stats() {
+        return Object.assign({}, this._stats, { invalidFrames: Object.assign({}, this._stats.invalidFrames) });
+    }
+
+    /**
+     * Feed bytes received from the host.
+     *
+     * @param {Buffer} data The bytes.
+     * @returns {void}
+     */
+    write(data) {
+        this._decoder.push(data);
+    }
+
+    /**
+     * Send an encoded event to the host.
+     *
+     * @param {Array|Buffer} event The encoded event, without the serialization packet type.
+     * @returns {void}
+     */
+    sendEvent(event) {
+        this._sendReliable([serializationPacketType.EVENT].concat(Array.from(event)));
+    }
+
+    /**
+     * Stop all timers, nothing is sent after this.
+     *
+     * @returns {void}
+     */
+    close() {
+        this._closed = true;
+        this._clearTimers();
+    }
+
+    _reset() {
+        this._clearTimers();
+
+        this._seq = 0;
+        this._ack = 0;
+        this._txQueue = [];
+        this._inFlight = null;
+        this._setState(linkState.UNINITIALIZED);
+    }
+
+    _setState(state) {
+        if (this._state === state) {
+            return;
+        }
+
+        this._state = state;
+
+        if (state === linkState.ACTIVE) {
+            this._stats.linkEstablishments++;
+        }
+
+        /**
+         * The H5 link state changed.
+         *
+         * @event ConnectivityEmulator#stateChanged
+         * @type {string}
+         */
+        this.emit('stateChanged', state);
+    }
+
+    _setTimer(fn, delay) {
+        const timer = setTimeout(() => {
+            this._timers.delete(timer);
+            fn();
+        }, delay);
+
+        this._timers.add(timer);
+        return timer;
+    }
+
+    _clearTimer(timer) {
+        clearTimeout(timer);
+        this._timers.delete(timer);
+    }
+
+    _clearTimers() {
+        for (const timer of this._timers) {
+            clearTimeout(timer);
+        }
+
+        this._timers.clear();
+    }
+
+    _countInvalid(error) {
+        this._stats.invalidFrames[error]++;
+    }
+
+    _send(packet) {
+        if (this._closed) {
+            return;
+        }
+
+        this._stats.framesSent++;
+
+        /**
+         * Bytes to the host.
+         *
+         * @event ConnectivityEmulator#data
+         * @type {Buffer}
+         */
+        this.emit('data', h5.slipEncode(h5.encode(packet)));
+    }
+
+    _sendControl(control) {
+        this._send({ type: h5.packetType.LINK_CONTROL, payload: control });
+    }
+
+    _sendAcknowledgement() {
+        this._send({ type: h5.packetType.ACK, ack: this._ack });
+    }
+
+    _sendReliable(payload) {
+        this._txQueue.push(payload);
+        this._sendNext();
+    }
+
+    _sendNext() {
+        if (this._inFlight || this._txQueue.length === 0 || this._state !== linkState.ACTIVE) {
+            return;
+        }
+
+        this._inFlight = { seq: this._seq, payload: this._txQueue.shift(), retransmissions: 0 };
+        this._seq = nextSequenceNumber(this._seq);
+        this._transmitInFlight();
+    }
+
+    _transmitInFlight() {
+        const inFlight = this._inFlight;
+
+        this._send({
+            type: h5.packetType.VENDOR_SPECIFIC,
+            seq: inFlight.seq,
+            ack: this._ack,
+            reliable: true,
+            crc: true,
+            payload: inFlight.payload,
+        });
+
+        inFlight.timer = this._setTimer(() => {
+            if (inFlight.retransmissions >= this._maxRetransmissions) {
+                this._stats.dropped++;
+                this._inFlight = null;
+                this._sendNext();
+                return;
+            }
+
+            inFlight.retransmissions++;
+            this._stats.retransmissions++;
+            this._transmitInFlight();
+        }, this._retransmissionInterval);
+    }
+
+    _onAcknowledge(ack) {
+        if (!this._inFlight || ack !== nextSequenceNumber(this._inFlight.seq)) {
+            return;
+        }
+
+        this._clearTimer(this._inFlight.timer);
+        this._inFlight = null;
+        this._sendNext();
+    }
+
+    _onFrame(frame) {
+        const packet = h5.decode(frame);
+
+        if (packet.error) {
+            this._countInvalid(packet.error);
+            return;
+        }
+
+        this._stats.framesReceived++;
+
+        switch (packet.type) {
+            case h5.packetType.RESET:
+                this._reset();
+                break;
+            case h5.packetType.LINK_CONTROL:
+                this._onLinkControl(packet.payload);
+                break;
+            case h5.packetType.ACK:
+                this._onAcknowledge(packet.ack);
+                break;
+            case h5.packetType.VENDOR_SPECIFIC:
+                this._onReliable(packet);
+                break;
+            default:
+                break;
+        }
+    }
+
+    _onLinkControl(payload) {
+        if (h5.isControlPacket(payload, h5.controlPacket.SYNC)) {
+            // A SYNC on an active link means the host restarted link establishment
+            if (this._state === linkState.ACTIVE) {
+                this._reset();
+            }
+
+            this._sendControl(h5.controlPacket.SYNC_RSP);
+            this._setState(linkState.INITIALIZED);
+        } else if (h5.isControlPacket(payload, h5.controlPacket.CONFIG)) {
+            if (this._state === linkState.UNINITIALIZED) {
+                return;
+            }
+
+            this._sendControl(h5.controlPacket.CONFIG_RSP);
+            this._setState(linkState.ACTIVE);
+            this._sendNext();
+        } else if (h5.isControlPacket(payload, h5.controlPacket.WAKEUP)) {
+            this._sendControl(h5.controlPacket.WOKEN);
+        }
+    }
+
+    _onReliable(packet) {
+        if (this._state !== linkState.ACTIVE || !packet.reliable) {
+            return;
+        }
+
+        this._onAcknowledge(packet.ack);
+
+        if (packet.seq !== this._ack) {
+            // Retransmission of a packet already received, the acknowledgement was lost
+            this._stats.duplicates++;
+            this._sendAcknowledgement();
+            return;
+        }
+
+        this._ack = nextSequenceNumber(this._ack);
+        this._stats.acknowledgements++;
+        this._sendAcknowledgement();
+
+        this._onSerializationPacket(packet.payload);
+    }
+
+    _onSerializationPacket(payload) {
+        if (payload.length === 0) {
+            return;
+        }
+
+        switch (payload[0]) {
+            case serializationPacketType.COMMAND:
+                this._onCommand(payload.slice(1));
+                break;
+            case serializationPacketType.DTM_COMMAND:
+                this._sendReliable([serializationPacketType.DTM_RESPONSE, 0, 0, 0, 0]);
+                break;
+            case serializationPacketType.RESET_COMMAND:
+                /**
+                 * The host reset the connectivity device, the emulator starts over as if it rebooted.
+                 *
+                 * @event ConnectivityEmulator#reset
+                 */
+                this.emit('reset');
+                this._reset();
+                break;
+            default:
+                break;
+        }
+    }
+
+    _reply(command) {
+        if (typeof this._script === 'function') {
+            return this._script(command) || {};
+        }
+
+        const responses = this._script.responses || {};
+        return responses[command.opcode] || {};
+    }
+
+    _onCommand(command) {
+        if (command.length === 0) {
+            return;
+        }
+
+        const opcode = command[0];
+
+        this._stats.commands++;
+        this._stats.commandBytes += command.length;
+
+        /**
+         * A command was received.
+         *
+         * @event ConnectivityEmulator#command
+         * @type {Object}
+         * @property {number} opcode The SoftDevice API opcode.
+         * @property {Buffer} data The encoded command parameters.
+         */
+        const received = { opcode, data: command.slice(1) };
+        this.emit('command', received);
+
+        const reply = this._reply(received);
+        let result = reply.result;
+
+        if (result === undefined) {
+            result = this._script.defaultResult === undefined ? NRF_SUCCESS : this._script.defaultResult;
+        }
+
+        let processingTime = reply.processingTime;
+
+        if (processingTime === undefined) {
+            processingTime = this._script.processingTime || 0;
+        }
+
+        const respond = () => {
+            const response = [
+                serializationPacketType.RESPONSE,
+                opcode,
+                result & 0xFF,
+                (result >> 8) & 0xFF,
+                (result >> 16) & 0xFF,
+                (result >>> 24) & 0xFF,
+            ].concat(Array.from(reply.data || []));
+
+            this._sendReliable(response);
+            (reply.events || []).forEach(event => this.sendEvent(event));
+        };
+
+        if (processingTime > 0) {
+            this._setTimer(respond, processingTime);
+        } else {
+            respond();
+        }
+    }
+}
+
+ConnectivityEmulator.serializationPacketType = serializationPacketType;
+ConnectivityEmulator.linkState = linkState;
+
+module.exports = ConnectivityEmulator;
@@ -0,0 +1,295 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/*
+ * Constants of the simulated driver. The values are the ones of SoftDevice API v5, so the simulated driver can be
+ * used wherever the pc-ble-driver-js-sd_api_v5 AddOn is.
+ */
+
+const NRF_SD_BLE_API_VERSION = 5;
+
+const errors = {
+    NRF_SUCCESS: 0x0000,
+    NRF_ERROR_SVC_HANDLER_MISSING: 0x0001,
+    NRF_ERROR_SOFTDEVICE_NOT_ENABLED: 0x0002,
+    NRF_ERROR_INTERNAL: 0x0003,
+    NRF_ERROR_NO_MEM: 0x0004,
+    NRF_ERROR_NOT_FOUND: 0x0005,
+    NRF_ERROR_NOT_SUPPORTED: 0x0006,
+    NRF_ERROR_INVALID_PARAM: 0x0007,
+    NRF_ERROR_INVALID_STATE: 0x0008,
+    NRF_ERROR_INVALID_LENGTH: 0x0009,
+    NRF_ERROR_INVALID_FLAGS: 0x000A,
+    NRF_ERROR_INVALID_DATA: 0x000B,
+    NRF_ERROR_DATA_SIZE: 0x000C,
+    NRF_ERROR_TIMEOUT: 0x000D,
+    NRF_ERROR_NULL: 0x000E,
+    NRF_ERROR_FORBIDDEN: 0x000F,
+    NRF_ERROR_INVALID_ADDR: 0x0010,
+    NRF_ERROR_BUSY: 0x0011,
+    NRF_ERROR_CONN_COUNT: 0x0012,
+    NRF_ERROR_RESOURCES: 0x0013,
+    BLE_ERROR_INVALID_CONN_HANDLE: 0x3001,
+};
+
+const events = {
+    BLE_EVT_USER_MEM_REQUEST: 0x01,
+    BLE_EVT_USER_MEM_RELEASE: 0x02,
+
+    BLE_GAP_EVT_CONNECTED: 0x10,
+    BLE_GAP_EVT_DISCONNECTED: 0x11,
+    BLE_GAP_EVT_CONN_PARAM_UPDATE: 0x12,
+    BLE_GAP_EVT_SEC_PARAMS_REQUEST: 0x13,
+    BLE_GAP_EVT_SEC_INFO_REQUEST: 0x14,
+    BLE_GAP_EVT_PASSKEY_DISPLAY: 0x15,
+    BLE_GAP_EVT_KEY_PRESSED: 0x16,
+    BLE_GAP_EVT_AUTH_KEY_REQUEST: 0x17,
+    BLE_GAP_EVT_LESC_DHKEY_REQUEST: 0x18,
+    BLE_GAP_EVT_AUTH_STATUS: 0x19,
+    BLE_GAP_EVT_CONN_SEC_UPDATE: 0x1A,
+    BLE_GAP_EVT_TIMEOUT: 0x1B,
+    BLE_GAP_EVT_RSSI_CHANGED: 0x1C,
+    BLE_GAP_EVT_ADV_REPORT: 0x1D,
+    BLE_GAP_EVT_SEC_REQUEST: 0x1E,
+    BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST: 0x1F,
+    BLE_GAP_EVT_SCAN_REQ_REPORT: 0x20,
+    BLE_GAP_EVT_PHY_UPDATE_REQUEST: 0x21,
+    BLE_GAP_EVT_PHY_UPDATE: 0x22,
+    BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST: 0x23,
+    BLE_GAP_EVT_DATA_LENGTH_UPDATE: 0x24,
+
+    BLE_GATTC_EVT_PRIM_SRVC_DISC_RSP: 0x30,
+    BLE_GATTC_EVT_REL_DISC_RSP: 0x31,
+    BLE_GATTC_EVT_CHAR_DISC_RSP: 0x32,
+    BLE_GATTC_EVT_DESC_DISC_RSP: 0x33,
+    BLE_GATTC_EVT_ATTR_INFO_DISC_RSP: 0x34,
+    BLE_GATTC_EVT_CHAR_VAL_BY_UUID_READ_RSP: 0x35,
+    BLE_GATTC_EVT_READ_RSP: 0x36,
+    BLE_GATTC_EVT_CHAR_VALS_READ_RSP: 0x37,
+    BLE_GATTC_EVT_WRITE_RSP: 0x38,
+    BLE_GATTC_EVT_HVX: 0x39,
+    BLE_GATTC_EVT_EXCHANGE_MTU_RSP: 0x3A,
+    BLE_GATTC_EVT_TIMEOUT: 0x3B,
+    BLE_GATTC_EVT_WRITE_CMD_TX_COMPLETE: 0x3C,
+
+    BLE_GATTS_EVT_WRITE: 0x50,
+    BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST: 0x51,
+    BLE_GATTS_EVT_SYS_ATTR_MISSING: 0x52,
+    BLE_GATTS_EVT_HVC: 0x53,
+    BLE_GATTS_EVT_SC_CONFIRM: 0x54,
+    BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST: 0x55,
+    BLE_GATTS_EVT_TIMEOUT: 0x56,
+    BLE_GATTS_EVT_HVN_TX_COMPLETE: 0x57,
+};
+
+const configIds = {
+    BLE_COMMON_CFG_VS_UUID: 0x01,
+    BLE_CONN_CFG_GAP: 0x20,
+    BLE_CONN_CFG_GATTC: 0x21,
+    BLE_CONN_CFG_GATTS: 0x22,
+    BLE_CONN_CFG_GATT: 0x23,
+    BLE_CONN_CFG_L2CAP: 0x24,
+    BLE_GAP_CFG_ROLE_COUNT: 0x40,
+    BLE_GAP_CFG_DEVICE_NAME: 0x41,
+    BLE_GATTS_CFG_SERVICE_CHANGED: 0xA0,
+    BLE_GATTS_CFG_ATTR_TAB_SIZE: 0xA1,
+};
+
+const gap = {
+    BLE_GAP_ADDR_CYCLE_MODE_NONE: 0x00,
+    BLE_GAP_ADDR_CYCLE_MODE_AUTO: 0x01,
+
+    BLE_GAP_ADV_TYPE_ADV_IND: 0x00,
+    BLE_GAP_ADV_TYPE_ADV_DIRECT_IND: 0x01,
+    BLE_GAP_ADV_TYPE_ADV_SCAN_IND: 0x02,
+    BLE_GAP_ADV_TYPE_ADV_NONCONN_IND: 0x03,
+    BLE_GAP_ADV_FP_ANY: 0x00,
+
+    BLE_GAP_TIMEOUT_SRC_ADVERTISING: 0x00,
+    BLE_GAP_TIMEOUT_SRC_SCAN: 0x01,
+    BLE_GAP_TIMEOUT_SRC_CONN: 0x02,
+    BLE_GAP_TIMEOUT_SRC_AUTH_PAYLOAD: 0x03,
+
+    BLE_GAP_ROLE_PERIPH: 0x01,
+    BLE_GAP_ROLE_CENTRAL: 0x02,
+
+    BLE_GAP_PHY_AUTO: 0x00,
+    BLE_GAP_PHY_1MBPS: 0x01,
+    BLE_GAP_PHY_2MBPS: 0x02,
+    BLE_GAP_PHY_CODED: 0x04,
+
+    BLE_GAP_DATA_LENGTH_DEFAULT: 27,
+};
+
+const gatt = {
+    BLE_CONN_HANDLE_INVALID: 0xFFFF,
+
+    BLE_UUID_TYPE_UNKNOWN: 0x00,
+    BLE_UUID_TYPE_BLE: 0x01,
+    BLE_UUID_TYPE_VENDOR_BEGIN: 0x02,
+
+    BLE_GATT_ATT_MTU_DEFAULT: 23,
+
+    BLE_GATT_OP_INVALID: 0x00,
+    BLE_GATT_OP_WRITE_REQ: 0x01,
+    BLE_GATT_OP_WRITE_CMD: 0x02,
+    BLE_GATT_OP_SIGN_WRITE_CMD: 0x03,
+    BLE_GATT_OP_PREP_WRITE_REQ: 0x04,
+    BLE_GATT_OP_EXEC_WRITE_REQ: 0x05,
+
+    BLE_GATT_HVX_INVALID: 0x00,
+    BLE_GATT_HVX_NOTIFICATION: 0x01,
+    BLE_GATT_HVX_INDICATION: 0x02,
+
+    BLE_GATTS_SRVC_TYPE_PRIMARY: 0x01,
+    BLE_GATTS_SRVC_TYPE_SECONDARY: 0x02,
+    BLE_GATTS_VLOC_STACK: 0x01,
+    BLE_GATTS_VLOC_USER: 0x02,
+    BLE_GATTS_ATTR_TAB_SIZE_DEFAULT: 0x580,
+
+    BLE_GATTS_OP_INVALID: 0x00,
+    BLE_GATTS_OP_WRITE_REQ: 0x01,
+    BLE_GATTS_OP_WRITE_CMD: 0x02,
+    BLE_GATTS_OP_SIGN_WRITE_CMD: 0x03,
+    BLE_GATTS_OP_PREP_WRITE_REQ: 0x04,
+    BLE_GATTS_OP_EXEC_WRITE_REQ_CANCEL: 0x05,
+    BLE_GATTS_OP_EXEC_WRITE_REQ_NOW: 0x06,
+
+    BLE_GATTS_AUTHORIZE_TYPE_INVALID: 0x00,
+    BLE_GATTS_AUTHORIZE_TYPE_READ: 0x01,
+    BLE_GATTS_AUTHORIZE_TYPE_WRITE: 0x02,
+
+    BLE_USER_MEM_TYPE_INVALID: 0x00,
+    BLE_USER_MEM_TYPE_GATTS_QUEUED_WRITES: 0x01,
+};
+
+const gattStatus = {
+    BLE_GATT_STATUS_SUCCESS: 0x0000,
+    BLE_GATT_STATUS_ATTERR_INVALID_HANDLE: 0x0101,
+    BLE_GATT_STATUS_ATTERR_READ_NOT_PERMITTED: 0x0102,
+    BLE_GATT_STATUS_ATTERR_WRITE_NOT_PERMITTED: 0x0103,
+    BLE_GATT_STATUS_ATTERR_INVALID_OFFSET: 0x0107,
+    BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_FOUND: 0x010A,
+    BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH: 0x010D,
+};
+
+const hci = {
+    BLE_HCI_STATUS_CODE_SUCCESS: 0x00,
+    BLE_HCI_CONNECTION_TIMEOUT: 0x08,
+    BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION: 0x13,
+    BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION: 0x16,
+};
+
+const status = {
+    PKT_SEND_MAX_RETRIES_REACHED: 0,
+    PKT_UNEXPECTED: 1,
+    PKT_ENCODE_ERROR: 2,
+    PKT_DECODE_ERROR: 3,
+    PKT_SEND_ERROR: 4,
+    IO_RESOURCES_UNAVAILABLE: 5,
+    RESET_PERFORMED: 6,
+    CONNECTION_ACTIVE: 7,
+};
+
+// The AD types parsed into advertising reports, keyed by value
+const adTypes = {
+    0x01: 'BLE_GAP_AD_TYPE_FLAGS',
+    0x02: 'BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_MORE_AVAILABLE',
+    0x03: 'BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE',
+    0x04: 'BLE_GAP_AD_TYPE_32BIT_SERVICE_UUID_MORE_AVAILABLE',
+    0x05: 'BLE_GAP_AD_TYPE_32BIT_SERVICE_UUID_COMPLETE',
+    0x06: 'BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_MORE_AVAILABLE',
+    0x07: 'BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE',
+    0x08: 'BLE_GAP_AD_TYPE_SHORT_LOCAL_NAME',
+    0x09: 'BLE_GAP_AD_TYPE_COMPLETE_LOCAL_NAME',
+    0x0A: 'BLE_GAP_AD_TYPE_TX_POWER_LEVEL',
+    0x0D: 'BLE_GAP_AD_TYPE_CLASS_OF_DEVICE',
+    0x0E: 'BLE_GAP_AD_TYPE_SIMPLE_PAIRING_HASH_C',
+    0x0F: 'BLE_GAP_AD_TYPE_SIMPLE_PAIRING_RANDOMIZER_R',
+    0x10: 'BLE_GAP_AD_TYPE_SECURITY_MANAGER_TK_VALUE',
+    0x11: 'BLE_GAP_AD_TYPE_SECURITY_MANAGER_OOB_FLAGS',
+    0x12: 'BLE_GAP_AD_TYPE_SLAVE_CONNECTION_INTERVAL_RANGE',
+    0x14: 'BLE_GAP_AD_TYPE_SOLICITED_SERVICE_UUIDS_16BIT',
+    0x15: 'BLE_GAP_AD_TYPE_SOLICITED_SERVICE_UUIDS_128BIT',
+    0x16: 'BLE_GAP_AD_TYPE_SERVICE_DATA',
+    0x17: 'BLE_GAP_AD_TYPE_PUBLIC_TARGET_ADDRESS',
+    0x18: 'BLE_GAP_AD_TYPE_RANDOM_TARGET_ADDRESS',
+    0x19: 'BLE_GAP_AD_TYPE_APPEARANCE',
+    0x1A: 'BLE_GAP_AD_TYPE_ADVERTISING_INTERVAL',
+    0x1B: 'BLE_GAP_AD_TYPE_LE_BLUETOOTH_DEVICE_ADDRESS',
+    0x1C: 'BLE_GAP_AD_TYPE_LE_ROLE',
+    0x1D: 'BLE_GAP_AD_TYPE_SIMPLE_PAIRING_HASH_C256',
+    0x1E: 'BLE_GAP_AD_TYPE_SIMPLE_PAIRING_RANDOMIZER_R256',
+    0x20: 'BLE_GAP_AD_TYPE_SERVICE_DATA_32BIT_UUID',
+    0x21: 'BLE_GAP_AD_TYPE_SERVICE_DATA_128BIT_UUID',
+    0x3D: 'BLE_GAP_AD_TYPE_3D_INFORMATION_DATA',
+    0xFF: 'BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA',
+};
+
+const advFlags = {
+    0x01: 'BLE_GAP_ADV_FLAG_LE_LIMITED_DISC_MODE',
+    0x02: 'BLE_GAP_ADV_FLAG_LE_GENERAL_DISC_MODE',
+    0x04: 'BLE_GAP_ADV_FLAG_BR_EDR_NOT_SUPPORTED',
+    0x08: 'BLE_GAP_ADV_FLAG_LE_BR_EDR_CONTROLLER',
+    0x10: 'BLE_GAP_ADV_FLAG_LE_BR_EDR_HOST',
+};
+
+function nameOf(map, value) {
+    return Object.keys(map).find(name => map[name] === value);
+}
+
+module.exports = Object.assign(
+    { NRF_SD_BLE_API_VERSION },
+    errors,
+    events,
+    configIds,
+    gap,
+    gatt,
+    gattStatus,
+    hci,
+    status,
+    {
+        errorName: value => nameOf(errors, value) || 'Unknown value',
+        eventName: value => nameOf(events, value),
+        gattStatusName: value => nameOf(gattStatus, value),
+        hciName: value => nameOf(hci, value),
+        statusName: value => nameOf(status, value),
+        adTypes,
+        advFlags,
+    }
+);
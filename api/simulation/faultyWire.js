@@ -0,0 +1,211 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const EventEmitter = require('events');
+
+// Deterministic pseudo random numbers in [0, 1), so that a fault profile can be replayed with the same seed
+function mulberry32(seed) {
+    let state = seed >>> 0;
+
+    return () => {
+        state = (state + 0x6D2B79F5) >>> 0;
+        let t = state;
+        t = Math.imul(t ^ (t >>> 15), t | 1);
+        t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+        return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+    };
+}
+
+/**
+ * @class FaultyWire
+ * @classdesc One direction of a serial line, with the timing and the faults of a real one.
+ *
+ * Bytes written to the wire are emitted as 'data' events after the time it takes to clock them out at
+ * `baudRate`, plus `latency` and up to `jitter` milliseconds. Bytes are never reordered. Each byte is lost with
+ * probability `loss` and has a random bit flipped with probability `corruption`. Every `stallInterval`
+ * milliseconds the wire stalls for `stallDuration` milliseconds, bytes due during a stall are delivered when it ends.
+ *
+ * @fires FaultyWire#data
+ */
+class FaultyWire extends EventEmitter {
+    /**
+     * @constructor
+     * @param {Object} [options] Options.
+     * @param {number} [options.baudRate=0] Baud rate to clock bytes out at, 0 delivers without pacing.
+     * @param {number} [options.bitsPerByte=10] Bits on the wire per byte, including start, stop and parity bits.
+     * @param {number} [options.latency=0] Fixed delay in milliseconds.
+     * @param {number} [options.jitter=0] Maximum random delay in milliseconds, added to `latency`.
+     * @param {number} [options.loss=0] Probability that a byte is lost.
+     * @param {number} [options.corruption=0] Probability that a byte has a bit flipped.
+     * @param {number} [options.stallInterval=0] Milliseconds between the start of two stalls, 0 disables stalls.
+     * @param {number} [options.stallDuration=0] Duration of a stall in milliseconds.
+     * @param {number} [options.seed=1] Seed of the fault generator.
+     */
+    constructor(options) {
+        super();
+
+        options = options || {};
+        this._baudRate = options.baudRate || 0;
+        this._bitsPerByte = options.bitsPerByte || 10;
+        this._latency = options.latency || 0;
+        this._jitter = options.jitter || 0;
+        this._loss = options.loss || 0;
+        this._corruption = options.corruption || 0;
+        this._stallInterval = options.stallInterval || 0;
+        this._stallDuration = options.stallDuration || 0;
+        this._random = mulberry32(options.seed === undefined ? 1 : options.seed);
+
+        this._start = Date.now();
+        this._busyUntil = 0;
+        this._lastDelivery = 0;
+        this._closed = false;
+
+        this._stats = {
+            bytesWritten: 0,
+            bytesDelivered: 0,
+            bytesLost: 0,
+            bytesCorrupted: 0,
+            stalledDeliveries: 0,
+        };
+    }
+
+    /**
+     * Counters of the bytes that went through the wire.
+     *
+     * @returns {Object} `{ bytesWritten, bytesDelivered, bytesLost, bytesCorrupted, stalledDeliveries }`.
+     */
+    get stats() {
+        return Object.assign({}, this._stats);
+    }
+
+    /**
+     * Send bytes over the wire.
+     *
+     * @param {Buffer} data The bytes.
+     * @returns {void}
+     */
+    write(data) {
+        if (this._closed || data.length === 0) {
+            return;
+        }
+
+        this._stats.bytesWritten += data.length;
+
+        const now = Date.now() - this._start;
+        const transmitTime = this._baudRate > 0 ? (data.length * this._bitsPerByte * 1000) / this._baudRate : 0;
+
+        // The UART clocks out the bytes after the ones already in flight
+        this._busyUntil = Math.max(now, this._busyUntil) + transmitTime;
+
+        let deliverAt = this._busyUntil + this._latency + (this._jitter > 0 ? this._random() * this._jitter : 0);
+        deliverAt = Math.max(this._stallEnd(deliverAt), this._lastDelivery);
+        this._lastDelivery = deliverAt;
+
+        const delivered = this._applyFaults(data);
+
+        if (delivered.length === 0) {
+            return;
+        }
+
+        setTimeout(() => {
+            if (this._closed) {
+                return;
+            }
+
+            this._stats.bytesDelivered += delivered.length;
+
+            /**
+             * Bytes arrived at the far end of the wire.
+             *
+             * @event FaultyWire#data
+             * @type {Buffer}
+             */
+            this.emit('data', delivered);
+        }, Math.max(0, deliverAt - (Date.now() - this._start)));
+    }
+
+    /**
+     * Drop the bytes in flight and stop delivering.
+     *
+     * @returns {void}
+     */
+    close() {
+        this._closed = true;
+    }
+
+    _stallEnd(time) {
+        if (this._stallInterval <= 0 || this._stallDuration <= 0) {
+            return time;
+        }
+
+        const offset = time % this._stallInterval;
+
+        // Stalls start at the end of each interval
+        const stallStart = this._stallInterval - this._stallDuration;
+
+        if (offset < stallStart) {
+            return time;
+        }
+
+        this._stats.stalledDeliveries++;
+        return time - offset + this._stallInterval;
+    }
+
+    _applyFaults(data) {
+        if (this._loss === 0 && this._corruption === 0) {
+            return data;
+        }
+
+        const delivered = [];
+
+        for (const byte of data) {
+            if (this._loss > 0 && this._random() < this._loss) {
+                this._stats.bytesLost++;
+            } else if (this._corruption > 0 && this._random() < this._corruption) {
+                this._stats.bytesCorrupted++;
+                delivered.push(byte ^ (1 << Math.floor(this._random() * 8)));
+            } else {
+                delivered.push(byte);
+            }
+        }
+
+        return Buffer.from(delivered);
+    }
+}
+
+module.exports = FaultyWire;
@@ -0,0 +1,287 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/*
+ * Three-wire UART (H5) framing as used between pc-ble-driver and the connectivity firmware.
+ *
+ * A packet is a 4 byte header, the payload and an optional CRC16, SLIP encoded between 0xC0 delimiters.
+ * Header: seq (3 bits) | ack (3 bits) | CRC present (1 bit) | reliable (1 bit), packet type (4 bits) |
+ * payload length (12 bits), header checksum. The header checksum makes the four header bytes sum to 0.
+ */
+
+const SLIP_END = 0xC0;
+const SLIP_ESC = 0xDB;
+const SLIP_ESC_END = 0xDC;
+const SLIP_ESC_ESC = 0xDD;
+
+const HEADER_LENGTH = 4;
+const CRC_LENGTH = 2;
+const MAX_PAYLOAD_LENGTH = 0xFFF;
+
+const packetType = {
+    ACK: 0,
+    HCI_COMMAND: 1,
+    ACL_DATA: 2,
+    SYNC_DATA: 3,
+    HCI_EVENT: 4,
+    RESET: 5,
+    VENDOR_SPECIFIC: 14,
+    LINK_CONTROL: 15,
+};
+
+// Link control payloads, only the first two bytes identify the message
+const controlPacket = {
+    SYNC: [0x01, 0x7E],
+    SYNC_RSP: [0x02, 0x7D],
+    CONFIG: [0x03, 0xFC, 0x11],
+    CONFIG_RSP: [0x04, 0x7B, 0x11],
+    WAKEUP: [0x05, 0xFA],
+    WOKEN: [0x06, 0xF9],
+    SLEEP: [0x07, 0x78],
+};
+
+function crc16(data, length) {
+    let crc = 0xFFFF;
+
+    for (let i = 0; i < length; i++) {
+        crc = ((crc >> 8) | (crc << 8)) & 0xFFFF;
+        crc ^= data[i];
+        crc ^= (crc & 0xFF) >> 4;
+        crc = (crc ^ (crc << 12)) & 0xFFFF;
+        crc = (crc ^ ((crc & 0xFF) << 5)) & 0xFFFF;
+    }
+
+    return crc;
+}
+
+function headerChecksum(header) {
+    return (~(header[0] + header[1] + header[2]) + 1) & 0xFF;
+}
+
+/**
+ * Encode an H5 packet, without SLIP framing.
+ *
+ * @param {Object} packet Packet to encode.
+ * @param {number} packet.type Packet type, one of `packetType`.
+ * @param {number} [packet.seq=0] Sequence number.
+ * @param {number} [packet.ack=0] Acknowledge number, the next sequence number expected from the peer.
+ * @param {boolean} [packet.reliable=false] Whether the packet is reliable and must be acknowledged.
+ * @param {boolean} [packet.crc=false] Whether a CRC16 is appended.
+ * @param {Array|Buffer} [packet.payload] Payload.
+ * @returns {Buffer} The encoded packet.
+ */
+function encode(packet) {
+    const payload = packet.payload || [];
+
+    if (payload.length > MAX_PAYLOAD_LENGTH) {
+        throw new Error(`H5 payload length ${payload.length} exceeds ${MAX_PAYLOAD_LENGTH}`);
+    }
+
+    const buffer = Buffer.alloc(HEADER_LENGTH + payload.length + (packet.crc ? CRC_LENGTH : 0));
+
+    buffer[0] = ((packet.seq || 0) & 0x07) |
+        (((packet.ack || 0) & 0x07) << 3) |
+        (packet.crc ? 0x40 : 0) |
+        (packet.reliable ? 0x80 : 0);
+    buffer[1] = (packet.type & 0x0F) | ((payload.length & 0x0F) << 4);
+    buffer[2] = (payload.length >> 4) & 0xFF;
+    buffer[3] = headerChecksum(buffer);
+
+    for (let i = 0; i < payload.length; i++) {
+        buffer[HEADER_LENGTH + i] = payload[i];
+    }
+
+    if (packet.crc) {
+        const crc = crc16(buffer, HEADER_LENGTH + payload.length);
+        buffer[HEADER_LENGTH + payload.length] = crc & 0xFF;
+        buffer[HEADER_LENGTH + payload.length + 1] = crc >> 8;
+    }
+
+    return buffer;
+}
+
+/**
+ * Decode an H5 packet, without SLIP framing.
+ *
+ * @param {Buffer} buffer The packet.
+ * @returns {Object} The packet, see `encode()`, or `{ error }` where error is 'length', 'header-checksum' or 'crc'.
+ */
+function decode(buffer) {
+    if (buffer.length < HEADER_LENGTH) {
+        return { error: 'length' };
+    }
+
+    if (headerChecksum(buffer) !== buffer[3]) {
+        return { error: 'header-checksum' };
+    }
+
+    const crc = (buffer[0] & 0x40) !== 0;
+    const length = (buffer[1] >> 4) | (buffer[2] << 4);
+
+    if (buffer.length !== HEADER_LENGTH + length + (crc ? CRC_LENGTH : 0)) {
+        return { error: 'length' };
+    }
+
+    if (crc) {
+        const expected = crc16(buffer, HEADER_LENGTH + length);
+        const actual = buffer[HEADER_LENGTH + length] | (buffer[HEADER_LENGTH + length + 1] << 8);
+
+        if (expected !== actual) {
+            return { error: 'crc' };
+        }
+    }
+
+    return {
+        seq: buffer[0] & 0x07,
+        ack: (buffer[0] >> 3) & 0x07,
+        crc,
+        reliable: (buffer[0] & 0x80) !== 0,
+        type: buffer[1] & 0x0F,
+        payload: buffer.slice(HEADER_LENGTH, HEADER_LENGTH + length),
+    };
+}
+
+/**
+ * SLIP encode a packet, including the leading and trailing delimiters.
+ *
+ * @param {Buffer} packet The packet.
+ * @returns {Buffer} The frame.
+ */
+function slipEncode(packet) {
+    const frame = [SLIP_END];
+
+    for (const byte of packet) {
+        if (byte === SLIP_END) {
+            frame.push(SLIP_ESC, SLIP_ESC_END);
+        } else if (byte === SLIP_ESC) {
+            frame.push(SLIP_ESC, SLIP_ESC_ESC);
+        } else {
+            frame.push(byte);
+        }
+    }
+
+    frame.push(SLIP_END);
+    return Buffer.from(frame);
+}
+
+/**
+ * @class SlipDecoder
+ * @classdesc Splits a byte stream into SLIP frames.
+ *
+ * Bytes between two delimiters form a frame, empty frames are skipped. A frame with an invalid escape sequence is
+ * reported with `onError` and dropped.
+ */
+class SlipDecoder {
+    /**
+     * @constructor
+     * @param {function(Buffer)} onFrame Called with each unescaped frame.
+     * @param {function(string)} [onError] Called with 'slip' for each dropped frame.
+     */
+    constructor(onFrame, onError) {
+        this._onFrame = onFrame;
+        this._onError = onError || (() => {});
+        this._frame = [];
+        this._escaped = false;
+        this._invalid = false;
+    }
+
+    /**
+     * Feed bytes received from the stream.
+     *
+     * @param {Buffer} data The received bytes.
+     * @returns {void}
+     */
+    push(data) {
+        for (const byte of data) {
+            if (byte === SLIP_END) {
+                this._endFrame();
+            } else if (this._escaped) {
+                this._escaped = false;
+
+                if (byte === SLIP_ESC_END) {
+                    this._frame.push(SLIP_END);
+                } else if (byte === SLIP_ESC_ESC) {
+                    this._frame.push(SLIP_ESC);
+                } else {
+                    this._invalid = true;
+                }
+            } else if (byte === SLIP_ESC) {
+                this._escaped = true;
+            } else {
+                this._frame.push(byte);
+            }
+        }
+    }
+
+    _endFrame() {
+        const frame = this._frame;
+        const invalid = this._invalid || this._escaped;
+
+        this._frame = [];
+        this._escaped = false;
+        this._invalid = false;
+
+        if (invalid) {
+            this._onError('slip');
+        } else if (frame.length > 0) {
+            this._onFrame(Buffer.from(frame));
+        }
+    }
+}
+
+/**
+ * Check if a link control payload is the given control packet.
+ *
+ * @param {Buffer} payload Link control payload.
+ * @param {Array} control One of `controlPacket`.
+ * @returns {boolean} True if the payload is the control packet.
+ */
+function isControlPacket(payload, control) {
+    return payload.length >= 2 && payload[0] === control[0] && payload[1] === control[1];
+}
+
+module.exports = {
+    packetType,
+    controlPacket,
+    crc16,
+    encode,
+    decode,
+    slipEncode,
+    SlipDecoder,
+    isControlPacket,
+};
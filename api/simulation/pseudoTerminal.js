@@ -0,0 +1,177 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const childProcess = require('child_process');
+const EventEmitter = require('events');
+
+// Opens a pseudo-terminal pair, prints the name of the slave and relays between the master and stdin/stdout.
+// The slave stays open in the helper so the terminal does not hang up when the host closes and reopens the port.
+const RELAY = `
+import os, pty, select, sys, tty
+master, slave = pty.openpty()
+tty.setraw(slave)
+sys.stdout.write(os.ttyname(slave) + "\\n")
+sys.stdout.flush()
+stdin = sys.stdin.fileno()
+stdout = sys.stdout.fileno()
+while True:
+    readable = select.select([master, stdin], [], [])[0]
+    if master in readable:
+        os.write(stdout, os.read(master, 65536))
+    if stdin in readable:
+        data = os.read(stdin, 65536)
+        if not data:
+            break
+        os.write(master, data)
+`;
+
+/**
+ * @class PseudoTerminal
+ * @classdesc A Linux pseudo-terminal pair to stand in for the serial port of a connectivity device.
+ *
+ * `path` is the slave, a tty the native adapter opens like a serial port. The master side is this object: bytes
+ * the adapter writes are emitted as 'data' events and `write()` sends bytes to the adapter. A pseudo-terminal
+ * ignores the baud rate and the flow control set on it, pace the bytes with a `FaultyWire` to model them.
+ *
+ * The pair is created by a small python3 helper, since Node.js has no API for it.
+ *
+ * @fires PseudoTerminal#data
+ */
+class PseudoTerminal extends EventEmitter {
+    /**
+     * Shall not be called by user, use `PseudoTerminal.open()`.
+     *
+     * @private
+     * @constructor
+     * @param {ChildProcess} helper The helper process.
+     * @param {string} path Path of the slave.
+     */
+    constructor(helper, path) {
+        super();
+
+        this._helper = helper;
+        this.path = path;
+    }
+
+    /**
+     * Create a pseudo-terminal pair.
+     *
+     * @param {function(Error, PseudoTerminal)} callback Called when the slave can be opened.
+     * @returns {void}
+     */
+    static open(callback) {
+        const helper = childProcess.spawn('python3', ['-c', RELAY], { stdio: ['pipe', 'pipe', 'inherit'] });
+        let terminal = null;
+        let header = '';
+
+        // A failed spawn emits both 'error' and 'exit', the callback is only called for the first completion
+        let settled = false;
+        const settle = (err, result) => {
+            if (settled) { return; }
+            settled = true;
+            callback(err, result);
+        };
+
+        helper.on('error', err => {
+            settle(new Error(`Failed to create pseudo-terminal: ${err.message}`));
+        });
+
+        helper.on('exit', () => {
+            settle(new Error('Failed to create pseudo-terminal, the python3 helper exited.'));
+        });
+
+        helper.stdout.on('data', data => {
+            if (terminal) {
+                /**
+                 * Bytes written by the adapter.
+                 *
+                 * @event PseudoTerminal#data
+                 * @type {Buffer}
+                 */
+                terminal.emit('data', data);
+                return;
+            }
+
+            // The first line is the path of the slave, anything after it is already data
+            const newline = data.indexOf(0x0A);
+
+            if (newline < 0) {
+                header += data.toString();
+                return;
+            }
+
+            if (settled) { return; }
+
+            terminal = new PseudoTerminal(helper, header + data.slice(0, newline).toString());
+            settle(undefined, terminal);
+
+            if (newline + 1 < data.length) {
+                terminal.emit('data', data.slice(newline + 1));
+            }
+        });
+    }
+
+    /**
+     * Send bytes to the adapter.
+     *
+     * @param {Buffer} data The bytes.
+     * @returns {void}
+     */
+    write(data) {
+        if (this._helper) {
+            this._helper.stdin.write(data);
+        }
+    }
+
+    /**
+     * Remove the pseudo-terminal pair.
+     *
+     * @returns {void}
+     */
+    close() {
+        if (!this._helper) {
+            return;
+        }
+
+        this._helper.stdin.end();
+        this._helper.kill();
+        this._helper = null;
+    }
+}
+
+module.exports = PseudoTerminal;
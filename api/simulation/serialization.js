@@ -0,0 +1,129 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/*
+ * Encoders for SoftDevice events in the serialization format of the connectivity firmware, so the connectivity
+ * emulator can send events that the native adapter decodes like the ones of a connectivity device. The layouts
+ * are the ones of SoftDevice API v5: the 16-bit event id, the connection handle and the event parameters, all
+ * little endian.
+ */
+
+const constants = require('./constants');
+
+const BLE_CONN_HANDLE_INVALID = 0xFFFF;
+
+const BLE_GAP_ADDR_TYPE_PUBLIC = 0x00;
+const BLE_GAP_ADDR_TYPE_RANDOM_STATIC = 0x01;
+
+function uint16(value) {
+    return [value & 0xFF, (value >> 8) & 0xFF];
+}
+
+/**
+ * Encode a ble_gap_addr_t.
+ *
+ * @param {string} address Address as 'AA:BB:CC:DD:EE:FF', most significant byte first.
+ * @param {number} [type=BLE_GAP_ADDR_TYPE_RANDOM_STATIC] The address type.
+ * @returns {Array} The encoded address, the type followed by the address least significant byte first.
+ */
+function encodeAddress(address, type) {
+    const bytes = address.split(':').map(octet => parseInt(octet, 16)).reverse();
+    const addrType = type === undefined ? BLE_GAP_ADDR_TYPE_RANDOM_STATIC : type;
+
+    // addr_id_peer in bit 0 is not set, addr_type in bits 1 to 7
+    return [(addrType << 1) & 0xFE].concat(bytes);
+}
+
+/**
+ * Encode a BLE_GAP_EVT_ADV_REPORT event.
+ *
+ * @param {Object} report The advertising report.
+ * @param {string} report.address Address of the advertiser.
+ * @param {number} [report.addressType] Type of the address, random static if not given.
+ * @param {number} [report.rssi=-50] RSSI in dBm.
+ * @param {boolean} [report.scanResponse=false] Whether the report is a scan response.
+ * @param {number} [report.type=BLE_GAP_ADV_TYPE_ADV_NONCONN_IND] The advertising type.
+ * @param {Array} report.data Advertising data, at most 31 bytes.
+ * @returns {Array} The encoded event.
+ */
+function encodeAdvertisingReport(report) {
+    const data = report.data.slice(0, 31);
+    const rssi = report.rssi === undefined ? -50 : report.rssi;
+    const type = report.type === undefined ? constants.BLE_GAP_ADV_TYPE_ADV_NONCONN_IND : report.type;
+
+    // scan_rsp in bit 0, type in bits 1 and 2, dlen in bits 3 to 7
+    const flags = (report.scanResponse ? 0x01 : 0x00) | ((type & 0x03) << 1) | ((data.length & 0x1F) << 3);
+
+    return uint16(constants.BLE_GAP_EVT_ADV_REPORT)
+        .concat(uint16(BLE_CONN_HANDLE_INVALID))
+        .concat(encodeAddress(report.address, report.addressType))
+        .concat(encodeAddress('00:00:00:00:00:00', BLE_GAP_ADDR_TYPE_PUBLIC))
+        .concat([rssi & 0xFF, flags])
+        .concat(data);
+}
+
+/**
+ * Encode a BLE_GATTC_EVT_HVX event.
+ *
+ * @param {Object} hvx The notification or indication.
+ * @param {number} hvx.connHandle Connection handle.
+ * @param {number} hvx.handle Handle of the characteristic value.
+ * @param {number} [hvx.type=BLE_GATT_HVX_NOTIFICATION] Notification or indication.
+ * @param {Array} hvx.data The value.
+ * @returns {Array} The encoded event.
+ */
+function encodeHandleValue(hvx) {
+    const type = hvx.type === undefined ? constants.BLE_GATT_HVX_NOTIFICATION : hvx.type;
+
+    return uint16(constants.BLE_GATTC_EVT_HVX)
+        .concat(uint16(hvx.connHandle))
+        .concat(uint16(constants.BLE_GATT_STATUS_SUCCESS))
+        .concat(uint16(0)) // error_handle
+        .concat(uint16(hvx.handle))
+        .concat([type])
+        .concat(uint16(hvx.data.length))
+        .concat(Array.from(hvx.data));
+}
+
+module.exports = {
+    BLE_GAP_ADDR_TYPE_PUBLIC,
+    BLE_GAP_ADDR_TYPE_RANDOM_STATIC,
+    encodeAddress,
+    encodeAdvertisingReport,
+    encodeHandleValue,
+};
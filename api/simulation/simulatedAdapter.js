@@ -0,0 +1,1843 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const constants = require('./constants');
+const VirtualRadio = require('./virtualRadio');
+
+const DEFAULT_DEVICE_NAME = 'nRF5x';
+const DEFAULT_EVENT_MAX_BATCH_SIZE = 32;
+const MAX_ATTRIBUTE_LENGTH = 512;
+const MAX_ADVERTISING_DATA_LENGTH = 31;
+const MAX_DATA_LENGTH = 251;
+
+// Number of latency samples kept per event type for getStats()
+const MAX_LATENCY_SAMPLES = 100000;
+
+const GAP_SERVICE_UUID = 0x1800;
+const GATT_SERVICE_UUID = 0x1801;
+const DEVICE_NAME_UUID = 0x2A00;
+const APPEARANCE_UUID = 0x2A01;
+const PPCP_UUID = 0x2A04;
+const PRIMARY_SERVICE_UUID = 0x2800;
+const SECONDARY_SERVICE_UUID = 0x2801;
+const CHARACTERISTIC_UUID = 0x2803;
+const CCCD_UUID = 0x2902;
+const SCCD_UUID = 0x2903;
+
+const OPEN_PERMISSION = { sm: 1, lv: 1 };
+
+let adapterCount = 0;
+
+function hex(value, digits) {
+    return ('0000' + value.toString(16)).slice(-digits).toUpperCase();
+}
+
+function toBytes(value) {
+    if (value === undefined || value === null) {
+        return [];
+    }
+
+    if (typeof value === 'string') {
+        return Array.from(Buffer.from(value, 'utf8'));
+    }
+
+    return Array.from(value);
+}
+
+function uint16ToBytes(value) {
+    return [value & 0xFF, (value >> 8) & 0xFF];
+}
+
+function uuidTypeString(type) {
+    if (type === constants.BLE_UUID_TYPE_UNKNOWN) return 'BLE_UUID_TYPE_UNKNOWN';
+    if (type === constants.BLE_UUID_TYPE_BLE) return 'BLE_UUID_TYPE_BLE';
+    return 'BLE_UUID_TYPE_VENDOR_BEGIN';
+}
+
+function permitted(permission) {
+    return !(permission && permission.sm === 0 && permission.lv === 0);
+}
+
+function makeError(errorCode, operation) {
+    const errcode = constants.errorName(errorCode);
+    const message = `Error occured when ${operation}. Errorcode: ${errcode} (0x${errorCode.toString(16)})\n`;
+    const error = new Error(message);
+
+    error.errno = errorCode;
+    error.errcode = errcode;
+    error.erroperation = operation;
+    error.errmsg = message;
+
+    return error;
+}
+
+function makeGattError(gattStatus, operation) {
+    const gattStatusName = constants.gattStatusName(gattStatus) || 'Unknown GATT status';
+    const error = new Error(`Error occured when ${operation}. GATT status: ${gattStatusName} (0x${gattStatus.toString(16)})`);
+
+    error.gatt_status = gattStatus;
+    error.gatt_status_name = gattStatusName;
+    error.erroperation = operation;
+
+    return error;
+}
+
+function summarize(samples) {
+    if (samples.length === 0) {
+        return { count: 0, min: 0, max: 0, mean: 0, p50: 0, p99: 0, p999: 0 };
+    }
+
+    const sorted = samples.slice().sort((a, b) => a - b);
+    const percentile = p => sorted[Math.min(sorted.length - 1, Math.floor((p / 100) * sorted.length))];
+
+    return {
+        count: sorted.length,
+        min: sorted[0],
+        max: sorted[sorted.length - 1],
+        mean: sorted.reduce((sum, sample) => sum + sample, 0) / sorted.length,
+        p50: percentile(50),
+        p99: percentile(99),
+        p999: percentile(99.9),
+    };
+}
+
+// Thrown by commands to fail with a SoftDevice error code, caught by _call()
+class CommandError {
+    constructor(errorCode) {
+        this.errorCode = errorCode;
+    }
+}
+
+function fail(errorCode) {
+    throw new CommandError(errorCode);
+}
+
+/**
+ * @class SimulatedAdapter
+ * @classdesc AddOn adapter running a simulated BLE stack instead of a connectivity device.
+ *
+ * Has the same methods, callbacks and events as the adapter of the pc-ble-driver-js-sd_api_v5 AddOn, so
+ * `api/adapter.js` runs unmodified on top of it. The port given to `open()` is the name of the `VirtualRadio` the
+ * adapter joins, adapters opened with the same port name can see and connect to each other.
+ *
+ * The simulated stack has a GATT server with a GAP and a GATT service, and supports advertising, scanning,
+ * connections, GATT client procedures, notifications, indications, ATT_MTU exchange, PHY and data length updates.
+ * Security procedures are not supported. Commands that are not implemented fail with NRF_ERROR_NOT_SUPPORTED.
+ */
+class SimulatedAdapter {
+    constructor() {
+        adapterCount += 1;
+
+        this._address = {
+            address: `C0:FF:EE:00:${hex((adapterCount >> 8) & 0xFF, 2)}:${hex(adapterCount & 0xFF, 2)}`,
+            type: 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC',
+        };
+
+        this._radio = null;
+        this._eventCallback = null;
+        this._statusCallback = null;
+        this._logCallback = null;
+        this._eventInterval = 0;
+        this._eventMaxBatchSize = DEFAULT_EVENT_MAX_BATCH_SIZE;
+        this._eventTimer = null;
+        this._eventQueue = [];
+        this._dispatchScheduled = false;
+
+        this._eventMask = new Set();
+        this._eventMaskAutoReply = true;
+        this._eventMaskAttMtu = constants.BLE_GATT_ATT_MTU_DEFAULT;
+
+        this._links = new Map();
+        this._resetStack();
+        this.resetStats();
+    }
+
+    // Lifecycle
+
+    open(port, options, callback) {
+        if (this._radio) {
+            this._reply(callback, makeError(constants.NRF_ERROR_INVALID_STATE, 'opening port'));
+            return;
+        }
+
+        this._eventCallback = options.eventCallback;
+        this._statusCallback = options.statusCallback;
+        this._logCallback = options.logCallback;
+        this._eventInterval = options.eventInterval || 0;
+        this._eventMaxBatchSize = options.eventMaxBatchSize || DEFAULT_EVENT_MAX_BATCH_SIZE;
+
+        this._radio = VirtualRadio.get(port);
+        this._radio.join(this);
+        this._resetStack();
+
+        if (this._eventInterval > 0) {
+            this._eventTimer = setInterval(() => this._dispatchEvents(), this._eventInterval);
+        }
+
+        this._status(constants.RESET_PERFORMED, 'Target Reset performed');
+        this._status(constants.CONNECTION_ACTIVE, 'Connection active');
+
+        if (options.enableBLE) {
+            const errorCode = this._enable(options.enableBLEParams);
+
+            if (errorCode !== constants.NRF_SUCCESS) {
+                this._reply(callback, makeError(errorCode, 'enabling SoftDevice'));
+                return;
+            }
+        }
+
+        this._log('info', `Simulated adapter ${this._address.address} joined radio ${port}`);
+        this._reply(callback, undefined);
+    }
+
+    close(callback) {
+        if (!this._radio) {
+            this._reply(callback, undefined);
+            return;
+        }
+
+        this._radio.leave(this);
+        this._radio = null;
+        this._resetStack();
+
+        clearInterval(this._eventTimer);
+        this._eventTimer = null;
+        this._eventQueue = [];
+
+        this._reply(callback, undefined);
+    }
+
+    connReset(callback) {
+        if (!this._radio) {
+            this._reply(callback, makeError(constants.NRF_ERROR_INVALID_STATE, 'resetting connectivity device'));
+            return;
+        }
+
+        this._reset();
+        this._reply(callback, undefined);
+    }
+
+    reopen(callback) {
+        if (!this._radio) {
+            this._reply(callback, makeError(constants.NRF_ERROR_INVALID_STATE, 'reopening adapter'), undefined);
+            return;
+        }
+
+        const start = process.hrtime();
+        this._reset();
+        this._status(constants.CONNECTION_ACTIVE, 'Connection active');
+        const elapsed = process.hrtime(start);
+
+        this._reply(callback, undefined, { close: 0, open: (elapsed[0] * 1e3) + (elapsed[1] / 1e6) });
+    }
+
+    enableBLE(enableParameters, callback) {
+        if (!this._radio) {
+            this._reply(callback, makeError(constants.NRF_ERROR_INVALID_STATE, 'enabling SoftDevice'));
+            return;
+        }
+
+        const errorCode = this._enable(enableParameters);
+        this._reply(callback, errorCode === constants.NRF_SUCCESS ? undefined : makeError(errorCode, 'enabling SoftDevice'));
+    }
+
+    setBleConfig(configId, config, callback) {
+        this._call('setting BLE configuration', callback, () => {
+            if (this._bleEnabled) fail(constants.NRF_ERROR_INVALID_STATE);
+            this._applyConfig(configId, config);
+        }, false);
+    }
+
+    getVersion(callback) {
+        const version = { version_number: 0x09, company_id: 0x0059, subversion_number: 0x009D };
+
+        this._reply(
+            callback,
+            this._bleEnabled ? version : undefined,
+            this._bleEnabled ? undefined : makeError(constants.NRF_ERROR_INVALID_STATE, 'getting version'));
+    }
+
+    getStats() {
+        const eventLatency = {};
+
+        for (let [id, samples] of this._latencySamples) {
+            eventLatency[constants.eventName(id)] = {
+                id,
+                queueResidence: summarize(samples.queueResidence),
+                callback: summarize(samples.callback),
+            };
+        }
+
+        return {
+            eventCallbackTotalTime: this._eventCallbackTotalTime,
+            eventCallbackTotalCount: this._eventCallbackTotalCount,
+            eventCallbackBatchMaxCount: this._eventCallbackBatchMaxCount,
+            eventCallbackBatchAvgCount: this._eventCallbackBatchCount > 0 ?
+                this._eventCallbackTotalCount / this._eventCallbackBatchCount : 0,
+            maskedEvents: Object.assign({}, this._maskedEvents),
+            eventLatency,
+        };
+    }
+
+    resetStats() {
+        this._eventCallbackTotalTime = 0;
+        this._eventCallbackTotalCount = 0;
+        this._eventCallbackBatchMaxCount = 0;
+        this._eventCallbackBatchCount = 0;
+        this._maskedEvents = {};
+        this._latencySamples = new Map();
+    }
+
+    setEventMask(eventIds, options) {
+        if (!Array.isArray(eventIds)) {
+            throw new TypeError('Argument 0 must be an array');
+        }
+
+        this._eventMask = new Set(eventIds);
+        this._eventMaskAutoReply = !(options && options.autoReply === false);
+        this._eventMaskAttMtu = (options && options.attMtu) || constants.BLE_GATT_ATT_MTU_DEFAULT;
+    }
+
+    // GAP
+
+    gapSetAddress(cycleMode, address, callback) {
+        this._call('setting address', callback, () => {
+            if (this._advertising || this._scanning || this._connecting) fail(constants.NRF_ERROR_INVALID_STATE);
+            this._address = { address: address.address.toUpperCase(), type: address.type };
+        });
+    }
+
+    gapGetAddress(callback) {
+        this._reply(callback, Object.assign({}, this._address), undefined);
+    }
+
+    gapSetDeviceName(writePermission, name, callback) {
+        this._call('setting device name', callback, () => {
+            const bytes = toBytes(name);
+            if (bytes.length > 248) fail(constants.NRF_ERROR_DATA_SIZE);
+            this._deviceName = bytes;
+            this._deviceNameWritePermission = writePermission;
+        });
+    }
+
+    gapGetDeviceName(callback) {
+        if (!this._bleEnabled) {
+            this._reply(callback, undefined, makeError(constants.NRF_ERROR_INVALID_STATE, 'getting device name'));
+            return;
+        }
+
+        this._reply(callback, Buffer.from(this._deviceName).toString('utf8'), undefined);
+    }
+
+    gapSetAppearance(appearance, callback) {
+        this._call('setting appearance', callback, () => {
+            this._appearance = appearance;
+        });
+    }
+
+    gapSetPPCP(connectionParameters, callback) {
+        this._call('setting PPCP', callback, () => {
+            this._ppcp = Object.assign({}, connectionParameters);
+        });
+    }
+
+    gapSetAdvertisingData(advertisingData, scanResponseData, callback) {
+        this._call('setting advertisement data', callback, () => {
+            const adv = toBytes(advertisingData);
+            const scanRsp = toBytes(scanResponseData);
+
+            if (adv.length > MAX_ADVERTISING_DATA_LENGTH || scanRsp.length > MAX_ADVERTISING_DATA_LENGTH) {
+                fail(constants.NRF_ERROR_INVALID_LENGTH);
+            }
+
+            this._advData = adv;
+            this._scanRspData = scanRsp;
+        });
+    }
+
+    gapStartAdvertising(params, callback) {
+        this._call('starting advertisement', callback, () => {
+            if (this._advertising) fail(constants.NRF_ERROR_INVALID_STATE);
+
+            const connectable = params.type === constants.BLE_GAP_ADV_TYPE_ADV_IND ||
+                params.type === constants.BLE_GAP_ADV_TYPE_ADV_DIRECT_IND;
+
+            if (connectable && this._linkCount(constants.BLE_GAP_ROLE_PERIPH) >= this._config.periphRoleCount) {
+                fail(constants.NRF_ERROR_CONN_COUNT);
+            }
+
+            this._advertising = true;
+            this._radio.startAdvertising(this, Object.assign({}, params));
+        });
+    }
+
+    gapStopAdvertising(callback) {
+        this._call('stopping advertisement', callback, () => {
+            if (!this._advertising) fail(constants.NRF_ERROR_INVALID_STATE);
+            this._radio.stopAdvertising(this);
+        });
+    }
+
+    gapStartScan(params, callback) {
+        this._call('starting scan', callback, () => {
+            if (this._scanning || this._connecting) fail(constants.NRF_ERROR_INVALID_STATE);
+            this._scanning = true;
+            this._radio.startScanning(this, Object.assign({}, params));
+        });
+    }
+
+    gapStopScan(callback) {
+        this._call('stopping scan', callback, () => {
+            if (!this._scanning) fail(constants.NRF_ERROR_INVALID_STATE);
+            this._radio.stopScanning(this);
+        });
+    }
+
+    gapConnect(address, scanParams, connParams, callback) {
+        this._call('connecting', callback, () => {
+            if (this._connecting) fail(constants.NRF_ERROR_INVALID_STATE);
+
+            if (this._linkCount(constants.BLE_GAP_ROLE_CENTRAL) >= this._config.centralRoleCount ||
+                this._links.size >= this._config.connCount) {
+                fail(constants.NRF_ERROR_CONN_COUNT);
+            }
+
+            if (this._scanning) {
+                this._radio.stopScanning(this);
+            }
+
+            this._connecting = true;
+            this._radio.connect(this, address, connParams, scanParams ? scanParams.timeout : 0);
+        });
+    }
+
+    gapCancelConnect(callback) {
+        this._call('canceling connection', callback, () => {
+            if (!this._connecting) fail(constants.NRF_ERROR_INVALID_STATE);
+            this._radio.cancelConnect(this);
+        });
+    }
+
+    gapDisconnect(connHandle, hciStatusCode, callback) {
+        this._call('disconnecting', callback, () => {
+            this._radio.disconnect(this._link(connHandle), this, hciStatusCode);
+        });
+    }
+
+    gapUpdateConnectionParameters(connHandle, connParams, callback) {
+        this._call('updating connection parameters', callback, () => {
+            const link = this._link(connHandle);
+            const peer = link.peerOf(this);
+
+            if (link.central !== this) {
+                // The peripheral asks the central to update the connection parameters
+                const requested = Object.assign({}, connParams || this._ppcp);
+                this._radio.send(() => peer._linkEvent(link, constants.BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST, {
+                    conn_params: requested,
+                }));
+                return;
+            }
+
+            // A central without connection parameters rejects the request of the peripheral
+            if (!connParams) {
+                return;
+            }
+
+            link.connParams = Object.assign({}, connParams);
+
+            this._radio.send(() => {
+                this._linkEvent(link, constants.BLE_GAP_EVT_CONN_PARAM_UPDATE, { conn_params: Object.assign({}, connParams) });
+                peer._linkEvent(link, constants.BLE_GAP_EVT_CONN_PARAM_UPDATE, { conn_params: Object.assign({}, connParams) });
+            });
+        });
+    }
+
+    gapPhyUpdate(connHandle, phys, callback) {
+        this._call('updating PHY', callback, () => {
+            const link = this._link(connHandle);
+            const peer = link.peerOf(this);
+            const request = link.phyRequest;
+
+            if (request && request.initiator === peer) {
+                // Reply to the request of the peer, 2 Mbps is used if both sides allow it
+                const allows2M = p => p === constants.BLE_GAP_PHY_AUTO || (p & constants.BLE_GAP_PHY_2MBPS) !== 0;
+                const phy = allows2M(request.phys.tx_phys) && allows2M(phys.tx_phys) ?
+                    constants.BLE_GAP_PHY_2MBPS : constants.BLE_GAP_PHY_1MBPS;
+
+                link.phyRequest = null;
+
+                this._radio.send(() => {
+                    const update = { status: constants.BLE_HCI_STATUS_CODE_SUCCESS, tx_phy: phy, rx_phy: phy };
+                    this._linkEvent(link, constants.BLE_GAP_EVT_PHY_UPDATE, Object.assign({}, update));
+                    peer._linkEvent(link, constants.BLE_GAP_EVT_PHY_UPDATE, Object.assign({}, update));
+                });
+                return;
+            }
+
+            if (request) fail(constants.NRF_ERROR_BUSY);
+
+            link.phyRequest = { initiator: this, phys: Object.assign({}, phys) };
+
+            this._radio.send(() => peer._linkEvent(link, constants.BLE_GAP_EVT_PHY_UPDATE_REQUEST, {
+                peer_preferred_phys: Object.assign({}, phys),
+            }));
+        });
+    }
+
+    gapDataLengthUpdate(connHandle, params, callback) {
+        this._call('updating data length', callback, () => {
+            const link = this._link(connHandle);
+            const peer = link.peerOf(this);
+            const request = link.dataLengthRequest;
+
+            const octets = (name) => Math.min((params && params[name]) || MAX_DATA_LENGTH, MAX_DATA_LENGTH);
+            const own = {
+                max_tx_octets: octets('max_tx_octets'),
+                max_rx_octets: octets('max_rx_octets'),
+            };
+
+            if (request && request.initiator === peer) {
+                link.dataLengthRequest = null;
+
+                const toPeer = Math.min(own.max_tx_octets, request.params.max_rx_octets);
+                const fromPeer = Math.min(own.max_rx_octets, request.params.max_tx_octets);
+                const effective = (tx, rx) => ({
+                    max_tx_octets: tx,
+                    max_rx_octets: rx,
+                    max_tx_time_us: (tx + 14) * 8,
+                    max_rx_time_us: (rx + 14) * 8,
+                });
+
+                this._radio.send(() => {
+                    this._linkEvent(link, constants.BLE_GAP_EVT_DATA_LENGTH_UPDATE, {
+                        effective_params: effective(toPeer, fromPeer),
+                    });
+                    peer._linkEvent(link, constants.BLE_GAP_EVT_DATA_LENGTH_UPDATE, {
+                        effective_params: effective(fromPeer, toPeer),
+                    });
+                });
+                return;
+            }
+
+            if (request) fail(constants.NRF_ERROR_BUSY);
+
+            link.dataLengthRequest = { initiator: this, params: own };
+
+            this._radio.send(() => peer._linkEvent(link, constants.BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST, {
+                peer_params: {
+                    max_tx_octets: own.max_tx_octets,
+                    max_rx_octets: own.max_rx_octets,
+                    max_tx_time_us: (own.max_tx_octets + 14) * 8,
+                    max_rx_time_us: (own.max_rx_octets + 14) * 8,
+                },
+            }));
+        });
+    }
+
+    // UUIDs
+
+    addVendorspecificUUID(uuid, callback) {
+        this._call('adding vendor specific UUID', callback, () => {
+            const base = this._uuidBase(uuid.uuid128);
+            const index = this._vsUuids.indexOf(base);
+
+            if (index >= 0) {
+                return index + constants.BLE_UUID_TYPE_VENDOR_BEGIN;
+            }
+
+            if (this._vsUuids.length >= this._config.vsUuidCount) fail(constants.NRF_ERROR_NO_MEM);
+
+            this._vsUuids.push(base);
+            return this._vsUuids.length - 1 + constants.BLE_UUID_TYPE_VENDOR_BEGIN;
+        });
+    }
+
+    decodeUUID(length, uuid, callback) {
+        this._call('decoding UUID', callback, () => {
+            const uuidString = uuid.replace(/-/g, '').toUpperCase();
+
+            if (length === 2 && uuidString.length === 4) {
+                return { uuid: parseInt(uuidString, 16), type: constants.BLE_UUID_TYPE_BLE, typeString: 'BLE_UUID_TYPE_BLE' };
+            }
+
+            if (length !== 16 || uuidString.length !== 32) fail(constants.NRF_ERROR_INVALID_LENGTH);
+
+            const index = this._vsUuids.indexOf(this._uuidBase(uuidString));
+            if (index < 0) fail(constants.NRF_ERROR_NOT_FOUND);
+
+            const type = index + constants.BLE_UUID_TYPE_VENDOR_BEGIN;
+            return { uuid: parseInt(uuidString.slice(4, 8), 16), type, typeString: uuidTypeString(type) };
+        });
+    }
+
+    // GATT server
+
+    gattsAddService(type, uuid, callback) {
+        this._call('adding service', callback, () => {
+            return this._addAttribute({
+                kind: 'service',
+                primary: type === constants.BLE_GATTS_SRVC_TYPE_PRIMARY,
+                uuid: this._localUuid(uuid),
+            });
+        });
+    }
+
+    gattsAddCharacteristic(serviceHandle, metadata, attribute, callback) {
+        this._call('adding characteristic', callback, () => {
+            if (!this._attributes.some(a => a.kind === 'service')) fail(constants.NRF_ERROR_INVALID_STATE);
+
+            const uuid = this._localUuid(attribute.uuid);
+            const props = Object.assign({}, metadata.char_props);
+            const attrMd = attribute.attr_md || {};
+            const maxLength = attribute.max_len || 0;
+            const value = toBytes(attribute.value).slice(0, attribute.init_len !== undefined ? attribute.init_len : undefined);
+
+            if (maxLength > MAX_ATTRIBUTE_LENGTH || value.length > maxLength) fail(constants.NRF_ERROR_INVALID_PARAM);
+
+            const declaration = this._addAttribute({ kind: 'characteristic', uuid: { uuid16: CHARACTERISTIC_UUID }, props });
+            const valueHandle = this._addAttribute({
+                kind: 'value',
+                uuid,
+                props,
+                value,
+                maxLength,
+                variableLength: !!attrMd.vlen,
+                readPermission: attrMd.read_perm || OPEN_PERMISSION,
+                writePermission: attrMd.write_perm || OPEN_PERMISSION,
+            });
+
+            this._attribute(declaration).valueHandle = valueHandle;
+
+            const handles = { value_handle: valueHandle, user_desc_handle: 0, cccd_handle: 0, sccd_handle: 0 };
+
+            if (metadata.char_user_desc_max_size > 0) {
+                const userDescriptionMd = metadata.user_desc_md || {};
+                handles.user_desc_handle = this._addAttribute({
+                    kind: 'descriptor',
+                    uuid: { uuid16: 0x2901 },
+                    value: toBytes(metadata.char_user_desc).slice(0, metadata.char_user_desc_size),
+                    maxLength: metadata.char_user_desc_max_size,
+                    variableLength: true,
+                    readPermission: userDescriptionMd.read_perm || OPEN_PERMISSION,
+                    writePermission: userDescriptionMd.write_perm || { sm: 0, lv: 0 },
+                });
+            }
+
+            if (props.notify || props.indicate) {
+                const cccdMd = metadata.cccd_md || {};
+                handles.cccd_handle = this._addAttribute({
+                    kind: 'descriptor',
+                    uuid: { uuid16: CCCD_UUID },
+                    cccd: true,
+                    readPermission: OPEN_PERMISSION,
+                    writePermission: cccdMd.write_perm || OPEN_PERMISSION,
+                });
+                this._attribute(valueHandle).cccdHandle = handles.cccd_handle;
+            }
+
+            if (props.broadcast) {
+                const sccdMd = metadata.sccd_md || {};
+                handles.sccd_handle = this._addAttribute({
+                    kind: 'descriptor',
+                    uuid: { uuid16: SCCD_UUID },
+                    value: [0, 0],
+                    maxLength: 2,
+                    readPermission: OPEN_PERMISSION,
+                    writePermission: sccdMd.write_perm || OPEN_PERMISSION,
+                });
+            }
+
+            return handles;
+        });
+    }
+
+    gattsAddDescriptor(characteristicHandle, descriptor, callback) {
+        this._call('adding descriptor', callback, () => {
+            const attrMd = descriptor.attr_md || {};
+            const maxLength = descriptor.max_len || 0;
+            const value = toBytes(descriptor.value).slice(0, descriptor.init_len !== undefined ? descriptor.init_len : undefined);
+
+            if (maxLength > MAX_ATTRIBUTE_LENGTH || value.length > maxLength) fail(constants.NRF_ERROR_INVALID_PARAM);
+
+            return this._addAttribute({
+                kind: 'descriptor',
+                uuid: this._localUuid(descriptor.uuid),
+                value,
+                maxLength,
+                variableLength: !!attrMd.vlen,
+                readPermission: attrMd.read_perm || OPEN_PERMISSION,
+                writePermission: attrMd.write_perm || OPEN_PERMISSION,
+            });
+        });
+    }
+
+    gattsSetValue(connHandle, handle, params, callback) {
+        this._call('setting value', callback, () => {
+            const attribute = this._attribute(handle);
+            if (!attribute || attribute.kind === 'service' || attribute.kind === 'characteristic') {
+                fail(constants.NRF_ERROR_NOT_FOUND);
+            }
+
+            const data = toBytes(params.value).slice(0, params.len !== undefined ? params.len : undefined);
+            const offset = params.offset || 0;
+
+            if (attribute.cccd) {
+                const link = this._link(connHandle);
+                if (offset !== 0 || data.length !== 2) fail(constants.NRF_ERROR_INVALID_PARAM);
+                link.cccds.get(this).set(handle, data[0] | (data[1] << 8));
+                return { len: 2, offset: 0, value: data };
+            }
+
+            this._setValue(attribute, offset, data);
+            return { len: data.length, offset, value: data };
+        });
+    }
+
+    gattsGetValue(connHandle, attributeOrHandle, params, callback) {
+        this._call('getting value', callback, () => {
+            const handle = typeof attributeOrHandle === 'number' ?
+                attributeOrHandle : (attributeOrHandle.valueHandle || attributeOrHandle.handle);
+            const attribute = this._attribute(handle);
+            if (!attribute) fail(constants.NRF_ERROR_NOT_FOUND);
+
+            const link = connHandle === constants.BLE_CONN_HANDLE_INVALID ? null : this._link(connHandle);
+            const offset = (params && params.offset) || 0;
+            const value = this._valueOf(attribute, link);
+            const len = params && params.len !== undefined ? params.len : value.length;
+            const slice = value.slice(offset, offset + len);
+
+            return { len: slice.length, offset, value: slice };
+        });
+    }
+
+    gattsHVX(connHandle, hvxParams, callback) {
+        this._call('notifying or indicating', callback, () => {
+            const link = this._link(connHandle);
+            const errorCode = this._hvx(link, hvxParams.type, hvxParams.handle, toBytes(hvxParams.data));
+            if (errorCode !== constants.NRF_SUCCESS) fail(errorCode);
+        });
+    }
+
+    gattsNotifyAll(valueHandle, data, callback) {
+        this._call('notifying all subscribers', callback, () => {
+            const attribute = this._attribute(valueHandle);
+            if (!attribute || attribute.kind !== 'value' || !attribute.cccdHandle) fail(constants.NRF_ERROR_INVALID_PARAM);
+
+            const value = toBytes(data);
+            this._setValue(attribute, 0, value);
+
+            const results = [];
+
+            for (let [connHandle, link] of this._links) {
+                const cccd = link.cccds.get(this).get(attribute.cccdHandle) || 0;
+                if (cccd === 0) continue;
+
+                const type = (cccd & 0x01) ? constants.BLE_GATT_HVX_NOTIFICATION : constants.BLE_GATT_HVX_INDICATION;
+                const errorCode = this._hvx(link, type, valueHandle, value);
+
+                if (errorCode === constants.NRF_SUCCESS) {
+                    results.push({ conn_handle: connHandle, type, len: Math.min(value.length, link.mtu - 3) });
+                } else {
+                    results.push({ conn_handle: connHandle, type, error: makeError(errorCode, 'notifying subscriber') });
+                }
+            }
+
+            return results;
+        });
+    }
+
+    gattsGetCccdValues(connHandle) {
+        const link = this._links.get(connHandle);
+        const values = [];
+
+        for (let attribute of this._attributes) {
+            if (attribute.kind === 'value' && attribute.cccdHandle) {
+                values.push({
+                    value_handle: attribute.handle,
+                    cccd_handle: attribute.cccdHandle,
+                    value: link ? (link.cccds.get(this).get(attribute.cccdHandle) || 0) : 0,
+                });
+            }
+        }
+
+        return values;
+    }
+
+    gattsSystemAttributeSet(connHandle, systemAttributes, length, flags, callback) {
+        this._call('setting system attributes', callback, () => {
+            this._link(connHandle).cccds.get(this).clear();
+        });
+    }
+
+    gattsExchangeMtuReply(connHandle, serverRxMtu, callback) {
+        this._call('replying to ATT_MTU exchange', callback, () => {
+            const link = this._link(connHandle);
+            const request = link.mtuRequest;
+
+            if (!request || request.client === this) fail(constants.NRF_ERROR_INVALID_STATE);
+            if (serverRxMtu < constants.BLE_GATT_ATT_MTU_DEFAULT || serverRxMtu > this._config.attMtu) {
+                fail(constants.NRF_ERROR_INVALID_PARAM);
+            }
+
+            link.mtuRequest = null;
+            link.mtu = Math.max(constants.BLE_GATT_ATT_MTU_DEFAULT, Math.min(request.mtu, serverRxMtu));
+
+            request.client._clientResponse(link, constants.BLE_GATTC_EVT_EXCHANGE_MTU_RSP, constants.BLE_GATT_STATUS_SUCCESS, {
+                server_rx_mtu: serverRxMtu,
+            });
+        });
+    }
+
+    gattsReplyReadWriteAuthorize(connHandle, reply, callback) {
+        // The simulated server never requests authorization
+        this._call('replying to authorization request', callback, () => fail(constants.NRF_ERROR_INVALID_STATE));
+    }
+
+    replyUserMemory(connHandle, userMemoryBlock, callback) {
+        // The simulated server never requests user memory
+        this._call('replying to user memory request', callback, () => fail(constants.NRF_ERROR_INVALID_STATE));
+    }
+
+    // GATT client
+
+    gattcDiscoverPrimaryServices(connHandle, startHandle, serviceUuid, callback) {
+        this._call('discovering primary services', callback, () => {
+            const link = this._beginProcedure(connHandle);
+            const server = link.peerOf(this);
+
+            const services = server._attributes.filter(a => a.kind === 'service' && a.primary && a.handle >= startHandle);
+            const found = this._group(services, a => a.uuid, (link.mtu - 2), 6, 20);
+
+            this._clientResponse(
+                link,
+                constants.BLE_GATTC_EVT_PRIM_SRVC_DISC_RSP,
+                found.length > 0 ? constants.BLE_GATT_STATUS_SUCCESS : constants.BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_FOUND,
+                {
+                    count: found.length,
+                    services: found.map(service => ({
+                        uuid: this._remoteUuid(service.uuid),
+                        handle_range: { start_handle: service.handle, end_handle: server._serviceEnd(service.handle) },
+                    })),
+                },
+                found.length > 0 ? 0 : startHandle);
+        });
+    }
+
+    gattcDiscoverCharacteristics(connHandle, handleRange, callback) {
+        this._call('discovering characteristics', callback, () => {
+            const link = this._beginProcedure(connHandle);
+            const server = link.peerOf(this);
+            const start = handleRange.start_handle;
+            const end = handleRange.end_handle;
+
+            const declarations = server._attributes.filter(a => a.kind === 'characteristic' && a.handle >= start && a.handle <= end);
+            const found = this._group(declarations, a => server._attribute(a.valueHandle).uuid, (link.mtu - 2), 7, 21);
+
+            this._clientResponse(
+                link,
+                constants.BLE_GATTC_EVT_CHAR_DISC_RSP,
+                found.length > 0 ? constants.BLE_GATT_STATUS_SUCCESS : constants.BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_FOUND,
+                {
+                    count: found.length,
+                    chars: found.map(declaration => ({
+                        uuid: this._remoteUuid(server._attribute(declaration.valueHandle).uuid),
+                        char_props: Object.assign({}, declaration.props),
+                        char_ext: false,
+                        handle_decl: declaration.handle,
+                        handle_value: declaration.valueHandle,
+                    })),
+                },
+                found.length > 0 ? 0 : start);
+        });
+    }
+
+    gattcDiscoverDescriptors(connHandle, handleRange, callback) {
+        this._call('discovering descriptors', callback, () => {
+            const link = this._beginProcedure(connHandle);
+            const server = link.peerOf(this);
+            const start = handleRange.start_handle;
+            const end = handleRange.end_handle;
+
+            const attributes = server._attributes.filter(a => a.handle >= start && a.handle <= end);
+            const found = this._group(attributes, a => a.uuid, (link.mtu - 2), 4, 18);
+
+            this._clientResponse(
+                link,
+                constants.BLE_GATTC_EVT_DESC_DISC_RSP,
+                found.length > 0 ? constants.BLE_GATT_STATUS_SUCCESS : constants.BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_FOUND,
+                {
+                    count: found.length,
+                    descs: found.map(attribute => ({ handle: attribute.handle, uuid: this._remoteUuid(attribute.uuid) })),
+                },
+                found.length > 0 ? 0 : start);
+        });
+    }
+
+    gattcDiscoverAll(connHandle, readValues, options, callback) {
+        this._callDeferred('discovering all attributes', callback, done => {
+            const link = this._beginProcedure(connHandle);
+            const server = link.peerOf(this);
+            const services = [];
+
+            for (let service of server._attributes.filter(a => a.kind === 'service' && a.primary)) {
+                const end = server._serviceEnd(service.handle);
+                const inService = server._attributes.filter(a => a.handle > service.handle && a.handle <= end);
+                const characteristics = [];
+
+                inService.forEach((declaration, index) => {
+                    if (declaration.kind !== 'characteristic') return;
+
+                    const valueAttribute = server._attribute(declaration.valueHandle);
+                    const nextDeclaration = inService.slice(index + 1).find(a => a.kind === 'characteristic');
+                    const descriptorEnd = nextDeclaration ? nextDeclaration.handle - 1 : end;
+                    const read = handle => {
+                        const result = server._serverRead(link, handle);
+                        return result.status === constants.BLE_GATT_STATUS_SUCCESS ? result.value : undefined;
+                    };
+
+                    characteristics.push(Object.assign(this._discoveredUuid(valueAttribute.uuid), {
+                        handle_decl: declaration.handle,
+                        handle_value: declaration.valueHandle,
+                        char_props: Object.assign({}, declaration.props),
+                        value: readValues && declaration.props.read ? read(declaration.valueHandle) : undefined,
+                        descriptors: server._attributes
+                            .filter(a => a.handle > declaration.valueHandle && a.handle <= descriptorEnd)
+                            .map(descriptor => Object.assign(this._discoveredUuid(descriptor.uuid), {
+                                handle: descriptor.handle,
+                                value: readValues ? read(descriptor.handle) : undefined,
+                            })),
+                    }));
+                });
+
+                services.push(Object.assign(this._discoveredUuid(service.uuid), {
+                    handle_range: { start_handle: service.handle, end_handle: end },
+                    characteristics,
+                }));
+            }
+
+            this._radio.send(() => {
+                link.busy.delete(this);
+                done(undefined, services);
+            });
+        });
+    }
+
+    gattcRead(connHandle, handle, offset, callback) {
+        this._call('reading characteristic', callback, () => {
+            const link = this._beginProcedure(connHandle);
+            const result = link.peerOf(this)._serverRead(link, handle);
+            let gattStatus = result.status;
+            let data = [];
+
+            if (gattStatus === constants.BLE_GATT_STATUS_SUCCESS) {
+                if (offset > result.value.length) {
+                    gattStatus = constants.BLE_GATT_STATUS_ATTERR_INVALID_OFFSET;
+                } else {
+                    data = result.value.slice(offset, offset + link.mtu - 1);
+                }
+            }
+
+            this._clientResponse(link, constants.BLE_GATTC_EVT_READ_RSP, gattStatus, {
+                handle,
+                offset,
+                len: data.length,
+                data,
+            }, gattStatus === constants.BLE_GATT_STATUS_SUCCESS ? 0 : handle);
+        });
+    }
+
+    gattcReadLong(connHandle, handle, options, callback) {
+        this._callDeferred('reading long characteristic', callback, done => {
+            const link = this._beginProcedure(connHandle);
+            const result = link.peerOf(this)._serverRead(link, handle);
+
+            this._radio.send(() => {
+                link.busy.delete(this);
+
+                if (result.status !== constants.BLE_GATT_STATUS_SUCCESS) {
+                    done(makeGattError(result.status, `reading long characteristic ${handle}`));
+                    return;
+                }
+
+                done(undefined, Buffer.from(result.value));
+            });
+        });
+    }
+
+    gattcReadCharacteristicValues(connHandle, handles, count, callback) {
+        this._call('reading characteristic values', callback, () => {
+            const link = this._beginProcedure(connHandle);
+            const server = link.peerOf(this);
+            let values = [];
+            let gattStatus = constants.BLE_GATT_STATUS_SUCCESS;
+            let errorHandle = 0;
+
+            for (let handle of handles.slice(0, count)) {
+                const result = server._serverRead(link, handle);
+
+                if (result.status !== constants.BLE_GATT_STATUS_SUCCESS) {
+                    gattStatus = result.status;
+                    errorHandle = handle;
+                    values = [];
+                    break;
+                }
+
+                values = values.concat(result.value);
+            }
+
+            values = values.slice(0, link.mtu - 1);
+
+            this._clientResponse(link, constants.BLE_GATTC_EVT_CHAR_VALS_READ_RSP, gattStatus, {
+                len: values.length,
+                values,
+            }, errorHandle);
+        });
+    }
+
+    gattcWrite(connHandle, params, callback) {
+        this._call('writing', callback, () => {
+            const link = this._link(connHandle);
+            const server = link.peerOf(this);
+            const data = toBytes(params.value).slice(0, params.len !== undefined ? params.len : undefined);
+            const offset = params.offset || 0;
+
+            if (data.length > link.mtu - 3) fail(constants.NRF_ERROR_DATA_SIZE);
+
+            if (params.write_op === constants.BLE_GATT_OP_WRITE_CMD) {
+                server._serverWrite(link, params.handle, offset, data, constants.BLE_GATTS_OP_WRITE_CMD);
+                this._radio.send(() => this._linkEvent(link, constants.BLE_GATTC_EVT_WRITE_CMD_TX_COMPLETE, { count: 1 }));
+                return;
+            }
+
+            if (params.write_op !== constants.BLE_GATT_OP_WRITE_REQ) fail(constants.NRF_ERROR_NOT_SUPPORTED);
+
+            this._beginProcedure(connHandle);
+            const gattStatus = server._serverWrite(link, params.handle, offset, data, constants.BLE_GATTS_OP_WRITE_REQ);
+
+            this._clientResponse(link, constants.BLE_GATTC_EVT_WRITE_RSP, gattStatus, {
+                handle: params.handle,
+                write_op: params.write_op,
+                offset,
+                len: data.length,
+                data,
+            }, gattStatus === constants.BLE_GATT_STATUS_SUCCESS ? 0 : params.handle);
+        });
+    }
+
+    gattcWriteLong(connHandle, handle, value, options, callback) {
+        // The value reaches the server as one write request, the prepare and execute write requests are not simulated
+        this._callDeferred('writing long characteristic', callback, done => {
+            const link = this._beginProcedure(connHandle);
+            const gattStatus = link.peerOf(this)._serverWrite(link, handle, 0, toBytes(value), constants.BLE_GATTS_OP_WRITE_REQ);
+
+            this._radio.send(() => {
+                link.busy.delete(this);
+                done(gattStatus === constants.BLE_GATT_STATUS_SUCCESS ?
+                    undefined : makeGattError(gattStatus, `writing long characteristic ${handle}`));
+            });
+        });
+    }
+
+    gattcWriteStream(connHandle, handle, values, options, callback) {
+        this._callDeferred('streaming write commands', callback, done => {
+            const link = this._link(connHandle);
+            const server = link.peerOf(this);
+            const packets = [];
+
+            if (Array.isArray(values)) {
+                values.forEach(value => packets.push(toBytes(value)));
+            } else {
+                // A buffer is split like the AddOn does, into the largest write commands the ATT_MTU allows
+                const bytes = toBytes(values);
+                const size = Math.max(options.att_mtu || 0, constants.BLE_GATT_ATT_MTU_DEFAULT) - 3;
+
+                for (let i = 0; i < bytes.length; i += size) {
+                    packets.push(bytes.slice(i, i + size));
+                }
+            }
+
+            if (packets.length === 0) fail(constants.NRF_ERROR_INVALID_PARAM);
+            if (packets.some(packet => packet.length > link.mtu - 3)) fail(constants.NRF_ERROR_DATA_SIZE);
+
+            const start = process.hrtime();
+            let bytes = 0;
+
+            for (let packet of packets) {
+                server._serverWrite(link, handle, 0, packet, constants.BLE_GATTS_OP_WRITE_CMD);
+                bytes += packet.length;
+            }
+
+            this._radio.send(() => {
+                const elapsed = process.hrtime(start);
+                const duration = (elapsed[0] * 1e3) + (elapsed[1] / 1e6);
+
+                done(undefined, {
+                    bytes,
+                    packets: packets.length,
+                    duration,
+                    bytesPerSecond: duration > 0 ? (bytes * 1000) / duration : 0,
+                });
+            });
+        });
+    }
+
+    gattcExchangeMtuRequest(connHandle, clientRxMtu, callback) {
+        this._call('requesting ATT_MTU exchange', callback, () => {
+            if (clientRxMtu < constants.BLE_GATT_ATT_MTU_DEFAULT || clientRxMtu > this._config.attMtu) {
+                fail(constants.NRF_ERROR_INVALID_PARAM);
+            }
+
+            const link = this._beginProcedure(connHandle);
+            const server = link.peerOf(this);
+
+            link.mtuRequest = { client: this, mtu: clientRxMtu };
+
+            this._radio.send(() => server._linkEvent(link, constants.BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST, {
+                client_rx_mtu: clientRxMtu,
+            }));
+        });
+    }
+
+    gattcConfirmHandleValue(connHandle, handle, callback) {
+        this._call('confirming handle value', callback, () => {
+            const link = this._link(connHandle);
+            const server = link.peerOf(this);
+
+            if (link.indications.get(server) !== handle) fail(constants.NRF_ERROR_INVALID_STATE);
+
+            link.indications.delete(server);
+            this._radio.send(() => server._linkEvent(link, constants.BLE_GATTS_EVT_HVC, { handle }));
+        });
+    }
+
+    // Called by the radio
+
+    _advertisingStopped() {
+        this._advertising = false;
+    }
+
+    _scanningStopped() {
+        this._scanning = false;
+    }
+
+    _connectingStopped() {
+        this._connecting = false;
+    }
+
+    _timedOut(source) {
+        const names = ['BLE_GAP_TIMEOUT_SRC_ADVERTISING', 'BLE_GAP_TIMEOUT_SRC_SCAN', 'BLE_GAP_TIMEOUT_SRC_CONN'];
+
+        this._pushEvent(this._event(constants.BLE_GAP_EVT_TIMEOUT, constants.BLE_CONN_HANDLE_INVALID, {
+            src: source,
+            src_name: names[source],
+        }));
+    }
+
+    _advertisingReport(peerAddress, type, data, scanResponse, rssi) {
+        const report = {
+            rssi,
+            peer_addr: Object.assign({}, peerAddress),
+            scan_rsp: scanResponse,
+        };
+
+        if (!scanResponse) {
+            report.adv_type = ['BLE_GAP_ADV_TYPE_ADV_IND', 'BLE_GAP_ADV_TYPE_ADV_DIRECT_IND',
+                'BLE_GAP_ADV_TYPE_ADV_SCAN_IND', 'BLE_GAP_ADV_TYPE_ADV_NONCONN_IND'][type];
+        }
+
+        if (data.length > 0) {
+            report.data = this._parseAdvertisingData(data);
+        }
+
+        this._pushEvent(this._event(constants.BLE_GAP_EVT_ADV_REPORT, constants.BLE_CONN_HANDLE_INVALID, report));
+    }
+
+    _addLink(link) {
+        let connHandle = 0;
+        while (this._links.has(connHandle)) connHandle++;
+
+        this._links.set(connHandle, link);
+
+        if (link.central === this) {
+            this._connecting = false;
+        }
+
+        return connHandle;
+    }
+
+    _removeLink(connHandle) {
+        this._links.delete(connHandle);
+    }
+
+    _connected(link) {
+        const peer = link.peerOf(this);
+
+        this._linkEvent(link, constants.BLE_GAP_EVT_CONNECTED, {
+            peer_addr: Object.assign({}, peer._address),
+            role: link.central === this ? 'BLE_GAP_ROLE_CENTRAL' : 'BLE_GAP_ROLE_PERIPH',
+            conn_params: Object.assign({}, link.connParams),
+            own_addr: Object.assign({}, this._address),
+            irk_match: false,
+        });
+    }
+
+    _disconnected(connHandle, reason) {
+        this._pushEvent(this._event(constants.BLE_GAP_EVT_DISCONNECTED, connHandle, {
+            reason,
+            reason_name: constants.hciName(reason) || 'Unknown HCI status',
+        }));
+    }
+
+    _handleValue(link, handle, type, data) {
+        this._linkEvent(link, constants.BLE_GATTC_EVT_HVX, { handle, type, len: data.length, data }, constants.BLE_GATT_STATUS_SUCCESS);
+    }
+
+    // Internals
+
+    _resetStack() {
+        this._bleEnabled = false;
+        this._config = {
+            connCount: 1,
+            attMtu: constants.BLE_GATT_ATT_MTU_DEFAULT,
+            vsUuidCount: 1,
+            periphRoleCount: 1,
+            centralRoleCount: 3,
+        };
+
+        this._vsUuids = [];
+        this._attributes = [];
+        this._deviceName = toBytes(DEFAULT_DEVICE_NAME);
+        this._deviceNameWritePermission = { sm: 0, lv: 0 };
+        this._appearance = 0;
+        this._ppcp = { min_conn_interval: 0, max_conn_interval: 0, slave_latency: 0, conn_sup_timeout: 0 };
+        this._advData = [];
+        this._scanRspData = [];
+        this._advertising = false;
+        this._scanning = false;
+        this._connecting = false;
+    }
+
+    _reset() {
+        // Connections are dropped without a disconnected event on this side, as on a connectivity device reset
+        this._radio.leave(this);
+        this._links.clear();
+        this._eventQueue = [];
+        this._resetStack();
+        this._radio.join(this);
+
+        this._status(constants.RESET_PERFORMED, 'Target Reset performed');
+    }
+
+    _enable(enableParameters) {
+        if (this._bleEnabled) {
+            return constants.NRF_ERROR_INVALID_STATE;
+        }
+
+        const params = enableParameters || {};
+
+        // SoftDevice API v2 enable parameters
+        if (params.gap_enable_params) {
+            this._config.periphRoleCount = params.gap_enable_params.periph_conn_count;
+            this._config.centralRoleCount = params.gap_enable_params.central_conn_count;
+            this._config.connCount = this._config.periphRoleCount + this._config.centralRoleCount;
+        }
+
+        if (params.gatt_enable_params) this._config.attMtu = params.gatt_enable_params.att_mtu;
+        if (params.common_enable_params) this._config.vsUuidCount = params.common_enable_params.vs_uuid_count;
+
+        // SoftDevice API v5 configurations
+        if (params.conn_cfg) {
+            const connCfg = params.conn_cfg;
+            if (connCfg.gap_conn_cfg) this._applyConfig(constants.BLE_CONN_CFG_GAP, { conn_cfg: connCfg });
+            if (connCfg.gatt_conn_cfg) this._applyConfig(constants.BLE_CONN_CFG_GATT, { conn_cfg: connCfg });
+        }
+
+        if (params.common_cfg) this._applyConfig(constants.BLE_COMMON_CFG_VS_UUID, params);
+        if (params.gap_cfg) this._applyConfig(constants.BLE_GAP_CFG_ROLE_COUNT, params);
+
+        if (this._config.attMtu < constants.BLE_GATT_ATT_MTU_DEFAULT || this._config.attMtu > MAX_ATTRIBUTE_LENGTH) {
+            return constants.NRF_ERROR_INVALID_PARAM;
+        }
+
+        this._createAttributeTable();
+        this._bleEnabled = true;
+
+        return constants.NRF_SUCCESS;
+    }
+
+    _applyConfig(configId, config) {
+        switch (configId) {
+            case constants.BLE_CONN_CFG_GAP:
+                this._config.connCount = config.conn_cfg.gap_conn_cfg.conn_count;
+                break;
+            case constants.BLE_CONN_CFG_GATT:
+                this._config.attMtu = config.conn_cfg.gatt_conn_cfg.att_mtu;
+                break;
+            case constants.BLE_COMMON_CFG_VS_UUID:
+                if (config.common_cfg.vs_uuid_cfg) {
+                    this._config.vsUuidCount = config.common_cfg.vs_uuid_cfg.vs_uuid_count;
+                }
+                break;
+            case constants.BLE_GAP_CFG_ROLE_COUNT:
+                if (config.gap_cfg.role_count_cfg) {
+                    this._config.periphRoleCount = config.gap_cfg.role_count_cfg.periph_role_count;
+                    this._config.centralRoleCount = config.gap_cfg.role_count_cfg.central_role_count;
+                }
+                break;
+            case constants.BLE_CONN_CFG_GATTC:
+            case constants.BLE_CONN_CFG_GATTS:
+            case constants.BLE_CONN_CFG_L2CAP:
+            case constants.BLE_GAP_CFG_DEVICE_NAME:
+            case constants.BLE_GATTS_CFG_SERVICE_CHANGED:
+            case constants.BLE_GATTS_CFG_ATTR_TAB_SIZE:
+                // Accepted, the simulated stack has no queues or memory to size
+                break;
+            default:
+                fail(constants.NRF_ERROR_INVALID_PARAM);
+        }
+    }
+
+    _createAttributeTable() {
+        const readOnly = { read: true };
+
+        this._attributes = [];
+
+        // GAP service at handles 1-7 and GATT service at handle 8, as laid out by the SoftDevice
+        this._addAttribute({ kind: 'service', primary: true, uuid: { uuid16: GAP_SERVICE_UUID } });
+        [DEVICE_NAME_UUID, APPEARANCE_UUID, PPCP_UUID].forEach(uuid16 => {
+            const declaration = this._addAttribute({ kind: 'characteristic', uuid: { uuid16: CHARACTERISTIC_UUID }, props: readOnly });
+            const valueHandle = this._addAttribute({
+                kind: 'value',
+                uuid: { uuid16 },
+                props: readOnly,
+                source: uuid16,
+                readPermission: OPEN_PERMISSION,
+                writePermission: { sm: 0, lv: 0 },
+            });
+            this._attribute(declaration).valueHandle = valueHandle;
+        });
+
+        this._addAttribute({ kind: 'service', primary: true, uuid: { uuid16: GATT_SERVICE_UUID } });
+    }
+
+    _addAttribute(attribute) {
+        if (this._attributes.length >= 0xFFFE) fail(constants.NRF_ERROR_NO_MEM);
+
+        attribute.handle = this._attributes.length + 1;
+        this._attributes.push(attribute);
+        return attribute.handle;
+    }
+
+    _attribute(handle) {
+        return this._attributes[handle - 1];
+    }
+
+    _serviceEnd(serviceHandle) {
+        const next = this._attributes.find(a => a.kind === 'service' && a.handle > serviceHandle);
+        return next ? next.handle - 1 : 0xFFFF;
+    }
+
+    _valueOf(attribute, link) {
+        switch (attribute.kind) {
+            case 'service':
+                return this._uuidBytes(attribute.uuid);
+            case 'characteristic': {
+                const valueAttribute = this._attribute(attribute.valueHandle);
+                return [this._propsByte(attribute.props)]
+                    .concat(uint16ToBytes(attribute.valueHandle), this._uuidBytes(valueAttribute.uuid));
+            }
+            default:
+                break;
+        }
+
+        if (attribute.cccd) {
+            return uint16ToBytes(link ? (link.cccds.get(this).get(attribute.handle) || 0) : 0);
+        }
+
+        switch (attribute.source) {
+            case DEVICE_NAME_UUID:
+                return this._deviceName.slice();
+            case APPEARANCE_UUID:
+                return uint16ToBytes(this._appearance);
+            case PPCP_UUID:
+                return [].concat(
+                    uint16ToBytes(Math.round(this._ppcp.min_conn_interval / 1.25)),
+                    uint16ToBytes(Math.round(this._ppcp.max_conn_interval / 1.25)),
+                    uint16ToBytes(this._ppcp.slave_latency),
+                    uint16ToBytes(Math.round(this._ppcp.conn_sup_timeout / 10)));
+            default:
+                return attribute.value.slice();
+        }
+    }
+
+    _setValue(attribute, offset, data) {
+        if (attribute.source !== undefined) fail(constants.NRF_ERROR_FORBIDDEN);
+        if (offset > attribute.value.length || offset + data.length > attribute.maxLength) fail(constants.NRF_ERROR_INVALID_PARAM);
+
+        attribute.value = attribute.value.slice(0, offset).concat(data);
+    }
+
+    _propsByte(props) {
+        return (props.broadcast ? 0x01 : 0) |
+            (props.read ? 0x02 : 0) |
+            (props.write_wo_resp ? 0x04 : 0) |
+            (props.write ? 0x08 : 0) |
+            (props.notify ? 0x10 : 0) |
+            (props.indicate ? 0x20 : 0) |
+            (props.auth_signed_wr ? 0x40 : 0);
+    }
+
+    _uuidBase(uuid128) {
+        const uuid = uuid128.replace(/-/g, '').toUpperCase();
+        return uuid.slice(0, 4) + '0000' + uuid.slice(8);
+    }
+
+    // UUID of a local attribute from the ble_uuid_t of a command
+    _localUuid(uuid) {
+        if (!uuid || uuid.type === undefined) fail(constants.NRF_ERROR_INVALID_PARAM);
+
+        if (uuid.type === constants.BLE_UUID_TYPE_BLE) {
+            return { uuid16: uuid.uuid };
+        }
+
+        const base = this._vsUuids[uuid.type - constants.BLE_UUID_TYPE_VENDOR_BEGIN];
+        if (!base) fail(constants.NRF_ERROR_INVALID_PARAM);
+
+        return { uuid16: uuid.uuid, uuid128: base.slice(0, 4) + hex(uuid.uuid, 4) + base.slice(8) };
+    }
+
+    // ble_uuid_t of a peer attribute as this client sees it, the type is unknown for unregistered 128-bit bases
+    _remoteUuid(uuid) {
+        if (!uuid.uuid128) {
+            return { uuid: uuid.uuid16, type: constants.BLE_UUID_TYPE_BLE, typeString: 'BLE_UUID_TYPE_BLE' };
+        }
+
+        const index = this._vsUuids.indexOf(this._uuidBase(uuid.uuid128));
+        if (index < 0) {
+            return { uuid: 0, type: constants.BLE_UUID_TYPE_UNKNOWN, typeString: 'BLE_UUID_TYPE_UNKNOWN' };
+        }
+
+        const type = index + constants.BLE_UUID_TYPE_VENDOR_BEGIN;
+        return { uuid: uuid.uuid16, type, typeString: uuidTypeString(type) };
+    }
+
+    // UUID of a peer attribute as reported by gattcDiscoverAll
+    _discoveredUuid(uuid) {
+        const discovered = { uuid: this._remoteUuid(uuid) };
+
+        if (uuid.uuid128) {
+            discovered.uuid128 = this._uuidBytes(uuid);
+        }
+
+        return discovered;
+    }
+
+    _uuidBytes(uuid) {
+        if (!uuid.uuid128) {
+            return uint16ToBytes(uuid.uuid16);
+        }
+
+        return Array.from(Buffer.from(uuid.uuid128, 'hex')).reverse();
+    }
+
+    // Attributes of a discovery response: consecutive attributes with UUIDs of the same size that fit the ATT_MTU
+    _group(attributes, uuidOf, space, shortEntrySize, longEntrySize) {
+        if (attributes.length === 0) {
+            return [];
+        }
+
+        const long = !!uuidOf(attributes[0]).uuid128;
+        const maxCount = Math.max(1, Math.floor(space / (long ? longEntrySize : shortEntrySize)));
+        const group = [];
+
+        for (let attribute of attributes) {
+            if (group.length >= maxCount || !!uuidOf(attribute).uuid128 !== long) break;
+            group.push(attribute);
+        }
+
+        return group;
+    }
+
+    _serverRead(link, handle) {
+        const attribute = this._attribute(handle);
+
+        if (!attribute) {
+            return { status: constants.BLE_GATT_STATUS_ATTERR_INVALID_HANDLE };
+        }
+
+        if (!permitted(attribute.readPermission)) {
+            return { status: constants.BLE_GATT_STATUS_ATTERR_READ_NOT_PERMITTED };
+        }
+
+        return { status: constants.BLE_GATT_STATUS_SUCCESS, value: this._valueOf(attribute, link) };
+    }
+
+    _serverWrite(link, handle, offset, data, op) {
+        const attribute = this._attribute(handle);
+
+        if (!attribute) {
+            return constants.BLE_GATT_STATUS_ATTERR_INVALID_HANDLE;
+        }
+
+        if (attribute.kind === 'service' || attribute.kind === 'characteristic' ||
+            attribute.source !== undefined || !permitted(attribute.writePermission)) {
+            return constants.BLE_GATT_STATUS_ATTERR_WRITE_NOT_PERMITTED;
+        }
+
+        if (attribute.cccd) {
+            if (offset !== 0 || data.length !== 2) {
+                return constants.BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH;
+            }
+
+            link.cccds.get(this).set(handle, data[0] | (data[1] << 8));
+        } else {
+            if (offset > attribute.value.length) {
+                return constants.BLE_GATT_STATUS_ATTERR_INVALID_OFFSET;
+            }
+
+            if (offset + data.length > attribute.maxLength) {
+                return constants.BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH;
+            }
+
+            attribute.value = attribute.value.slice(0, offset).concat(data);
+        }
+
+        const uuid = attribute.uuid.uuid128 ?
+            { uuid: attribute.uuid.uuid16, type: this._vsUuids.indexOf(this._uuidBase(attribute.uuid.uuid128)) + 2 } :
+            { uuid: attribute.uuid.uuid16, type: constants.BLE_UUID_TYPE_BLE };
+
+        this._radio.send(() => this._linkEvent(link, constants.BLE_GATTS_EVT_WRITE, {
+            handle,
+            uuid,
+            op,
+            auth_required: false,
+            offset,
+            len: data.length,
+            data,
+        }));
+
+        return constants.BLE_GATT_STATUS_SUCCESS;
+    }
+
+    _hvx(link, type, handle, data) {
+        const attribute = this._attribute(handle);
+        const client = link.peerOf(this);
+
+        if (!attribute || attribute.kind !== 'value' || !attribute.cccdHandle) {
+            return constants.NRF_ERROR_INVALID_PARAM;
+        }
+
+        const cccd = link.cccds.get(this).get(attribute.cccdHandle) || 0;
+        const notification = type === constants.BLE_GATT_HVX_NOTIFICATION;
+
+        if ((notification && !(cccd & 0x01)) || (!notification && !(cccd & 0x02))) {
+            return constants.NRF_ERROR_INVALID_STATE;
+        }
+
+        if (!notification && link.indications.has(this)) {
+            return constants.NRF_ERROR_BUSY;
+        }
+
+        const sent = data.slice(0, link.mtu - 3);
+
+        if (!notification) {
+            link.indications.set(this, handle);
+        }
+
+        this._radio.send(() => {
+            client._handleValue(link, handle, type, sent);
+
+            if (notification) {
+                this._linkEvent(link, constants.BLE_GATTS_EVT_HVN_TX_COMPLETE, { count: 1 });
+            }
+        });
+
+        return constants.NRF_SUCCESS;
+    }
+
+    _parseAdvertisingData(data) {
+        const parsed = {};
+        let pos = 0;
+
+        while (pos < data.length) {
+            const length = data[pos];
+            pos++;
+
+            if (length === 0 || pos + length > data.length) break;
+
+            const type = data[pos];
+            const payload = data.slice(pos + 1, pos + length);
+            const name = constants.adTypes[type] || String(type);
+
+            if (type === 0x01) {
+                parsed[name] = Object.keys(constants.advFlags)
+                    .filter(flag => (payload[0] & flag) !== 0)
+                    .map(flag => constants.advFlags[flag]);
+            } else if (type === 0x08 || type === 0x09) {
+                parsed[name] = Buffer.from(payload).toString('utf8');
+            } else if (type === 0x02 || type === 0x03) {
+                parsed[name] = [];
+                for (let i = 0; i + 1 < payload.length; i += 2) {
+                    parsed[name].push(hex(payload[i] | (payload[i + 1] << 8), 4));
+                }
+            } else if (type === 0x06 || type === 0x07) {
+                parsed[name] = [];
+                for (let i = 0; i + 15 < payload.length; i += 16) {
+                    const uuid = Buffer.from(payload.slice(i, i + 16)).reverse().toString('hex').toUpperCase();
+                    parsed[name].push(`${uuid.slice(0, 8)}-${uuid.slice(8, 12)}-${uuid.slice(12, 16)}-${uuid.slice(16, 20)}-${uuid.slice(20)}`);
+                }
+            } else if (type === 0x0A && payload.length === 1) {
+                parsed[name] = payload[0];
+            } else {
+                parsed[name] = payload;
+            }
+
+            pos += length;
+        }
+
+        return parsed;
+    }
+
+    _linkCount(role) {
+        let count = 0;
+
+        for (let link of this._links.values()) {
+            if ((role === constants.BLE_GAP_ROLE_CENTRAL) === (link.central === this)) count++;
+        }
+
+        return count;
+    }
+
+    _link(connHandle) {
+        const link = this._links.get(connHandle);
+        if (!link) fail(constants.BLE_ERROR_INVALID_CONN_HANDLE);
+        return link;
+    }
+
+    _beginProcedure(connHandle) {
+        const link = this._link(connHandle);
+        if (link.busy.has(this)) fail(constants.NRF_ERROR_BUSY);
+
+        link.busy.add(this);
+        return link;
+    }
+
+    _clientResponse(link, id, gattStatus, fields, errorHandle) {
+        this._radio.send(() => {
+            link.busy.delete(this);
+            this._linkEvent(link, id, Object.assign({ error_handle: errorHandle || 0 }, fields), gattStatus);
+        });
+    }
+
+    _event(id, connHandle, fields) {
+        return Object.assign({
+            id,
+            name: constants.eventName(id),
+            time: new Date().toISOString(),
+            conn_handle: connHandle,
+        }, fields);
+    }
+
+    // Event on a connection, dropped if the connection is gone by the time it arrives
+    _linkEvent(link, id, fields, gattStatus) {
+        const connHandle = link.handleOf(this);
+        if (this._links.get(connHandle) !== link) return;
+
+        const event = this._event(id, connHandle, fields);
+
+        if (gattStatus !== undefined) {
+            event.gatt_status = gattStatus;
+            event.gatt_status_name = constants.gattStatusName(gattStatus) || 'Unknown GATT status';
+        }
+
+        this._pushEvent(event);
+    }
+
+    _pushEvent(event) {
+        if (!this._radio) return;
+
+        if (this._eventMask.has(event.id)) {
+            this._maskedEvents[event.id] = (this._maskedEvents[event.id] || 0) + 1;
+
+            if (this._eventMaskAutoReply) {
+                this._replyMaskedEvent(event);
+            }
+
+            return;
+        }
+
+        this._eventQueue.push({ event, queued: process.hrtime.bigint() });
+
+        if (this._eventInterval === 0 && !this._dispatchScheduled) {
+            this._dispatchScheduled = true;
+            setImmediate(() => this._dispatchEvents());
+        }
+    }
+
+    _replyMaskedEvent(event) {
+        const ignore = () => {};
+
+        switch (event.id) {
+            case constants.BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+                this.gattsExchangeMtuReply(event.conn_handle, Math.min(this._eventMaskAttMtu, this._config.attMtu), ignore);
+                break;
+            case constants.BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST:
+                this.gapUpdateConnectionParameters(event.conn_handle, event.conn_params, ignore);
+                break;
+            case constants.BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+                this.gapPhyUpdate(event.conn_handle, { tx_phys: constants.BLE_GAP_PHY_AUTO, rx_phys: constants.BLE_GAP_PHY_AUTO }, ignore);
+                break;
+            case constants.BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
+                this.gapDataLengthUpdate(event.conn_handle, null, ignore);
+                break;
+            default:
+                // No reply required, the event is dropped
+                break;
+        }
+    }
+
+    _dispatchEvents() {
+        this._dispatchScheduled = false;
+
+        while (this._eventQueue.length > 0 && this._eventCallback) {
+            const batch = this._eventQueue.splice(0, this._eventMaxBatchSize);
+            const dispatched = process.hrtime.bigint();
+
+            this._eventCallback(batch.map(entry => entry.event));
+
+            const done = process.hrtime.bigint();
+            const callbackTime = Number(done - dispatched) / 1000;
+
+            this._eventCallbackTotalTime += callbackTime / 1000;
+            this._eventCallbackTotalCount += batch.length;
+            this._eventCallbackBatchCount += 1;
+            this._eventCallbackBatchMaxCount = Math.max(this._eventCallbackBatchMaxCount, batch.length);
+
+            for (let entry of batch) {
+                let samples = this._latencySamples.get(entry.event.id);
+
+                if (!samples) {
+                    samples = { queueResidence: [], callback: [] };
+                    this._latencySamples.set(entry.event.id, samples);
+                }
+
+                if (samples.queueResidence.length < MAX_LATENCY_SAMPLES) {
+                    // Microseconds, as in the native AddOn
+                    samples.queueResidence.push(Number(dispatched - entry.queued) / 1000);
+                    samples.callback.push(callbackTime / batch.length);
+                }
+            }
+        }
+    }
+
+    _status(id, message) {
+        const status = { id, name: constants.statusName(id), message, time: new Date().toISOString() };
+        setImmediate(() => {
+            if (this._statusCallback) this._statusCallback(status);
+        });
+    }
+
+    _log(severity, message) {
+        setImmediate(() => {
+            if (this._logCallback) this._logCallback(severity, message);
+        });
+    }
+
+    _reply(callback) {
+        const args = Array.prototype.slice.call(arguments, 1);
+        if (callback) setImmediate(() => callback.apply(undefined, args));
+    }
+
+    // Runs a command, fn returns the result of the command or fails with a SoftDevice error code
+    _call(operation, callback, fn, requireEnabled) {
+        let result;
+
+        try {
+            if (requireEnabled !== false && (!this._radio || !this._bleEnabled)) fail(constants.NRF_ERROR_INVALID_STATE);
+            result = fn();
+        } catch (error) {
+            if (!(error instanceof CommandError)) throw error;
+            this._reply(callback, makeError(error.errorCode, operation));
+            return;
+        }
+
+        this._reply(callback, undefined, result);
+    }
+
+    // Runs a command that completes later, fn calls done with the arguments of the callback
+    _callDeferred(operation, callback, fn) {
+        try {
+            if (!this._radio || !this._bleEnabled) fail(constants.NRF_ERROR_INVALID_STATE);
+            fn((...args) => {
+                if (callback) callback.apply(undefined, args);
+            });
+        } catch (error) {
+            if (!(error instanceof CommandError)) throw error;
+            this._reply(callback, makeError(error.errorCode, operation));
+        }
+    }
+}
+
+// Security procedures and the remaining commands of the AddOn are not simulated
+[
+    'gapAuthenticate',
+    'gapReplySecurityParameters',
+    'gapReplySecurityInfo',
+    'gapReplyAuthKey',
+    'gapReplyLescDhKey',
+    'gapNotifyKeypress',
+    'gapGetLescOobData',
+    'gapSetLescOobData',
+    'gapEncrypt',
+    'gapGetConnectionSecurity',
+    'gapSecurityRequest',
+    'gapSetTxPower',
+    'gapStartRssi',
+    'gapStopRssi',
+    'gapGetRssi',
+    'gapSetWhitelist',
+    'gapSetDeviceIdentities',
+    'gattsServiceChanged',
+].forEach(name => {
+    SimulatedAdapter.prototype[name] = function notSupported() {
+        const callback = arguments[arguments.length - 1];
+        this._reply(typeof callback === 'function' ? callback : undefined, makeError(constants.NRF_ERROR_NOT_SUPPORTED, name));
+    };
+});
+
+module.exports = SimulatedAdapter;
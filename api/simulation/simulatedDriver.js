@@ -0,0 +1,83 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/*
+ * Simulated driver, a stand-in for the pc-ble-driver-js-sd_api_v5 AddOn that needs no connectivity device.
+ *
+ * Exports the same constants and `Adapter` class as the AddOn. Adapters opened with the same port name share a
+ * `VirtualRadio` and can advertise to, scan for and connect to each other. Use it through
+ * `AdapterFactory.createAdapter('sim', radioName, instanceId)`.
+ *
+ * The stand-in is meant for fast unit tests of the JavaScript API. Benchmarks run the AddOn itself on the simulated
+ * physical layer of the `simulation` option of `Adapter.open()`, see simulatedLink.js.
+ */
+
+const constants = require('./constants');
+const SimulatedAdapter = require('./simulatedAdapter');
+const VirtualRadio = require('./virtualRadio');
+
+function notSupported(operation) {
+    return function () {
+        throw new Error(`${operation} is not supported by the simulated driver.`);
+    };
+}
+
+module.exports = Object.assign({}, constants, {
+    Adapter: SimulatedAdapter,
+    VirtualRadio,
+
+    /**
+     * Get a virtual radio, it is created if it does not exist.
+     *
+     * @param {string} name Name of the radio, the port adapters are opened with.
+     * @param {Object} [options] Radio options, see `VirtualRadio.configure()`.
+     * @returns {VirtualRadio} The radio.
+     */
+    getRadio: (name, options) => VirtualRadio.get(name, options),
+
+    // LE Secure Connections are not simulated
+    eccInit: () => {},
+    eccGenerateKeypair: notSupported('eccGenerateKeypair'),
+    eccComputePublicKey: notSupported('eccComputePublicKey'),
+    eccComputeSharedSecret: notSupported('eccComputeSharedSecret'),
+
+    // There is no serialization transport to collect command statistics from
+    getCommandStats: () => ({}),
+    resetCommandStats: () => {},
+    setCommandStatsSink: () => {},
+});
@@ -0,0 +1,210 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const ConnectivityEmulator = require('./connectivityEmulator');
+const FaultyWire = require('./faultyWire');
+const PseudoTerminal = require('./pseudoTerminal');
+const serialization = require('./serialization');
+
+/**
+ * @class SimulatedLink
+ * @classdesc A simulated physical layer for the native adapter: a pseudo-terminal with a connectivity emulator on
+ * the far end, through a faulty wire in each direction.
+ *
+ * The native adapter opens `path` like the serial port of a connectivity device, so the AddOn, the H5 link layer
+ * and the serialization transport are the real ones. Events are generated by the emulator, see
+ * `floodAdvertisements()` and `streamNotifications()`, in the layout of SoftDevice API v5.
+ *
+ * Use it through the `simulation` option of `Adapter.open()`. Needs Linux and python3, see `PseudoTerminal`.
+ */
+class SimulatedLink {
+    /**
+     * Shall not be called by user, use `SimulatedLink.open()`.
+     *
+     * @private
+     * @constructor
+     * @param {PseudoTerminal} terminal The pseudo-terminal.
+     * @param {Object} options See `SimulatedLink.open()`.
+     */
+    constructor(terminal, options) {
+        const wireOptions = Object.assign({
+            baudRate: options.baudRate,
+            bitsPerByte: options.parity === 'none' || options.parity === undefined ? 10 : 11,
+        }, options.faults);
+
+        this._terminal = terminal;
+        this._toDevice = new FaultyWire(Object.assign({}, wireOptions, { seed: 1 }));
+        this._toHost = new FaultyWire(Object.assign({}, wireOptions, { seed: 2 }));
+        this._emulator = new ConnectivityEmulator({
+            script: options.script,
+            retransmissionInterval: options.retransmissionInterval,
+        });
+
+        terminal.on('data', data => this._toDevice.write(data));
+        this._toDevice.on('data', data => this._emulator.write(data));
+        this._emulator.on('data', data => this._toHost.write(data));
+        this._toHost.on('data', data => terminal.write(data));
+    }
+
+    /**
+     * Create a simulated link.
+     *
+     * @param {Object} [options] Options.
+     * @param {number} [options.baudRate=0] Baud rate of the wires, 0 delivers without pacing.
+     * @param {string} [options.parity='none'] Parity, adds a bit per byte on the wires if not 'none'.
+     * @param {Object} [options.faults] Faults of the wires in both directions, see `FaultyWire`.
+     * @param {Object|function} [options.script] Script of the emulator, see `ConnectivityEmulator`.
+     * @param {number} [options.retransmissionInterval] Retransmission interval of the emulator.
+     * @param {function(Error, SimulatedLink)} callback Called when the link can be opened by the adapter.
+     * @returns {void}
+     */
+    static open(options, callback) {
+        PseudoTerminal.open((err, terminal) => {
+            if (err) {
+                callback(err);
+                return;
+            }
+
+            callback(undefined, new SimulatedLink(terminal, options || {}));
+        });
+    }
+
+    /**
+     * Path of the serial port to open the adapter with.
+     *
+     * @returns {string} The path.
+     */
+    get path() {
+        return this._terminal.path;
+    }
+
+    /**
+     * The connectivity emulator on the far end.
+     *
+     * @returns {ConnectivityEmulator} The emulator.
+     */
+    get emulator() {
+        return this._emulator;
+    }
+
+    /**
+     * Counters of the emulator and of the wires.
+     *
+     * @returns {Object} The counters, `{ emulator, wire: { toDevice, toHost } }`.
+     */
+    get stats() {
+        return {
+            emulator: this._emulator.stats,
+            wire: { toDevice: this._toDevice.stats, toHost: this._toHost.stats },
+        };
+    }
+
+    /**
+     * Send advertising reports from a number of advertisers, as fast as the link takes them.
+     *
+     * @param {Object} [options] Options.
+     * @param {number} [options.count=1000] Number of reports.
+     * @param {number} [options.dataLength=31] Length of the advertising data, between 9 and 31.
+     * @param {number} [options.devices=1] Number of advertisers, at most 256.
+     * @param {number} [options.rssi=-50] RSSI of the reports.
+     * @returns {number} The number of reports queued.
+     */
+    floodAdvertisements(options) {
+        const count = (options && options.count) || 1000;
+        const dataLength = Math.min(Math.max((options && options.dataLength) || 31, 9), 31);
+        const devices = Math.min((options && options.devices) || 1, 256);
+        const rssi = options && options.rssi;
+
+        // Flags, a complete local name and manufacturer specific data to fill up the length
+        const name = [0x53, 0x49, 0x4D];
+        const data = [0x02, 0x01, 0x06, name.length + 1, 0x09].concat(name);
+        const manufacturerData = dataLength - data.length - 2;
+        if (manufacturerData >= 0) {
+            data.push(manufacturerData + 1, 0xFF);
+            for (let i = 0; i < manufacturerData; i++) data.push(i & 0xFF);
+        }
+
+        for (let i = 0; i < count; i++) {
+            const address = `C0:FF:EE:00:00:${('0' + (i % devices).toString(16)).slice(-2).toUpperCase()}`;
+            this._emulator.sendEvent(serialization.encodeAdvertisingReport({ address, rssi, data }));
+        }
+
+        return count;
+    }
+
+    /**
+     * Send notifications of a characteristic value, as fast as the link takes them.
+     *
+     * @param {Object} options Options.
+     * @param {number} [options.connHandle=0] Connection handle.
+     * @param {number} options.handle Handle of the characteristic value.
+     * @param {number} [options.count=1000] Number of notifications.
+     * @param {number} [options.length=20] Length of each value.
+     * @returns {number} The number of notifications queued.
+     */
+    streamNotifications(options) {
+        const count = options.count || 1000;
+        const length = options.length || 20;
+        const connHandle = options.connHandle || 0;
+
+        for (let i = 0; i < count; i++) {
+            this._emulator.sendEvent(serialization.encodeHandleValue({
+                connHandle,
+                handle: options.handle,
+                data: new Array(length).fill(i & 0xFF),
+            }));
+        }
+
+        return count;
+    }
+
+    /**
+     * Stop the emulator and remove the pseudo-terminal pair.
+     *
+     * @returns {void}
+     */
+    close() {
+        this._emulator.close();
+        this._toDevice.close();
+        this._toHost.close();
+        this._terminal.removeAllListeners('data');
+        this._terminal.close();
+    }
+}
+
+module.exports = SimulatedLink;
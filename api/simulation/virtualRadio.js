@@ -0,0 +1,486 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const constants = require('./constants');
+
+const radios = new Map();
+
+// Number of advertising reports generated per turn of the event loop when flooding without a rate limit
+const FLOOD_CHUNK_SIZE = 64;
+
+function schedule(latency, fn) {
+    if (latency > 0) {
+        setTimeout(fn, latency);
+    } else {
+        setImmediate(fn);
+    }
+}
+
+function sameAddress(a, b) {
+    return a.toUpperCase() === b.toUpperCase();
+}
+
+/**
+ * @class VirtualRadio
+ * @classdesc The air between simulated adapters.
+ *
+ * Simulated adapters opened with the same port name share a radio. The radio delivers advertising reports from
+ * advertisers to scanners, establishes connections between initiators and connectable advertisers, and carries
+ * the packets of the connections. Packets are delivered in the order they are sent, after `latency` milliseconds or
+ * on the next turn of the event loop if `latency` is 0.
+ *
+ * The radio can also generate event loads on its own: advertising floods received by all scanners, and
+ * notification streams received by the central of a connection. These bypass the advertiser and the GATT server,
+ * so they measure the receiving side only.
+ */
+class VirtualRadio {
+    /**
+     * Shall not be called by user, use `VirtualRadio.get()`.
+     *
+     * @private
+     * @constructor
+     * @param {string} name Name of the radio, the port simulated adapters are opened with.
+     * @param {Object} [options] Options, see `configure()`.
+     */
+    constructor(name, options) {
+        this.name = name;
+        this.latency = 0;
+        this.rssi = -40;
+
+        this._adapters = new Set();
+        this._advertisers = new Map();
+        this._scanners = new Map();
+        this._initiators = new Map();
+        this._links = new Set();
+
+        this.configure(options);
+    }
+
+    /**
+     * Get the radio with the given name, it is created if it does not exist.
+     *
+     * @param {string} name Name of the radio.
+     * @param {Object} [options] Options to configure the radio with, see `configure()`.
+     * @returns {VirtualRadio} The radio.
+     */
+    static get(name, options) {
+        let radio = radios.get(name);
+
+        if (!radio) {
+            radio = new VirtualRadio(name, options);
+            radios.set(name, radio);
+        } else if (options) {
+            radio.configure(options);
+        }
+
+        return radio;
+    }
+
+    /**
+     * Configure the radio.
+     *
+     * Available options:
+     * <ul>
+     * <li>{number} [latency=0]: Milliseconds from a packet is sent until it is received.
+     * <li>{number} [rssi=-40]: RSSI of received advertising reports.
+     * </ul>
+     *
+     * @param {Object} options Options to configure the radio with.
+     * @returns {void}
+     */
+    configure(options) {
+        if (!options) return;
+        if (options.latency !== undefined) this.latency = options.latency;
+        if (options.rssi !== undefined) this.rssi = options.rssi;
+    }
+
+    /**
+     * Connections currently established on this radio.
+     *
+     * @returns {Array<Object>} The connections: {central, peripheral, mtu}, `central` and `peripheral` are
+     *                          simulated adapters.
+     */
+    get links() {
+        return Array.from(this._links);
+    }
+
+    send(fn) {
+        schedule(this.latency, fn);
+    }
+
+    join(adapter) {
+        this._adapters.add(adapter);
+    }
+
+    leave(adapter) {
+        this.stopAdvertising(adapter);
+        this.stopScanning(adapter);
+        this.cancelConnect(adapter);
+
+        for (let link of this._links) {
+            if (link.central === adapter || link.peripheral === adapter) {
+                this._terminate(link, adapter, constants.BLE_HCI_CONNECTION_TIMEOUT, false);
+            }
+        }
+
+        this._adapters.delete(adapter);
+    }
+
+    startAdvertising(adapter, params) {
+        const advertiser = { params, timer: null, timeout: null };
+        this._advertisers.set(adapter, advertiser);
+
+        // The first advertising event is sent right away, then one per advertising interval
+        this.send(() => this._advertise(adapter));
+        advertiser.timer = setInterval(() => this._advertise(adapter), Math.max(params.interval || 0, 20));
+
+        if (params.timeout) {
+            advertiser.timeout = setTimeout(() => {
+                this.stopAdvertising(adapter);
+                adapter._timedOut(constants.BLE_GAP_TIMEOUT_SRC_ADVERTISING);
+            }, params.timeout * 1000);
+        }
+
+        this._initiate();
+    }
+
+    stopAdvertising(adapter) {
+        const advertiser = this._advertisers.get(adapter);
+        if (!advertiser) return;
+
+        clearInterval(advertiser.timer);
+        clearTimeout(advertiser.timeout);
+        this._advertisers.delete(adapter);
+        adapter._advertisingStopped();
+    }
+
+    startScanning(adapter, params) {
+        const scanner = { params, timeout: null };
+        this._scanners.set(adapter, scanner);
+
+        // Scanners pick up all advertisers at once instead of waiting for their next advertising event
+        for (let advertiser of this._advertisers.keys()) {
+            this.send(() => this._report(advertiser, adapter));
+        }
+
+        if (params.timeout) {
+            scanner.timeout = setTimeout(() => {
+                this.stopScanning(adapter);
+                adapter._timedOut(constants.BLE_GAP_TIMEOUT_SRC_SCAN);
+            }, params.timeout * 1000);
+        }
+    }
+
+    stopScanning(adapter) {
+        const scanner = this._scanners.get(adapter);
+        if (!scanner) return;
+
+        clearTimeout(scanner.timeout);
+        this._scanners.delete(adapter);
+        adapter._scanningStopped();
+    }
+
+    connect(central, address, connParams, timeout) {
+        const initiator = { address, connParams, timeout: null };
+        this._initiators.set(central, initiator);
+
+        if (timeout) {
+            initiator.timeout = setTimeout(() => {
+                this.cancelConnect(central);
+                central._timedOut(constants.BLE_GAP_TIMEOUT_SRC_CONN);
+            }, timeout * 1000);
+        }
+
+        this._initiate();
+    }
+
+    cancelConnect(central) {
+        const initiator = this._initiators.get(central);
+        if (!initiator) return;
+
+        clearTimeout(initiator.timeout);
+        this._initiators.delete(central);
+        central._connectingStopped();
+    }
+
+    disconnect(link, adapter, hciStatusCode) {
+        this._terminate(link, adapter, hciStatusCode, true);
+    }
+
+    /**
+     * Send advertising reports to all scanners on this radio.
+     *
+     * The reports come from an advertiser that is not on the radio, with non-connectable advertising data of
+     * `dataLength` bytes: flags, a complete local name and manufacturer specific data filling up the rest.
+     *
+     * Available options:
+     * <ul>
+     * <li>{number} [count=1000]: Number of advertising reports to send to each scanner.
+     * <li>{number} [rate=0]: Advertising reports per second, 0 sends them as fast as possible.
+     * <li>{number} [dataLength=31]: Length of the advertising data, between 9 and 31 bytes.
+     * <li>{number} [devices=1]: Number of advertisers to spread the reports over, each with its own address.
+     * </ul>
+     *
+     * @param {Object} [options] Options for the flood.
+     * @returns {Promise<Object>} Resolved with {count, duration} when all reports have been delivered to the
+     *                            scanners' event queues, `duration` is in milliseconds.
+     */
+    floodAdvertisements(options) {
+        const count = (options && options.count) || 1000;
+        const rate = (options && options.rate) || 0;
+        const dataLength = Math.min(Math.max((options && options.dataLength) || 31, 9), 31);
+        const devices = Math.min((options && options.devices) || 1, 256);
+
+        const name = [0x53, 0x49, 0x4D];
+        const data = [0x02, 0x01, 0x06, name.length + 1, 0x09].concat(name);
+        const manufacturerData = dataLength - data.length - 2;
+        if (manufacturerData >= 0) {
+            data.push(manufacturerData + 1, 0xFF);
+            for (let i = 0; i < manufacturerData; i++) data.push(i & 0xFF);
+        }
+
+        const start = Date.now();
+        let sent = 0;
+
+        const sendReports = n => {
+            for (let i = 0; i < n; i++, sent++) {
+                const address = `C0:FF:EE:00:00:${('0' + (sent % devices).toString(16)).slice(-2).toUpperCase()}`;
+
+                for (let scanner of this._scanners.keys()) {
+                    scanner._advertisingReport(
+                        { address, type: 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC' },
+                        constants.BLE_GAP_ADV_TYPE_ADV_NONCONN_IND,
+                        data,
+                        false,
+                        this.rssi);
+                }
+            }
+        };
+
+        return new Promise(resolve => {
+            const done = () => resolve({ count, duration: Date.now() - start });
+
+            if (rate === 0) {
+                const next = () => {
+                    sendReports(Math.min(FLOOD_CHUNK_SIZE, count - sent));
+                    if (sent < count) {
+                        setImmediate(next);
+                    } else {
+                        done();
+                    }
+                };
+
+                this.send(next);
+                return;
+            }
+
+            const timer = setInterval(() => {
+                const due = Math.min(Math.floor(((Date.now() - start) * rate) / 1000), count);
+                sendReports(due - sent);
+
+                if (sent >= count) {
+                    clearInterval(timer);
+                    done();
+                }
+            }, 1);
+        });
+    }
+
+    /**
+     * Send notifications to the central of a connection.
+     *
+     * Available options:
+     * <ul>
+     * <li>{number} handle: Value handle the notifications are sent from.
+     * <li>{Object} [link]: Connection to send on, one of `links`. Defaults to the first connection.
+     * <li>{number} [count=1000]: Number of notifications.
+     * <li>{number} [length]: Length of each notification. Defaults to ATT_MTU - 3 of the connection.
+     * <li>{number} [rate=0]: Notifications per second, 0 sends them as fast as possible.
+     * </ul>
+     *
+     * @param {Object} options Options for the stream.
+     * @returns {Promise<Object>} Resolved with {count, bytes, duration} when all notifications have been delivered to
+     *                            the central's event queue, `duration` is in milliseconds.
+     */
+    streamNotifications(options) {
+        const link = options.link || this.links[0];
+        if (!link) {
+            return Promise.reject(new Error('There is no connection on the radio.'));
+        }
+
+        const count = options.count || 1000;
+        const rate = options.rate || 0;
+        const length = Math.min(options.length || (link.mtu - 3), link.mtu - 3);
+        const start = Date.now();
+        let sent = 0;
+
+        const sendNotifications = n => {
+            for (let i = 0; i < n && this._links.has(link); i++, sent++) {
+                const data = new Array(length).fill(sent & 0xFF);
+                link.central._handleValue(link, options.handle, constants.BLE_GATT_HVX_NOTIFICATION, data);
+            }
+        };
+
+        return new Promise(resolve => {
+            const done = () => resolve({ count: sent, bytes: sent * length, duration: Date.now() - start });
+
+            if (rate === 0) {
+                const next = () => {
+                    sendNotifications(Math.min(FLOOD_CHUNK_SIZE, count - sent));
+                    if (sent < count && this._links.has(link)) {
+                        setImmediate(next);
+                    } else {
+                        done();
+                    }
+                };
+
+                this.send(next);
+                return;
+            }
+
+            const timer = setInterval(() => {
+                const due = Math.min(Math.floor(((Date.now() - start) * rate) / 1000), count);
+                sendNotifications(due - sent);
+
+                if (sent >= count || !this._links.has(link)) {
+                    clearInterval(timer);
+                    done();
+                }
+            }, 1);
+        });
+    }
+
+    _advertise(adapter) {
+        for (let scanner of this._scanners.keys()) {
+            if (scanner !== adapter) {
+                this._report(adapter, scanner);
+            }
+        }
+    }
+
+    _report(advertiser, scanner) {
+        const adv = this._advertisers.get(advertiser);
+        const scan = this._scanners.get(scanner);
+        if (!adv || !scan) return;
+
+        const type = adv.params.type;
+        const address = advertiser._address;
+
+        scanner._advertisingReport(address, type, advertiser._advData, false, this.rssi);
+
+        const scannable = type === constants.BLE_GAP_ADV_TYPE_ADV_IND ||
+            type === constants.BLE_GAP_ADV_TYPE_ADV_SCAN_IND;
+
+        if (scan.params.active && scannable && advertiser._scanRspData.length > 0) {
+            scanner._advertisingReport(address, type, advertiser._scanRspData, true, this.rssi);
+        }
+    }
+
+    _initiate() {
+        for (let [central, initiator] of this._initiators) {
+            for (let [peripheral, advertiser] of this._advertisers) {
+                const connectable = advertiser.params.type === constants.BLE_GAP_ADV_TYPE_ADV_IND ||
+                    advertiser.params.type === constants.BLE_GAP_ADV_TYPE_ADV_DIRECT_IND;
+
+                if (peripheral !== central && connectable &&
+                    sameAddress(peripheral._address.address, initiator.address.address)) {
+                    this._establish(central, peripheral, initiator.connParams);
+                    break;
+                }
+            }
+        }
+    }
+
+    _establish(central, peripheral, connParams) {
+        clearTimeout(this._initiators.get(central).timeout);
+        this._initiators.delete(central);
+        this.stopAdvertising(peripheral);
+        this.stopScanning(central);
+
+        const link = {
+            central,
+            peripheral,
+            handles: new Map(),
+            connParams: Object.assign({}, connParams),
+            mtu: constants.BLE_GATT_ATT_MTU_DEFAULT,
+            // CCCD values written by the client, keyed by server and then CCCD handle
+            cccds: new Map([[central, new Map()], [peripheral, new Map()]]),
+            // Clients with a request outstanding
+            busy: new Set(),
+            // Indications waiting for a confirmation, keyed by server
+            indications: new Map(),
+            mtuRequest: null,
+            phyRequest: null,
+            dataLengthRequest: null,
+            peerOf: adapter => (adapter === central ? peripheral : central),
+            handleOf: adapter => link.handles.get(adapter),
+        };
+
+        link.handles.set(central, central._addLink(link));
+        link.handles.set(peripheral, peripheral._addLink(link));
+        this._links.add(link);
+
+        this.send(() => {
+            peripheral._connected(link);
+            central._connected(link);
+        });
+    }
+
+    _terminate(link, adapter, hciStatusCode, notifyInitiator) {
+        if (!this._links.has(link)) return;
+
+        this._links.delete(link);
+
+        const peer = link.peerOf(adapter);
+        const adapterHandle = link.handleOf(adapter);
+        const peerHandle = link.handleOf(peer);
+
+        adapter._removeLink(adapterHandle);
+        peer._removeLink(peerHandle);
+
+        this.send(() => {
+            if (notifyInitiator) {
+                adapter._disconnected(adapterHandle, constants.BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION);
+            }
+
+            peer._disconnected(peerHandle, hciStatusCode);
+        });
+    }
+}
+
+module.exports = VirtualRadio;
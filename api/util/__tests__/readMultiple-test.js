@@ -0,0 +1,84 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const ReadMultiple = require('../readMultiple');
+
+describe('fixedValueLength', () => {
+    it('should return the length of fixed size characteristics', () => {
+        expect(ReadMultiple.fixedValueLength('2A19')).toEqual(1);
+        expect(ReadMultiple.fixedValueLength('2A50')).toEqual(7);
+    });
+
+    it('should return undefined for variable length characteristics', () => {
+        expect(ReadMultiple.fixedValueLength('2A00')).toBeUndefined();
+    });
+});
+
+describe('groupByPayloadSize', () => {
+    it('should group entries that fit in one response', () => {
+        const entries = [{ length: 1 }, { length: 7 }, { length: 8 }];
+        expect(ReadMultiple.groupByPayloadSize(entries, 22)).toEqual([entries]);
+    });
+
+    it('should start a new group when the response would exceed the payload size', () => {
+        const entries = [{ length: 16 }, { length: 4 }, { length: 8 }, { length: 1 }];
+        expect(ReadMultiple.groupByPayloadSize(entries, 22)).toEqual([
+            [{ length: 16 }, { length: 4 }],
+            [{ length: 8 }, { length: 1 }],
+        ]);
+    });
+
+    it('should put entries larger than the payload size in a group of their own', () => {
+        const entries = [{ length: 1 }, { length: 30 }, { length: 2 }];
+        expect(ReadMultiple.groupByPayloadSize(entries, 22)).toEqual([
+            [{ length: 1 }],
+            [{ length: 30 }],
+            [{ length: 2 }],
+        ]);
+    });
+});
+
+describe('splitValues', () => {
+    it('should split a response into the values read', () => {
+        expect(ReadMultiple.splitValues([1, 2, 3, 4, 5], [1, 4])).toEqual([[1], [2, 3, 4, 5]]);
+    });
+
+    it('should return undefined if the response length does not match', () => {
+        expect(ReadMultiple.splitValues([1, 2, 3], [1, 4])).toBeUndefined();
+    });
+});
@@ -0,0 +1,124 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/**
+ * Value lengths of Bluetooth SIG characteristics that have a fixed size. The values returned in a Read Multiple
+ * response are concatenated without length fields, so only characteristics with a known length can be read that way.
+ */
+const FIXED_VALUE_LENGTHS = {
+    '2A01': 2, // Appearance
+    '2A04': 8, // Peripheral Preferred Connection Parameters
+    '2A05': 4, // Service Changed
+    '2A07': 1, // Tx Power Level
+    '2A08': 7, // Date Time
+    '2A0F': 2, // Local Time Information
+    '2A19': 1, // Battery Level
+    '2A23': 8, // System ID
+    '2A2B': 10, // Current Time
+    '2A38': 1, // Body Sensor Location
+    '2A50': 7, // PnP ID
+    '2A6D': 4, // Pressure
+    '2A6E': 2, // Temperature
+    '2A6F': 2, // Humidity
+    '2AA6': 1, // Central Address Resolution
+    '2B2A': 16, // Database Hash
+};
+
+function fixedValueLength(uuid) {
+    return FIXED_VALUE_LENGTHS[uuid];
+}
+
+/**
+ * Group attributes into Read Multiple requests whose responses fit in one ATT PDU.
+ *
+ * @param {Array} entries Attributes to read, each an object with a value <code>length</code>.
+ * @param {number} maxPayloadSize Maximum size of a Read Multiple response value, ATT_MTU - 1.
+ * @returns {Array} Groups of entries in the order given. Groups with a single entry have to be read separately.
+ */
+function groupByPayloadSize(entries, maxPayloadSize) {
+    const groups = [];
+    let group = [];
+    let groupSize = 0;
+
+    for (const entry of entries) {
+        if (group.length > 0 && groupSize + entry.length > maxPayloadSize) {
+            groups.push(group);
+            group = [];
+            groupSize = 0;
+        }
+
+        group.push(entry);
+        groupSize += entry.length;
+    }
+
+    if (group.length > 0) {
+        groups.push(group);
+    }
+
+    return groups;
+}
+
+/**
+ * Split the value of a Read Multiple response into the values of the attributes read.
+ *
+ * @param {Array} values Concatenated values from the response.
+ * @param {Array} lengths Expected length of each value.
+ * @returns {Array|undefined} The values, or undefined if the response does not match the expected lengths.
+ */
+function splitValues(values, lengths) {
+    const totalLength = lengths.reduce((sum, length) => sum + length, 0);
+    if (values.length !== totalLength) {
+        return undefined;
+    }
+
+    const result = [];
+    let offset = 0;
+
+    for (const length of lengths) {
+        result.push(values.slice(offset, offset + length));
+        offset += length;
+    }
+
+    return result;
+}
+
+module.exports = {
+    fixedValueLength,
+    groupByPayloadSize,
+    splitValues,
+};
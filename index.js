@@ -43,9 +43,11 @@ const Device = require('./api/device');
 const Dfu = require('./api/dfu');
 const FirmwareRegistry = require('./api/firmwareRegistry');
 const FirmwareUpdater = require('./api/firmwareUpdater');
+const GattCache = require('./api/gattCache');
 const Security = require('./api/security');
 const Service = require('./api/service');
 const ServiceFactory = require('./api/serviceFactory');
+const VirtualRadio = require('./api/simulation/virtualRadio');
 
 module.exports = {
     Adapter,
@@ -57,7 +59,9 @@ module.exports = {
     Dfu,
     FirmwareRegistry,
     FirmwareUpdater,
+    GattCache,
     Security,
     Service,
     ServiceFactory,
+    VirtualRadio,
 };
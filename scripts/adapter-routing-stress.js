@@ -0,0 +1,209 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/*
+ * Stress test of the routing of driver callbacks to AddOn adapters, no connectivity device needed.
+ *
+ * Opens a number of AddOn adapters concurrently, each on its own simulated physical layer, see
+ * api/simulation/simulatedLink.js. The connectivity emulator of each adapter then streams notifications with a
+ * connection handle, a value handle and a value unique to the adapter, all at the same time. Every event must
+ * reach the event callback of the adapter whose link sent it, and every adapter must get the status of its own
+ * link. Writes the events per second and the routing errors to stdout as JSON, exits with an error if any event
+ * was lost or misrouted. Needs Linux and python3.
+ *
+ * Usage: node scripts/adapter-routing-stress.js [--adapters <n>] [--count <n>] [--timeout <ms>]
+ */
+
+const SimulatedLink = require('../api/simulation/simulatedLink');
+const serialization = require('../api/simulation/serialization');
+
+function argument(name, defaultValue) {
+    const index = process.argv.indexOf(`--${name}`);
+    return index >= 0 ? process.argv[index + 1] : defaultValue;
+}
+
+const adapterCount = Number(argument('adapters', 16));
+const count = Number(argument('count', 2000));
+const timeout = Number(argument('timeout', 60000));
+
+// The emulator sends events in the layout of SoftDevice API v5
+const bleDriver = require('bindings')('pc-ble-driver-js-sd_api_v5');
+
+const VALUE_HANDLE_BASE = 0x0100;
+const VALUE_LENGTH = 20;
+
+function call(object, method) {
+    const args = Array.prototype.slice.call(arguments, 2);
+
+    return new Promise((resolve, reject) => {
+        object[method].apply(object, args.concat((err, result) => (err ? reject(err) : resolve(result))));
+    });
+}
+
+function openLink() {
+    return new Promise((resolve, reject) => {
+        SimulatedLink.open({}, (err, link) => (err ? reject(err) : resolve(link)));
+    });
+}
+
+// One adapter and its link, counting the events and statuses it gets and the ones meant for another adapter
+async function createEndpoint(index) {
+    const endpoint = {
+        index,
+        link: await openLink(),
+        adapter: new bleDriver.Adapter(),
+        received: 0,
+        misrouted: 0,
+        statuses: 0,
+        onReceived: () => {},
+    };
+
+    const onEvents = events => {
+        events.forEach(event => {
+            if (event.id !== bleDriver.BLE_GATTC_EVT_HVX) {
+                return;
+            }
+
+            if (event.conn_handle !== index || event.handle !== VALUE_HANDLE_BASE + index || event.data[0] !== (index & 0xFF)) {
+                endpoint.misrouted += 1;
+                return;
+            }
+
+            endpoint.received += 1;
+        });
+
+        endpoint.onReceived();
+    };
+
+    await call(endpoint.adapter, 'open', endpoint.link.path, {
+        baudRate: 1000000,
+        parity: 'none',
+        flowControl: 'none',
+        eventInterval: 0,
+        eventMaxDelay: 0,
+        eventMaxBatchSize: 32,
+        logLevel: 'fatal',
+        retransmissionInterval: 250,
+        responseTimeout: 1500,
+        enableBLE: false,
+        logCallback: () => {},
+        eventCallback: onEvents,
+        statusCallback: () => {
+            endpoint.statuses += 1;
+        },
+    });
+
+    return endpoint;
+}
+
+function streamed(endpoint) {
+    return new Promise(resolve => {
+        endpoint.onReceived = () => {
+            if (endpoint.received + endpoint.misrouted >= count) {
+                resolve();
+            }
+        };
+    });
+}
+
+async function run() {
+    const indexes = Array.from({ length: adapterCount }, (value, index) => index);
+
+    // Opened concurrently, so the driver adapters are registered while callbacks of the others are running
+    const endpoints = await Promise.all(indexes.map(createEndpoint));
+
+    const start = process.hrtime();
+    const done = Promise.all(endpoints.map(streamed));
+
+    endpoints.forEach(endpoint => {
+        // Each emulator encodes the notifications with its own handles, the value is filled with the index
+        const value = endpoint.index & 0xFF;
+        for (let i = 0; i < count; i++) {
+            endpoint.link.emulator.sendEvent(serialization.encodeHandleValue({
+                connHandle: endpoint.index,
+                handle: VALUE_HANDLE_BASE + endpoint.index,
+                data: new Array(VALUE_LENGTH).fill(value),
+            }));
+        }
+    });
+
+    let timer;
+    const timedOut = await Promise.race([
+        done.then(() => false),
+        new Promise(resolve => {
+            timer = setTimeout(() => resolve(true), timeout);
+        }),
+    ]);
+    clearTimeout(timer);
+
+    const [seconds, nanoseconds] = process.hrtime(start);
+    const duration = (seconds * 1e3) + (nanoseconds / 1e6);
+
+    const results = {
+        adapters: adapterCount,
+        count,
+        timedOut,
+        duration,
+        eventsPerSecond: Math.round((endpoints.reduce((sum, endpoint) => sum + endpoint.received, 0) * 1000) / duration),
+        adapterResults: endpoints.map(endpoint => ({
+            index: endpoint.index,
+            received: endpoint.received,
+            misrouted: endpoint.misrouted,
+            statuses: endpoint.statuses,
+        })),
+    };
+
+    for (const endpoint of endpoints) {
+        await call(endpoint.adapter, 'close');
+        endpoint.link.close();
+    }
+
+    process.stdout.write(`${JSON.stringify(results, null, 2)}\n`);
+
+    const failed = results.adapterResults.filter(result => result.received !== count || result.misrouted > 0 || result.statuses === 0);
+
+    if (failed.length > 0) {
+        process.stderr.write(`Routing failed for adapters ${failed.map(result => result.index).join(', ')}\n`);
+        process.exit(1);
+    }
+}
+
+run().catch(err => {
+    process.stderr.write(`Stress test failed: ${err.message}\n`);
+    process.exit(1);
+});
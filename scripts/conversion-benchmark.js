@@ -0,0 +1,287 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/*
+ * Benchmarks the conversions of the NAN layer between JavaScript objects and SoftDevice structs, no connectivity
+ * device needed. Requires the benchmark AddOn, build it with `npm run build-bench`.
+ *
+ * Every struct type is converted from JavaScript to native (the arguments of the AddOn methods) and, where the AddOn
+ * does so, from native back to JavaScript (events and callbacks), with every conversion path the AddOn provides.
+ * ByteArray is the value array of writes, notifications and events and is measured from 0 to 512 bytes. It reports
+ * time per conversion, C++ allocations per conversion, and JavaScript heap allocated per conversion to JavaScript
+ * when run with --expose-gc. Struct types marshalled from a StructSchema keep their former hand-written conversions
+ * as the 'handwritten' path, and the current path reports its speedup over it. Other paths than 'current' and
+ * 'handwritten' report their speedup over the current path.
+ *
+ * The results are written to stdout, or to --output, as JSON. With --baseline, the results are compared to an earlier
+ * result file and the script fails if any conversion got slower by more than --threshold percent.
+ *
+ * Usage: node --expose-gc scripts/conversion-benchmark.js [--sd v2|v5] [--iterations <n>] [--output <file>]
+ *                                                         [--baseline <file>] [--threshold <percent>]
+ */
+
+const fs = require('fs');
+const v8 = require('v8');
+const Adapter = require('../api/adapter');
+
+function argument(name, defaultValue) {
+    const index = process.argv.indexOf(`--${name}`);
+    return index >= 0 ? process.argv[index + 1] : defaultValue;
+}
+
+const sdVersion = argument('sd', 'v5');
+const iterations = Number(argument('iterations', 100000));
+const output = argument('output');
+const baseline = argument('baseline');
+const threshold = Number(argument('threshold', 10));
+
+const addOn = require('bindings')(`pc-ble-driver-js-bench-sd_api_${sdVersion}`);
+
+// Few enough conversions to not trigger a scavenge, to measure the JavaScript heap allocated per conversion
+const HEAP_SAMPLE_COUNT = 1000;
+
+const BYTE_ARRAY_LENGTHS = [0, 1, 8, 20, 64, 128, 244, 512];
+
+function bytes(length) {
+    return Array.from({ length }, (value, index) => index & 0xFF);
+}
+
+function gattcWrite(length) {
+    return {
+        write_op: addOn.BLE_GATT_OP_WRITE_CMD,
+        flags: 0,
+        handle: 0x0010,
+        offset: 0,
+        len: length,
+        value: bytes(length),
+    };
+}
+
+function gattsHvx(length) {
+    return {
+        handle: 0x0012,
+        type: addOn.BLE_GATT_HVX_NOTIFICATION,
+        offset: 0,
+        len: length,
+        data: bytes(length),
+    };
+}
+
+// The objects the API passes to the AddOn, struct types the SoftDevice API does not have are skipped
+const cases = [
+    { name: 'BleUUID', struct: 'BleUUID', object: { uuid: 0x180D, type: addOn.BLE_UUID_TYPE_BLE } },
+    {
+        name: 'EnableParameters',
+        struct: 'EnableParameters',
+        object: Adapter.prototype._getDefaultEnableBLEParams.call({ _bleDriver: addOn }),
+    },
+    { name: 'GapAddr', struct: 'GapAddr', object: { address: 'E3:1F:6A:50:2B:C4', type: 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC' } },
+    {
+        name: 'GapAdvParams',
+        struct: 'GapAdvParams',
+        object: {
+            type: addOn.BLE_GAP_ADV_TYPE_ADV_IND,
+            fp: addOn.BLE_GAP_ADV_FP_ANY,
+            timeout: 0,
+            interval: 100,
+            channel_mask: { ch_37_off: false, ch_38_off: false, ch_39_off: false },
+        },
+    },
+    {
+        name: 'GapConnParams',
+        struct: 'GapConnParams',
+        object: { min_conn_interval: 7.5, max_conn_interval: 7.5, slave_latency: 0, conn_sup_timeout: 4000 },
+    },
+    {
+        name: 'GapDataLengthLimitation',
+        struct: 'GapDataLengthLimitation',
+        object: { tx_payload_limited_octets: 27, rx_payload_limited_octets: 27, tx_rx_time_limited_us: 0 },
+    },
+    { name: 'GapDataLengthParams', struct: 'GapDataLengthParams', object: { max_tx_octets: 251, max_rx_octets: 251 } },
+    {
+        name: 'GapEnableParameters',
+        struct: 'GapEnableParameters',
+        object: { periph_conn_count: 1, central_conn_count: 7, central_sec_count: 1 },
+    },
+    { name: 'GapScanParams', struct: 'GapScanParams', object: { active: true, interval: 100, window: 50, timeout: 0 } },
+    { name: 'GapPhys', struct: 'GapPhys', object: { tx_phys: 2, rx_phys: 2 } },
+    { name: 'GattcHandleRange', struct: 'GattcHandleRange', object: { start_handle: 0x0001, end_handle: 0xFFFF } },
+    { name: 'GattcWriteParameters/20', struct: 'GattcWriteParameters', object: gattcWrite(20) },
+    { name: 'GattcWriteParameters/244', struct: 'GattcWriteParameters', object: gattcWrite(244) },
+    { name: 'GattsValue/20', struct: 'GattsValue', object: { len: 20, offset: 0, value: bytes(20) } },
+    { name: 'GattsHVXParams/20', struct: 'GattsHVXParams', object: gattsHvx(20) },
+    { name: 'GattsHVXParams/244', struct: 'GattsHVXParams', object: gattsHvx(244) },
+    { name: 'Version', struct: 'Version', object: { version_number: 8, company_id: 0x0059, subversion_number: 0x00A8 } },
+].concat(BYTE_ARRAY_LENGTHS.map(length => ({
+    name: `ByteArray/${length}`,
+    struct: 'ByteArray',
+    object: { value: bytes(length) },
+}))).filter(testCase => addOn.bench.conversions[testCase.struct]);
+
+function perConversion(value, conversions) {
+    return Math.round((value / conversions) * 100) / 100;
+}
+
+function jsHeapPerConversion(testCase, path) {
+    if (!global.gc) {
+        return null;
+    }
+
+    global.gc();
+
+    const before = v8.getHeapStatistics();
+    addOn.bench.toJs(testCase.struct, path, testCase.object, HEAP_SAMPLE_COUNT);
+    const after = v8.getHeapStatistics();
+
+    // A collection during the sample makes the difference meaningless
+    if (after.used_heap_size < before.used_heap_size) {
+        return null;
+    }
+
+    return perConversion(after.used_heap_size - before.used_heap_size, HEAP_SAMPLE_COUNT);
+}
+
+function measure(testCase, path, direction) {
+    const convert = addOn.bench[direction];
+
+    // Warm up the JIT and the allocators
+    convert(testCase.struct, path, testCase.object, Math.min(iterations, 10000));
+
+    const result = convert(testCase.struct, path, testCase.object, iterations);
+
+    return {
+        nsPerConversion: perConversion(result.time, result.iterations),
+        allocationsPerConversion: perConversion(result.allocations, result.iterations),
+        nativeBytesPerConversion: perConversion(result.allocatedBytes, result.iterations),
+        jsHeapBytesPerConversion: direction === 'toJs' ? jsHeapPerConversion(testCase, path) : undefined,
+    };
+}
+
+function speedup(current, other) {
+    return other.nsPerConversion > 0 ? Math.round((current.nsPerConversion / other.nsPerConversion) * 100) / 100 : null;
+}
+
+function run(testCase) {
+    const description = addOn.bench.conversions[testCase.struct];
+    const paths = {};
+
+    description.paths.forEach(path => {
+        paths[path] = { toNative: measure(testCase, path, 'toNative') };
+
+        if (description.toJs) {
+            paths[path].toJs = measure(testCase, path, 'toJs');
+        }
+    });
+
+    if (paths.handwritten) {
+        paths.current.speedup = {
+            toNative: speedup(paths.handwritten.toNative, paths.current.toNative),
+            toJs: description.toJs ? speedup(paths.handwritten.toJs, paths.current.toJs) : undefined,
+        };
+    }
+
+    Object.keys(paths).filter(path => path !== 'current' && path !== 'handwritten').forEach(path => {
+        paths[path].speedup = {
+            toNative: speedup(paths.current.toNative, paths[path].toNative),
+            toJs: description.toJs ? speedup(paths.current.toJs, paths[path].toJs) : undefined,
+        };
+    });
+
+    return { name: testCase.name, struct: testCase.struct, paths };
+}
+
+function regressions(results, previous) {
+    const found = [];
+    const limit = threshold / 100;
+
+    results.cases.forEach(testCase => {
+        const old = previous.cases.find(candidate => candidate.name === testCase.name);
+
+        if (!old) {
+            return;
+        }
+
+        Object.keys(testCase.paths).filter(path => old.paths[path]).forEach(path => {
+            ['toNative', 'toJs'].filter(direction => testCase.paths[path][direction] && old.paths[path][direction]).forEach(direction => {
+                const current = testCase.paths[path][direction].nsPerConversion;
+                const reference = old.paths[path][direction].nsPerConversion;
+
+                if (reference > 0 && (current - reference) / reference > limit) {
+                    found.push({ case: testCase.name, metric: `${path}.${direction}.nsPerConversion`, baseline: reference, current });
+                }
+            });
+        });
+    });
+
+    return found;
+}
+
+function main() {
+    const results = {
+        sdVersion,
+        node: process.version,
+        v8: process.versions.v8,
+        platform: `${process.platform}-${process.arch}`,
+        iterations,
+        cases: cases.map(run),
+    };
+
+    if (baseline) {
+        results.regressions = regressions(results, JSON.parse(fs.readFileSync(baseline, 'utf8')));
+    }
+
+    const json = `${JSON.stringify(results, null, 2)}\n`;
+
+    if (output) {
+        fs.writeFileSync(output, json);
+    } else {
+        process.stdout.write(json);
+    }
+
+    if (results.regressions && results.regressions.length > 0) {
+        process.stderr.write(`${results.regressions.length} regressions of more than ${threshold}% against ${baseline}\n`);
+        process.exit(1);
+    }
+}
+
+try {
+    main();
+} catch (err) {
+    process.stderr.write(`Benchmark failed: ${err.message}\n`);
+    process.exit(1);
+}
@@ -0,0 +1,296 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/*
+ * Benchmarks the native event pipeline, Adapter::appendEvent -> Adapter::onRpcEvent -> JavaScript, with synthetic
+ * events, no connectivity device needed. Requires the benchmark AddOn, build it with `npm run build-bench`.
+ *
+ * For each event kind it measures:
+ * - conversion: events appended and converted in batches in the NodeJS thread. Time per event of appendEvent and of
+ *   onRpcEvent (native to JavaScript conversion and the event callback), C++ allocations per event, and JavaScript
+ *   heap allocated per event when run with --expose-gc.
+ * - pipeline: events appended from a separate thread like the SerializationTransport event thread. Events per
+ *   second, average batch size and garbage collection time.
+ *
+ * The results are written to stdout, or to --output, as JSON. With --baseline, the conversion and pipeline results
+ * are compared to an earlier result file and the script fails if any event kind got slower by more than
+ * --threshold percent.
+ *
+ * Usage: node --expose-gc scripts/event-benchmark.js [--sd v2|v5] [--count <n>] [--output <file>]
+ *                                                    [--baseline <file>] [--threshold <percent>]
+ */
+
+const fs = require('fs');
+const v8 = require('v8');
+const { PerformanceObserver } = require('perf_hooks');
+
+function argument(name, defaultValue) {
+    const index = process.argv.indexOf(`--${name}`);
+    return index >= 0 ? process.argv[index + 1] : defaultValue;
+}
+
+const sdVersion = argument('sd', 'v5');
+const count = Number(argument('count', 100000));
+const output = argument('output');
+const baseline = argument('baseline');
+const threshold = Number(argument('threshold', 10));
+
+const addOn = require('bindings')(`pc-ble-driver-js-bench-sd_api_${sdVersion}`);
+
+// Events converted in one onRpcEvent call in the conversion benchmark, the default eventMaxBatchSize
+const BATCH_SIZE = 32;
+
+// Few enough events to convert without a scavenge, to measure the JavaScript heap allocated per event
+const HEAP_SAMPLE_COUNT = 1000;
+
+const scenarios = [
+    { name: 'adv_report/empty', type: 'adv_report', variant: 'empty' },
+    { name: 'adv_report/name', type: 'adv_report', variant: 'name' },
+    { name: 'adv_report/uuids', type: 'adv_report', variant: 'uuids' },
+    { name: 'adv_report/uuid128', type: 'adv_report', variant: 'uuid128' },
+    { name: 'adv_report/manufacturer', type: 'adv_report', variant: 'manufacturer' },
+    { name: 'adv_report/mixed', type: 'adv_report', variant: 'mixed' },
+    { name: 'hvx/20', type: 'hvx', length: 20 },
+    { name: 'hvx/244', type: 'hvx', length: 244 },
+    { name: 'prim_srvc_disc_rsp/4', type: 'prim_srvc_disc_rsp', entries: 4 },
+    { name: 'char_disc_rsp/8', type: 'char_disc_rsp', entries: 8 },
+].map(scenario => Object.assign({ variant: '', length: 0, entries: 0 }, scenario));
+
+const gc = { count: 0, duration: 0 };
+const gcObserver = new PerformanceObserver(list => {
+    list.getEntries().forEach(entry => {
+        gc.count += 1;
+        gc.duration += entry.duration;
+    });
+});
+gcObserver.observe({ entryTypes: ['gc'] });
+
+// Performance entries are delivered asynchronously
+function flushGcEntries() {
+    return new Promise(resolve => setImmediate(resolve));
+}
+
+function perEvent(value, events) {
+    return Math.round((value / events) * 100) / 100;
+}
+
+function convert(scenario, events) {
+    const adapter = new addOn.Adapter();
+    let received = 0;
+
+    const result = addOn.bench.convertEvents(adapter, scenario, { count: events, batchSize: BATCH_SIZE }, batch => {
+        received += batch.length;
+    });
+
+    addOn.bench.release(adapter);
+
+    if (received !== events) {
+        throw new Error(`${scenario.name}: ${received} of ${events} events received`);
+    }
+
+    return result;
+}
+
+async function jsHeapPerEvent(scenario) {
+    if (!global.gc) {
+        return null;
+    }
+
+    global.gc();
+    await flushGcEntries();
+
+    const gcCount = gc.count;
+    const before = v8.getHeapStatistics().used_heap_size;
+    convert(scenario, HEAP_SAMPLE_COUNT);
+    const after = v8.getHeapStatistics().used_heap_size;
+
+    await flushGcEntries();
+
+    // A collection during the sample makes the difference meaningless
+    return gc.count === gcCount ? perEvent(after - before, HEAP_SAMPLE_COUNT) : null;
+}
+
+async function conversion(scenario) {
+    // Warm up the JIT and the allocators
+    convert(scenario, Math.min(count, 10000));
+
+    const jsHeapBytesPerEvent = await jsHeapPerEvent(scenario);
+    const result = convert(scenario, count);
+    const total = result.appendTime + result.convertTime;
+
+    return {
+        events: result.events,
+        eventsPerSecond: Math.round((result.events * 1e9) / total),
+        appendNsPerEvent: perEvent(result.appendTime, result.events),
+        convertNsPerEvent: perEvent(result.convertTime, result.events),
+        appendAllocationsPerEvent: perEvent(result.appendAllocations, result.events),
+        convertAllocationsPerEvent: perEvent(result.convertAllocations, result.events),
+        nativeBytesPerEvent: perEvent(result.appendAllocatedBytes + result.convertAllocatedBytes, result.events),
+        jsHeapBytesPerEvent,
+    };
+}
+
+async function pipeline(scenario) {
+    const adapter = new addOn.Adapter();
+    const options = { count, eventInterval: 0, eventMaxDelay: 0, eventMaxBatchSize: BATCH_SIZE };
+
+    await flushGcEntries();
+    const gcCount = gc.count;
+    const gcDuration = gc.duration;
+
+    const start = process.hrtime();
+    let received = 0;
+    let produced;
+
+    await new Promise((resolve, reject) => {
+        const checkDone = () => {
+            if (received === count && produced) {
+                resolve();
+            }
+        };
+
+        addOn.bench.runPipeline(adapter, scenario, options, batch => {
+            received += batch.length;
+            checkDone();
+        }, (err, result) => {
+            if (err) {
+                reject(err);
+                return;
+            }
+
+            produced = result;
+            checkDone();
+        });
+    });
+
+    const [seconds, nanoseconds] = process.hrtime(start);
+    const duration = (seconds * 1e3) + (nanoseconds / 1e6);
+    const stats = adapter.getStats();
+    addOn.bench.release(adapter);
+
+    await flushGcEntries();
+
+    return {
+        events: count,
+        duration: Math.round(duration),
+        eventsPerSecond: Math.round((count * 1000) / duration),
+        batchAvgCount: stats.eventCallbackBatchAvgCount,
+        queueFullWaits: produced.queueFullWaits,
+        gc: {
+            count: gc.count - gcCount,
+            duration: Math.round(gc.duration - gcDuration),
+            share: Math.round(((gc.duration - gcDuration) / duration) * 1000) / 1000,
+        },
+    };
+}
+
+function regressions(results, previous) {
+    const found = [];
+    const limit = threshold / 100;
+
+    // Metric, and whether lower is better
+    const metrics = [
+        ['conversion', 'convertNsPerEvent', true],
+        ['conversion', 'appendNsPerEvent', true],
+        ['pipeline', 'eventsPerSecond', false],
+    ];
+
+    results.scenarios.forEach(scenario => {
+        const old = previous.scenarios.find(candidate => candidate.name === scenario.name);
+
+        if (!old) {
+            return;
+        }
+
+        metrics.forEach(([benchmark, metric, lowerIsBetter]) => {
+            const current = scenario[benchmark][metric];
+            const reference = old[benchmark][metric];
+            const change = reference > 0 ? (current - reference) / reference : 0;
+
+            if ((lowerIsBetter && change > limit) || (!lowerIsBetter && change < -limit)) {
+                found.push({ scenario: scenario.name, metric: `${benchmark}.${metric}`, baseline: reference, current });
+            }
+        });
+    });
+
+    return found;
+}
+
+async function run() {
+    const results = {
+        sdVersion,
+        node: process.version,
+        v8: process.versions.v8,
+        platform: `${process.platform}-${process.arch}`,
+        count,
+        batchSize: BATCH_SIZE,
+        scenarios: [],
+    };
+
+    for (const scenario of scenarios) {
+        results.scenarios.push({
+            name: scenario.name,
+            conversion: await conversion(scenario),
+            pipeline: await pipeline(scenario),
+        });
+    }
+
+    gcObserver.disconnect();
+
+    if (baseline) {
+        results.regressions = regressions(results, JSON.parse(fs.readFileSync(baseline, 'utf8')));
+    }
+
+    const json = `${JSON.stringify(results, null, 2)}\n`;
+
+    if (output) {
+        fs.writeFileSync(output, json);
+    } else {
+        process.stdout.write(json);
+    }
+
+    if (results.regressions && results.regressions.length > 0) {
+        process.stderr.write(`${results.regressions.length} regressions of more than ${threshold}% against ${baseline}\n`);
+        process.exit(1);
+    }
+}
+
+run().catch(err => {
+    process.stderr.write(`Benchmark failed: ${err.message}\n`);
+    process.exit(1);
+});
@@ -0,0 +1,215 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/*
+ * Benchmarks the native adapter and the JavaScript API on a simulated physical layer, no connectivity device
+ * needed. The adapter is opened with the `simulation` option of Adapter.open(), the AddOn, the H5 link layer and
+ * the serialization transport are the real ones and the events are generated by the connectivity emulator.
+ *
+ * Measures advertising report throughput through Adapter, notification throughput through the event callback of
+ * the AddOn, and the time to ready of a cold open compared to a warm restart. The results are written to stdout
+ * as JSON. Needs Linux and python3, see api/simulation/pseudoTerminal.js.
+ *
+ * Usage: node scripts/simulated-benchmark.js [--count <n>] [--latency <ms>]
+ */
+
+const Adapter = require('../api/adapter');
+const SimulatedLink = require('../api/simulation/simulatedLink');
+
+// The emulator sends events in the layout of SoftDevice API v5
+const bleDriver = require('bindings')('pc-ble-driver-js-sd_api_v5');
+
+function argument(name, defaultValue) {
+    const index = process.argv.indexOf(`--${name}`);
+    return index >= 0 ? Number(process.argv[index + 1]) : defaultValue;
+}
+
+const count = argument('count', 10000);
+const latency = argument('latency', 0);
+
+// The emulator answers every command with NRF_SUCCESS and no data, commands that return data report errors
+const errors = {};
+
+const openOptions = () => ({
+    logLevel: 'fatal',
+    simulation: { faults: { latency } },
+});
+
+function call(object, method) {
+    const args = Array.prototype.slice.call(arguments, 2);
+
+    return new Promise((resolve, reject) => {
+        object[method].apply(object, args.concat((err, result) => (err ? reject(err) : resolve(result))));
+    });
+}
+
+function createAdapter(instanceId) {
+    const adapter = new Adapter(bleDriver, new bleDriver.Adapter(), instanceId, 'simulated');
+    adapter.on('error', err => {
+        const message = err.message || String(err);
+        errors[message] = (errors[message] || 0) + 1;
+    });
+    return adapter;
+}
+
+function rate(events, milliseconds) {
+    return milliseconds > 0 ? Math.round((events * 1000) / milliseconds) : 0;
+}
+
+async function advertisingReports() {
+    const scanner = createAdapter('scanner');
+    await call(scanner, 'open', openOptions());
+    await call(scanner, 'startScan', { active: false, interval: 100, window: 100, timeout: 0 });
+
+    let received = 0;
+    const start = Date.now();
+    const done = new Promise(resolve => {
+        scanner.on('deviceDiscovered', () => {
+            received += 1;
+            if (received === count) resolve();
+        });
+    });
+
+    scanner.simulatedLink.floodAdvertisements({ count, dataLength: 31, devices: 16 });
+    await done;
+    const duration = Date.now() - start;
+    const stats = scanner.getStats();
+    const link = scanner.simulatedLink.stats;
+
+    await call(scanner, 'close');
+
+    return {
+        reports: count,
+        duration,
+        reportsPerSecond: rate(count, duration),
+        eventCallbackBatchAvgCount: stats.eventCallbackBatchAvgCount,
+        retransmissions: link.emulator.retransmissions,
+    };
+}
+
+// The JavaScript Adapter drops notifications without a discovered characteristic, count them in the AddOn callback
+async function notifications() {
+    const length = 244;
+    const link = await new Promise((resolve, reject) => {
+        SimulatedLink.open({ baudRate: 1000000, faults: { latency } },
+            (err, simulatedLink) => (err ? reject(err) : resolve(simulatedLink)));
+    });
+    const adapter = new bleDriver.Adapter();
+
+    let received = 0;
+    let onReceived = () => {};
+
+    try {
+        await call(adapter, 'open', link.path, {
+            baudRate: 1000000,
+            parity: 'none',
+            flowControl: 'none',
+            eventInterval: 0,
+            eventMaxDelay: 0,
+            eventMaxBatchSize: 32,
+            logLevel: 'fatal',
+            retransmissionInterval: 250,
+            responseTimeout: 1500,
+            enableBLE: false,
+            logCallback: () => {},
+            statusCallback: () => {},
+            eventCallback: events => {
+                received += events.filter(event => event.id === bleDriver.BLE_GATTC_EVT_HVX).length;
+                onReceived();
+            },
+        });
+
+        const start = Date.now();
+        const done = new Promise(resolve => {
+            onReceived = () => {
+                if (received >= count) resolve();
+            };
+        });
+
+        link.streamNotifications({ handle: 0x0010, count, length });
+        await done;
+        const duration = Date.now() - start;
+
+        await call(adapter, 'close');
+
+        return {
+            notifications: count,
+            length,
+            duration,
+            notificationsPerSecond: rate(count, duration),
+            bytesPerSecond: rate(count * length, duration),
+            retransmissions: link.stats.emulator.retransmissions,
+        };
+    } finally {
+        link.close();
+    }
+}
+
+async function timeToReady() {
+    const adapter = createAdapter('restart');
+
+    const start = Date.now();
+    await call(adapter, 'open', openOptions());
+    const cold = Date.now() - start;
+
+    const warm = await call(adapter, 'warmRestart');
+
+    // Let the state refresh started by warmRestart complete before closing
+    await new Promise(resolve => adapter.getState(() => resolve()));
+    await call(adapter, 'close');
+
+    return { cold, warm: warm.total, warmSteps: warm };
+}
+
+async function run() {
+    const results = {
+        count,
+        latency,
+        advertising: await advertisingReports(),
+        notifications: await notifications(),
+        timeToReady: await timeToReady(),
+        errors,
+    };
+
+    process.stdout.write(`${JSON.stringify(results, null, 2)}\n`);
+}
+
+run().catch(err => {
+    process.stderr.write(`Benchmark failed: ${err.message}\n`);
+    process.exit(1);
+});
@@ -0,0 +1,288 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+/*
+ * Benchmarks the serial transport of the native adapter against a connectivity firmware emulator on a Linux
+ * pseudo-terminal, no connectivity device needed.
+ *
+ * Sweeps the transport options of Adapter.open() one at a time, with the others at their defaults, under each
+ * fault profile. For each point it measures the time to open (H5 link establishment and enabling BLE), the round
+ * trip latency of a command without parameters and the throughput of write commands. The results are written to
+ * stdout as JSON, one curve per option.
+ *
+ * Usage: node scripts/transport-benchmark.js [--sd v2|v5] [--count <n>] [--payload <bytes>]
+ *                                            [--profiles <name,...>] [--sweep <option,...>]
+ */
+
+const Adapter = require('../api/adapter');
+const ConnectivityEmulator = require('../api/simulation/connectivityEmulator');
+const FaultyWire = require('../api/simulation/faultyWire');
+const PseudoTerminal = require('../api/simulation/pseudoTerminal');
+
+function argument(name, defaultValue) {
+    const index = process.argv.indexOf(`--${name}`);
+    return index >= 0 ? process.argv[index + 1] : defaultValue;
+}
+
+const sdVersion = argument('sd', 'v5');
+const count = Number(argument('count', 200));
+const payloadLength = Number(argument('payload', 20));
+
+const bleDriver = require('bindings')(`pc-ble-driver-js-sd_api_${sdVersion}`);
+
+// Faults of the wire in both directions, see FaultyWire
+const profiles = {
+    clean: {},
+    latency: { latency: 5, jitter: 5 },
+    lossy: { loss: 0.0005 },
+    noisy: { corruption: 0.0005 },
+    stalling: { stallInterval: 1000, stallDuration: 100 },
+};
+
+// Values of each swept option
+const sweeps = {
+    baudRate: [115200, 230400, 460800, 921600, 1000000],
+    retransmissionInterval: [25, 50, 100, 250, 500],
+    responseTimeout: [250, 500, 1000, 1500, 3000],
+    flowControl: ['none', 'hw'],
+};
+
+// The defaults of Adapter.open()
+const defaults = {
+    baudRate: 1000000,
+    parity: 'none',
+    flowControl: 'none',
+    eventInterval: 0,
+    eventMaxDelay: 0,
+    eventMaxBatchSize: 32,
+    logLevel: 'fatal',
+    retransmissionInterval: 250,
+    responseTimeout: 1500,
+    enableBLE: true,
+};
+
+const selectedProfiles = argument('profiles', Object.keys(profiles).join(',')).split(',');
+const selectedSweeps = argument('sweep', Object.keys(sweeps).join(',')).split(',');
+
+function call(object, method) {
+    const args = Array.prototype.slice.call(arguments, 2);
+
+    return new Promise((resolve, reject) => {
+        object[method].apply(object, args.concat((err, result) => (err ? reject(err) : resolve(result))));
+    });
+}
+
+function percentile(sorted, fraction) {
+    if (sorted.length === 0) {
+        return null;
+    }
+
+    return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * fraction))];
+}
+
+function summarize(durations) {
+    const sorted = durations.slice().sort((a, b) => a - b);
+
+    return {
+        min: percentile(sorted, 0),
+        p50: percentile(sorted, 0.5),
+        p90: percentile(sorted, 0.9),
+        p99: percentile(sorted, 0.99),
+        max: percentile(sorted, 1),
+    };
+}
+
+function elapsed(start) {
+    const [seconds, nanoseconds] = process.hrtime(start);
+    return (seconds * 1e3) + (nanoseconds / 1e6);
+}
+
+// Connects the pseudo-terminal to the emulator through a faulty wire in each direction
+function connect(terminal, options, faults) {
+    const wireOptions = Object.assign({
+        baudRate: options.baudRate,
+        bitsPerByte: options.parity === 'none' ? 10 : 11,
+    }, faults);
+
+    const toDevice = new FaultyWire(Object.assign({}, wireOptions, { seed: 1 }));
+    const toHost = new FaultyWire(Object.assign({}, wireOptions, { seed: 2 }));
+    const emulator = new ConnectivityEmulator();
+
+    terminal.on('data', data => toDevice.write(data));
+    toDevice.on('data', data => emulator.write(data));
+    emulator.on('data', data => toHost.write(data));
+    toHost.on('data', data => terminal.write(data));
+
+    return {
+        emulator,
+        toDevice,
+        toHost,
+        close: () => {
+            emulator.close();
+            toDevice.close();
+            toHost.close();
+            terminal.removeAllListeners('data');
+        },
+    };
+}
+
+async function commands(adapter, method, args) {
+    const durations = [];
+    let failures = 0;
+
+    const start = process.hrtime();
+
+    for (let i = 0; i < count; i++) {
+        const commandStart = process.hrtime();
+
+        try {
+            await call.apply(null, [adapter, method].concat(args));
+            durations.push(elapsed(commandStart));
+        } catch (err) {
+            failures += 1;
+        }
+    }
+
+    return { duration: elapsed(start), durations, failures };
+}
+
+async function measure(terminal, options, faults) {
+    const link = connect(terminal, options, faults);
+    const adapter = new bleDriver.Adapter();
+    const statuses = {};
+
+    const openOptions = Object.assign({}, options, {
+        logCallback: () => {},
+        eventCallback: () => {},
+        statusCallback: status => {
+            statuses[status.name] = (statuses[status.name] || 0) + 1;
+        },
+        enableBLEParams: Adapter.prototype._getDefaultEnableBLEParams.call({ _bleDriver: bleDriver }),
+    });
+
+    const result = { statuses };
+
+    try {
+        const openStart = process.hrtime();
+        await call(adapter, 'open', terminal.path, openOptions);
+        result.open = elapsed(openStart);
+
+        // sd_ble_gap_adv_stop has no parameters, its round trip is the transport overhead
+        const latency = await commands(adapter, 'gapStopAdvertising', []);
+        result.latency = Object.assign(summarize(latency.durations), { failures: latency.failures });
+
+        const writeParams = {
+            write_op: bleDriver.BLE_GATT_OP_WRITE_CMD,
+            flags: 0,
+            handle: 0x0010,
+            offset: 0,
+            len: payloadLength,
+            value: new Array(payloadLength).fill(0xAA),
+        };
+        const writes = await commands(adapter, 'gattcWrite', [0, writeParams]);
+        const succeeded = count - writes.failures;
+
+        result.throughput = {
+            commandsPerSecond: Math.round((succeeded * 1000) / writes.duration),
+            bytesPerSecond: Math.round((succeeded * payloadLength * 1000) / writes.duration),
+            failures: writes.failures,
+        };
+
+        await call(adapter, 'close');
+    } catch (err) {
+        result.error = err.message;
+    }
+
+    result.emulator = link.emulator.stats;
+    result.wire = { toDevice: link.toDevice.stats, toHost: link.toHost.stats };
+    link.close();
+
+    return result;
+}
+
+async function run() {
+    const terminal = await new Promise((resolve, reject) => {
+        PseudoTerminal.open((err, pty) => (err ? reject(err) : resolve(pty)));
+    });
+
+    const results = {
+        sdVersion,
+        count,
+        payloadLength,
+        defaults,
+        profiles: {},
+        curves: {},
+    };
+
+    try {
+        for (const profile of selectedProfiles) {
+            if (!profiles[profile]) {
+                throw new Error(`Unknown fault profile ${profile}, available: ${Object.keys(profiles).join(', ')}`);
+            }
+
+            results.profiles[profile] = profiles[profile];
+        }
+
+        for (const option of selectedSweeps) {
+            if (!sweeps[option]) {
+                throw new Error(`Unknown option ${option}, available: ${Object.keys(sweeps).join(', ')}`);
+            }
+
+            results.curves[option] = [];
+
+            for (const profile of selectedProfiles) {
+                for (const value of sweeps[option]) {
+                    const options = Object.assign({}, defaults, { [option]: value });
+                    const point = await measure(terminal, options, profiles[profile]);
+
+                    results.curves[option].push(Object.assign({ value, profile }, point));
+                    process.stderr.write(`${option}=${value} ${profile}: ${point.error || 'done'}\n`);
+                }
+            }
+        }
+    } finally {
+        terminal.close();
+    }
+
+    process.stdout.write(`${JSON.stringify(results, null, 2)}\n`);
+}
+
+run().catch(err => {
+    process.stderr.write(`Benchmark failed: ${err.message}\n`);
+    process.exit(1);
+});
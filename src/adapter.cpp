@@ -37,12 +37,12 @@
 #include "adapter.h"
 #include "common.h"
 
-#include <algorithm>
 #include <iostream>
 
 Nan::Persistent<v8::Function> Adapter::constructor;
 
-std::vector<Adapter *> adapters;
+// Driver adapters of all open AddOn adapters, looked up in the driver threads for each callback
+AdapterRegistry adapters;
 
 NAN_MODULE_INIT(Adapter::Init)
 {
@@ -59,27 +59,24 @@ NAN_MODULE_INIT(Adapter::Init)
     Nan::Set(target, Nan::New("Adapter").ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
 }
 
-Adapter *Adapter::getAdapter(adapter_t *adapter, Adapter *defaultAdapter)
+Adapter *Adapter::getAdapter(adapter_t *adapter)
 {
     if (adapter == nullptr)
     {
-        return defaultAdapter;
+        return nullptr;
     }
 
-    for (auto value : adapters)
-    {
-        auto deviceAdapter = value->getInternalAdapter();
+    return adapters.find(adapter->internal);
+}
 
-        if (deviceAdapter != nullptr)
-        {
-            if (value->getInternalAdapter()->internal == adapter->internal)
-            {
-                return value;
-            }
-        }
-    }
+bool Adapter::registerAdapter(adapter_t *adapter, Adapter *jsAdapter)
+{
+    return adapters.add(adapter->internal, jsAdapter);
+}
 
-    return defaultAdapter;
+void Adapter::unregisterAdapter(adapter_t *adapter)
+{
+    adapters.remove(adapter->internal);
 }
 
 adapter_t *Adapter::getInternalAdapter() const
@@ -132,9 +129,21 @@ namespace {
     }
 }
 
-void Adapter::initEventHandling(std::unique_ptr<Nan::Callback> callback, uint32_t interval)
+void Adapter::initEventHandling(std::unique_ptr<Nan::Callback> callback, uint32_t interval, uint32_t maxDelay, uint32_t maxBatchSize)
 {
     eventInterval = interval;
+    eventMaxDelay = maxDelay;
+    eventCoalescing = false;
+
+    // Leave room in the event queue for events arriving while a full batch is sent to JavaScript
+    if (maxBatchSize == 0 || maxBatchSize > EVENT_QUEUE_SIZE / 2)
+    {
+        eventMaxBatchSize = EVENT_QUEUE_SIZE / 2;
+    }
+    else
+    {
+        eventMaxBatchSize = maxBatchSize;
+    }
     asyncEvent = std::make_unique<uv_async_t>();
 
     // Setup event related functionality
@@ -156,7 +165,7 @@ void Adapter::initEventHandling(std::unique_ptr<Nan::Callback> callback, uint32_
     eventCallbackBatchEventTotalCount = 0;
     eventCallbackBatchNumber = 0;
 
-    if (eventInterval == 0)
+    if (eventInterval == 0 && eventMaxDelay == 0)
     {
         return;
     }
@@ -175,6 +184,12 @@ void Adapter::initEventHandling(std::unique_ptr<Nan::Callback> callback, uint32_
         std::terminate();
     }
 
+    // In adaptive mode the timer is started by Adapter::updateEventDispatchMode when JavaScript falls behind
+    if (eventInterval == 0)
+    {
+        return;
+    }
+
     if (uv_timer_start(eventIntervalTimer.get(), event_interval_handler, eventInterval, eventInterval) != 0)
     {
         std::cerr << "Not able to create a new event interval handler." << std::endl;
@@ -268,6 +283,71 @@ void Adapter::initStatusHandling(std::unique_ptr<Nan::Callback> callback)
     }
 }
 
+// This compilation unit will be linked several times. So
+// gattc_procedure_handler must not have external linkage.
+namespace {
+    std::remove_pointer<uv_async_cb>::type gattc_procedure_handler;
+    void gattc_procedure_handler(uv_async_t *handle)
+    {
+        auto adapter = static_cast<Adapter *>(handle->data);
+
+        if (adapter != nullptr)
+        {
+            adapter->onGattcProcedureEvent(handle);
+        }
+        else
+        {
+            std::cerr << "No AddOn adapter to process GATT procedure event." << std::endl;
+            std::terminate();
+        }
+    }
+}
+
+void Adapter::initGattcProcedureHandling()
+{
+    asyncGattcProcedure = std::make_unique<uv_async_t>();
+    asyncGattcProcedure->data = static_cast<void *>(this);
+
+    if (uv_async_init(uv_default_loop(), asyncGattcProcedure.get(), gattc_procedure_handler) != 0)
+    {
+        std::cerr << "Not able to create a new GATT procedure handler." << std::endl;
+        std::terminate();
+    }
+}
+
+#if NRF_SD_BLE_API_VERSION >= 5
+// gatts_hvn_tx_handler must not have external linkage.
+namespace {
+    std::remove_pointer<uv_async_cb>::type gatts_hvn_tx_handler;
+    void gatts_hvn_tx_handler(uv_async_t *handle)
+    {
+        auto adapter = static_cast<Adapter *>(handle->data);
+
+        if (adapter != nullptr)
+        {
+            adapter->onGattsHvnTxEvent(handle);
+        }
+        else
+        {
+            std::cerr << "No AddOn adapter to process notification TX event." << std::endl;
+            std::terminate();
+        }
+    }
+}
+
+void Adapter::initGattsHvnTxHandling()
+{
+    asyncGattsHvnTx = std::make_unique<uv_async_t>();
+    asyncGattsHvnTx->data = static_cast<void *>(this);
+
+    if (uv_async_init(uv_default_loop(), asyncGattsHvnTx.get(), gatts_hvn_tx_handler) != 0)
+    {
+        std::cerr << "Not able to create a new notification TX handler." << std::endl;
+        std::terminate();
+    }
+}
+#endif
+
 // Helper function for cleanUpV8Resources for closing uv_*_t
 // handles. It is also suitable as a Deleter (template argment
 // of unique_ptr).
@@ -291,8 +371,30 @@ namespace {
     }
 }
 
+void Adapter::resetSessionState()
+{
+    // No responses will arrive for GATT client procedures still running, report them as failed
+    if (asyncGattcProcedure != nullptr)
+    {
+        abortGattcProcedures();
+    }
+
+    // The attribute table is gone with the connection to the SoftDevice
+    clearGattsCccds();
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    // Queued notifications will never be sent, report them as failed
+    if (asyncGattsHvnTx != nullptr)
+    {
+        abortGattsHvnTx();
+    }
+#endif
+}
+
 void Adapter::cleanUpV8Resources()
 {
+    resetSessionState();
+
     uv_mutex_lock(&adapterCloseMutex);
 
     if (asyncStatus != nullptr)
@@ -319,6 +421,18 @@ void Adapter::cleanUpV8Resources()
         this->logCallback.reset();
     }
 
+    if (asyncGattcProcedure != nullptr)
+    {
+        close_uv_handle(std::move(asyncGattcProcedure));
+    }
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    if (asyncGattsHvnTx != nullptr)
+    {
+        close_uv_handle(std::move(asyncGattsHvnTx));
+    }
+#endif
+
     uv_mutex_unlock(&adapterCloseMutex);
 }
 
@@ -327,6 +441,7 @@ void Adapter::initGeneric(v8::Local<v8::FunctionTemplate> tpl)
     Nan::SetPrototypeMethod(tpl, "open", Open);
     Nan::SetPrototypeMethod(tpl, "close", Close);
     Nan::SetPrototypeMethod(tpl, "connReset", ConnReset);
+    Nan::SetPrototypeMethod(tpl, "reopen", Reopen);
     Nan::SetPrototypeMethod(tpl, "getVersion", GetVersion);
     Nan::SetPrototypeMethod(tpl, "enableBLE", EnableBLE);
     Nan::SetPrototypeMethod(tpl, "addVendorspecificUUID", AddVendorSpecificUUID);
@@ -337,6 +452,8 @@ void Adapter::initGeneric(v8::Local<v8::FunctionTemplate> tpl)
     Nan::SetPrototypeMethod(tpl, "getBleOption", GetBleOption);
 
     Nan::SetPrototypeMethod(tpl, "getStats", GetStats);
+    Nan::SetPrototypeMethod(tpl, "resetStats", ResetStats);
+    Nan::SetPrototypeMethod(tpl, "setEventMask", SetEventMask);
 
 #if NRF_SD_BLE_API_VERSION >= 5
     Nan::SetPrototypeMethod(tpl, "setBleConfig", SetBleConfig);
@@ -394,7 +511,11 @@ void Adapter::initGattC(v8::Local<v8::FunctionTemplate> tpl)
     Nan::SetPrototypeMethod(tpl, "gattcReadCharacteristicValues", GattcReadCharacteristicValues);
     Nan::SetPrototypeMethod(tpl, "gattcWrite", GattcWrite);
     Nan::SetPrototypeMethod(tpl, "gattcConfirmHandleValue", GattcConfirmHandleValue);
+    Nan::SetPrototypeMethod(tpl, "gattcDiscoverAll", GattcDiscoverAll);
+    Nan::SetPrototypeMethod(tpl, "gattcReadLong", GattcReadLong);
+    Nan::SetPrototypeMethod(tpl, "gattcWriteLong", GattcWriteLong);
 #if NRF_SD_BLE_API_VERSION >= 5
+    Nan::SetPrototypeMethod(tpl, "gattcWriteStream", GattcWriteStream);
     Nan::SetPrototypeMethod(tpl, "gattcExchangeMtuRequest", GattcExchangeMtuRequest);
 #endif
 }
@@ -405,7 +526,9 @@ void Adapter::initGattS(v8::Local<v8::FunctionTemplate> tpl)
     Nan::SetPrototypeMethod(tpl, "gattsAddCharacteristic", GattsAddCharacteristic);
     Nan::SetPrototypeMethod(tpl, "gattsAddDescriptor", GattsAddDescriptor);
     Nan::SetPrototypeMethod(tpl, "gattsHVX", GattsHVX);
+    Nan::SetPrototypeMethod(tpl, "gattsNotifyAll", GattsNotifyAll);
     Nan::SetPrototypeMethod(tpl, "gattsSystemAttributeSet", GattsSystemAttributeSet);
+    Nan::SetPrototypeMethod(tpl, "gattsGetCccdValues", GattsGetCccdValues);
     Nan::SetPrototypeMethod(tpl, "gattsSetValue", GattsSetValue);
     Nan::SetPrototypeMethod(tpl, "gattsGetValue", GattsGetValue);
     Nan::SetPrototypeMethod(tpl, "gattsReplyReadWriteAuthorize", GattsReplyReadWriteAuthorize);
@@ -418,29 +541,75 @@ Adapter::Adapter()
 {
     adapter = nullptr;
 
+    eventCallbackDuration = std::chrono::milliseconds::zero();
+    eventCallbackCount = 0;
     eventCallbackMaxCount = 0;
     eventCallbackBatchEventCounter = 0;
     eventCallbackBatchEventTotalCount = 0;
     eventCallbackBatchNumber = 0;
 
+    for (auto i = 0; i < EVENT_ID_COUNT; i++)
+    {
+        eventMask[i] = false;
+        maskedEventCount[i] = 0;
+    }
+
+    eventInterval = 0;
+    eventMaxDelay = 0;
+    eventMaxBatchSize = EVENT_QUEUE_SIZE / 2;
+    eventCoalescing = false;
+    eventSession = 0;
+
+    eventMaskAutoReply = true;
+#if NRF_SD_BLE_API_VERSION >= 5
+    eventMaskAttMtu = BLE_GATT_ATT_MTU_DEFAULT;
+#endif
+
     if (uv_mutex_init(&adapterCloseMutex) != 0)
     {
         std::cerr << "Not able to create adapterCloseMutex! Terminating." << std::endl;
         std::terminate();
     }
 
-    adapters.push_back(this);
+    gattcProcedureCount = 0;
+
+    if (uv_mutex_init(&gattcProcedureMutex) != 0)
+    {
+        std::cerr << "Not able to create gattcProcedureMutex! Terminating." << std::endl;
+        std::terminate();
+    }
+
+    if (uv_mutex_init(&gattsCccdMutex) != 0)
+    {
+        std::cerr << "Not able to create gattsCccdMutex! Terminating." << std::endl;
+        std::terminate();
+    }
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    gattsHvnTxQueueSize = BLE_GATTS_HVN_TX_QUEUE_SIZE_DEFAULT;
+
+    if (uv_mutex_init(&gattsHvnTxMutex) != 0)
+    {
+        std::cerr << "Not able to create gattsHvnTxMutex! Terminating." << std::endl;
+        std::terminate();
+    }
+#endif
 }
 
 Adapter::~Adapter()
 {
-    // Remove this adapter from the global container of adapters
-    adapters.erase(std::find(adapters.begin(), adapters.end(), this));
+    // Remove this adapter from the global registry of adapters
+    adapters.remove(this);
 
     // Remove callbacks and cleanup uv_handle_t instances
     cleanUpV8Resources();
 
     uv_mutex_destroy(&adapterCloseMutex);
+    uv_mutex_destroy(&gattcProcedureMutex);
+    uv_mutex_destroy(&gattsCccdMutex);
+#if NRF_SD_BLE_API_VERSION >= 5
+    uv_mutex_destroy(&gattsHvnTxMutex);
+#endif
 }
 
 NAN_METHOD(Adapter::New)
@@ -463,6 +632,11 @@ int32_t Adapter::getEventCallbackTotalTime() const
     return static_cast<int32_t>(eventCallbackDuration.count());
 }
 
+bool Adapter::isEventQueueFull() const
+{
+    return eventQueue.wasFull();
+}
+
 uint32_t Adapter::getEventCallbackCount() const
 {
     return eventCallbackCount;
@@ -489,12 +663,22 @@ double Adapter::getAverageCallbackBatchCount() const
 
     if (getEventCallbackBatchNumber() != 0)
     {
-        averageCallbackBatchCount = getEventCallbackBatchEventTotalCount() / getEventCallbackBatchNumber();
+        averageCallbackBatchCount = static_cast<double>(getEventCallbackBatchEventTotalCount()) / getEventCallbackBatchNumber();
     }
 
     return averageCallbackBatchCount;
 }
 
+bool Adapter::isEventMasked(const uint16_t evt_id) const
+{
+    return evt_id < EVENT_ID_COUNT && eventMask[evt_id];
+}
+
+uint32_t Adapter::getMaskedEventCount(const uint16_t evt_id) const
+{
+    return evt_id < EVENT_ID_COUNT ? maskedEventCount[evt_id].load() : 0;
+}
+
 void Adapter::addEventBatchStatistics(std::chrono::milliseconds duration)
 {
     eventCallbackDuration += duration;
@@ -504,6 +688,77 @@ void Adapter::addEventBatchStatistics(std::chrono::milliseconds duration)
     eventCallbackBatchNumber += 1;
 }
 
+void Adapter::resetStatistics()
+{
+    eventCallbackDuration = std::chrono::milliseconds::zero();
+    eventCallbackCount = 0;
+    eventCallbackMaxCount = 0;
+    eventCallbackBatchEventTotalCount = 0;
+    eventCallbackBatchNumber = 0;
+
+    for (auto i = 0; i < EVENT_ID_COUNT; i++)
+    {
+        maskedEventCount[i] = 0;
+    }
+
+    // Reset in place, onRpcEvent may hold pointers to the histograms while the JavaScript event callback runs
+    for (auto &entry : eventLatencies)
+    {
+        entry.second->reset();
+    }
+}
+
+EventLatency *Adapter::getEventLatency(const uint16_t evt_id)
+{
+    auto &latency = eventLatencies[evt_id];
+
+    if (latency == nullptr)
+    {
+        latency = std::make_unique<EventLatency>();
+    }
+
+    return latency.get();
+}
+
+const std::map<uint16_t, std::unique_ptr<EventLatency>> &Adapter::getEventLatencies() const
+{
+    return eventLatencies;
+}
+
+void Adapter::updateEventDispatchMode(const uint32_t batchEventCount, std::chrono::milliseconds duration)
+{
+    if (eventInterval != 0 || eventMaxDelay == 0 || eventIntervalTimer == nullptr)
+    {
+        return;
+    }
+
+    // More than one event in the batch means events queued up while JavaScript handled the previous batch.
+    // A callback using the whole delay budget means JavaScript will not keep up with one wakeup per event.
+    const auto underLoad = batchEventCount > 1 || duration.count() >= eventMaxDelay;
+
+    if (underLoad)
+    {
+        eventCoalescing = true;
+
+        if (uv_timer_start(eventIntervalTimer.get(), event_interval_handler, eventMaxDelay, 0) != 0)
+        {
+            std::cerr << "Not able to start the event coalescing timer." << std::endl;
+            std::terminate();
+        }
+    }
+    else
+    {
+        eventCoalescing = false;
+        uv_timer_stop(eventIntervalTimer.get());
+
+        // The transport thread may have queued an event while coalescing was still on, without dispatching it
+        if (!eventQueue.wasEmpty())
+        {
+            dispatchEvents();
+        }
+    }
+}
+
 void Adapter::createSecurityKeyStorage(const uint16_t connHandle, ble_gap_sec_keyset_t *keyset)
 {
     ble_gap_sec_keyset_t *set = new ble_gap_sec_keyset_t();
@@ -38,18 +38,32 @@
 #define ADAPTER_H
 
 #include <nan.h>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "sd_rpc.h"
 
+#include "adapter_registry.h"
 #include "circular_fifo_unsafe.h"
+#include "latency_histogram.h"
+#include "gattc_discovery.h"
+#include "gattc_read_long.h"
+#include "gattc_write_long.h"
+#include "gattc_write_stream.h"
+#include "gatts_hvn_tx_queue.h"
 
 const auto EVENT_QUEUE_SIZE = 64;
 const auto LOG_QUEUE_SIZE = 64;
 const auto STATUS_QUEUE_SIZE = 64;
 
+// All SoftDevice event IDs (BLE_EVT_BASE up to BLE_L2CAP_EVT_LAST) are below this value
+const auto EVENT_ID_COUNT = 256;
+
 #define ADAPTER_METHOD_DEFINITIONS(MainName) \
     static NAN_METHOD(MainName); \
     static void MainName(uv_work_t *req); \
@@ -59,17 +73,7 @@ struct enable_ble_params_t {
 #if NRF_SD_BLE_API_VERSION < 5
     ble_enable_params_t ble_enable_params; // If enable BLE is true, then use these params when enabling BLE
 #else
-    ~enable_ble_params_t() {
-        if (gap_conn_cfg) delete gap_conn_cfg;
-        if (gatt_conn_cfg) delete gatt_conn_cfg;
-        if (gatts_conn_cfg) delete gatts_conn_cfg;
-        if (gattc_conn_cfg) delete gattc_conn_cfg;
-        if (l2cap_conn_cfg) delete l2cap_conn_cfg;
-        if (common_cfg) delete common_cfg;
-        if (gap_cfg) delete gap_cfg;
-        if (gatts_cfg_service_changed) delete gatts_cfg_service_changed;
-        if (gatts_cfg_attr_tab_size) delete gatts_cfg_attr_tab_size;
-    }
+    // The configurations are not owned, EnableParameters allocates them from the Baton arena
     ble_cfg_t *gap_conn_cfg;     /**< BLE GAP specific connection configuration. */
     ble_cfg_t *gatt_conn_cfg;    /**< BLE GATT specific connection configuration. */
     ble_cfg_t *gatts_conn_cfg;   /**< BLE GATTS specific connection configuration. */
@@ -95,6 +99,33 @@ public:
     ble_evt_t *event;
     std::string timestamp;
     int adapterID;
+
+    std::chrono::steady_clock::time_point received; // When the SoftDevice event callback was invoked
+    std::chrono::steady_clock::time_point queued;   // When the event was pushed to the event queue
+    uint32_t session;                               // Adapter::eventSession when the event was received
+};
+
+// Latency of each step an event goes through before it has been handled by JavaScript
+struct EventLatency
+{
+public:
+    LatencyHistogram queuePush;      // SoftDevice event callback -> pushed to event queue
+    LatencyHistogram queueResidence; // Pushed to event queue -> popped in the NodeJS thread
+    LatencyHistogram conversion;     // Conversion from native event to JavaScript object
+    LatencyHistogram callback;       // JavaScript event callback for the batch the event was part of
+
+    void reset()
+    {
+        queuePush.reset();
+        queueResidence.reset();
+        conversion.reset();
+        callback.reset();
+    }
+
+    bool isEmpty() const
+    {
+        return queuePush.getCount() == 0 && queueResidence.getCount() == 0 && conversion.getCount() == 0 && callback.getCount() == 0;
+    }
 };
 
 struct StatusEntry
@@ -117,12 +148,17 @@ class Adapter : public Nan::ObjectWrap
 public:
     static NAN_MODULE_INIT(Init);
 
-    static Adapter *getAdapter(adapter_t *adapter, Adapter *defaultAdapter = nullptr);
+    static Adapter *getAdapter(adapter_t *adapter);
+    static bool registerAdapter(adapter_t *adapter, Adapter *jsAdapter);
+    static void unregisterAdapter(adapter_t *adapter);
 
     adapter_t *getInternalAdapter() const;
 
-    void initEventHandling(std::unique_ptr<Nan::Callback> callback, const uint32_t interval);
-    void appendEvent(ble_evt_t *event);
+    void initEventHandling(std::unique_ptr<Nan::Callback> callback, const uint32_t interval, const uint32_t maxDelay, const uint32_t maxBatchSize);
+    void appendEvent(ble_evt_t *event, const std::chrono::steady_clock::time_point received);
+
+    // Snapshot, used by the event benchmark to append synthetic events without overrunning the queue
+    bool isEventQueueFull() const;
 
     void onRpcEvent(uv_async_t *handle);
     void eventIntervalCallback(uv_timer_t *handle);
@@ -137,6 +173,16 @@ public:
 
     void onStatusEvent(uv_async_t *handle);
 
+    void initGattcProcedureHandling();
+    void onGattcProcedureEvent(uv_async_t *handle);
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    void initGattsHvnTxHandling();
+    void onGattsHvnTxEvent(uv_async_t *handle);
+#endif
+
+    // Fail or drop per connection state of the current SoftDevice session, used when the session ends
+    void resetSessionState();
     void cleanUpV8Resources();
 
     // Statistics:
@@ -149,6 +195,15 @@ public:
     double getAverageCallbackBatchCount() const;
 
     void addEventBatchStatistics(std::chrono::milliseconds duration);
+    void updateEventDispatchMode(const uint32_t batchEventCount, std::chrono::milliseconds duration);
+    void resetStatistics();
+
+    EventLatency *getEventLatency(const uint16_t evt_id);
+    const std::map<uint16_t, std::unique_ptr<EventLatency>> &getEventLatencies() const;
+
+    // Event mask:
+    bool isEventMasked(const uint16_t evt_id) const;
+    uint32_t getMaskedEventCount(const uint16_t evt_id) const;
 
 private:
     explicit Adapter();
@@ -162,6 +217,7 @@ private:
     ADAPTER_METHOD_DEFINITIONS(Open);
     ADAPTER_METHOD_DEFINITIONS(Close);
     ADAPTER_METHOD_DEFINITIONS(ConnReset);
+    ADAPTER_METHOD_DEFINITIONS(Reopen);
     ADAPTER_METHOD_DEFINITIONS(EnableBLE);
     ADAPTER_METHOD_DEFINITIONS(GetVersion);
     ADAPTER_METHOD_DEFINITIONS(AddVendorSpecificUUID);
@@ -177,6 +233,11 @@ private:
 
     // General sync methods
     static NAN_METHOD(GetStats);
+    static NAN_METHOD(ResetStats);
+    static NAN_METHOD(SetEventMask);
+
+    // Gatts sync methods
+    static NAN_METHOD(GattsGetCccdValues);
 
     // Gap async mehtods
     ADAPTER_METHOD_DEFINITIONS(GapSetAddress);
@@ -227,7 +288,11 @@ private:
     ADAPTER_METHOD_DEFINITIONS(GattcReadCharacteristicValues);
     ADAPTER_METHOD_DEFINITIONS(GattcWrite);
     ADAPTER_METHOD_DEFINITIONS(GattcConfirmHandleValue);
+    ADAPTER_METHOD_DEFINITIONS(GattcDiscoverAll);
+    ADAPTER_METHOD_DEFINITIONS(GattcReadLong);
+    ADAPTER_METHOD_DEFINITIONS(GattcWriteLong);
 #if NRF_SD_BLE_API_VERSION >= 5
+    ADAPTER_METHOD_DEFINITIONS(GattcWriteStream);
     ADAPTER_METHOD_DEFINITIONS(GattcExchangeMtuRequest);
 #endif
 
@@ -236,6 +301,7 @@ private:
     ADAPTER_METHOD_DEFINITIONS(GattsAddCharacteristic);
     ADAPTER_METHOD_DEFINITIONS(GattsAddDescriptor);
     ADAPTER_METHOD_DEFINITIONS(GattsHVX);
+    ADAPTER_METHOD_DEFINITIONS(GattsNotifyAll);
     ADAPTER_METHOD_DEFINITIONS(GattsSystemAttributeSet);
     ADAPTER_METHOD_DEFINITIONS(GattsSetValue);
     ADAPTER_METHOD_DEFINITIONS(GattsGetValue);
@@ -250,6 +316,30 @@ private:
     static void initGattS(v8::Local<v8::FunctionTemplate> tpl);
 
     void dispatchEvents();
+    void replyMaskedEvent(ble_evt_t *event);
+
+    bool addGattcProcedure(std::shared_ptr<GattcProcedure> procedure);
+    void removeGattcProcedure(const std::shared_ptr<GattcProcedure> &procedure);
+    uint32_t startGattcProcedure(GattcProcedure *procedure);
+    bool handleGattcProcedureEvent(ble_evt_t *event);
+    void completeGattcProcedures();
+    void abortGattcProcedures();
+
+    void addGattsCccd(const uint16_t value_handle, const uint16_t cccd_handle);
+    void clearGattsCccds();
+    bool restoreGattsCccds(const uint16_t conn_handle, const uint8_t *p_sys_attr_data, const uint16_t len, const uint32_t flags, std::map<uint16_t, uint16_t> *restored, std::map<uint16_t, uint16_t> *previous);
+    void revertGattsCccds(const uint16_t conn_handle, const std::map<uint16_t, uint16_t> &restored, const std::map<uint16_t, uint16_t> &previous);
+    std::vector<std::pair<uint16_t, uint16_t>> getGattsSubscribers(const uint16_t value_handle);
+    void trackGattsCccdEvent(ble_evt_t *event);
+    void trackGattsCccdAuthorizeReply(const uint16_t conn_handle, const ble_gatts_rw_authorize_reply_params_t *params);
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    void setGattsHvnTxQueueSize(const ble_cfg_t *gatts_conn_cfg);
+    bool sendGattsHvn(std::unique_ptr<GattsHvnTxEntry> entry, Nan::Callback **callback, uint32_t *result, uint16_t *len);
+    void handleGattsHvnTxEvent(ble_evt_t *event);
+    void completeGattsHvnTx();
+    void abortGattsHvnTx();
+#endif
 
     static uint32_t enableBLE(adapter_t *adapter, enable_ble_params_t *enable_params);
 
@@ -270,6 +360,16 @@ private:
 
     // Interval to use for sending BLE driver events to JavaScript. If 0 events will be sent as soon as they are received from the BLE driver.
     uint32_t eventInterval;
+
+    // Adaptive dispatch, only used when eventInterval is 0. If eventMaxDelay is not 0 events are sent as soon
+    // as they are received while JavaScript keeps up. Under load events are coalesced for at most eventMaxDelay ms
+    // or until eventMaxBatchSize events are queued.
+    uint32_t eventMaxDelay;
+    uint32_t eventMaxBatchSize;
+    std::atomic<bool> eventCoalescing;
+
+    // Incremented when the transport of a session is closed by Reopen, queued events of older sessions are discarded
+    std::atomic<uint32_t> eventSession;
     std::unique_ptr<uv_timer_t> eventIntervalTimer;
     std::unique_ptr<uv_async_t> asyncEvent;
 
@@ -288,5 +388,48 @@ private:
     uint32_t eventCallbackBatchEventCounter;
     uint32_t eventCallbackBatchEventTotalCount;
     uint32_t eventCallbackBatchNumber;
+
+    // Latency histograms per event ID, only accessed in the NodeJS thread
+    std::map<uint16_t, std::unique_ptr<EventLatency>> eventLatencies;
+
+    // Event IDs that are handled natively and never queued for JavaScript.
+    // Written from the main thread, read from the SerializationTransport event thread.
+    std::array<std::atomic<bool>, EVENT_ID_COUNT> eventMask;
+
+    // Reply with a default response to masked events the peer is waiting on
+    std::atomic<bool> eventMaskAutoReply;
+#if NRF_SD_BLE_API_VERSION >= 5
+    std::atomic<uint16_t> eventMaskAttMtu;
+#endif
+
+    // Number of events dropped or auto replied per event ID
+    std::array<std::atomic<uint32_t>, EVENT_ID_COUNT> maskedEventCount;
+
+    // Native GATT client procedures per connection handle, driven from the SerializationTransport event thread.
+    // The map and the procedures are protected by gattcProcedureMutex.
+    std::map<uint16_t, std::shared_ptr<GattcProcedure>> gattcProcedures;
+    std::atomic<uint32_t> gattcProcedureCount;
+    uv_mutex_t gattcProcedureMutex;
+    std::unique_ptr<uv_async_t> asyncGattcProcedure;
+
+    // Local CCCDs mapped to the value handle of their characteristic, recorded when characteristics are added,
+    // and the CCCD value each connection has written per characteristic value handle.
+    // Updated from the SerializationTransport event thread and protected by gattsCccdMutex.
+    std::map<uint16_t, uint16_t> gattsCccdValueHandles;
+    std::map<uint16_t, std::map<uint16_t, uint16_t>> gattsCccdValues;
+    // Value handle and value of the CCCD write each connection has pending in a write authorize request
+    std::map<uint16_t, std::pair<uint16_t, uint16_t>> gattsCccdAuthorizeWrites;
+    uv_mutex_t gattsCccdMutex;
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    // Notification flow control per connection, driven from the libuv worker threads and the
+    // SerializationTransport event thread. The queue and the notifications waiting for their
+    // callbacks in the NodeJS thread are protected by gattsHvnTxMutex, as is the queue size of new connections.
+    GattsHvnTxQueue gattsHvnTxQueue;
+    GattsHvnTxEntries gattsHvnTxCompleted;
+    uint8_t gattsHvnTxQueueSize;
+    uv_mutex_t gattsHvnTxMutex;
+    std::unique_ptr<uv_async_t> asyncGattsHvnTx;
+#endif
 };
 #endif
@@ -0,0 +1,153 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "adapter_registry.h"
+
+namespace {
+// Slot key markers, never valid addresses of driver adapters
+const void *const SLOT_EMPTY = nullptr;
+const void *const SLOT_REMOVED = reinterpret_cast<const void *>(1);
+const void *const SLOT_RESERVED = reinterpret_cast<const void *>(2);
+}
+
+AdapterRegistry::AdapterRegistry()
+{
+    for (auto &slot : slots)
+    {
+        slot.key.store(SLOT_EMPTY);
+        slot.adapter.store(nullptr);
+    }
+}
+
+size_t AdapterRegistry::slotIndex(const void *key)
+{
+    // Fibonacci hashing, uses the high bits of the product so that alignment of the address does not matter
+    const auto value = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key));
+    return static_cast<size_t>((value * 11400714819323198485ull) >> (64 - ADAPTER_REGISTRY_BITS));
+}
+
+bool AdapterRegistry::add(const void *key, Adapter *adapter)
+{
+    if (key == SLOT_EMPTY || key == SLOT_REMOVED || key == SLOT_RESERVED)
+    {
+        return false;
+    }
+
+    const auto index = slotIndex(key);
+
+    for (size_t probe = 0; probe < ADAPTER_REGISTRY_SIZE; probe++)
+    {
+        auto &slot = slots[(index + probe) & (ADAPTER_REGISTRY_SIZE - 1)];
+        auto current = slot.key.load(std::memory_order_acquire);
+
+        while (current == SLOT_EMPTY || current == SLOT_REMOVED)
+        {
+            // Reserve the slot before publishing the key, lookups must never see the key without the adapter
+            if (slot.key.compare_exchange_weak(current, SLOT_RESERVED, std::memory_order_acq_rel))
+            {
+                slot.adapter.store(adapter, std::memory_order_release);
+                slot.key.store(key, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void AdapterRegistry::remove(const void *key)
+{
+    const auto index = slotIndex(key);
+
+    for (size_t probe = 0; probe < ADAPTER_REGISTRY_SIZE; probe++)
+    {
+        auto &slot = slots[(index + probe) & (ADAPTER_REGISTRY_SIZE - 1)];
+        const auto current = slot.key.load(std::memory_order_acquire);
+
+        if (current == SLOT_EMPTY)
+        {
+            return;
+        }
+
+        if (current == key)
+        {
+            slot.adapter.store(nullptr, std::memory_order_release);
+            slot.key.store(SLOT_REMOVED, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+void AdapterRegistry::remove(const Adapter *adapter)
+{
+    for (auto &slot : slots)
+    {
+        const auto current = slot.key.load(std::memory_order_acquire);
+
+        if (current != SLOT_EMPTY && current != SLOT_REMOVED && current != SLOT_RESERVED &&
+            slot.adapter.load(std::memory_order_relaxed) == adapter)
+        {
+            slot.adapter.store(nullptr, std::memory_order_release);
+            slot.key.store(SLOT_REMOVED, std::memory_order_release);
+        }
+    }
+}
+
+Adapter *AdapterRegistry::find(const void *key) const
+{
+    const auto index = slotIndex(key);
+
+    for (size_t probe = 0; probe < ADAPTER_REGISTRY_SIZE; probe++)
+    {
+        const auto &slot = slots[(index + probe) & (ADAPTER_REGISTRY_SIZE - 1)];
+        const auto current = slot.key.load(std::memory_order_acquire);
+
+        if (current == key)
+        {
+            const auto adapter = slot.adapter.load(std::memory_order_acquire);
+
+            // The slot may have been removed and reused for another key in between
+            return slot.key.load(std::memory_order_acquire) == key ? adapter : nullptr;
+        }
+
+        if (current == SLOT_EMPTY)
+        {
+            return nullptr;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,85 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADAPTER_REGISTRY_H
+#define ADAPTER_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class Adapter;
+
+// Lock-free map from driver adapters to AddOn adapters.
+//
+// SoftDevice driver callbacks run in the transport threads of the driver for every
+// event, log entry and status, and must find the AddOn adapter without taking locks.
+// The registry is an open addressing hash table with linear probing and a fixed
+// number of slots. Lookups are wait-free. Adding and removing entries is lock-free
+// and may run concurrently with lookups and with each other. Removed slots are marked
+// so that probing continues past them, and are reused by later additions.
+
+const auto ADAPTER_REGISTRY_BITS = 7;
+const auto ADAPTER_REGISTRY_SIZE = 1 << ADAPTER_REGISTRY_BITS;
+
+class AdapterRegistry
+{
+public:
+    AdapterRegistry();
+
+    // Key must not be registered already. Returns false if the registry is full.
+    bool add(const void *key, Adapter *adapter);
+    void remove(const void *key);
+
+    // Remove all keys registered for adapter
+    void remove(const Adapter *adapter);
+
+    Adapter *find(const void *key) const;
+
+private:
+    struct Slot
+    {
+        std::atomic<const void *> key;
+        std::atomic<Adapter *> adapter;
+    };
+
+    static size_t slotIndex(const void *key);
+
+    std::array<Slot, ADAPTER_REGISTRY_SIZE> slots;
+};
+
+#endif // ADAPTER_REGISTRY_H
@@ -0,0 +1,587 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "conversion_benchmark.h"
+#include "allocation_counter.h"
+
+#include "common.h"
+#include "driver.h"
+#include "driver_gap.h"
+#include "driver_gattc.h"
+#include "driver_gatts.h"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace chrono = std::chrono;
+
+namespace
+{
+    struct Measurement
+    {
+        chrono::steady_clock::duration duration;
+        uint64_t allocations;
+        uint64_t allocatedBytes;
+    };
+
+    template<typename Function>
+    Measurement measure(const uint32_t iterations, Function function)
+    {
+        const auto startAllocations = AllocationCounter::get();
+        const auto start = chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            Nan::HandleScope scope;
+            function();
+        }
+
+        const auto end = chrono::steady_clock::now();
+        const auto endAllocations = AllocationCounter::get();
+
+        return { end - start, endAllocations.count - startAllocations.count, endAllocations.bytes - startAllocations.bytes };
+    }
+
+    // A conversion path describes how one struct type is converted: Native is what toNative returns, release frees
+    // it. The current path converts through the BleToJs classes, like the AddOn methods do.
+    template<typename Converter, typename NativeType, bool ConvertsToJs = true>
+    struct CurrentPath
+    {
+        using Native = NativeType *;
+        static const bool convertsToJs = ConvertsToJs;
+
+        static Native toNative(v8::Local<v8::Object> js) { return Converter(js).ToNative(); }
+        static v8::Local<v8::Value> toJs(Native native) { return Converter(native).ToJs(); }
+        static void release(Native native) { delete native; }
+    };
+
+    // Converters that allocate from the Baton arena in the AddOn, releasing the arena frees everything converted
+    template<typename Converter, typename NativeType, bool ConvertsToJs = true>
+    struct CurrentArenaPath
+    {
+        using Native = NativeType *;
+        static const bool convertsToJs = ConvertsToJs;
+
+        static ConversionArena &arena()
+        {
+            static ConversionArena conversionArena;
+            return conversionArena;
+        }
+
+        static Native toNative(v8::Local<v8::Object> js) { return Converter(js, &arena()).ToNative(); }
+        static v8::Local<v8::Value> toJs(Native native) { return Converter(native).ToJs(); }
+        static void release(Native) { arena().release(); }
+    };
+
+    struct CurrentGattsValue : CurrentPath<GattsValue, ble_gatts_value_t>
+    {
+        static void release(Native native)
+        {
+            free(native->p_value);
+            delete native;
+        }
+    };
+
+    struct ByteArray
+    {
+        uint8_t *data;
+        uint16_t length;
+    };
+
+    struct CurrentByteArray
+    {
+        using Native = ByteArray;
+        static const bool convertsToJs = true;
+
+        static Native toNative(v8::Local<v8::Object> js)
+        {
+            ByteArray array;
+            array.data = ConversionUtility::getNativePointerToUint8(js, "value");
+            array.length = static_cast<uint16_t>(v8::Local<v8::Array>::Cast(Utility::Get(js, "value"))->Length());
+            return array;
+        }
+
+        static v8::Local<v8::Value> toJs(Native native) { return ConversionUtility::toJsValueArray(native.data, native.length); }
+        static void release(Native native) { free(native.data); }
+    };
+
+    // The hand-written conversions the AddOn used before the struct types moved to StructSchema. They are kept
+    // here as the baseline the schema derived conversions of the current path are compared with.
+    template<typename NativeType>
+    struct Handwritten;
+
+    template<typename NativeType>
+    struct HandwrittenPath
+    {
+        using Native = NativeType *;
+        static const bool convertsToJs = true;
+
+        static Native toNative(v8::Local<v8::Object> js) { return Handwritten<NativeType>::toNative(js); }
+        static v8::Local<v8::Value> toJs(Native native) { return Handwritten<NativeType>::toJs(native); }
+        static void release(Native native) { delete native; }
+    };
+
+    template<>
+    struct Handwritten<ble_gap_conn_params_t>
+    {
+        static ble_gap_conn_params_t *toNative(v8::Local<v8::Object> js)
+        {
+            auto conn_params = new ble_gap_conn_params_t();
+            conn_params->min_conn_interval = ConversionUtility::msecsToUnitsUint16(js, "min_conn_interval", ConversionUtility::ConversionUnit1250ms);
+            conn_params->max_conn_interval = ConversionUtility::msecsToUnitsUint16(js, "max_conn_interval", ConversionUtility::ConversionUnit1250ms);
+            conn_params->slave_latency = ConversionUtility::getNativeUint16(js, "slave_latency");
+            conn_params->conn_sup_timeout = ConversionUtility::msecsToUnitsUint16(js, "conn_sup_timeout", ConversionUtility::ConversionUnit10s);
+            return conn_params;
+        }
+
+        static v8::Local<v8::Value> toJs(ble_gap_conn_params_t *native)
+        {
+            Nan::EscapableHandleScope scope;
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            Utility::Set(obj, "min_conn_interval", ConversionUtility::unitsToMsecs(native->min_conn_interval, ConversionUtility::ConversionUnit1250ms));
+            Utility::Set(obj, "max_conn_interval", ConversionUtility::unitsToMsecs(native->max_conn_interval, ConversionUtility::ConversionUnit1250ms));
+            Utility::Set(obj, "slave_latency", native->slave_latency);
+            Utility::Set(obj, "conn_sup_timeout", ConversionUtility::unitsToMsecs(native->conn_sup_timeout, ConversionUtility::ConversionUnit10s));
+            return scope.Escape(obj);
+        }
+    };
+
+    template<>
+    struct Handwritten<ble_gattc_handle_range_t>
+    {
+        static ble_gattc_handle_range_t *toNative(v8::Local<v8::Object> js)
+        {
+            auto handleRange = new ble_gattc_handle_range_t();
+            handleRange->start_handle = ConversionUtility::getNativeUint16(js, "start_handle");
+            handleRange->end_handle = ConversionUtility::getNativeUint16(js, "end_handle");
+            return handleRange;
+        }
+
+        static v8::Local<v8::Value> toJs(ble_gattc_handle_range_t *native)
+        {
+            Nan::EscapableHandleScope scope;
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            Utility::Set(obj, "start_handle", native->start_handle);
+            Utility::Set(obj, "end_handle", native->end_handle);
+            return scope.Escape(obj);
+        }
+    };
+
+    template<>
+    struct Handwritten<ble_gattc_write_params_t>
+    {
+        static ble_gattc_write_params_t *toNative(v8::Local<v8::Object> js)
+        {
+            auto writeparams = new ble_gattc_write_params_t();
+            writeparams->write_op = ConversionUtility::getNativeUint8(js, "write_op");
+            writeparams->flags = ConversionUtility::getNativeUint8(js, "flags");
+            writeparams->handle = ConversionUtility::getNativeUint16(js, "handle");
+            writeparams->offset = ConversionUtility::getNativeUint16(js, "offset");
+            writeparams->len = ConversionUtility::getNativeUint16(js, "len");
+            writeparams->p_value = ConversionUtility::getNativePointerToUint8(js, "value");
+            return writeparams;
+        }
+
+        static v8::Local<v8::Value> toJs(ble_gattc_write_params_t *native)
+        {
+            Nan::EscapableHandleScope scope;
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            Utility::Set(obj, "write_op", native->write_op);
+            Utility::Set(obj, "flags", native->flags);
+            Utility::Set(obj, "handle", native->handle);
+            Utility::Set(obj, "offset", native->offset);
+            Utility::Set(obj, "len", native->len);
+            Utility::Set(obj, "value", ConversionUtility::toJsValueArray(native->p_value, native->len));
+            return scope.Escape(obj);
+        }
+    };
+
+    struct HandwrittenGattcWriteParameters : HandwrittenPath<ble_gattc_write_params_t>
+    {
+        static void release(Native native)
+        {
+            free((char*)(native->p_value));
+            delete native;
+        }
+    };
+
+    template<>
+    struct Handwritten<ble_gatts_value_t>
+    {
+        static ble_gatts_value_t *toNative(v8::Local<v8::Object> js)
+        {
+            auto value = new ble_gatts_value_t();
+            value->len = ConversionUtility::getNativeUint16(js, "len");
+            value->offset = ConversionUtility::getNativeUint16(js, "offset");
+            value->p_value = ConversionUtility::getNativePointerToUint8(js, "value");
+            return value;
+        }
+
+        static v8::Local<v8::Value> toJs(ble_gatts_value_t *native)
+        {
+            Nan::EscapableHandleScope scope;
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            Utility::Set(obj, "len", ConversionUtility::toJsNumber(native->len));
+            Utility::Set(obj, "offset", ConversionUtility::toJsNumber(native->offset));
+            Utility::Set(obj, "value", ConversionUtility::toJsValueArray(native->p_value, native->len));
+            return scope.Escape(obj);
+        }
+    };
+
+    struct HandwrittenGattsValue : HandwrittenPath<ble_gatts_value_t>
+    {
+        static void release(Native native)
+        {
+            free(native->p_value);
+            delete native;
+        }
+    };
+
+    template<>
+    struct Handwritten<ble_version_t>
+    {
+        static ble_version_t *toNative(v8::Local<v8::Object> js)
+        {
+            auto version = new ble_version_t();
+            version->version_number = ConversionUtility::getNativeUint8(js, "version_number");
+            version->company_id = ConversionUtility::getNativeUint16(js, "company_id");
+            version->subversion_number = ConversionUtility::getNativeUint16(js, "subversion_number");
+            return version;
+        }
+
+        static v8::Local<v8::Value> toJs(ble_version_t *native)
+        {
+            Nan::EscapableHandleScope scope;
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            Utility::Set(obj, "version_number", native->version_number);
+            Utility::Set(obj, "company_id", native->company_id);
+            Utility::Set(obj, "subversion_number", native->subversion_number);
+            return scope.Escape(obj);
+        }
+    };
+
+#if NRF_SD_BLE_API_VERSION < 5
+    template<>
+    struct Handwritten<ble_gap_enable_params_t>
+    {
+        static ble_gap_enable_params_t *toNative(v8::Local<v8::Object> js)
+        {
+            auto enable_params = new ble_gap_enable_params_t();
+            enable_params->periph_conn_count = ConversionUtility::getNativeUint8(js, "periph_conn_count");
+            enable_params->central_conn_count = ConversionUtility::getNativeUint8(js, "central_conn_count");
+            enable_params->central_sec_count = ConversionUtility::getNativeUint8(js, "central_sec_count");
+            return enable_params;
+        }
+
+        static v8::Local<v8::Value> toJs(ble_gap_enable_params_t *native)
+        {
+            Nan::EscapableHandleScope scope;
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            Utility::Set(obj, "periph_conn_count", native->periph_conn_count);
+            Utility::Set(obj, "central_conn_count", native->central_conn_count);
+            Utility::Set(obj, "central_sec_count", native->central_sec_count);
+            return scope.Escape(obj);
+        }
+    };
+#endif
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    template<>
+    struct Handwritten<ble_gap_phys_t>
+    {
+        static ble_gap_phys_t *toNative(v8::Local<v8::Object> js)
+        {
+            auto ble_gap_phys = new ble_gap_phys_t();
+            ble_gap_phys->tx_phys = ConversionUtility::getNativeUint8(js, "tx_phys");
+            ble_gap_phys->rx_phys = ConversionUtility::getNativeUint8(js, "rx_phys");
+            return ble_gap_phys;
+        }
+
+        static v8::Local<v8::Value> toJs(ble_gap_phys_t *native)
+        {
+            Nan::EscapableHandleScope scope;
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            Utility::Set(obj, "tx_phys", native->tx_phys);
+            Utility::Set(obj, "rx_phys", native->rx_phys);
+            return scope.Escape(obj);
+        }
+    };
+
+    template<>
+    struct Handwritten<ble_gap_data_length_limitation_t>
+    {
+        static ble_gap_data_length_limitation_t *toNative(v8::Local<v8::Object> js)
+        {
+            auto ble_gap_data_length_limitation = new ble_gap_data_length_limitation_t();
+            ble_gap_data_length_limitation->tx_payload_limited_octets = ConversionUtility::getNativeUint16(js, "tx_payload_limited_octets");
+            ble_gap_data_length_limitation->rx_payload_limited_octets = ConversionUtility::getNativeUint16(js, "rx_payload_limited_octets");
+            ble_gap_data_length_limitation->tx_rx_time_limited_us = ConversionUtility::getNativeUint16(js, "tx_rx_time_limited_us");
+            return ble_gap_data_length_limitation;
+        }
+
+        static v8::Local<v8::Value> toJs(ble_gap_data_length_limitation_t *native)
+        {
+            Nan::EscapableHandleScope scope;
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            Utility::Set(obj, "tx_payload_limited_octets", native->tx_payload_limited_octets);
+            Utility::Set(obj, "rx_payload_limited_octets", native->rx_payload_limited_octets);
+            Utility::Set(obj, "tx_rx_time_limited_us", native->tx_rx_time_limited_us);
+            return scope.Escape(obj);
+        }
+    };
+
+    template<>
+    struct Handwritten<ble_gap_data_length_params_t>
+    {
+        static ble_gap_data_length_params_t *toNative(v8::Local<v8::Object> js)
+        {
+            auto ble_gap_data_length_params = new ble_gap_data_length_params_t();
+            ble_gap_data_length_params->max_tx_octets = ConversionUtility::getNativeUint16(js, "max_tx_octets");
+            ble_gap_data_length_params->max_rx_octets = ConversionUtility::getNativeUint16(js, "max_rx_octets");
+            ble_gap_data_length_params->max_tx_time_us = Utility::Has(js, "max_tx_time_us")
+                ? ConversionUtility::getNativeUint16(js, "max_tx_time_us")
+                : BLE_GAP_DATA_LENGTH_AUTO;
+            ble_gap_data_length_params->max_rx_time_us = Utility::Has(js, "max_rx_time_us")
+                ? ConversionUtility::getNativeUint16(js, "max_rx_time_us")
+                : BLE_GAP_DATA_LENGTH_AUTO;
+            return ble_gap_data_length_params;
+        }
+
+        static v8::Local<v8::Value> toJs(ble_gap_data_length_params_t *native)
+        {
+            Nan::EscapableHandleScope scope;
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            Utility::Set(obj, "max_tx_octets", native->max_tx_octets);
+            Utility::Set(obj, "max_rx_octets", native->max_rx_octets);
+            Utility::Set(obj, "max_tx_time_us", native->max_tx_time_us);
+            Utility::Set(obj, "max_rx_time_us", native->max_rx_time_us);
+            return scope.Escape(obj);
+        }
+    };
+#endif
+
+    struct ConversionCase
+    {
+        std::function<Measurement(v8::Local<v8::Object>, uint32_t)> toNative;
+        std::function<Measurement(v8::Local<v8::Object>, uint32_t)> toJs; // Empty if the path does not convert to JavaScript
+    };
+
+    template<typename Path>
+    ConversionCase makeCase()
+    {
+        ConversionCase conversion;
+
+        conversion.toNative = [](v8::Local<v8::Object> js, const uint32_t iterations) {
+            return measure(iterations, [&js]() { Path::release(Path::toNative(js)); });
+        };
+
+        if (Path::convertsToJs)
+        {
+            conversion.toJs = [](v8::Local<v8::Object> js, const uint32_t iterations) {
+                auto native = Path::toNative(js);
+                const auto measurement = measure(iterations, [&native]() { Path::toJs(native); });
+                Path::release(native);
+                return measurement;
+            };
+        }
+
+        return conversion;
+    }
+
+    // Conversion paths by struct type and path name
+    using ConversionPaths = std::map<std::string, ConversionCase>;
+
+    const std::map<std::string, ConversionPaths> &conversions()
+    {
+        static const std::map<std::string, ConversionPaths> registered = {
+            { "BleUUID", { { "current", makeCase<CurrentPath<BleUUID, ble_uuid_t>>() } } },
+            { "ByteArray", { { "current", makeCase<CurrentByteArray>() } } },
+            { "EnableParameters", { { "current", makeCase<CurrentArenaPath<EnableParameters, enable_ble_params_t>>() } } },
+            { "GapAddr", { { "current", makeCase<CurrentPath<GapAddr, ble_gap_addr_t>>() } } },
+            { "GapAdvParams", { { "current", makeCase<CurrentPath<GapAdvParams, ble_gap_adv_params_t, false>>() } } },
+            { "GapConnParams", {
+                { "current", makeCase<CurrentPath<GapConnParams, ble_gap_conn_params_t>>() },
+                { "handwritten", makeCase<HandwrittenPath<ble_gap_conn_params_t>>() } } },
+            { "GapScanParams", { { "current", makeCase<CurrentPath<GapScanParams, ble_gap_scan_params_t, false>>() } } },
+            { "GattcWriteParameters", {
+                { "current", makeCase<CurrentArenaPath<GattcWriteParameters, ble_gattc_write_params_t>>() },
+                { "handwritten", makeCase<HandwrittenGattcWriteParameters>() } } },
+            { "GattcHandleRange", {
+                { "current", makeCase<CurrentPath<GattcHandleRange, ble_gattc_handle_range_t>>() },
+                { "handwritten", makeCase<HandwrittenPath<ble_gattc_handle_range_t>>() } } },
+            { "GattsHVXParams", { { "current", makeCase<CurrentArenaPath<GattsHVXParams, ble_gatts_hvx_params_t, false>>() } } },
+            { "GattsValue", {
+                { "current", makeCase<CurrentGattsValue>() },
+                { "handwritten", makeCase<HandwrittenGattsValue>() } } },
+            { "Version", {
+                { "current", makeCase<CurrentPath<Version, ble_version_t>>() },
+                { "handwritten", makeCase<HandwrittenPath<ble_version_t>>() } } },
+#if NRF_SD_BLE_API_VERSION < 5
+            { "GapEnableParameters", {
+                { "current", makeCase<CurrentArenaPath<GapEnableParameters, ble_gap_enable_params_t>>() },
+                { "handwritten", makeCase<HandwrittenPath<ble_gap_enable_params_t>>() } } },
+#endif
+#if NRF_SD_BLE_API_VERSION >= 5
+            { "GapDataLengthLimitation", {
+                { "current", makeCase<CurrentPath<GapDataLengthLimitation, ble_gap_data_length_limitation_t>>() },
+                { "handwritten", makeCase<HandwrittenPath<ble_gap_data_length_limitation_t>>() } } },
+            { "GapDataLengthParams", {
+                { "current", makeCase<CurrentPath<GapDataLengthParams, ble_gap_data_length_params_t>>() },
+                { "handwritten", makeCase<HandwrittenPath<ble_gap_data_length_params_t>>() } } },
+            { "GapPhys", {
+                { "current", makeCase<CurrentPath<GapPhys, ble_gap_phys_t>>() },
+                { "handwritten", makeCase<HandwrittenPath<ble_gap_phys_t>>() } } },
+#endif
+        };
+
+        return registered;
+    }
+
+    int64_t nanoseconds(const chrono::steady_clock::duration duration)
+    {
+        return chrono::duration_cast<chrono::nanoseconds>(duration).count();
+    }
+
+    void measureConversion(Nan::NAN_METHOD_ARGS_TYPE info, const bool toJs)
+    {
+        const ConversionCase *conversion;
+        v8::Local<v8::Object> js;
+        uint32_t iterations;
+        auto argumentcount = 0;
+
+        try
+        {
+            const auto paths = conversions().find(ConversionUtility::getNativeString(info[argumentcount]));
+
+            if (paths == conversions().end())
+            {
+                throw std::string("a known struct type");
+            }
+
+            argumentcount++;
+
+            const auto path = paths->second.find(ConversionUtility::getNativeString(info[argumentcount]));
+
+            if (path == paths->second.end())
+            {
+                throw std::string("a conversion path of the struct type");
+            }
+
+            conversion = &path->second;
+
+            if (toJs && !conversion->toJs)
+            {
+                throw std::string("a conversion path converting to JavaScript");
+            }
+
+            argumentcount++;
+
+            js = ConversionUtility::getJsObject(info[argumentcount]);
+            argumentcount++;
+
+            iterations = ConversionUtility::getNativeUint32(info[argumentcount]);
+            argumentcount++;
+        }
+        catch (std::string error)
+        {
+            v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+            Nan::ThrowTypeError(message);
+            return;
+        }
+
+        Measurement measurement;
+
+        try
+        {
+            measurement = toJs ? conversion->toJs(js, iterations) : conversion->toNative(js, iterations);
+        }
+        catch (std::string error)
+        {
+            // The object does not convert to the struct type
+            v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(2, error);
+            Nan::ThrowTypeError(message);
+            return;
+        }
+
+        auto result = Nan::New<v8::Object>();
+        Utility::Set(result, "iterations", iterations);
+        Utility::Set(result, "time", static_cast<double>(nanoseconds(measurement.duration)));
+        Utility::Set(result, "allocations", static_cast<double>(measurement.allocations));
+        Utility::Set(result, "allocatedBytes", static_cast<double>(measurement.allocatedBytes));
+
+        info.GetReturnValue().Set(result);
+    }
+}
+
+NAN_MODULE_INIT(ConversionBenchmark::Init)
+{
+    Utility::SetMethod(target, "toNative", ToNative);
+    Utility::SetMethod(target, "toJs", ToJs);
+
+    auto list = Nan::New<v8::Object>();
+
+    for (const auto &conversion : conversions())
+    {
+        auto paths = Nan::New<v8::Array>();
+        auto convertsToJs = false;
+        uint32_t index = 0;
+
+        for (const auto &path : conversion.second)
+        {
+            Nan::Set(paths, index++, Nan::New(path.first).ToLocalChecked());
+            convertsToJs = convertsToJs || static_cast<bool>(path.second.toJs);
+        }
+
+        auto description = Nan::New<v8::Object>();
+        Utility::Set(description, "paths", v8::Local<v8::Value>(paths));
+        Utility::Set(description, "toJs", convertsToJs);
+        Utility::Set(list, conversion.first.c_str(), v8::Local<v8::Value>(description));
+    }
+
+    Utility::Set(target, "conversions", v8::Local<v8::Value>(list));
+}
+
+NAN_METHOD(ConversionBenchmark::ToNative)
+{
+    measureConversion(info, false);
+}
+
+NAN_METHOD(ConversionBenchmark::ToJs)
+{
+    measureConversion(info, true);
+}
@@ -0,0 +1,64 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BENCH_CONVERSION_BENCHMARK_H
+#define BENCH_CONVERSION_BENCHMARK_H
+
+#include <nan.h>
+
+// Times the conversions between JavaScript objects and SoftDevice structs done by the NAN layer, without a
+// connectivity device.
+//
+// conversions lists, per struct type, the conversion paths that can be measured and whether the struct is converted
+// back to JavaScript: { GapConnParams: { paths: ['current'], toJs: true }, ... }. ByteArray is the value array of
+// writes, notifications and events, { value: [...] } converted to a uint8_t buffer and back.
+//
+// toNative(struct, path, object, iterations) converts the object to the native struct and frees it again.
+// toJs(struct, path, object, iterations) converts the object to the native struct once and times the conversion of
+// the struct back to JavaScript.
+//
+// Both return the total time in nanoseconds and the C++ allocations made, see AllocationCounter.
+class ConversionBenchmark
+{
+public:
+    static NAN_MODULE_INIT(Init);
+
+private:
+    static NAN_METHOD(ToNative);
+    static NAN_METHOD(ToJs);
+};
+
+#endif // BENCH_CONVERSION_BENCHMARK_H
@@ -0,0 +1,535 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "event_benchmark.h"
+#include "allocation_counter.h"
+#include "conversion_benchmark.h"
+
+#include "adapter.h"
+#include "common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace chrono = std::chrono;
+
+namespace
+{
+    // Number of distinct events per scenario, so consecutive events come from different peers
+    const auto EVENT_POOL_SIZE = 64;
+
+    const char ADVERTISED_NAME[] = "Benchmark device";
+
+    std::vector<uint8_t> advertisingData(const std::string &variant, const uint32_t index)
+    {
+        std::vector<uint8_t> data;
+
+        const auto addStructure = [&data](const uint8_t type, const std::vector<uint8_t> &value) {
+            data.push_back(static_cast<uint8_t>(value.size() + 1));
+            data.push_back(type);
+            data.insert(data.end(), value.begin(), value.end());
+        };
+
+        if (variant == "empty")
+        {
+            return data;
+        }
+
+        addStructure(BLE_GAP_AD_TYPE_FLAGS, { BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE });
+
+        if (variant == "name")
+        {
+            addStructure(BLE_GAP_AD_TYPE_COMPLETE_LOCAL_NAME, std::vector<uint8_t>(ADVERTISED_NAME, ADVERTISED_NAME + sizeof(ADVERTISED_NAME) - 1));
+        }
+        else if (variant == "uuids")
+        {
+            std::vector<uint8_t> uuids;
+
+            for (uint8_t i = 0; i < 12; i++)
+            {
+                uuids.push_back(static_cast<uint8_t>(0x00 + i));
+                uuids.push_back(0x18);
+            }
+
+            addStructure(BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE, uuids);
+        }
+        else if (variant == "uuid128")
+        {
+            std::vector<uint8_t> uuid;
+
+            for (uint8_t i = 0; i < 16; i++)
+            {
+                uuid.push_back(static_cast<uint8_t>(0xA0 + i));
+            }
+
+            addStructure(BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE, uuid);
+        }
+        else if (variant == "manufacturer")
+        {
+            std::vector<uint8_t> manufacturer = { 0x59, 0x00 };
+
+            for (uint8_t i = 0; i < 24; i++)
+            {
+                manufacturer.push_back(static_cast<uint8_t>(index + i));
+            }
+
+            addStructure(BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, manufacturer);
+        }
+        else if (variant == "mixed")
+        {
+            addStructure(BLE_GAP_AD_TYPE_TX_POWER_LEVEL, { 0x00 });
+            addStructure(BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE, { 0x0D, 0x18, 0x0F, 0x18 });
+            addStructure(BLE_GAP_AD_TYPE_SHORT_LOCAL_NAME, { 'B', 'e', 'n', 'c', 'h' });
+            addStructure(BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, { 0x59, 0x00, static_cast<uint8_t>(index), 0x01, 0x02 });
+        }
+        else
+        {
+            throw std::string("a known adv_report variant");
+        }
+
+        return data;
+    }
+
+    void makeAdvReport(BenchEventBuffer &buffer, const BenchScenario &scenario, const uint32_t index)
+    {
+        const auto data = advertisingData(scenario.variant, index);
+
+        if (data.size() > BLE_GAP_ADV_MAX_SIZE)
+        {
+            throw std::string("advertising data fitting in an advertising report");
+        }
+
+        buffer.event.header.evt_id = BLE_GAP_EVT_ADV_REPORT;
+        buffer.event.evt.gap_evt.conn_handle = BLE_CONN_HANDLE_INVALID;
+
+        auto report = &buffer.event.evt.gap_evt.params.adv_report;
+        report->peer_addr.addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+
+        for (auto i = 0; i < BLE_GAP_ADDR_LEN; i++)
+        {
+            report->peer_addr.addr[i] = static_cast<uint8_t>(index >> (i * 8));
+        }
+
+        report->peer_addr.addr[BLE_GAP_ADDR_LEN - 1] |= 0xC0;
+        report->rssi = static_cast<int8_t>(-40 - static_cast<int>(index % 50));
+        report->scan_rsp = 0;
+        report->type = BLE_GAP_ADV_TYPE_ADV_IND;
+        report->dlen = static_cast<uint8_t>(data.size());
+        std::copy(data.begin(), data.end(), report->data);
+    }
+
+    // Bytes left in the event buffer from the given member on
+    size_t remaining(const BenchEventBuffer &buffer, const void *member)
+    {
+        return BENCH_EVENT_BUFFER_SIZE - (static_cast<const uint8_t *>(member) - buffer.raw);
+    }
+
+    void makeGattcEvent(BenchEventBuffer &buffer, const uint16_t evt_id)
+    {
+        buffer.event.header.evt_id = evt_id;
+        buffer.event.evt.gattc_evt.conn_handle = 0;
+        buffer.event.evt.gattc_evt.gatt_status = BLE_GATT_STATUS_SUCCESS;
+        buffer.event.evt.gattc_evt.error_handle = BLE_GATT_HANDLE_INVALID;
+    }
+
+    void makeHvx(BenchEventBuffer &buffer, const BenchScenario &scenario, const uint32_t index)
+    {
+        makeGattcEvent(buffer, BLE_GATTC_EVT_HVX);
+
+        auto hvx = &buffer.event.evt.gattc_evt.params.hvx;
+
+        if (scenario.length > remaining(buffer, hvx->data))
+        {
+            throw std::string("a length fitting in the event buffer");
+        }
+
+        hvx->handle = 0x0010;
+        hvx->type = BLE_GATT_HVX_NOTIFICATION;
+        hvx->len = scenario.length;
+        std::memset(hvx->data, static_cast<int>(index & 0xFF), scenario.length);
+    }
+
+    void makePrimaryServiceDiscovery(BenchEventBuffer &buffer, const BenchScenario &scenario)
+    {
+        makeGattcEvent(buffer, BLE_GATTC_EVT_PRIM_SRVC_DISC_RSP);
+
+        auto response = &buffer.event.evt.gattc_evt.params.prim_srvc_disc_rsp;
+
+        if (scenario.entries * sizeof(ble_gattc_service_t) > remaining(buffer, response->services))
+        {
+            throw std::string("a number of entries fitting in the event buffer");
+        }
+
+        response->count = scenario.entries;
+
+        for (uint16_t i = 0; i < scenario.entries; i++)
+        {
+            auto service = &response->services[i];
+            service->uuid.type = BLE_UUID_TYPE_BLE;
+            service->uuid.uuid = static_cast<uint16_t>(0x1800 + i);
+            service->handle_range.start_handle = static_cast<uint16_t>(1 + i * 10);
+            service->handle_range.end_handle = static_cast<uint16_t>(10 + i * 10);
+        }
+    }
+
+    void makeCharacteristicDiscovery(BenchEventBuffer &buffer, const BenchScenario &scenario)
+    {
+        makeGattcEvent(buffer, BLE_GATTC_EVT_CHAR_DISC_RSP);
+
+        auto response = &buffer.event.evt.gattc_evt.params.char_disc_rsp;
+
+        if (scenario.entries * sizeof(ble_gattc_char_t) > remaining(buffer, response->chars))
+        {
+            throw std::string("a number of entries fitting in the event buffer");
+        }
+
+        response->count = scenario.entries;
+
+        for (uint16_t i = 0; i < scenario.entries; i++)
+        {
+            auto characteristic = &response->chars[i];
+            characteristic->uuid.type = BLE_UUID_TYPE_BLE;
+            characteristic->uuid.uuid = static_cast<uint16_t>(0x2A00 + i);
+            characteristic->char_props.read = 1;
+            characteristic->char_props.notify = 1;
+            characteristic->handle_decl = static_cast<uint16_t>(2 + i * 3);
+            characteristic->handle_value = static_cast<uint16_t>(3 + i * 3);
+        }
+    }
+
+    BenchScenario parseScenario(v8::Local<v8::Object> js)
+    {
+        BenchScenario scenario;
+        scenario.type = ConversionUtility::getNativeString(js, "type");
+        scenario.variant = ConversionUtility::getNativeString(js, "variant");
+        scenario.length = ConversionUtility::getNativeUint16(js, "length");
+        scenario.entries = ConversionUtility::getNativeUint16(js, "entries");
+
+        // Fail on the options before anything is measured
+        scenario.createEvents(1);
+
+        return scenario;
+    }
+
+    int64_t nanoseconds(const chrono::steady_clock::duration duration)
+    {
+        return chrono::duration_cast<chrono::nanoseconds>(duration).count();
+    }
+
+    // A pipeline run, owned by its done handle and deleted when the handle is closed
+    struct PipelineRun
+    {
+        Adapter *adapter;
+        std::vector<BenchEventBuffer> events;
+        uint32_t count;
+
+        std::thread producer;
+        chrono::steady_clock::duration duration;
+        uint32_t queueFullWaits;
+
+        uv_async_t done;
+        std::unique_ptr<Nan::Callback> callback;
+    };
+
+    void produce(PipelineRun *run)
+    {
+        const auto start = chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < run->count; i++)
+        {
+            // The transport would overrun the queue and lose the event, a benchmark must not
+            while (run->adapter->isEventQueueFull())
+            {
+                run->queueFullWaits++;
+                std::this_thread::yield();
+            }
+
+            run->adapter->appendEvent(&run->events[i % run->events.size()].event, chrono::steady_clock::now());
+        }
+
+        run->duration = chrono::steady_clock::now() - start;
+        uv_async_send(&run->done);
+    }
+
+    void onPipelineDone(uv_async_t *handle)
+    {
+        Nan::HandleScope scope;
+
+        auto run = static_cast<PipelineRun *>(handle->data);
+        run->producer.join();
+
+        auto result = Nan::New<v8::Object>();
+        Utility::Set(result, "events", run->count);
+        Utility::Set(result, "produceTime", static_cast<double>(nanoseconds(run->duration)));
+        Utility::Set(result, "queueFullWaits", run->queueFullWaits);
+
+        v8::Local<v8::Value> argv[2] = { Nan::Undefined(), result };
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        run->callback->Call(2, argv, &resource);
+
+        uv_close(reinterpret_cast<uv_handle_t *>(handle), [](uv_handle_t *closed) {
+            delete static_cast<PipelineRun *>(closed->data);
+        });
+    }
+}
+
+std::vector<BenchEventBuffer> BenchScenario::createEvents(const size_t count) const
+{
+    std::vector<BenchEventBuffer> events(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        auto &buffer = events[i];
+        std::memset(buffer.raw, 0, sizeof(buffer.raw));
+
+        const auto index = static_cast<uint32_t>(i);
+
+        if (type == "adv_report")
+        {
+            makeAdvReport(buffer, *this, index);
+        }
+        else if (type == "hvx")
+        {
+            makeHvx(buffer, *this, index);
+        }
+        else if (type == "prim_srvc_disc_rsp")
+        {
+            makePrimaryServiceDiscovery(buffer, *this);
+        }
+        else if (type == "char_disc_rsp")
+        {
+            makeCharacteristicDiscovery(buffer, *this);
+        }
+        else
+        {
+            throw std::string("a known event type");
+        }
+    }
+
+    return events;
+}
+
+NAN_MODULE_INIT(EventBenchmark::Init)
+{
+    Utility::SetMethod(target, "convertEvents", ConvertEvents);
+    Utility::SetMethod(target, "runPipeline", RunPipeline);
+    Utility::SetMethod(target, "release", Release);
+}
+
+NAN_METHOD(EventBenchmark::ConvertEvents)
+{
+    Adapter *adapter;
+    BenchScenario scenario;
+    uint32_t count;
+    uint32_t batchSize;
+    v8::Local<v8::Function> eventCallback;
+    auto argumentcount = 0;
+
+    try
+    {
+        adapter = Nan::ObjectWrap::Unwrap<Adapter>(ConversionUtility::getJsObject(info[argumentcount]));
+        argumentcount++;
+
+        scenario = parseScenario(ConversionUtility::getJsObject(info[argumentcount]));
+        argumentcount++;
+
+        auto options = ConversionUtility::getJsObject(info[argumentcount]);
+        count = ConversionUtility::getNativeUint32(options, "count");
+        batchSize = ConversionUtility::getNativeUint32(options, "batchSize");
+        argumentcount++;
+
+        eventCallback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    // One slot of the event queue is always free
+    if (batchSize == 0 || batchSize >= EVENT_QUEUE_SIZE)
+    {
+        batchSize = EVENT_QUEUE_SIZE - 1;
+    }
+
+    auto events = scenario.createEvents(EVENT_POOL_SIZE);
+
+    // Events are dispatched here, the event interval timer must not be running
+    adapter->initEventHandling(std::make_unique<Nan::Callback>(eventCallback), 0, 0, batchSize);
+
+    chrono::steady_clock::duration appendDuration(0);
+    chrono::steady_clock::duration convertDuration(0);
+    uint64_t appendAllocations = 0;
+    uint64_t appendBytes = 0;
+    uint64_t convertAllocations = 0;
+    uint64_t convertBytes = 0;
+    uint32_t batches = 0;
+
+    for (uint32_t appended = 0; appended < count; batches++)
+    {
+        const auto batchStart = chrono::steady_clock::now();
+        const auto batchAllocations = AllocationCounter::get();
+
+        for (uint32_t i = 0; i < batchSize && appended < count; i++, appended++)
+        {
+            adapter->appendEvent(&events[appended % events.size()].event, batchStart);
+        }
+
+        const auto converted = chrono::steady_clock::now();
+        const auto convertAllocationsStart = AllocationCounter::get();
+
+        adapter->onRpcEvent(nullptr);
+
+        const auto end = chrono::steady_clock::now();
+        const auto endAllocations = AllocationCounter::get();
+
+        appendDuration += converted - batchStart;
+        convertDuration += end - converted;
+        appendAllocations += convertAllocationsStart.count - batchAllocations.count;
+        appendBytes += convertAllocationsStart.bytes - batchAllocations.bytes;
+        convertAllocations += endAllocations.count - convertAllocationsStart.count;
+        convertBytes += endAllocations.bytes - convertAllocationsStart.bytes;
+    }
+
+    auto result = Nan::New<v8::Object>();
+    Utility::Set(result, "events", count);
+    Utility::Set(result, "batches", batches);
+    Utility::Set(result, "appendTime", static_cast<double>(nanoseconds(appendDuration)));
+    Utility::Set(result, "convertTime", static_cast<double>(nanoseconds(convertDuration)));
+    Utility::Set(result, "appendAllocations", static_cast<double>(appendAllocations));
+    Utility::Set(result, "appendAllocatedBytes", static_cast<double>(appendBytes));
+    Utility::Set(result, "convertAllocations", static_cast<double>(convertAllocations));
+    Utility::Set(result, "convertAllocatedBytes", static_cast<double>(convertBytes));
+
+    Utility::SetReturnValue(info, result);
+}
+
+NAN_METHOD(EventBenchmark::RunPipeline)
+{
+    Adapter *adapter;
+    BenchScenario scenario;
+    uint32_t count;
+    uint32_t eventInterval;
+    uint32_t eventMaxDelay;
+    uint32_t eventMaxBatchSize;
+    v8::Local<v8::Function> eventCallback;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        adapter = Nan::ObjectWrap::Unwrap<Adapter>(ConversionUtility::getJsObject(info[argumentcount]));
+        argumentcount++;
+
+        scenario = parseScenario(ConversionUtility::getJsObject(info[argumentcount]));
+        argumentcount++;
+
+        auto options = ConversionUtility::getJsObject(info[argumentcount]);
+        count = ConversionUtility::getNativeUint32(options, "count");
+        eventInterval = ConversionUtility::getNativeUint32(options, "eventInterval");
+        eventMaxDelay = ConversionUtility::getNativeUint32(options, "eventMaxDelay");
+        eventMaxBatchSize = ConversionUtility::getNativeUint32(options, "eventMaxBatchSize");
+        argumentcount++;
+
+        eventCallback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    adapter->initEventHandling(std::make_unique<Nan::Callback>(eventCallback), eventInterval, eventMaxDelay, eventMaxBatchSize);
+
+    auto run = new PipelineRun();
+    run->adapter = adapter;
+    run->events = scenario.createEvents(EVENT_POOL_SIZE);
+    run->count = count;
+    run->queueFullWaits = 0;
+    run->callback = std::make_unique<Nan::Callback>(callback);
+    run->done.data = static_cast<void *>(run);
+
+    if (uv_async_init(uv_default_loop(), &run->done, onPipelineDone) != 0)
+    {
+        delete run;
+        Nan::ThrowError("Not able to create the pipeline done handler.");
+        return;
+    }
+
+    run->producer = std::thread(produce, run);
+}
+
+NAN_METHOD(EventBenchmark::Release)
+{
+    try
+    {
+        auto adapter = Nan::ObjectWrap::Unwrap<Adapter>(ConversionUtility::getJsObject(info[0]));
+        adapter->cleanUpV8Resources();
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+    }
+}
+
+extern "C" {
+    // The module init of the AddOn, the benchmark AddOn exports the same API and the benchmarks
+    NAN_MODULE_INIT(init);
+
+    NAN_MODULE_INIT(init_bench)
+    {
+        init(target);
+
+        auto bench = Nan::New<v8::Object>();
+        EventBenchmark::Init(bench);
+        ConversionBenchmark::Init(bench);
+        Nan::Set(target, Nan::New("bench").ToLocalChecked(), bench);
+    }
+}
+
+NODE_MODULE(ble_driver_bench, init_bench)
@@ -0,0 +1,87 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BENCH_EVENT_BENCHMARK_H
+#define BENCH_EVENT_BENCHMARK_H
+
+#include <nan.h>
+#include <string>
+#include <vector>
+
+#include "sd_rpc.h"
+
+// Adapter::appendEvent copies this many bytes of every event, the same size as serialization_transport.cpp uses
+const auto BENCH_EVENT_BUFFER_SIZE = 512;
+
+union BenchEventBuffer
+{
+    ble_evt_t event;
+    uint8_t raw[BENCH_EVENT_BUFFER_SIZE];
+};
+
+// A stream of synthetic events of one kind, cycled through by the benchmarks
+struct BenchScenario
+{
+    std::string type;    // adv_report, hvx, prim_srvc_disc_rsp or char_disc_rsp
+    std::string variant; // AD content of adv_report: empty, name, uuids, uuid128, manufacturer or mixed
+    uint16_t length;     // Value length of hvx
+    uint16_t entries;    // Number of services or characteristics of the discovery responses
+
+    std::vector<BenchEventBuffer> createEvents(const size_t count) const;
+};
+
+// Drives Adapter::appendEvent -> Adapter::onRpcEvent with synthetic events, without a connectivity device.
+//
+// convertEvents(adapter, scenario, options, eventCallback) queues batches of events and converts them in the NodeJS
+// thread, timing appendEvent and onRpcEvent separately and counting the C++ allocations of each.
+//
+// runPipeline(adapter, scenario, options, eventCallback, callback) appends events from a separate thread, like the
+// SerializationTransport event thread, and dispatches them with the event options of Adapter.open(). The producer
+// waits while the event queue is full. The callback is called when all events have been appended.
+//
+// release(adapter) frees the event handling resources, call it when all events have been received.
+class EventBenchmark
+{
+public:
+    static NAN_MODULE_INIT(Init);
+
+private:
+    static NAN_METHOD(ConvertEvents);
+    static NAN_METHOD(RunPipeline);
+    static NAN_METHOD(Release);
+};
+
+#endif // BENCH_EVENT_BENCHMARK_H
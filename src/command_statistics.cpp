@@ -0,0 +1,149 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "command_statistics.h"
+#include "common.h"
+
+std::map<std::string, std::unique_ptr<CommandLatency>> CommandStatistics::commands;
+std::chrono::steady_clock::time_point CommandStatistics::resetTime = std::chrono::steady_clock::now();
+std::unique_ptr<Nan::Callback> CommandStatistics::sink;
+
+v8::Local<v8::Object> latencyHistogramToJs(const LatencyHistogram &histogram)
+{
+    Nan::EscapableHandleScope scope;
+    auto obj = Nan::New<v8::Object>();
+
+    Utility::Set(obj, "count", static_cast<double>(histogram.getCount()));
+    Utility::Set(obj, "min", static_cast<double>(histogram.getMin()));
+    Utility::Set(obj, "max", static_cast<double>(histogram.getMax()));
+    Utility::Set(obj, "mean", histogram.getMean());
+    Utility::Set(obj, "p50", static_cast<double>(histogram.getValueAtPercentile(50.0)));
+    Utility::Set(obj, "p99", static_cast<double>(histogram.getValueAtPercentile(99.0)));
+    Utility::Set(obj, "p999", static_cast<double>(histogram.getValueAtPercentile(99.9)));
+
+    return scope.Escape(obj);
+}
+
+static double toMicroseconds(const std::chrono::steady_clock::duration duration)
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+void CommandStatistics::record(const CommandSample &sample)
+{
+    auto &latency = commands[sample.command];
+
+    if (latency == nullptr)
+    {
+        latency = std::make_unique<CommandLatency>();
+    }
+
+    latency->count += 1;
+
+    if (sample.result != NRF_SUCCESS)
+    {
+        latency->errorCount += 1;
+    }
+
+    latency->queue.record(sample.workerStarted - sample.called);
+    latency->softDevice.record(sample.workerDone - sample.workerStarted);
+    latency->dispatch.record(sample.callbackStarted - sample.workerDone);
+    latency->callback.record(sample.callbackDone - sample.callbackStarted);
+    latency->total.record(sample.callbackDone - sample.called);
+
+    if (sink != nullptr)
+    {
+        Nan::HandleScope scope;
+        v8::Local<v8::Value> argv[1] = { sampleToJs(sample) };
+
+        Nan::AsyncResource resource("pc-ble-driver-js:command-stats");
+        sink->Call(1, argv, &resource);
+    }
+}
+
+void CommandStatistics::reset()
+{
+    commands.clear();
+    resetTime = std::chrono::steady_clock::now();
+}
+
+v8::Local<v8::Object> CommandStatistics::ToJs()
+{
+    Nan::EscapableHandleScope scope;
+    auto obj = Nan::New<v8::Object>();
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - resetTime).count();
+
+    for (auto &entry : commands)
+    {
+        auto &latency = entry.second;
+        auto command = Nan::New<v8::Object>();
+
+        Utility::Set(command, "count", static_cast<double>(latency->count));
+        Utility::Set(command, "errorCount", static_cast<double>(latency->errorCount));
+        Utility::Set(command, "perSecond", elapsed > 0 ? latency->count / elapsed : 0.0);
+        Utility::Set(command, "queue", latencyHistogramToJs(latency->queue));
+        Utility::Set(command, "softDevice", latencyHistogramToJs(latency->softDevice));
+        Utility::Set(command, "dispatch", latencyHistogramToJs(latency->dispatch));
+        Utility::Set(command, "callback", latencyHistogramToJs(latency->callback));
+        Utility::Set(command, "total", latencyHistogramToJs(latency->total));
+
+        Utility::Set(obj, entry.first.c_str(), command);
+    }
+
+    return scope.Escape(obj);
+}
+
+void CommandStatistics::setSink(std::unique_ptr<Nan::Callback> callback)
+{
+    sink = std::move(callback);
+}
+
+v8::Local<v8::Object> CommandStatistics::sampleToJs(const CommandSample &sample)
+{
+    Nan::EscapableHandleScope scope;
+    auto obj = Nan::New<v8::Object>();
+
+    Utility::Set(obj, "command", sample.command);
+    Utility::Set(obj, "result", static_cast<int32_t>(sample.result));
+    Utility::Set(obj, "queue", toMicroseconds(sample.workerStarted - sample.called));
+    Utility::Set(obj, "softDevice", toMicroseconds(sample.workerDone - sample.workerStarted));
+    Utility::Set(obj, "dispatch", toMicroseconds(sample.callbackStarted - sample.workerDone));
+    Utility::Set(obj, "callback", toMicroseconds(sample.callbackDone - sample.callbackStarted));
+    Utility::Set(obj, "total", toMicroseconds(sample.callbackDone - sample.called));
+
+    return scope.Escape(obj);
+}
@@ -0,0 +1,100 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COMMAND_STATISTICS_H
+#define COMMAND_STATISTICS_H
+
+#include <nan.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "latency_histogram.h"
+
+// Timestamps of one command going through the Baton lifecycle
+struct CommandSample
+{
+public:
+    const char *command;
+    int result;
+
+    std::chrono::steady_clock::time_point called;          // Baton created in the NAN_METHOD called from JavaScript
+    std::chrono::steady_clock::time_point workerStarted;   // Worker thread started the command
+    std::chrono::steady_clock::time_point workerDone;      // SoftDevice call returned in the worker thread
+    std::chrono::steady_clock::time_point callbackStarted; // After* function started in the NodeJS thread
+    std::chrono::steady_clock::time_point callbackDone;    // JavaScript callback returned
+};
+
+struct CommandLatency
+{
+public:
+    CommandLatency() : count(0), errorCount(0) {}
+
+    uint64_t count;
+    uint64_t errorCount;
+
+    LatencyHistogram queue;      // JavaScript call -> worker thread started
+    LatencyHistogram softDevice; // Worker thread started -> SoftDevice call returned
+    LatencyHistogram dispatch;   // SoftDevice call returned -> After* function started in the NodeJS thread
+    LatencyHistogram callback;   // After* function including the JavaScript callback
+    LatencyHistogram total;      // JavaScript call -> JavaScript callback returned
+};
+
+// Histogram as a JavaScript object with count, min, max, mean, p50, p99 and p999, shared by getStats and getCommandStats
+v8::Local<v8::Object> latencyHistogramToJs(const LatencyHistogram &histogram);
+
+// Per command statistics for all adapters in this process. Only accessed in the NodeJS thread.
+class CommandStatistics
+{
+public:
+    static void record(const CommandSample &sample);
+    static void reset();
+
+    static v8::Local<v8::Object> ToJs();
+
+    // Callback called with every sample, an empty callback removes the sink
+    static void setSink(std::unique_ptr<Nan::Callback> callback);
+
+private:
+    static v8::Local<v8::Object> sampleToJs(const CommandSample &sample);
+
+    static std::map<std::string, std::unique_ptr<CommandLatency>> commands;
+    static std::chrono::steady_clock::time_point resetTime;
+    static std::unique_ptr<Nan::Callback> sink;
+};
+
+#endif // COMMAND_STATISTICS_H
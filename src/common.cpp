@@ -41,6 +41,7 @@
 #include <cassert>
 
 #include "common.h"
+#include "command_statistics.h"
 #include "ble_hci.h"
 
 #define RETURN_VALUE_OR_THROW_EXCEPTION(method) \
@@ -182,6 +183,45 @@ const std::string getCurrentTimeInMilliseconds()
     return result;
 }
 
+namespace {
+    void baton_work(uv_work_t *req)
+    {
+        auto baton = static_cast<Baton *>(req->data);
+
+        baton->workerStarted = std::chrono::steady_clock::now();
+        baton->work(req);
+        baton->workerDone = std::chrono::steady_clock::now();
+    }
+
+    void baton_after_work(uv_work_t *req, int status)
+    {
+        auto baton = static_cast<Baton *>(req->data);
+
+        // The After* function deletes the baton, keep what is needed for the statistics
+        CommandSample sample;
+        sample.command = baton->command;
+        sample.result = baton->result;
+        sample.called = baton->called;
+        sample.workerStarted = baton->workerStarted;
+        sample.workerDone = baton->workerDone;
+        sample.callbackStarted = std::chrono::steady_clock::now();
+
+        baton->afterWork(req, status);
+
+        sample.callbackDone = std::chrono::steady_clock::now();
+        CommandStatistics::record(sample);
+    }
+}
+
+int queueBatonWork(Baton *baton, const char *command, uv_work_cb work, uv_after_work_cb afterWork)
+{
+    baton->command = command;
+    baton->work = work;
+    baton->afterWork = afterWork;
+
+    return uv_queue_work(uv_default_loop(), baton->req, baton_work, baton_after_work);
+}
+
 uint16_t uint16_decode(const uint8_t *p_encoded_data)
 {
         return ( (static_cast<uint16_t>(const_cast<uint8_t *>(p_encoded_data)[0])) |
@@ -311,26 +351,16 @@ uint8_t *ConversionUtility::getNativePointerToUint8(v8::Local<v8::Object>js, con
     RETURN_VALUE_OR_THROW_EXCEPTION(ConversionUtility::getNativePointerToUint8(value));
 }
 
-uint8_t *ConversionUtility::getNativePointerToUint8(v8::Local<v8::Value> js)
+uint8_t *ConversionUtility::getNativePointerToUint8(v8::Local<v8::Object>js, const char *name, ConversionArena *arena)
 {
-    if (!js->IsArray())
-    {
-        throw std::string("array");
-    }
-
-    v8::Local<v8::Array> jsarray = v8::Local<v8::Array>::Cast(js);
-    auto length = jsarray->Length();
-    auto string = static_cast<uint8_t *>(malloc(sizeof(uint8_t) * length));
-
-    assert(string != nullptr);
+    v8::Local<v8::Value> value = Utility::Get(js, name);
 
-    for (uint32_t i = 0; i < length; ++i)
-    {
-        string[i] = static_cast<uint8_t>(
-            Nan::Get(jsarray, i).ToLocalChecked()->Uint32Value(Nan::GetCurrentContext()).FromJust());
-    }
+    RETURN_VALUE_OR_THROW_EXCEPTION(JsValue<uint8_t *>::read(value, arena).valueOrThrow());
+}
 
-    return string;
+uint8_t *ConversionUtility::getNativePointerToUint8(v8::Local<v8::Value> js)
+{
+    return JsValue<uint8_t *>::read(js).valueOrThrow();
 }
 
 uint16_t *ConversionUtility::getNativePointerToUint16(v8::Local<v8::Object>js, const char *name)
@@ -359,12 +389,7 @@ uint16_t *ConversionUtility::getNativePointerToUint16(v8::Local<v8::Value>js)
 
 v8::Local<v8::Object> ConversionUtility::getJsObject(v8::Local<v8::Value>js)
 {
-    if (!js->IsObject())
-    {
-        throw std::string("object");
-    }
-
-    return Nan::To<v8::Object>(js).ToLocalChecked();
+    return JsValue<v8::Local<v8::Object>>::read(js).valueOrThrow();
 }
 
 v8::Local<v8::Object> ConversionUtility::getJsObject(v8::Local<v8::Object> js, const char *name)
@@ -584,12 +609,7 @@ v8::Local<v8::Function> ConversionUtility::getCallbackFunction(v8::Local<v8::Obj
 
 v8::Local<v8::Function> ConversionUtility::getCallbackFunction(v8::Local<v8::Value> js)
 {
-    Nan::EscapableHandleScope scope;
-    if (!js->IsFunction())
-    {
-        throw std::string("function");
-    }
-    return scope.Escape(js.As<v8::Function>());
+    return JsValue<v8::Local<v8::Function>>::read(js).valueOrThrow();
 }
 
 uint8_t ConversionUtility::extractHexHelper(char text)
@@ -667,6 +687,34 @@ v8::Local<v8::Value> Utility::Get(v8::Local<v8::Object> jsobj, const int index)
     return scope.Escape(Nan::Get(jsobj, index).ToLocalChecked());
 }
 
+std::map<uint16_t, std::unique_ptr<Nan::Persistent<v8::ObjectTemplate>>> EventTemplate::templates;
+
+void EventTemplate::Register(uint16_t evt_id, std::vector<const char *> properties)
+{
+    Nan::HandleScope scope;
+    auto objectTemplate = Nan::New<v8::ObjectTemplate>();
+
+    for (auto property : properties)
+    {
+        Nan::SetTemplate(objectTemplate, property, Nan::Undefined());
+    }
+
+    templates[evt_id] = std::unique_ptr<Nan::Persistent<v8::ObjectTemplate>>(new Nan::Persistent<v8::ObjectTemplate>(objectTemplate));
+}
+
+v8::Local<v8::Object> EventTemplate::NewInstance(uint16_t evt_id)
+{
+    Nan::EscapableHandleScope scope;
+    auto it = templates.find(evt_id);
+
+    if (it == templates.end())
+    {
+        return scope.Escape(Nan::New<v8::Object>());
+    }
+
+    return scope.Escape(Nan::NewInstance(Nan::New(*it->second)).ToLocalChecked());
+}
+
 void Utility::SetMethod(v8::Handle<v8::Object> target, const char *exportName, Nan::FunctionCallback function)
 {
     Utility::Set(target,
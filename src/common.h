@@ -38,11 +38,17 @@
 #define SD_COMMON_H
 
 #include <nan.h>
+#include <chrono>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "sd_rpc.h"
+#include "conversion_arena.h"
+#include "js_reader.h"
 
 #if !(defined NRF_SD_BLE_API_VERSION)
 #error "NRF_SD_BLE_API_VERSION is not defined. Aborting compilation."
@@ -55,6 +61,13 @@
 #define BATON_CONSTRUCTOR(BatonType) BatonType(v8::Local<v8::Function> callback) : Baton(callback) {}
 #define BATON_DESTRUCTOR(BatonType) ~BatonType()
 
+// Properties every event object starts with, see BleDriverEvent::ToJs
+#define EVENT_TEMPLATE_HEADER "id", "name", "time", "conn_handle"
+
+// Queue a Baton on the libuv thread pool, recording command statistics for it
+#define QUEUE_BATON_WORK(baton, MainName) \
+    queueBatonWork(baton, #MainName, MainName, reinterpret_cast<uv_after_work_cb>(After##MainName))
+
 #define METHOD_DEFINITIONS(MainName) \
     NAN_METHOD(MainName); \
     void MainName(uv_work_t *req); \
@@ -82,9 +95,15 @@ protected:
 
     v8::Local<v8::Object> jsobj;
     NativeType *native;
+    ConversionArena *arena = nullptr;
+
+    // Converters constructed with an arena allocate from it, the caller owns what ToNative returns otherwise
+    template<typename T>
+    T *allocate() { return arena != nullptr ? arena->create<T>() : new T(); }
 
 public:
     BleToJs(v8::Local<v8::Object> js) : jsobj(js) {}
+    BleToJs(v8::Local<v8::Object> js, ConversionArena *arena) : jsobj(js), arena(arena) {}
     BleToJs(NativeType *native) : native(native) {}
 
     virtual v8::Local<v8::Object> ToJs()
@@ -93,12 +112,32 @@ public:
         Nan::EscapableHandleScope scope;
         return scope.Escape(Nan::New<v8::Object>());
     }
-    virtual NativeType *ToNative() { /*TODO: ASSERT*/ return new NativeType(); }
+    virtual NativeType *ToNative() { /*TODO: ASSERT*/ return allocate<NativeType>(); }
 
     operator NativeType*() { return ToNative(); }
 
-    /*TODO: Should be redesigned to not leak memory.*/
-    operator NativeType() { return *(ToNative()); }
+    // The converted struct is copied and the temporary freed, pointers in it are owned as with ToNative
+    operator NativeType()
+    {
+        static_assert(std::is_trivially_destructible<NativeType>::value, "The copy would share what the destructor frees");
+
+        auto converted = ToNative();
+
+        if (converted == nullptr)
+        {
+            return NativeType();
+        }
+
+        NativeType value = *converted;
+
+        if (arena == nullptr)
+        {
+            delete converted;
+        }
+
+        return value;
+    }
+
     operator v8::Handle<v8::Value>()
     {
         Nan::EscapableHandleScope scope;
@@ -139,6 +178,19 @@ public:
     static int WriteUtf8(v8::Local<v8::String>& v8Str, char *buffer, int length = -1);
 };
 
+// Cache of one ObjectTemplate per event id. The templates are populated at module init
+// with the properties every event of that type always carries, so all instances share
+// the same hidden class instead of each one transitioning through dictionary mode.
+class EventTemplate
+{
+public:
+    static void Register(uint16_t evt_id, std::vector<const char *> properties);
+    static v8::Local<v8::Object> NewInstance(uint16_t evt_id);
+
+private:
+    static std::map<uint16_t, std::unique_ptr<Nan::Persistent<v8::ObjectTemplate>>> templates;
+};
+
 template<typename EventType>
 class BleDriverEvent : public BleToJs<EventType>
 {
@@ -176,6 +228,12 @@ public:
     virtual v8::Local<v8::Object> ToJs() override = 0;
     virtual EventType *ToNative() override = 0;
     virtual const char *getEventName() = 0;
+
+protected:
+    v8::Local<v8::Object> NewEventObject()
+    {
+        return EventTemplate::NewInstance(evt_id);
+    }
 };
 
 struct Baton
@@ -186,6 +244,12 @@ public:
         req = new uv_work_t();
         callback = new Nan::Callback(cb);
         req->data = static_cast<void*>(this);
+        result = 0;
+        adapter = nullptr;
+        command = nullptr;
+        work = nullptr;
+        afterWork = nullptr;
+        called = std::chrono::steady_clock::now();
     }
 
     ~Baton()
@@ -199,8 +263,21 @@ public:
 
     int result;
     adapter_t *adapter;
+
+    // Native structs converted from the JavaScript arguments, released with the Baton
+    ConversionArena arena;
+
+    // Command statistics, see queueBatonWork
+    const char *command;
+    uv_work_cb work;
+    uv_after_work_cb afterWork;
+    std::chrono::steady_clock::time_point called;
+    std::chrono::steady_clock::time_point workerStarted;
+    std::chrono::steady_clock::time_point workerDone;
 };
 
+int queueBatonWork(Baton *baton, const char *command, uv_work_cb work, uv_after_work_cb afterWork);
+
 const std::string getCurrentTimeInMilliseconds();
 
 uint16_t uint16_decode(const uint8_t *p_encoded_data);
@@ -214,42 +291,22 @@ class ConvUtil
 public:
     static NativeType getNativeUnsigned(v8::Local<v8::Value> js)
     {
-        if (!js->IsNumber())
-        {
-            throw std::string("number");
-        }
-
-        return Nan::To<uint32_t>(js).FromJust();
+        return JsValue<uint32_t>::read(js).valueOrThrow();
     }
 
     static NativeType getNativeSigned(v8::Local<v8::Value> js)
     {
-        if (!js->IsNumber())
-        {
-            throw std::string("number");
-        }
-
-        return Nan::To<int32_t>(js).FromJust();
+        return JsValue<int32_t>::read(js).valueOrThrow();
     }
 
     static NativeType getNativeFloat(v8::Local<v8::Value> js)
     {
-        if (!js->IsNumber())
-        {
-            throw std::string("number");
-        }
-
-        return Nan::To<double>(js).FromJust();
+        return JsValue<double>::read(js).valueOrThrow();
     }
 
     static NativeType getNativeBool(v8::Local<v8::Value> js)
     {
-        if (!js->IsBoolean())
-        {
-            throw std::string("bool");
-        }
-
-        return Nan::To<bool>(js).FromJust();
+        return JsValue<bool>::read(js).valueOrThrow();
     }
 
     static NativeType getNativeUnsigned(v8::Local<v8::Object> js, const char *name)
@@ -303,6 +360,7 @@ public:
     static bool         getBool(v8::Local<v8::Object>js, const char *name);
     static bool         getBool(v8::Local<v8::Value>js);
     static uint8_t *    getNativePointerToUint8(v8::Local<v8::Object>js, const char *name);
+    static uint8_t *    getNativePointerToUint8(v8::Local<v8::Object>js, const char *name, ConversionArena *arena);
     static uint8_t *    getNativePointerToUint8(v8::Local<v8::Value>js);
     static uint16_t *   getNativePointerToUint16(v8::Local<v8::Object>js, const char *name);
     static uint16_t *   getNativePointerToUint16(v8::Local<v8::Value>js);
@@ -0,0 +1,98 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CONVERSION_ARENA_H
+#define CONVERSION_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for the native structs converted from JavaScript for one command.
+//
+// Every Baton owns an arena. Converters constructed with it allocate the struct and everything it points to
+// from the arena, and all of it is released in one go when the After* function deletes the Baton. The first
+// CONVERSION_ARENA_INLINE_SIZE bytes are part of the Baton itself, so most commands convert their arguments
+// without any heap allocation. Only trivially destructible types can be allocated, destructors are never run.
+
+const auto CONVERSION_ARENA_INLINE_SIZE = 256;
+const auto CONVERSION_ARENA_BLOCK_SIZE = 1024;
+
+class ConversionArena
+{
+public:
+    ConversionArena();
+
+    ConversionArena(const ConversionArena &) = delete;
+    ConversionArena &operator=(const ConversionArena &) = delete;
+
+    // Value initialized object, like new T()
+    template<typename T>
+    T *create()
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "The arena does not run destructors");
+        return new (allocate(sizeof(T), alignof(T))) T();
+    }
+
+    // Uninitialized array of count elements, like malloc
+    template<typename T>
+    T *createArray(const size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "The arena does not run destructors");
+        return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void *allocate(const size_t size, const size_t alignment);
+
+    // Frees everything allocated from the arena, pointers into it are invalid afterwards
+    void release();
+
+    // Bytes handed out since the last release, including alignment padding
+    size_t getAllocatedBytes() const;
+
+private:
+    alignas(std::max_align_t) uint8_t inlineBlock[CONVERSION_ARENA_INLINE_SIZE];
+    std::vector<std::unique_ptr<uint8_t[]>> blocks;
+
+    uint8_t *current;
+    size_t remaining;
+    size_t allocatedBytes;
+};
+
+#endif // CONVERSION_ARENA_H
@@ -49,12 +49,11 @@
 #include "driver_gattc.h"
 #include "driver_gatts.h"
 #include "driver_uecc.h"
+#include "command_statistics.h"
+#include "struct_schema.h"
 
 using namespace std;
 
-// Variable to use to handle callbacks while device is opened and the corresponding callbacks is not fully operational
-Adapter *adapterBeingOpened = nullptr;
-
 // Macro for keeping sanity in event switch case below
 #define COMMON_EVT_CASE(evt_enum, evt_to_js, params_name, event_array, event_array_idx, eventEntry) \
     case BLE_EVT_##evt_enum:                                                                                         \
@@ -117,7 +116,7 @@ void sd_rpc_on_log_event(adapter_t *adapter, sd_rpc_log_severity_t severity, con
     logEntry->message = std::string(log_message);
     logEntry->severity = severity;
 
-    auto jsAdapter = Adapter::getAdapter(adapter, adapterBeingOpened);
+    auto jsAdapter = Adapter::getAdapter(adapter);
 
     if (jsAdapter != nullptr)
     {
@@ -207,6 +206,18 @@ void Adapter::dispatchEvents()
 
 void Adapter::eventIntervalCallback(uv_timer_t *handle)
 {
+    // In adaptive mode an empty queue when the coalescing timer expires means the load is gone
+    if (eventInterval == 0 && eventQueue.wasEmpty())
+    {
+        eventCoalescing = false;
+
+        // Check again in case an event was queued while coalescing was still on
+        if (eventQueue.wasEmpty())
+        {
+            return;
+        }
+    }
+
     dispatchEvents();
 }
 
@@ -219,11 +230,13 @@ static void sd_rpc_on_event(adapter_t *adapter, ble_evt_t *event)
         return;
     }
 
-    auto jsAdapter = Adapter::getAdapter(adapter, adapterBeingOpened);
+    const auto received = chrono::steady_clock::now();
+
+    auto jsAdapter = Adapter::getAdapter(adapter);
 
     if (jsAdapter != nullptr)
     {
-        jsAdapter->appendEvent(event);
+        jsAdapter->appendEvent(event, received);
     }
     else
     {
@@ -232,8 +245,34 @@ static void sd_rpc_on_event(adapter_t *adapter, ble_evt_t *event)
     }
 }
 
-void Adapter::appendEvent(ble_evt_t *event)
+void Adapter::appendEvent(ble_evt_t *event, const chrono::steady_clock::time_point received)
 {
+    const auto evt_id = event->header.evt_id;
+
+    trackGattsCccdEvent(event);
+#if NRF_SD_BLE_API_VERSION >= 5
+    handleGattsHvnTxEvent(event);
+#endif
+
+    // Responses to a native GATT client procedure are consumed here, the next request is sent from this thread
+    if (handleGattcProcedureEvent(event))
+    {
+        return;
+    }
+
+    // Masked events are never converted to JavaScript, handle them here in the transport thread
+    if (isEventMasked(evt_id))
+    {
+        maskedEventCount[evt_id] += 1;
+
+        if (eventMaskAutoReply)
+        {
+            replyMaskedEvent(event);
+        }
+
+        return;
+    }
+
     eventCallbackCount += 1;
     eventCallbackBatchEventCounter += 1;
 
@@ -252,16 +291,65 @@ void Adapter::appendEvent(ble_evt_t *event)
     auto eventEntry = new EventEntry();
     eventEntry->event = static_cast<ble_evt_t*>(evt);
     eventEntry->timestamp = getCurrentTimeInMilliseconds();
+    eventEntry->received = received;
+    eventEntry->queued = chrono::steady_clock::now();
+    eventEntry->session = eventSession;
 
     eventQueue.push(eventEntry);
 
     // If the event interval is not set, send the events to NodeJS as soon as possible.
-    if (eventInterval == 0)
+    // In adaptive mode events are held back under load until the batch is full or the coalescing timer expires.
+    if (eventInterval == 0 && (!eventCoalescing || eventCallbackBatchEventCounter >= eventMaxBatchSize))
     {
         dispatchEvents();
     }
 }
 
+// Default responses to masked events where the SoftDevice or the peer is waiting for a reply.
+// This runs in thread SerializationTransport::eventThread
+void Adapter::replyMaskedEvent(ble_evt_t *event)
+{
+    uint32_t err_code = NRF_SUCCESS;
+
+    switch (event->header.evt_id)
+    {
+        case BLE_EVT_USER_MEM_REQUEST:
+            err_code = sd_ble_user_mem_reply(adapter, event->evt.common_evt.conn_handle, nullptr);
+            break;
+        case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
+            err_code = sd_ble_gap_sec_params_reply(adapter, event->evt.gap_evt.conn_handle, BLE_GAP_SEC_STATUS_PAIRING_NOT_SUPP, nullptr, nullptr);
+            break;
+        case BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST:
+            err_code = sd_ble_gap_conn_param_update(adapter, event->evt.gap_evt.conn_handle, &event->evt.gap_evt.params.conn_param_update_request.conn_params);
+            break;
+        case BLE_GATTS_EVT_SYS_ATTR_MISSING:
+            err_code = sd_ble_gatts_sys_attr_set(adapter, event->evt.gatts_evt.conn_handle, nullptr, 0, 0);
+            break;
+#if NRF_SD_BLE_API_VERSION >= 5
+        case BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
+            err_code = sd_ble_gap_data_length_update(adapter, event->evt.gap_evt.conn_handle, nullptr, nullptr);
+            break;
+        case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+        {
+            const ble_gap_phys_t phys = { BLE_GAP_PHY_AUTO, BLE_GAP_PHY_AUTO };
+            err_code = sd_ble_gap_phy_update(adapter, event->evt.gap_evt.conn_handle, &phys);
+            break;
+        }
+        case BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+            err_code = sd_ble_gatts_exchange_mtu_reply(adapter, event->evt.gatts_evt.conn_handle, eventMaskAttMtu);
+            break;
+#endif
+        default:
+            // No reply required, the event is dropped
+            break;
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        std::cerr << "Failed to reply to masked event " << event->header.evt_id << ", error code " << err_code << "." << std::endl;
+    }
+}
+
 // Now we are in the NodeJS thread. Call callbacks.
 void Adapter::onRpcEvent(uv_async_t *handle)
 {
@@ -275,11 +363,16 @@ void Adapter::onRpcEvent(uv_async_t *handle)
     auto array = Nan::New<v8::Array>();
     auto arrayIndex = 0;
 
+    // Latency histograms of the events in this batch, the callback duration is recorded for all of them
+    std::vector<EventLatency *> batchLatencies;
+
     while (!eventQueue.wasEmpty())
     {
         EventEntry *eventEntry = nullptr;
         eventQueue.pop(eventEntry);
 
+        const auto popped = chrono::steady_clock::now();
+
         if (eventEntry == nullptr)
         {
             std::cerr << "eventEntry from queue is null. Illegal state, terminating." << std::endl;
@@ -293,6 +386,14 @@ void Adapter::onRpcEvent(uv_async_t *handle)
             std::terminate();
         }
 
+        // Events from the transport closed by Reopen belong to connections that no longer exist
+        if (eventEntry->session != eventSession)
+        {
+            free(eventEntry->event);
+            delete eventEntry;
+            continue;
+        }
+
         if (eventCallback != nullptr)
         {
             switch (event->header.evt_id)
@@ -379,6 +480,12 @@ void Adapter::onRpcEvent(uv_async_t *handle)
             }
         }
 
+        auto latency = getEventLatency(event->header.evt_id);
+        latency->queuePush.record(eventEntry->queued - eventEntry->received);
+        latency->queueResidence.record(popped - eventEntry->queued);
+        latency->conversion.record(chrono::steady_clock::now() - popped);
+        batchLatencies.push_back(latency);
+
         arrayIndex++;
 
         // Free memory for current entry
@@ -403,7 +510,13 @@ void Adapter::onRpcEvent(uv_async_t *handle)
 
     auto end = chrono::high_resolution_clock::now();
 
+    for (auto latency : batchLatencies)
+    {
+        latency->callback.record(end - start);
+    }
+
     auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
+    updateEventDispatchMode(eventCallbackBatchEventCounter, duration);
     addEventBatchStatistics(duration);
 }
 
@@ -414,7 +527,7 @@ static void sd_rpc_on_status(adapter_t *adapter, sd_rpc_app_status_t id, const c
     statusEntry->id = id;
     statusEntry->message = std::string(message);
 
-    auto jsAdapter = Adapter::getAdapter(adapter, adapterBeingOpened);
+    auto jsAdapter = Adapter::getAdapter(adapter);
 
     if (jsAdapter != nullptr)
     {
@@ -463,7 +576,7 @@ void Adapter::onStatusEvent(uv_async_t *handle)
 v8::Local<v8::Object> CommonTXCompleteEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverCommonEvent::ToJs(obj);
 
     Utility::Set(obj, "count", ConversionUtility::toJsNumber(evt->count));
@@ -475,7 +588,7 @@ v8::Local<v8::Object> CommonTXCompleteEvent::ToJs()
 v8::Local<v8::Object> CommonMemRequestEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverCommonEvent::ToJs(obj);
 
     Utility::Set(obj, "type", ConversionUtility::toJsNumber(evt->type));
@@ -487,7 +600,7 @@ v8::Local<v8::Object> CommonMemRequestEvent::ToJs()
 v8::Local<v8::Object> CommonMemReleaseEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverCommonEvent::ToJs(obj);
 
     Utility::Set(obj, "type", ConversionUtility::toJsNumber(evt->type));
@@ -591,16 +704,21 @@ NAN_METHOD(Adapter::EnableBLE)
 
     try
     {
-        baton->enable_ble_params = EnableParameters(enableObject);
+        baton->enable_ble_params = EnableParameters(enableObject, &baton->arena);
     }
     catch (std::string error)
     {
         v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("enable parameters", error);
         Nan::ThrowTypeError(message);
+        delete baton;
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, EnableBLE, reinterpret_cast<uv_after_work_cb>(AfterEnableBLE));
+#if NRF_SD_BLE_API_VERSION >= 5
+    obj->setGattsHvnTxQueueSize(baton->enable_ble_params->gatts_conn_cfg);
+#endif
+
+    QUEUE_BATON_WORK(baton, EnableBLE);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -672,11 +790,13 @@ NAN_METHOD(Adapter::Open)
         baton->parity = ToParityEnum(ConversionUtility::getNativeString(options, "parity")); parameter++;
         baton->flow_control = ToFlowControlEnum(ConversionUtility::getNativeString(options, "flowControl")); parameter++;
         baton->evt_interval = ConversionUtility::getNativeUint32(options, "eventInterval"); parameter++;
+        baton->evt_max_delay = ConversionUtility::getNativeUint32(options, "eventMaxDelay"); parameter++;
+        baton->evt_max_batch_size = ConversionUtility::getNativeUint32(options, "eventMaxBatchSize"); parameter++;
         baton->log_level = ToLogSeverityEnum(ConversionUtility::getNativeString(options, "logLevel")); parameter++;
         baton->retransmission_interval = ConversionUtility::getNativeUint32(options, "retransmissionInterval"); parameter++;
         baton->response_timeout = ConversionUtility::getNativeUint32(options, "responseTimeout"); parameter++;
         baton->enable_ble = ConversionUtility::getBool(options, "enableBLE"); parameter++;
-        baton->enable_ble_params = EnableParameters(ConversionUtility::getJsObject(options, "enableBLEParams")); parameter++;
+        baton->enable_ble_params = EnableParameters(ConversionUtility::getJsObject(options, "enableBLEParams"), &baton->arena); parameter++;
     }
     catch (std::string error)
     {
@@ -687,6 +807,8 @@ NAN_METHOD(Adapter::Open)
             "parity",
             "flowcontrol",
             "eventInterval",
+            "eventMaxDelay",
+            "eventMaxBatchSize",
             "logLevel",
             "retransmissionInterval",
             "responseTimeout",
@@ -695,9 +817,17 @@ NAN_METHOD(Adapter::Open)
         };
         errormessage << _options[parameter] << ". Reason: " << error;
         Nan::ThrowTypeError(errormessage.str().c_str());
+        delete baton;
         return;
     }
 
+#if NRF_SD_BLE_API_VERSION >= 5
+    if (baton->enable_ble)
+    {
+        obj->setGattsHvnTxQueueSize(baton->enable_ble_params->gatts_conn_cfg);
+    }
+#endif
+
     try
     {
         baton->log_callback = std::make_unique<Nan::Callback>(ConversionUtility::getCallbackFunction(options, "logCallback"));
@@ -706,6 +836,7 @@ NAN_METHOD(Adapter::Open)
     {
         auto message = ErrorMessage::getStructErrorMessage("logCallback", error);
         Nan::ThrowTypeError(message);
+        delete baton;
         return;
     }
 
@@ -717,6 +848,7 @@ NAN_METHOD(Adapter::Open)
     {
         auto message = ErrorMessage::getStructErrorMessage("eventCallback", error);
         Nan::ThrowTypeError(message);
+        delete baton;
         return;
     }
 
@@ -728,10 +860,20 @@ NAN_METHOD(Adapter::Open)
     {
         auto message = ErrorMessage::getStructErrorMessage("statusCallback", error);
         Nan::ThrowTypeError(message);
+        delete baton;
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, Open, reinterpret_cast<uv_after_work_cb>(AfterOpen));
+    // libuv handles must be initialized in the NodeJS thread, adapters may be opened concurrently
+    baton->mainObject->initEventHandling(std::move(baton->event_callback), baton->evt_interval, baton->evt_max_delay, baton->evt_max_batch_size);
+    baton->mainObject->initLogHandling(std::move(baton->log_callback));
+    baton->mainObject->initStatusHandling(std::move(baton->status_callback));
+    baton->mainObject->initGattcProcedureHandling();
+#if NRF_SD_BLE_API_VERSION >= 5
+    baton->mainObject->initGattsHvnTxHandling();
+#endif
+
+    QUEUE_BATON_WORK(baton, Open);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -739,14 +881,6 @@ void Adapter::Open(uv_work_t *req)
 {
     auto baton = static_cast<OpenBaton *>(req->data);
 
-    baton->mainObject->initEventHandling(std::move(baton->event_callback), baton->evt_interval);
-    baton->mainObject->initLogHandling(std::move(baton->log_callback));
-    baton->mainObject->initStatusHandling(std::move(baton->status_callback));
-
-    // Ensure that the correct adapter gets the callbacks as long as we have no reference to
-    // the driver adapter until after sd_rpc_open is called
-    adapterBeingOpened = baton->mainObject;
-
     auto path = baton->path.c_str();
 
     auto uart = sd_rpc_physical_layer_create_uart(path, baton->baud_rate, baton->flow_control, baton->parity);
@@ -762,6 +896,19 @@ void Adapter::Open(uv_work_t *req)
     baton->adapter = adapter;
     baton->mainObject->adapter = adapter;
 
+    // Driver callbacks are routed through the adapter registry, register before sd_rpc_open starts them
+    if (!Adapter::registerAdapter(adapter, baton->mainObject))
+    {
+        std::cerr << std::endl << "Failed to register the driver adapter, too many adapters are open." << std::endl;
+        baton->result = NRF_ERROR_NO_MEM;
+
+        sd_rpc_adapter_delete(adapter);
+        free(adapter);
+        baton->mainObject->adapter = nullptr;
+
+        return;
+    }
+
     // Set the log level
     auto error_code = sd_rpc_log_handler_severity_filter_set(adapter, baton->log_level);
 
@@ -774,15 +921,13 @@ void Adapter::Open(uv_work_t *req)
 
     error_code = sd_rpc_open(adapter, sd_rpc_on_status, sd_rpc_on_event, sd_rpc_on_log_event);
 
-    // Let the normal log handling handle the rest of the log calls
-    adapterBeingOpened = nullptr;
-
     if (error_code != NRF_SUCCESS)
     {
         std::cerr << std::endl << "Failed to open the nRF5 BLE driver." << std::endl;
         baton->result = error_code;
 
         // Delete the adapter layer and all layers below
+        Adapter::unregisterAdapter(adapter);
         sd_rpc_adapter_delete(adapter);
         free(adapter);
 
@@ -856,7 +1001,7 @@ NAN_METHOD(Adapter::Close)
     baton->adapter = obj->adapter;
     baton->mainObject = obj;
 
-    uv_queue_work(uv_default_loop(), baton->req, Close, reinterpret_cast<uv_after_work_cb>(AfterClose));
+    QUEUE_BATON_WORK(baton, Close);
 }
 
 void Adapter::Close(uv_work_t *req)
@@ -884,6 +1029,7 @@ void Adapter::AfterClose(uv_work_t *req)
         {
             argv[0] = Nan::Undefined();
 
+            Adapter::unregisterAdapter(baton->adapter);
             sd_rpc_adapter_delete(baton->adapter);
             free(baton->adapter);
             baton->adapter = nullptr;
@@ -918,7 +1064,7 @@ NAN_METHOD(Adapter::ConnReset)
     /* Hardcoding the reset mode. Consider adding argument for letting user choose reset mode. */
     baton->reset = SOFT_RESET;
 
-    uv_queue_work(uv_default_loop(), baton->req, ConnReset, reinterpret_cast<uv_after_work_cb>(AfterConnReset));
+    QUEUE_BATON_WORK(baton, ConnReset);
 }
 
 void Adapter::ConnReset(uv_work_t *req)
@@ -952,6 +1098,93 @@ void Adapter::AfterConnReset(uv_work_t *req)
     delete baton;
 }
 
+NAN_METHOD(Adapter::Reopen)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    v8::Local<v8::Function> callback;
+
+    try
+    {
+        callback = ConversionUtility::getCallbackFunction(info[0]);
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto baton = new ReopenBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+
+    QUEUE_BATON_WORK(baton, Reopen);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::Reopen(uv_work_t *req)
+{
+    auto baton = static_cast<ReopenBaton *>(req->data);
+
+    if (baton->adapter == nullptr)
+    {
+        baton->result = NRF_ERROR_INVALID_STATE;
+        return;
+    }
+
+    // The physical, data link and transport layers of the driver adapter are reused,
+    // only the serial port and the handshake with the connectivity firmware are redone
+    const auto started = chrono::steady_clock::now();
+    const auto close_error_code = sd_rpc_close(baton->adapter);
+
+    if (close_error_code != NRF_SUCCESS)
+    {
+        // The transport may already be down after a connectivity device reset, open it regardless
+        std::cerr << "Failed to close the nRF5 BLE driver before reopening, error " << close_error_code << "." << std::endl;
+    }
+
+    // No more events arrive from the closed transport, the ones still queued are discarded by onRpcEvent
+    baton->mainObject->eventSession++;
+
+    const auto closed = chrono::steady_clock::now();
+    baton->result = sd_rpc_open(baton->adapter, sd_rpc_on_status, sd_rpc_on_event, sd_rpc_on_log_event);
+    const auto opened = chrono::steady_clock::now();
+
+    baton->close_duration = chrono::duration<double, milli>(closed - started).count();
+    baton->open_duration = chrono::duration<double, milli>(opened - closed).count();
+}
+
+// This runs in Main Thread
+void Adapter::AfterReopen(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+    auto baton = static_cast<ReopenBaton *>(req->data);
+    v8::Local<v8::Value> argv[2];
+
+    // Connections of the closed session ended with it, without any events to tell. This is done after
+    // sd_rpc_close has returned so that no late event of the old transport can touch the state again.
+    baton->mainObject->resetSessionState();
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "reopening port");
+        argv[1] = Nan::Undefined();
+    }
+    else
+    {
+        auto timing = Nan::New<v8::Object>();
+        Utility::Set(timing, "close", baton->close_duration);
+        Utility::Set(timing, "open", baton->open_duration);
+
+        argv[0] = Nan::Undefined();
+        argv[1] = timing;
+    }
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    baton->callback->Call(2, argv, &resource);
+    delete baton;
+}
+
 NAN_METHOD(Adapter::AddVendorSpecificUUID)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
@@ -979,7 +1212,7 @@ NAN_METHOD(Adapter::AddVendorSpecificUUID)
     baton->p_vs_uuid = BleUUID128(uuid);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, AddVendorSpecificUUID, reinterpret_cast<uv_after_work_cb>(AfterAddVendorSpecificUUID));
+    QUEUE_BATON_WORK(baton, AddVendorSpecificUUID);
 }
 
 void Adapter::AddVendorSpecificUUID(uv_work_t *req)
@@ -1094,7 +1327,7 @@ NAN_METHOD(Adapter::GetVersion)
     baton->version = version;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GetVersion, reinterpret_cast<uv_after_work_cb>(AfterGetVersion));
+    QUEUE_BATON_WORK(baton, GetVersion);
 
     return;
 }
@@ -1167,7 +1400,7 @@ NAN_METHOD(Adapter::EncodeUUID)
     baton->uuid_le = new uint8_t[16];
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, EncodeUUID, reinterpret_cast<uv_after_work_cb>(AfterEncodeUUID));
+    QUEUE_BATON_WORK(baton, EncodeUUID);
 
     return;
 }
@@ -1237,7 +1470,7 @@ NAN_METHOD(Adapter::DecodeUUID)
     baton->p_uuid = new ble_uuid_t();
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, DecodeUUID, reinterpret_cast<uv_after_work_cb>(AfterDecodeUUID));
+    QUEUE_BATON_WORK(baton, DecodeUUID);
 
     return;
 }
@@ -1271,6 +1504,17 @@ void Adapter::AfterDecodeUUID(uv_work_t *req)
     delete baton;
 }
 
+static const char *eventIdToName(const uint16_t evt_id)
+{
+    const char *name = ConversionUtility::valueToString(evt_id, common_event_name_map, nullptr);
+
+    if (name == nullptr) name = ConversionUtility::valueToString(evt_id, gap_event_name_map, nullptr);
+    if (name == nullptr) name = ConversionUtility::valueToString(evt_id, gattc_event_name_map, nullptr);
+    if (name == nullptr) name = ConversionUtility::valueToString(evt_id, gatts_event_name_map, "UNKNOWN_EVENT");
+
+    return name;
+}
+
 NAN_METHOD(Adapter::GetStats)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
@@ -1281,9 +1525,122 @@ NAN_METHOD(Adapter::GetStats)
     Utility::Set(stats, "eventCallbackBatchMaxCount", obj->getEventCallbackMaxCount());
     Utility::Set(stats, "eventCallbackBatchAvgCount", obj->getAverageCallbackBatchCount());
 
+    auto maskedEvents = Nan::New<v8::Object>();
+
+    for (uint16_t evt_id = 0; evt_id < EVENT_ID_COUNT; evt_id++)
+    {
+        const auto count = obj->getMaskedEventCount(evt_id);
+
+        if (count > 0)
+        {
+            Nan::Set(maskedEvents, evt_id, ConversionUtility::toJsNumber(count));
+        }
+    }
+
+    Utility::Set(stats, "maskedEvents", maskedEvents);
+
+    // Latencies are in microseconds
+    auto eventLatency = Nan::New<v8::Object>();
+
+    for (auto &entry : obj->getEventLatencies())
+    {
+        // Events not received since the statistics were reset
+        if (entry.second->isEmpty())
+        {
+            continue;
+        }
+
+        auto segments = Nan::New<v8::Object>();
+        Utility::Set(segments, "id", entry.first);
+        Utility::Set(segments, "queuePush", latencyHistogramToJs(entry.second->queuePush));
+        Utility::Set(segments, "queueResidence", latencyHistogramToJs(entry.second->queueResidence));
+        Utility::Set(segments, "conversion", latencyHistogramToJs(entry.second->conversion));
+        Utility::Set(segments, "callback", latencyHistogramToJs(entry.second->callback));
+
+        Utility::Set(eventLatency, eventIdToName(entry.first), segments);
+    }
+
+    Utility::Set(stats, "eventLatency", eventLatency);
+
     Utility::SetReturnValue(info, stats);
 }
 
+NAN_METHOD(Adapter::ResetStats)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    obj->resetStatistics();
+}
+
+NAN_METHOD(Adapter::SetEventMask)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    v8::Local<v8::Array> eventIds;
+    v8::Local<v8::Object> options;
+    std::array<bool, EVENT_ID_COUNT> mask = {};
+    auto autoReply = true;
+#if NRF_SD_BLE_API_VERSION >= 5
+    uint16_t attMtu = BLE_GATT_ATT_MTU_DEFAULT;
+#endif
+    auto argumentcount = 0;
+
+    try
+    {
+        if (!info[argumentcount]->IsArray())
+        {
+            throw std::string("array");
+        }
+
+        eventIds = info[argumentcount].As<v8::Array>();
+
+        for (uint32_t i = 0; i < eventIds->Length(); i++)
+        {
+            const auto evt_id = ConversionUtility::getNativeUint16(Nan::Get(eventIds, i).ToLocalChecked());
+
+            if (evt_id >= EVENT_ID_COUNT)
+            {
+                throw std::string("array of event IDs");
+            }
+
+            mask[evt_id] = true;
+        }
+
+        argumentcount++;
+
+        if (info.Length() > argumentcount && !info[argumentcount]->IsUndefined())
+        {
+            options = ConversionUtility::getJsObject(info[argumentcount]);
+
+            if (Utility::Has(options, "autoReply"))
+            {
+                autoReply = ConversionUtility::getBool(options, "autoReply");
+            }
+
+#if NRF_SD_BLE_API_VERSION >= 5
+            if (Utility::Has(options, "attMtu"))
+            {
+                attMtu = ConversionUtility::getNativeUint16(options, "attMtu");
+            }
+#endif
+        }
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    obj->eventMaskAutoReply = autoReply;
+#if NRF_SD_BLE_API_VERSION >= 5
+    obj->eventMaskAttMtu = attMtu;
+#endif
+
+    for (auto i = 0; i < EVENT_ID_COUNT; i++)
+    {
+        obj->eventMask[i] = mask[i];
+    }
+}
+
 NAN_METHOD(Adapter::ReplyUserMemory)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
@@ -1325,7 +1682,7 @@ NAN_METHOD(Adapter::ReplyUserMemory)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, ReplyUserMemory, reinterpret_cast<uv_after_work_cb>(AfterReplyUserMemory));
+    QUEUE_BATON_WORK(baton, ReplyUserMemory);
 }
 
 void Adapter::ReplyUserMemory(uv_work_t *req)
@@ -1399,7 +1756,7 @@ NAN_METHOD(Adapter::SetBleOption)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, SetBleOption, reinterpret_cast<uv_after_work_cb>(AfterSetBleOption));
+    QUEUE_BATON_WORK(baton, SetBleOption);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1463,7 +1820,7 @@ NAN_METHOD(Adapter::GetBleOption)
     baton->opt_id = optionId;
     baton->p_opt = new ble_opt_t();
 
-    uv_queue_work(uv_default_loop(), baton->req, GetBleOption, reinterpret_cast<uv_after_work_cb>(AfterGetBleOption));
+    QUEUE_BATON_WORK(baton, GetBleOption);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1553,7 +1910,12 @@ NAN_METHOD(Adapter::SetBleConfig)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, SetBleConfig, reinterpret_cast<uv_after_work_cb>(AfterSetBleConfig));
+    if (configId == BLE_CONN_CFG_GATTS)
+    {
+        obj->setGattsHvnTxQueueSize(baton->p_cfg);
+    }
+
+    QUEUE_BATON_WORK(baton, SetBleConfig);
 }
 
 void Adapter::SetBleConfig(uv_work_t *req)
@@ -1589,25 +1951,26 @@ void Adapter::AfterSetBleConfig(uv_work_t *req)
 #pragma region BandwidthCountParameters
 
 #if NRF_SD_BLE_API_VERSION == 2
-v8::Local<v8::Object> BandwidthCountParameters::ToJs()
+template<>
+struct StructSchema<ble_conn_bw_count_t>
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-
-    Utility::Set(obj, "high_count", native->high_count);
-    Utility::Set(obj, "mid_count", native->mid_count);
-    Utility::Set(obj, "low_count", native->low_count);
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("high_count", &ble_conn_bw_count_t::high_count),
+            schemaField("mid_count", &ble_conn_bw_count_t::mid_count),
+            schemaField("low_count", &ble_conn_bw_count_t::low_count));
+    }
+};
 
-    return scope.Escape(obj);
+v8::Local<v8::Object> BandwidthCountParameters::ToJs()
+{
+    return StructMarshaller<ble_conn_bw_count_t>::toJs(*native);
 }
 
 ble_conn_bw_count_t *BandwidthCountParameters::ToNative()
 {
-    auto count_params = new ble_conn_bw_count_t();
-    count_params->high_count = ConversionUtility::getNativeUint8(jsobj, "high_count");
-    count_params->mid_count = ConversionUtility::getNativeUint8(jsobj, "mid_count");
-    count_params->low_count = ConversionUtility::getNativeUint8(jsobj, "low_count");
-    return count_params;
+    return StructMarshaller<ble_conn_bw_count_t>::newNative(jsobj, arena);
 }
 #endif
 
@@ -1639,9 +2002,9 @@ ble_conn_bw_counts_t *BandwidthGlobalMemoryPool::ToNative()
         return nullptr;
     }
 
-    auto memory_pool = new ble_conn_bw_counts_t();
-    memory_pool->tx_counts = BandwidthCountParameters(ConversionUtility::getJsObject(jsobj, "tx_counts"));
-    memory_pool->rx_counts = BandwidthCountParameters(ConversionUtility::getJsObject(jsobj, "rx_counts"));
+    auto memory_pool = allocate<ble_conn_bw_counts_t>();
+    memory_pool->tx_counts = BandwidthCountParameters(ConversionUtility::getJsObject(jsobj, "tx_counts"), arena);
+    memory_pool->rx_counts = BandwidthCountParameters(ConversionUtility::getJsObject(jsobj, "rx_counts"), arena);
     return memory_pool;
 }
 #endif
@@ -1671,9 +2034,9 @@ v8::Local<v8::Object> CommonEnableParameters::ToJs()
 
 ble_common_enable_params_t *CommonEnableParameters::ToNative()
 {
-    auto enable_params = new ble_common_enable_params_t();
+    auto enable_params = allocate<ble_common_enable_params_t>();
     enable_params->vs_uuid_count = ConversionUtility::getNativeUint16(jsobj, "vs_uuid_count");
-    enable_params->p_conn_bw_counts = BandwidthGlobalMemoryPool(ConversionUtility::getJsObjectOrNull(jsobj, "conn_bw_counts"));
+    enable_params->p_conn_bw_counts = BandwidthGlobalMemoryPool(ConversionUtility::getJsObjectOrNull(jsobj, "conn_bw_counts"), arena);
     return enable_params;
 }
 #endif
@@ -1697,10 +2060,10 @@ v8::Local<v8::Object> EnableParameters::ToJs()
 
 enable_ble_params_t *EnableParameters::ToNative()
 {
-    auto enable_params = new enable_ble_params_t();
-    enable_params->ble_enable_params.common_enable_params = CommonEnableParameters(ConversionUtility::getJsObject(jsobj, "common_enable_params"));
-    enable_params->ble_enable_params.gap_enable_params = GapEnableParameters(ConversionUtility::getJsObject(jsobj, "gap_enable_params"));
-    enable_params->ble_enable_params.gatts_enable_params = GattsEnableParameters(ConversionUtility::getJsObjectOrNull(jsobj, "gatts_enable_params"));
+    auto enable_params = allocate<enable_ble_params_t>();
+    enable_params->ble_enable_params.common_enable_params = CommonEnableParameters(ConversionUtility::getJsObject(jsobj, "common_enable_params"), arena);
+    enable_params->ble_enable_params.gap_enable_params = GapEnableParameters(ConversionUtility::getJsObject(jsobj, "gap_enable_params"), arena);
+    enable_params->ble_enable_params.gatts_enable_params = GattsEnableParameters(ConversionUtility::getJsObjectOrNull(jsobj, "gatts_enable_params"), arena);
     return enable_params;
 }
 #endif
@@ -1809,7 +2172,7 @@ v8::Local<v8::Object> EnableParameters::ToJs()
 
 enable_ble_params_t *EnableParameters::ToNative()
 {
-    auto enable_params = new enable_ble_params_t();
+    auto enable_params = allocate<enable_ble_params_t>();
 
     if (Utility::Has(jsobj, "conn_cfg"))
     {
@@ -1818,7 +2181,7 @@ enable_ble_params_t *EnableParameters::ToNative()
 
         if (Utility::Has(conn_cfg_obj, "gatt_conn_cfg"))
         {
-            enable_params->gatt_conn_cfg = new ble_cfg_t();
+            enable_params->gatt_conn_cfg = allocate<ble_cfg_t>();
             auto gatt_conn_cfg_obj = ConversionUtility::getJsObject(conn_cfg_obj, "gatt_conn_cfg");
             att_mtu = ConversionUtility::getNativeUint16(gatt_conn_cfg_obj, "att_mtu");
             enable_params->gatt_conn_cfg->conn_cfg.params.gatt_conn_cfg.att_mtu = att_mtu;
@@ -1830,7 +2193,7 @@ enable_ble_params_t *EnableParameters::ToNative()
             {
                 att_mtu = BLE_GATT_ATT_MTU_DEFAULT;
             }
-            enable_params->gap_conn_cfg = new ble_cfg_t();
+            enable_params->gap_conn_cfg = allocate<ble_cfg_t>();
             auto gap_conn_cfg_obj = ConversionUtility::getJsObject(conn_cfg_obj, "gap_conn_cfg");
             enable_params->gap_conn_cfg->conn_cfg.params.gap_conn_cfg.conn_count = ConversionUtility::getNativeUint8(gap_conn_cfg_obj, "conn_count");
             if (Utility::Has(gap_conn_cfg_obj, "event_length") || att_mtu == 0)
@@ -1845,21 +2208,21 @@ enable_ble_params_t *EnableParameters::ToNative()
 
         if (Utility::Has(conn_cfg_obj, "gattc_conn_cfg"))
         {
-            enable_params->gattc_conn_cfg = new ble_cfg_t();
+            enable_params->gattc_conn_cfg = allocate<ble_cfg_t>();
             auto gattc_conn_cfg_obj = ConversionUtility::getJsObject(conn_cfg_obj, "gattc_conn_cfg");
             enable_params->gattc_conn_cfg->conn_cfg.params.gattc_conn_cfg.write_cmd_tx_queue_size = ConversionUtility::getNativeUint8(gattc_conn_cfg_obj, "write_cmd_tx_queue_size");
         }
 
         if (Utility::Has(conn_cfg_obj, "gatts_conn_cfg"))
         {
-            enable_params->gatts_conn_cfg = new ble_cfg_t();
+            enable_params->gatts_conn_cfg = allocate<ble_cfg_t>();
             auto gatts_conn_cfg_obj = ConversionUtility::getJsObject(conn_cfg_obj, "gatts_conn_cfg");
             enable_params->gatts_conn_cfg->conn_cfg.params.gatts_conn_cfg.hvn_tx_queue_size = ConversionUtility::getNativeUint8(gatts_conn_cfg_obj, "hvn_tx_queue_size");
         }
 
         if (Utility::Has(conn_cfg_obj, "l2cap_conn_cfg"))
         {
-            enable_params->l2cap_conn_cfg = new ble_cfg_t();
+            enable_params->l2cap_conn_cfg = allocate<ble_cfg_t>();
             auto l2cap_conn_cfg_obj = ConversionUtility::getJsObject(conn_cfg_obj, "l2cap_conn_cfg");
             enable_params->l2cap_conn_cfg->conn_cfg.params.l2cap_conn_cfg.rx_mps = ConversionUtility::getNativeUint16(l2cap_conn_cfg_obj, "rx_mps");
             enable_params->l2cap_conn_cfg->conn_cfg.params.l2cap_conn_cfg.tx_mps = ConversionUtility::getNativeUint16(l2cap_conn_cfg_obj, "tx_mps");
@@ -1874,7 +2237,7 @@ enable_ble_params_t *EnableParameters::ToNative()
         auto common_cfg_obj = ConversionUtility::getJsObject(jsobj, "common_cfg");
         if (Utility::Has(common_cfg_obj, "vs_uuid_cfg"))
         {
-            enable_params->common_cfg = new ble_cfg_t();
+            enable_params->common_cfg = allocate<ble_cfg_t>();
             auto vs_uuid_cfg_obj = ConversionUtility::getJsObject(common_cfg_obj, "vs_uuid_cfg");
             enable_params->common_cfg->common_cfg.vs_uuid_cfg.vs_uuid_count = ConversionUtility::getNativeUint8(vs_uuid_cfg_obj, "vs_uuid_count");
         }
@@ -1885,7 +2248,7 @@ enable_ble_params_t *EnableParameters::ToNative()
         auto gap_cfg_obj = ConversionUtility::getJsObject(jsobj, "gap_cfg");
         if (Utility::Has(gap_cfg_obj, "role_count_cfg"))
         {
-            enable_params->gap_cfg = new ble_cfg_t();
+            enable_params->gap_cfg = allocate<ble_cfg_t>();
             auto role_count_cfg_obj = ConversionUtility::getJsObject(gap_cfg_obj, "role_count_cfg");
             enable_params->gap_cfg->gap_cfg.role_count_cfg.periph_role_count = ConversionUtility::getNativeUint8(role_count_cfg_obj, "periph_role_count");
             enable_params->gap_cfg->gap_cfg.role_count_cfg.central_role_count = ConversionUtility::getNativeUint8(role_count_cfg_obj, "central_role_count");
@@ -1898,13 +2261,13 @@ enable_ble_params_t *EnableParameters::ToNative()
         auto gatts_cfg_obj = ConversionUtility::getJsObject(jsobj, "gatts_cfg");
         if (Utility::Has(gatts_cfg_obj, "service_changed"))
         {
-            enable_params->gatts_cfg_service_changed = new ble_cfg_t();
+            enable_params->gatts_cfg_service_changed = allocate<ble_cfg_t>();
             auto service_changed_obj = ConversionUtility::getJsObject(gatts_cfg_obj, "service_changed");
             enable_params->gatts_cfg_service_changed->gatts_cfg.service_changed.service_changed = ConversionUtility::getNativeBool(service_changed_obj, "service_changed");
         }
         if (Utility::Has(gatts_cfg_obj, "attr_tab_size"))
         {
-            enable_params->gatts_cfg_attr_tab_size = new ble_cfg_t();
+            enable_params->gatts_cfg_attr_tab_size = allocate<ble_cfg_t>();
             auto attr_tab_size_obj = ConversionUtility::getJsObject(gatts_cfg_obj, "attr_tab_size");
             enable_params->gatts_cfg_attr_tab_size->gatts_cfg.attr_tab_size.attr_tab_size = ConversionUtility::getNativeUint32(attr_tab_size_obj, "attr_tab_size");
         }
@@ -1918,16 +2281,21 @@ enable_ble_params_t *EnableParameters::ToNative()
 
 #pragma region Version
 
-v8::Local<v8::Object> Version::ToJs()
+template<>
+struct StructSchema<ble_version_t>
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-
-    Utility::Set(obj, "version_number", native->version_number);
-    Utility::Set(obj, "company_id", native->company_id);
-    Utility::Set(obj, "subversion_number", native->subversion_number);
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("version_number", &ble_version_t::version_number),
+            schemaField("company_id", &ble_version_t::company_id),
+            schemaField("subversion_number", &ble_version_t::subversion_number));
+    }
+};
 
-    return scope.Escape(obj);
+v8::Local<v8::Object> Version::ToJs()
+{
+    return StructMarshaller<ble_version_t>::toJs(*native);
 }
 
 ble_version_t *Version::ToNative()
@@ -1937,11 +2305,7 @@ ble_version_t *Version::ToNative()
         return nullptr;
     }
 
-    auto version = new ble_version_t();
-    version->version_number = ConversionUtility::getNativeUint8(jsobj, "version_number");
-    version->company_id = ConversionUtility::getNativeUint16(jsobj, "company_id");
-    version->subversion_number = ConversionUtility::getNativeUint16(jsobj, "subversion_number");
-    return version;
+    return StructMarshaller<ble_version_t>::newNative(jsobj);
 }
 
 #pragma endregion Version
@@ -1997,7 +2361,7 @@ ble_uuid_t *BleUUID::ToNative()
         return nullptr;
     }
 
-    auto uuid = new ble_uuid_t();
+    auto uuid = allocate<ble_uuid_t>();
 
     uuid->uuid = ConversionUtility::getNativeUint16(jsobj, "uuid");
     uuid->type = ConversionUtility::getNativeUint8(jsobj, "type");
@@ -2271,19 +2635,35 @@ ble_conn_cfg_t *BleConnCfg::ToNative()
     return ble_conn_cfg;
 }
 
+template<>
+struct StructSchema<ble_gap_conn_cfg_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("conn_count", &ble_gap_conn_cfg_t::conn_count),
+            schemaField("event_length", &ble_gap_conn_cfg_t::event_length));
+    }
+};
+
 ble_gap_conn_cfg_t *BleGapConnCfg::ToNative()
 {
-    auto gap_conn_cfg = new ble_gap_conn_cfg_t();
-    gap_conn_cfg->conn_count = ConversionUtility::getNativeUint8(jsobj, "conn_count");
-    gap_conn_cfg->event_length = ConversionUtility::getNativeUint16(jsobj, "event_length");
-    return gap_conn_cfg;
+    return StructMarshaller<ble_gap_conn_cfg_t>::newNative(jsobj);
 }
 
+template<>
+struct StructSchema<ble_common_cfg_vs_uuid_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("vs_uuid_count", &ble_common_cfg_vs_uuid_t::vs_uuid_count));
+    }
+};
+
 ble_common_cfg_vs_uuid_t *BleCommonCfgVsUuid::ToNative()
 {
-    auto common_cfg_vs_uuid = new ble_common_cfg_vs_uuid_t();
-    common_cfg_vs_uuid->vs_uuid_count = ConversionUtility::getNativeUint8(jsobj, "vs_uuid_count");
-    return common_cfg_vs_uuid;
+    return StructMarshaller<ble_common_cfg_vs_uuid_t>::newNative(jsobj);
 }
 
 ble_gap_cfg_t *BleGapCfg::ToNative()
@@ -2357,45 +2737,85 @@ ble_gap_conn_sec_mode_t *BleGapConnSecMode::ToNative()
     return ble_gap_conn_sec_mode;
 }
 
+template<>
+struct StructSchema<ble_gap_cfg_role_count_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("periph_role_count", &ble_gap_cfg_role_count_t::periph_role_count),
+            schemaField("central_role_count", &ble_gap_cfg_role_count_t::central_role_count),
+            schemaField("central_sec_count", &ble_gap_cfg_role_count_t::central_sec_count));
+    }
+};
+
 ble_gap_cfg_role_count_t *BleGapCfgRoleCount::ToNative()
 {
-    auto ble_gap_cfg_role_count = new ble_gap_cfg_role_count_t();
-    ble_gap_cfg_role_count->periph_role_count = ConversionUtility::getNativeUint8(jsobj, "periph_role_count");
-    ble_gap_cfg_role_count->central_role_count = ConversionUtility::getNativeUint8(jsobj, "central_role_count");
-    ble_gap_cfg_role_count->central_sec_count = ConversionUtility::getNativeUint8(jsobj, "central_sec_count");
-    return ble_gap_cfg_role_count;
+    return StructMarshaller<ble_gap_cfg_role_count_t>::newNative(jsobj);
 }
 
+template<>
+struct StructSchema<ble_gattc_conn_cfg_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("write_cmd_tx_queue_size", &ble_gattc_conn_cfg_t::write_cmd_tx_queue_size));
+    }
+};
+
 ble_gattc_conn_cfg_t *BleGattcConnCfg::ToNative()
 {
-    auto gattc_conn_cfg = new ble_gattc_conn_cfg_t();
-    gattc_conn_cfg->write_cmd_tx_queue_size = ConversionUtility::getNativeUint8(jsobj, "write_cmd_tx_queue_size");
-    return gattc_conn_cfg;
+    return StructMarshaller<ble_gattc_conn_cfg_t>::newNative(jsobj);
 }
 
+template<>
+struct StructSchema<ble_gatts_conn_cfg_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("hvn_tx_queue_size", &ble_gatts_conn_cfg_t::hvn_tx_queue_size));
+    }
+};
+
 ble_gatts_conn_cfg_t *BleGattsConnCfg::ToNative()
 {
-    auto gatts_conn_cfg = new ble_gatts_conn_cfg_t();
-    gatts_conn_cfg->hvn_tx_queue_size = ConversionUtility::getNativeUint8(jsobj, "hvn_tx_queue_size");
-    return gatts_conn_cfg;
+    return StructMarshaller<ble_gatts_conn_cfg_t>::newNative(jsobj);
 }
 
+template<>
+struct StructSchema<ble_gatt_conn_cfg_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("att_mtu", &ble_gatt_conn_cfg_t::att_mtu));
+    }
+};
+
 ble_gatt_conn_cfg_t *BleGattConnCfg::ToNative()
 {
-    auto gatt_conn_cfg = new ble_gatt_conn_cfg_t();
-    gatt_conn_cfg->att_mtu = ConversionUtility::getNativeUint16(jsobj, "att_mtu");
-    return gatt_conn_cfg;
+    return StructMarshaller<ble_gatt_conn_cfg_t>::newNative(jsobj);
 }
 
+template<>
+struct StructSchema<ble_l2cap_conn_cfg_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("rx_mps", &ble_l2cap_conn_cfg_t::rx_mps),
+            schemaField("tx_mps", &ble_l2cap_conn_cfg_t::tx_mps),
+            schemaField("rx_queue_size", &ble_l2cap_conn_cfg_t::rx_queue_size),
+            schemaField("tx_queue_size", &ble_l2cap_conn_cfg_t::tx_queue_size),
+            schemaField("ch_count", &ble_l2cap_conn_cfg_t::ch_count));
+    }
+};
+
 ble_l2cap_conn_cfg_t *BleL2capConnCfg::ToNative()
 {
-    auto l2cap_conn_cfg = new ble_l2cap_conn_cfg_t();
-    l2cap_conn_cfg->rx_mps = ConversionUtility::getNativeUint16(jsobj, "rx_mps");
-    l2cap_conn_cfg->tx_mps = ConversionUtility::getNativeUint16(jsobj, "tx_mps");
-    l2cap_conn_cfg->rx_queue_size = ConversionUtility::getNativeUint8(jsobj, "rx_queue_size");
-    l2cap_conn_cfg->tx_queue_size = ConversionUtility::getNativeUint8(jsobj, "tx_queue_size");
-    l2cap_conn_cfg->ch_count = ConversionUtility::getNativeUint8(jsobj, "ch_count");
-    return l2cap_conn_cfg;
+    return StructMarshaller<ble_l2cap_conn_cfg_t>::newNative(jsobj);
 }
 
 ble_gatts_cfg_t *BleGattsCfg::ToNative() {
@@ -2422,15 +2842,62 @@ ble_gatts_cfg_service_changed_t *BleGattsCfgServiceChanged::ToNative()
     return ble_gatts_cfg_service_changed;
 }
 
+template<>
+struct StructSchema<ble_gatts_cfg_attr_tab_size_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("attr_tab_size", &ble_gatts_cfg_attr_tab_size_t::attr_tab_size));
+    }
+};
+
 ble_gatts_cfg_attr_tab_size_t *BleGattsCfgAttrTabSize::ToNative()
 {
-    auto ble_gatts_cfg_attr_tab_size = new ble_gatts_cfg_attr_tab_size_t();
-    ble_gatts_cfg_attr_tab_size->attr_tab_size = ConversionUtility::getNativeUint16(jsobj, "attr_tab_size");
-    return ble_gatts_cfg_attr_tab_size;
+    return StructMarshaller<ble_gatts_cfg_attr_tab_size_t>::newNative(jsobj);
 }
 
 #endif
 
+NAN_METHOD(GetCommandStats)
+{
+    info.GetReturnValue().Set(CommandStatistics::ToJs());
+}
+
+NAN_METHOD(ResetCommandStats)
+{
+    CommandStatistics::reset();
+}
+
+NAN_METHOD(SetCommandStatsSink)
+{
+    if (info[0]->IsUndefined() || info[0]->IsNull())
+    {
+        CommandStatistics::setSink(nullptr);
+        return;
+    }
+
+    try
+    {
+        auto callback = ConversionUtility::getCallbackFunction(info[0]);
+        CommandStatistics::setSink(std::make_unique<Nan::Callback>(callback));
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+    }
+}
+
+static void init_common_event_templates()
+{
+#if NRF_SD_BLE_API_VERSION <= 3
+    EventTemplate::Register(BLE_EVT_TX_COMPLETE, { EVENT_TEMPLATE_HEADER, "count" });
+#endif
+    EventTemplate::Register(BLE_EVT_USER_MEM_REQUEST, { EVENT_TEMPLATE_HEADER, "type" });
+    EventTemplate::Register(BLE_EVT_USER_MEM_RELEASE, { EVENT_TEMPLATE_HEADER, "type", "mem_block" });
+}
+
 extern "C" {
     void init_adapter_list(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target);
     void init_driver(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target);
@@ -2468,6 +2935,13 @@ extern "C" {
 
     void init_driver(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target)
     {
+        init_common_event_templates();
+
+        // Statistics for commands sent to the SoftDevice, shared by all adapters
+        Utility::SetMethod(target, "getCommandStats", GetCommandStats);
+        Utility::SetMethod(target, "resetCommandStats", ResetCommandStats);
+        Utility::SetMethod(target, "setCommandStatsSink", SetCommandStatsSink);
+
         // Constants used for log events
         NODE_DEFINE_CONSTANT(target, SD_RPC_LOG_TRACE);
         NODE_DEFINE_CONSTANT(target, SD_RPC_LOG_DEBUG);
@@ -2769,4 +3243,7 @@ extern "C" {
     }
 }
 
+// The benchmark AddOn registers its own module, which exports this one
+#ifndef PC_BLE_DRIVER_JS_BENCH
 NODE_MODULE(ble_driver, init)
+#endif
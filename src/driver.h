@@ -70,7 +70,7 @@ class BandwidthCountParameters : public BleToJs<ble_conn_bw_count_t>
 {
 public:
     explicit BandwidthCountParameters(ble_conn_bw_count_t *countParamters) : BleToJs<ble_conn_bw_count_t>(countParamters) {}
-    explicit BandwidthCountParameters(v8::Local<v8::Object> js) : BleToJs<ble_conn_bw_count_t>(js) {}
+    explicit BandwidthCountParameters(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_conn_bw_count_t>(js, arena) {}
     virtual ~BandwidthCountParameters() {}
 
     v8::Local<v8::Object> ToJs() override;
@@ -81,7 +81,7 @@ class BandwidthGlobalMemoryPool : public BleToJs<ble_conn_bw_counts_t>
 {
 public:
     explicit BandwidthGlobalMemoryPool(ble_conn_bw_counts_t *enable_params) : BleToJs<ble_conn_bw_counts_t>(enable_params) {}
-    explicit BandwidthGlobalMemoryPool(v8::Local<v8::Object> js) : BleToJs<ble_conn_bw_counts_t>(js) {}
+    explicit BandwidthGlobalMemoryPool(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_conn_bw_counts_t>(js, arena) {}
     virtual ~BandwidthGlobalMemoryPool() {}
 
     v8::Local<v8::Object> ToJs() override;
@@ -92,7 +92,7 @@ class CommonEnableParameters : public BleToJs<ble_common_enable_params_t>
 {
 public:
     explicit CommonEnableParameters(ble_common_enable_params_t *enable_params) : BleToJs<ble_common_enable_params_t>(enable_params) {}
-    explicit CommonEnableParameters(v8::Local<v8::Object> js) : BleToJs<ble_common_enable_params_t>(js) {}
+    explicit CommonEnableParameters(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_common_enable_params_t>(js, arena) {}
     virtual ~CommonEnableParameters() {}
 
     v8::Local<v8::Object> ToJs() override;
@@ -105,7 +105,8 @@ class EnableParameters : public BleToJs<enable_ble_params_t>
 {
 public:
     explicit EnableParameters(enable_ble_params_t *enable_params) : BleToJs<enable_ble_params_t>(enable_params) {}
-    explicit EnableParameters(v8::Local<v8::Object> js) : BleToJs<enable_ble_params_t>(js) {}
+    // enable_ble_params_t does not own the configurations it points to, they are allocated from the arena
+    explicit EnableParameters(v8::Local<v8::Object> js, ConversionArena *arena) : BleToJs<enable_ble_params_t>(js, arena) {}
     virtual ~EnableParameters() {}
 
     v8::Local<v8::Object> ToJs() override;
@@ -138,7 +139,7 @@ class BleUUID : public BleToJs<ble_uuid_t>
 {
 public:
     explicit BleUUID(ble_uuid_t *uuid) : BleToJs<ble_uuid_t>(uuid) {}
-    explicit BleUUID(v8::Local<v8::Object> js) : BleToJs<ble_uuid_t>(js) {}
+    explicit BleUUID(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_uuid_t>(js, arena) {}
     virtual ~BleUUID() {}
 
     v8::Local<v8::Object> ToJs() override;
@@ -406,9 +407,6 @@ struct OpenBaton : public Baton
 {
 public:
     BATON_CONSTRUCTOR(OpenBaton);
-    BATON_DESTRUCTOR(OpenBaton) {
-        if (enable_ble_params) delete  enable_ble_params;
-    }
 
     //char path[PATH_STRING_SIZE];
     std::string path;
@@ -425,12 +423,14 @@ public:
     sd_rpc_parity_t parity;
 
     uint32_t evt_interval; // The interval in ms that the event queue is sent to NodeJS
+    uint32_t evt_max_delay; // Max time in ms events are held back under load when evt_interval is 0, 0 disables adaptive dispatch
+    uint32_t evt_max_batch_size; // Number of queued events that are sent to NodeJS without waiting for evt_max_delay
     uint32_t retransmission_interval; // The interval between each retransmission of packet to target
     uint32_t response_timeout; // Duration to wait for reply on reliable packet sent to target
 
     bool enable_ble; // Enable BLE or not when connecting, if not the developer must enable the BLE when state is active
 
-    enable_ble_params_t *enable_ble_params; // If enable BLE is true, then use these params when enabling BLE
+    enable_ble_params_t *enable_ble_params; // If enable BLE is true, then use these params when enabling BLE. Allocated from the arena.
 
     Adapter *mainObject;
 };
@@ -450,15 +450,22 @@ public:
     Adapter *mainObject;
 };
 
+struct ReopenBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(ReopenBaton);
+    Adapter *mainObject;
+
+    double close_duration; // Time in ms spent closing the transport
+    double open_duration; // Time in ms spent opening the transport, including the handshake with the connectivity firmware
+};
+
 struct EnableBLEBaton : public Baton
 {
 public:
     BATON_CONSTRUCTOR(EnableBLEBaton);
-    BATON_DESTRUCTOR(EnableBLEBaton) {
-        if (enable_ble_params) delete  enable_ble_params;
-    }
 
-    enable_ble_params_t *enable_ble_params;
+    enable_ble_params_t *enable_ble_params; // Allocated from the arena
 };
 
 
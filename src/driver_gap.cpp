@@ -46,6 +46,7 @@
 #include <iostream>
 
 #include "adapter.h"
+#include "struct_schema.h"
 
 extern adapter_t *connectedAdapters[];
 extern int adapterCount;
@@ -213,16 +214,21 @@ static name_map_t gap_phy_map =
 #pragma region GapEnableParameters
 
 #if NRF_SD_BLE_API_VERSION < 5
-v8::Local<v8::Object> GapEnableParameters::ToJs()
+template<>
+struct StructSchema<ble_gap_enable_params_t>
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-
-    Utility::Set(obj, "periph_conn_count", native->periph_conn_count);
-    Utility::Set(obj, "central_conn_count", native->central_conn_count);
-    Utility::Set(obj, "central_sec_count", native->central_sec_count);
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("periph_conn_count", &ble_gap_enable_params_t::periph_conn_count),
+            schemaField("central_conn_count", &ble_gap_enable_params_t::central_conn_count),
+            schemaField("central_sec_count", &ble_gap_enable_params_t::central_sec_count));
+    }
+};
 
-    return scope.Escape(obj);
+v8::Local<v8::Object> GapEnableParameters::ToJs()
+{
+    return StructMarshaller<ble_gap_enable_params_t>::toJs(*native);
 }
 
 ble_gap_enable_params_t *GapEnableParameters::ToNative()
@@ -232,13 +238,7 @@ ble_gap_enable_params_t *GapEnableParameters::ToNative()
         return nullptr;
     }
 
-    auto enable_params = new ble_gap_enable_params_t();
-
-    enable_params->periph_conn_count = ConversionUtility::getNativeUint8(jsobj, "periph_conn_count");
-    enable_params->central_conn_count = ConversionUtility::getNativeUint8(jsobj, "central_conn_count");
-    enable_params->central_sec_count = ConversionUtility::getNativeUint8(jsobj, "central_sec_count");
-
-    return enable_params;
+    return StructMarshaller<ble_gap_enable_params_t>::newNative(jsobj, arena);
 }
 #endif
 
@@ -309,17 +309,22 @@ ble_gap_addr_t *GapAddr::ToNative()
 
 #pragma region GapConnParams
 
-v8::Local<v8::Object> GapConnParams::ToJs()
+template<>
+struct StructSchema<ble_gap_conn_params_t>
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-
-    Utility::Set(obj, "min_conn_interval", ConversionUtility::unitsToMsecs(native->min_conn_interval, ConversionUtility::ConversionUnit1250ms));
-    Utility::Set(obj, "max_conn_interval", ConversionUtility::unitsToMsecs(native->max_conn_interval, ConversionUtility::ConversionUnit1250ms));
-    Utility::Set(obj, "slave_latency", native->slave_latency);
-    Utility::Set(obj, "conn_sup_timeout", ConversionUtility::unitsToMsecs(native->conn_sup_timeout, ConversionUtility::ConversionUnit10s));
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField<SchemaConversion::Units<ConversionUtility::ConversionUnit1250ms>>("min_conn_interval", &ble_gap_conn_params_t::min_conn_interval),
+            schemaField<SchemaConversion::Units<ConversionUtility::ConversionUnit1250ms>>("max_conn_interval", &ble_gap_conn_params_t::max_conn_interval),
+            schemaField("slave_latency", &ble_gap_conn_params_t::slave_latency),
+            schemaField<SchemaConversion::Units<ConversionUtility::ConversionUnit10s>>("conn_sup_timeout", &ble_gap_conn_params_t::conn_sup_timeout));
+    }
+};
 
-    return scope.Escape(obj);
+v8::Local<v8::Object> GapConnParams::ToJs()
+{
+    return StructMarshaller<ble_gap_conn_params_t>::toJs(*native);
 }
 
 ble_gap_conn_params_t *GapConnParams::ToNative()
@@ -329,15 +334,7 @@ ble_gap_conn_params_t *GapConnParams::ToNative()
         return nullptr;
     }
 
-    auto conn_params = new ble_gap_conn_params_t();
-    memset(conn_params, 0, sizeof(ble_gap_conn_params_t));
-
-    conn_params->min_conn_interval = ConversionUtility::msecsToUnitsUint16(jsobj, "min_conn_interval", ConversionUtility::ConversionUnit1250ms);
-    conn_params->max_conn_interval = ConversionUtility::msecsToUnitsUint16(jsobj, "max_conn_interval", ConversionUtility::ConversionUnit1250ms);
-    conn_params->slave_latency = ConversionUtility::getNativeUint16(jsobj, "slave_latency");
-    conn_params->conn_sup_timeout = ConversionUtility::msecsToUnitsUint16(jsobj, "conn_sup_timeout", ConversionUtility::ConversionUnit10s);
-
-    return conn_params;
+    return StructMarshaller<ble_gap_conn_params_t>::newNative(jsobj);
 }
 
 #pragma endregion GapConnParams
@@ -886,7 +883,7 @@ ble_gap_lesc_oob_data_t *GapLescOobData::ToNative()
 v8::Local<v8::Object> GapConnected::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
 
     Utility::Set(obj, "peer_addr", GapAddr(&(evt->peer_addr)).ToJs());
@@ -911,7 +908,7 @@ v8::Local<v8::Object> GapConnected::ToJs()
 v8::Local<v8::Object> GapDisconnected::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "reason", evt->reason);
     Utility::Set(obj, "reason_name", HciStatus::getHciStatus(evt->reason));
@@ -925,7 +922,7 @@ v8::Local<v8::Object> GapDisconnected::ToJs()
 v8::Local<v8::Object> GapConnParamUpdate::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "conn_params", GapConnParams(&(this->evt->conn_params)).ToJs());
 
@@ -939,7 +936,7 @@ v8::Local<v8::Object> GapConnParamUpdate::ToJs()
 v8::Local<v8::Object> GapSecParamsRequest::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "peer_params", GapSecParams(&(this->evt->peer_params)).ToJs());
     return scope.Escape(obj);
@@ -952,7 +949,7 @@ v8::Local<v8::Object> GapSecParamsRequest::ToJs()
 v8::Local<v8::Object> GapSecInfoRequest::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "peer_addr", GapAddr(&(evt->peer_addr)).ToJs());
     Utility::Set(obj, "master_id", GapMasterId(&(evt->master_id)).ToJs());
@@ -970,7 +967,7 @@ v8::Local<v8::Object> GapSecInfoRequest::ToJs()
 v8::Local<v8::Object> GapDataLengthUpdateRequest::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "peer_params", GapDataLengthParams(&(evt->peer_params)).ToJs());
     return scope.Escape(obj);
@@ -982,7 +979,7 @@ v8::Local<v8::Object> GapDataLengthUpdateRequest::ToJs()
 v8::Local<v8::Object> GapDataLengthUpdateEvt::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "effective_params", GapDataLengthParams(&(evt->effective_params)).ToJs());
     return scope.Escape(obj);
@@ -990,46 +987,33 @@ v8::Local<v8::Object> GapDataLengthUpdateEvt::ToJs()
 #pragma endregion GapDataLengthUpdateEvt
 
 #pragma region GapDataLengthParams
-ble_gap_data_length_params_t *GapDataLengthParams::ToNative()
+
+template<>
+struct StructSchema<ble_gap_data_length_params_t>
 {
-    if (Utility::IsNull(jsobj))
+    static auto fields()
     {
-        return nullptr;
+        return std::make_tuple(
+            schemaField("max_tx_octets", &ble_gap_data_length_params_t::max_tx_octets),
+            schemaField("max_rx_octets", &ble_gap_data_length_params_t::max_rx_octets),
+            schemaField<SchemaConversion::WithDefault<BLE_GAP_DATA_LENGTH_AUTO>>("max_tx_time_us", &ble_gap_data_length_params_t::max_tx_time_us),
+            schemaField<SchemaConversion::WithDefault<BLE_GAP_DATA_LENGTH_AUTO>>("max_rx_time_us", &ble_gap_data_length_params_t::max_rx_time_us));
     }
+};
 
-    auto ble_gap_data_length_params = new ble_gap_data_length_params_t();
-
-    ble_gap_data_length_params->max_tx_octets = ConversionUtility::getNativeUint16(jsobj, "max_tx_octets");
-    ble_gap_data_length_params->max_rx_octets = ConversionUtility::getNativeUint16(jsobj, "max_rx_octets");
-    if (Utility::Has(jsobj, "max_tx_time_us"))
-    {
-        ble_gap_data_length_params->max_tx_time_us = ConversionUtility::getNativeUint16(jsobj, "max_tx_time_us");
-    }
-    else
-    {
-        ble_gap_data_length_params->max_tx_time_us = BLE_GAP_DATA_LENGTH_AUTO;
-    }
-    if (Utility::Has(jsobj, "max_rx_time_us"))
-    {
-        ble_gap_data_length_params->max_rx_time_us = ConversionUtility::getNativeUint16(jsobj, "max_rx_time_us");
-    }
-    else
+ble_gap_data_length_params_t *GapDataLengthParams::ToNative()
+{
+    if (Utility::IsNull(jsobj))
     {
-        ble_gap_data_length_params->max_rx_time_us = BLE_GAP_DATA_LENGTH_AUTO;
+        return nullptr;
     }
 
-    return ble_gap_data_length_params;
+    return StructMarshaller<ble_gap_data_length_params_t>::newNative(jsobj);
 };
 
 v8::Local<v8::Object> GapDataLengthParams::ToJs()
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-    Utility::Set(obj, "max_tx_octets", native->max_tx_octets);
-    Utility::Set(obj, "max_rx_octets", native->max_rx_octets);
-    Utility::Set(obj, "max_tx_time_us", native->max_tx_time_us);
-    Utility::Set(obj, "max_rx_time_us", native->max_rx_time_us);
-    return scope.Escape(obj);
+    return StructMarshaller<ble_gap_data_length_params_t>::toJs(*native);
 };
 
 #pragma endregion GapDataLengthParams
@@ -1038,7 +1022,7 @@ v8::Local<v8::Object> GapDataLengthParams::ToJs()
 v8::Local<v8::Object> GapPhyUpdateRequest::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "peer_preferred_phys", GapPhys(&(evt->peer_preferred_phys)).ToJs());
     return scope.Escape(obj);
@@ -1050,7 +1034,7 @@ v8::Local<v8::Object> GapPhyUpdateRequest::ToJs()
 v8::Local<v8::Object> GapPhyUpdateEvt::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "status", evt->status);
     Utility::Set(obj, "tx_phy", evt->tx_phy);
@@ -1062,6 +1046,18 @@ v8::Local<v8::Object> GapPhyUpdateEvt::ToJs()
 
 #pragma region GapDataLengthLimitation
 
+template<>
+struct StructSchema<ble_gap_data_length_limitation_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("tx_payload_limited_octets", &ble_gap_data_length_limitation_t::tx_payload_limited_octets),
+            schemaField("rx_payload_limited_octets", &ble_gap_data_length_limitation_t::rx_payload_limited_octets),
+            schemaField("tx_rx_time_limited_us", &ble_gap_data_length_limitation_t::tx_rx_time_limited_us));
+    }
+};
+
 ble_gap_data_length_limitation_t *GapDataLengthLimitation::ToNative()
 {
     if (Utility::IsNull(jsobj))
@@ -1069,29 +1065,29 @@ ble_gap_data_length_limitation_t *GapDataLengthLimitation::ToNative()
         return nullptr;
     }
 
-    auto ble_gap_data_length_limitation = new ble_gap_data_length_limitation_t();
-
-    ble_gap_data_length_limitation->tx_payload_limited_octets = ConversionUtility::getNativeUint16(jsobj, "tx_payload_limited_octets");
-    ble_gap_data_length_limitation->rx_payload_limited_octets = ConversionUtility::getNativeUint16(jsobj, "rx_payload_limited_octets");
-    ble_gap_data_length_limitation->tx_rx_time_limited_us = ConversionUtility::getNativeUint16(jsobj, "tx_rx_time_limited_us");
-
-    return ble_gap_data_length_limitation;
+    return StructMarshaller<ble_gap_data_length_limitation_t>::newNative(jsobj);
 };
 
 v8::Local<v8::Object> GapDataLengthLimitation::ToJs()
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-    Utility::Set(obj, "tx_payload_limited_octets", native->tx_payload_limited_octets);
-    Utility::Set(obj, "rx_payload_limited_octets", native->rx_payload_limited_octets);
-    Utility::Set(obj, "tx_rx_time_limited_us", native->tx_rx_time_limited_us);
-    return scope.Escape(obj);
+    return StructMarshaller<ble_gap_data_length_limitation_t>::toJs(*native);
 };
 
 #pragma endregion GapDataLengthLimitation
 
 #pragma region GapPhys
 
+template<>
+struct StructSchema<ble_gap_phys_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("tx_phys", &ble_gap_phys_t::tx_phys),
+            schemaField("rx_phys", &ble_gap_phys_t::rx_phys));
+    }
+};
+
 ble_gap_phys_t *GapPhys::ToNative()
 {
     if (Utility::IsNull(jsobj))
@@ -1099,22 +1095,13 @@ ble_gap_phys_t *GapPhys::ToNative()
         return nullptr;
     }
 
-    auto ble_gap_phys = new ble_gap_phys_t();
-
-    ble_gap_phys->tx_phys = ConversionUtility::getNativeUint8(jsobj, "tx_phys");
-    ble_gap_phys->rx_phys = ConversionUtility::getNativeUint8(jsobj, "rx_phys");
-
-    return ble_gap_phys;
+    return StructMarshaller<ble_gap_phys_t>::newNative(jsobj);
 };
 
 
 v8::Local<v8::Object> GapPhys::ToJs()
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-    Utility::Set(obj, "tx_phys", native->tx_phys);
-    Utility::Set(obj, "rx_phys", native->rx_phys);
-    return scope.Escape(obj);
+    return StructMarshaller<ble_gap_phys_t>::toJs(*native);
 };
 
 
@@ -1127,7 +1114,7 @@ v8::Local<v8::Object> GapPhys::ToJs()
 v8::Local<v8::Object> GapPasskeyDisplay::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "match_request", ConversionUtility::toJsBool(evt->match_request));
     Utility::Set(obj, "passkey", ConversionUtility::toJsString(reinterpret_cast<char *>(evt->passkey), BLE_GAP_PASSKEY_LEN));
@@ -1141,7 +1128,7 @@ v8::Local<v8::Object> GapPasskeyDisplay::ToJs()
 v8::Local<v8::Object> GapKeyPressed::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "kp_not", ConversionUtility::valueToJsString(evt->kp_not, gap_kp_not_types));
     return scope.Escape(obj);
@@ -1153,7 +1140,7 @@ v8::Local<v8::Object> GapKeyPressed::ToJs()
 v8::Local<v8::Object> GapAuthKeyRequest::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "key_type", ConversionUtility::valueToJsString(evt->key_type, gap_auth_key_types));
     return scope.Escape(obj);
@@ -1164,7 +1151,7 @@ v8::Local<v8::Object> GapAuthKeyRequest::ToJs()
 v8::Local<v8::Object> GapLESCDHKeyRequest::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "oobd_req", ConversionUtility::toJsBool(evt->oobd_req));
     Utility::Set(obj, "pk_peer", GapLescP256Pk(evt->p_pk_peer).ToJs());
@@ -1377,7 +1364,7 @@ ble_gap_sec_keyset_t *GapSecKeyset::ToNative()
 v8::Local<v8::Object> GapAuthStatus::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "auth_status", ConversionUtility::toJsNumber(evt->auth_status));
     Utility::Set(obj, "auth_status_name", ConversionUtility::valueToJsString(evt->auth_status, gap_sec_status_map));
@@ -1403,7 +1390,7 @@ v8::Local<v8::Object> GapAuthStatus::ToJs()
 v8::Local<v8::Object> GapConnSecUpdate::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "conn_sec", GapConnSec(&(evt->conn_sec)).ToJs());
     return scope.Escape(obj);
@@ -1415,7 +1402,7 @@ v8::Local<v8::Object> GapConnSecUpdate::ToJs()
 v8::Local<v8::Object> GapTimeout::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "src", evt->src);
     Utility::Set(obj, "src_name", ConversionUtility::valueToJsString(evt->src, gap_timeout_sources_map));
@@ -1429,7 +1416,7 @@ v8::Local<v8::Object> GapTimeout::ToJs()
 v8::Local<v8::Object> GapRssiChanged::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "rssi", evt->rssi);
 
@@ -1442,7 +1429,7 @@ v8::Local<v8::Object> GapRssiChanged::ToJs()
 v8::Local<v8::Object> GapAdvReport::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "rssi", evt->rssi);
     Utility::Set(obj, "peer_addr", GapAddr(&(this->evt->peer_addr)).ToJs());
@@ -1618,7 +1605,7 @@ v8::Local<v8::Object> GapAdvReport::ToJs()
 v8::Local<v8::Object> GapSecRequest::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "bond", ConversionUtility::toJsBool(evt->bond));
     Utility::Set(obj, "mitm", ConversionUtility::toJsBool(evt->mitm));
@@ -1633,7 +1620,7 @@ v8::Local<v8::Object> GapSecRequest::ToJs()
 v8::Local<v8::Object> GapScanReqReport::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "rssi", evt->rssi);
     Utility::Set(obj, "peer_addr", GapAddr(&(this->evt->peer_addr)).ToJs());
@@ -1647,7 +1634,7 @@ v8::Local<v8::Object> GapScanReqReport::ToJs()
 v8::Local<v8::Object> GapConnParamUpdateRequest::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverEvent::ToJs(obj);
     Utility::Set(obj, "conn_params", GapConnParams(&(this->evt->conn_params)).ToJs());
     return scope.Escape(obj);
@@ -1707,7 +1694,7 @@ NAN_METHOD(Adapter::GapSetAddress)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetAddress, reinterpret_cast<uv_after_work_cb>(AfterGapSetAddress));
+    QUEUE_BATON_WORK(baton, GapSetAddress);
 }
 
 void Adapter::GapSetAddress(uv_work_t *req)
@@ -1770,7 +1757,7 @@ NAN_METHOD(Adapter::GapGetAddress)
     baton->address = address;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetAddress, reinterpret_cast<uv_after_work_cb>(AfterGapGetAddress));
+    QUEUE_BATON_WORK(baton, GapGetAddress);
 
     return;
 }
@@ -1855,7 +1842,7 @@ NAN_METHOD(Adapter::GapUpdateConnectionParameters)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapUpdateConnectionParameters, reinterpret_cast<uv_after_work_cb>(AfterGapUpdateConnectionParameters));
+    QUEUE_BATON_WORK(baton, GapUpdateConnectionParameters);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1924,7 +1911,7 @@ NAN_METHOD(Adapter::GapDisconnect)
     baton->hci_status_code = hci_status_code;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapDisconnect, reinterpret_cast<uv_after_work_cb>(AfterGapDisconnect));
+    QUEUE_BATON_WORK(baton, GapDisconnect);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1987,7 +1974,7 @@ NAN_METHOD(Adapter::GapSetTXPower)
     baton->tx_power = tx_power;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetTXPower, reinterpret_cast<uv_after_work_cb>(AfterGapSetTXPower));
+    QUEUE_BATON_WORK(baton, GapSetTXPower);
 
 }
 
@@ -2073,7 +2060,7 @@ NAN_METHOD(Adapter::GapSetDeviceName)
     baton->length = (uint16_t)length;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetDeviceName, reinterpret_cast<uv_after_work_cb>(AfterGapSetDeviceName));
+    QUEUE_BATON_WORK(baton, GapSetDeviceName);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2134,7 +2121,7 @@ NAN_METHOD(Adapter::GapGetDeviceName)
     baton->dev_name.resize(baton->length);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetDeviceName, reinterpret_cast<uv_after_work_cb>(AfterGapGetDeviceName));
+    QUEUE_BATON_WORK(baton, GapGetDeviceName);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2213,7 +2200,7 @@ NAN_METHOD(Adapter::GapStartRSSI)
     baton->skip_count = skip_count;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStartRSSI, reinterpret_cast<uv_after_work_cb>(AfterGapStartRSSI));
+    QUEUE_BATON_WORK(baton, GapStartRSSI);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2275,7 +2262,7 @@ NAN_METHOD(Adapter::GapStopRSSI)
     baton->conn_handle = conn_handle;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStopRSSI, reinterpret_cast<uv_after_work_cb>(AfterGapStopRSSI));
+    QUEUE_BATON_WORK(baton, GapStopRSSI);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2353,7 +2340,7 @@ NAN_METHOD(Adapter::GapStartScan)
     baton->adapter = obj->adapter;
 
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStartScan, reinterpret_cast<uv_after_work_cb>(AfterGapStartScan));
+    QUEUE_BATON_WORK(baton, GapStartScan);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2415,7 +2402,7 @@ NAN_METHOD(Adapter::GapStopScan)
     auto baton = new StopScanBaton(callback);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStopScan, reinterpret_cast<uv_after_work_cb>(AfterGapStopScan));
+    QUEUE_BATON_WORK(baton, GapStopScan);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2518,7 +2505,7 @@ NAN_METHOD(Adapter::GapConnect)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GapConnect, reinterpret_cast<uv_after_work_cb>(AfterGapConnect));
+    QUEUE_BATON_WORK(baton, GapConnect);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2580,7 +2567,7 @@ NAN_METHOD(Adapter::GapCancelConnect)
     auto baton = new GapConnectCancelBaton(callback);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapCancelConnect, reinterpret_cast<uv_after_work_cb>(AfterGapCancelConnect));
+    QUEUE_BATON_WORK(baton, GapCancelConnect);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2642,7 +2629,7 @@ NAN_METHOD(Adapter::GapGetRSSI)
     baton->rssi = 0;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetRSSI, reinterpret_cast<uv_after_work_cb>(AfterGapGetRSSI));
+    QUEUE_BATON_WORK(baton, GapGetRSSI);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2740,7 +2727,7 @@ NAN_METHOD(Adapter::GapStartAdvertising)
 
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStartAdvertising, reinterpret_cast<uv_after_work_cb>(AfterGapStartAdvertising));
+    QUEUE_BATON_WORK(baton, GapStartAdvertising);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2806,7 +2793,7 @@ NAN_METHOD(Adapter::GapStopAdvertising)
     auto baton = new GapStopAdvertisingBaton(callback);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStopAdvertising, reinterpret_cast<uv_after_work_cb>(AfterGapStopAdvertising));
+    QUEUE_BATON_WORK(baton, GapStopAdvertising);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2869,7 +2856,7 @@ NAN_METHOD(Adapter::GapGetConnectionSecurity)
     baton->conn_sec = new ble_gap_conn_sec_t();
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetConnectionSecurity, reinterpret_cast<uv_after_work_cb>(AfterGapGetConnectionSecurity));
+    QUEUE_BATON_WORK(baton, GapGetConnectionSecurity);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2963,7 +2950,7 @@ NAN_METHOD(Adapter::GapEncrypt)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapEncrypt, reinterpret_cast<uv_after_work_cb>(AfterGapEncrypt));
+    QUEUE_BATON_WORK(baton, GapEncrypt);
 }
 
 void Adapter::GapEncrypt(uv_work_t *req)
@@ -3096,7 +3083,7 @@ NAN_METHOD(Adapter::GapReplySecurityParameters)
 
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapReplySecurityParameters, reinterpret_cast<uv_after_work_cb>(AfterGapReplySecurityParameters));
+    QUEUE_BATON_WORK(baton, GapReplySecurityParameters);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3218,7 +3205,7 @@ NAN_METHOD(Adapter::GapReplySecurityInfo)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapReplySecurityInfo, reinterpret_cast<uv_after_work_cb>(AfterGapReplySecurityInfo));
+    QUEUE_BATON_WORK(baton, GapReplySecurityInfo);
 }
 
 void Adapter::GapReplySecurityInfo(uv_work_t *req)
@@ -3293,7 +3280,7 @@ NAN_METHOD(Adapter::GapAuthenticate)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapAuthenticate, reinterpret_cast<uv_after_work_cb>(AfterGapAuthenticate));
+    QUEUE_BATON_WORK(baton, GapAuthenticate);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3387,7 +3374,7 @@ NAN_METHOD(Adapter::GapSetAdvertisingData)
     baton->srdlen = scan_response_length;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetAdvertisingData, reinterpret_cast<uv_after_work_cb>(AfterGapSetAdvertisingData));
+    QUEUE_BATON_WORK(baton, GapSetAdvertisingData);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3460,7 +3447,7 @@ NAN_METHOD(Adapter::GapSetPPCP)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetPPCP, reinterpret_cast<uv_after_work_cb>(AfterGapSetPPCP));
+    QUEUE_BATON_WORK(baton, GapSetPPCP);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3518,7 +3505,7 @@ NAN_METHOD(Adapter::GapGetPPCP)
     baton->p_conn_params = new ble_gap_conn_params_t();
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetPPCP, reinterpret_cast<uv_after_work_cb>(AfterGapGetPPCP));
+    QUEUE_BATON_WORK(baton, GapGetPPCP);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3582,7 +3569,7 @@ NAN_METHOD(Adapter::GapSetAppearance)
     baton->appearance = appearance;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetAppearance, reinterpret_cast<uv_after_work_cb>(AfterGapSetAppearance));
+    QUEUE_BATON_WORK(baton, GapSetAppearance);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3637,7 +3624,7 @@ NAN_METHOD(Adapter::GapGetAppearance)
     auto baton = new GapGetAppearanceBaton(callback);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetAppearance, reinterpret_cast<uv_after_work_cb>(AfterGapGetAppearance));
+    QUEUE_BATON_WORK(baton, GapGetAppearance);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3727,7 +3714,7 @@ NAN_METHOD(Adapter::GapReplyAuthKey)
     baton->key_type = key_type;
     baton->key = key;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapReplyAuthKey, reinterpret_cast<uv_after_work_cb>(AfterGapReplyAuthKey));
+    QUEUE_BATON_WORK(baton, GapReplyAuthKey);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3797,7 +3784,7 @@ NAN_METHOD(Adapter::GapReplyDHKeyLESC)
     baton->dhkey = dhkey;
     free(key);
 
-    uv_queue_work(uv_default_loop(), baton->req, GapReplyDHKeyLESC, reinterpret_cast<uv_after_work_cb>(AfterGapReplyDHKeyLESC));
+    QUEUE_BATON_WORK(baton, GapReplyDHKeyLESC);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3863,7 +3850,7 @@ NAN_METHOD(Adapter::GapNotifyKeypress)
     baton->conn_handle = conn_handle;
     baton->kp_not = kp_not;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapNotifyKeypress, reinterpret_cast<uv_after_work_cb>(AfterGapNotifyKeypress));
+    QUEUE_BATON_WORK(baton, GapNotifyKeypress);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3934,7 +3921,7 @@ NAN_METHOD(Adapter::GapGetLESCOOBData)
     baton->p_pk_own = p_pk_own;
     baton->p_oobd_own = new ble_gap_lesc_oob_data_t();
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetLESCOOBData, reinterpret_cast<uv_after_work_cb>(AfterGapGetLESCOOBData));
+    QUEUE_BATON_WORK(baton, GapGetLESCOOBData);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -4027,7 +4014,7 @@ NAN_METHOD(Adapter::GapSetLESCOOBData)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetLESCOOBData, reinterpret_cast<uv_after_work_cb>(AfterGapSetLESCOOBData));
+    QUEUE_BATON_WORK(baton, GapSetLESCOOBData);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -4107,7 +4094,7 @@ NAN_METHOD(Adapter::GapDataLengthUpdate)
 
     baton->p_dl_limitation = new ble_gap_data_length_limitation_t();
 
-    uv_queue_work(uv_default_loop(), baton->req, GapDataLengthUpdate, reinterpret_cast<uv_after_work_cb>(AfterGapDataLengthUpdate));
+    QUEUE_BATON_WORK(baton, GapDataLengthUpdate);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -4188,7 +4175,7 @@ NAN_METHOD(Adapter::GapPhyUpdate)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GapPhyUpdate, reinterpret_cast<uv_after_work_cb>(AfterGapPhyUpdate));
+    QUEUE_BATON_WORK(baton, GapPhyUpdate);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -4229,9 +4216,47 @@ void Adapter::AfterGapPhyUpdate(uv_work_t *req)
 #pragma endregion JavaScript function implementations
 
 #pragma region JavaScript constants from ble_gap.h
+static void init_gap_event_templates()
+{
+    EventTemplate::Register(BLE_GAP_EVT_CONNECTED, { EVENT_TEMPLATE_HEADER, "peer_addr", "role", "conn_params"
+#if NRF_SD_BLE_API_VERSION == 2
+        , "own_addr", "irk_match"
+#endif
+    });
+    EventTemplate::Register(BLE_GAP_EVT_DISCONNECTED, { EVENT_TEMPLATE_HEADER, "reason", "reason_name" });
+    EventTemplate::Register(BLE_GAP_EVT_CONN_PARAM_UPDATE, { EVENT_TEMPLATE_HEADER, "conn_params" });
+    EventTemplate::Register(BLE_GAP_EVT_SEC_PARAMS_REQUEST, { EVENT_TEMPLATE_HEADER, "peer_params" });
+    EventTemplate::Register(BLE_GAP_EVT_SEC_INFO_REQUEST, { EVENT_TEMPLATE_HEADER, "peer_addr", "master_id", "enc_info", "id_info", "sign_info" });
+    EventTemplate::Register(BLE_GAP_EVT_PASSKEY_DISPLAY, { EVENT_TEMPLATE_HEADER, "match_request", "passkey" });
+    EventTemplate::Register(BLE_GAP_EVT_KEY_PRESSED, { EVENT_TEMPLATE_HEADER, "kp_not" });
+    EventTemplate::Register(BLE_GAP_EVT_AUTH_KEY_REQUEST, { EVENT_TEMPLATE_HEADER, "key_type" });
+    EventTemplate::Register(BLE_GAP_EVT_LESC_DHKEY_REQUEST, { EVENT_TEMPLATE_HEADER, "oobd_req", "pk_peer" });
+    EventTemplate::Register(BLE_GAP_EVT_AUTH_STATUS, { EVENT_TEMPLATE_HEADER, "auth_status", "auth_status_name", "error_src", "error_src_name", "bonded",
+                                                       "sm1_levels", "sm2_levels", "kdist_own", "kdist_peer"
+#if NRF_SD_BLE_API_VERSION >= 5
+        , "lesc"
+#endif
+    });
+    EventTemplate::Register(BLE_GAP_EVT_CONN_SEC_UPDATE, { EVENT_TEMPLATE_HEADER, "conn_sec" });
+    EventTemplate::Register(BLE_GAP_EVT_TIMEOUT, { EVENT_TEMPLATE_HEADER, "src", "src_name" });
+    EventTemplate::Register(BLE_GAP_EVT_RSSI_CHANGED, { EVENT_TEMPLATE_HEADER, "rssi" });
+    EventTemplate::Register(BLE_GAP_EVT_ADV_REPORT, { EVENT_TEMPLATE_HEADER, "rssi", "peer_addr", "scan_rsp" });
+    EventTemplate::Register(BLE_GAP_EVT_SEC_REQUEST, { EVENT_TEMPLATE_HEADER, "bond", "mitm", "lesc", "keypress" });
+    EventTemplate::Register(BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST, { EVENT_TEMPLATE_HEADER, "conn_params" });
+    EventTemplate::Register(BLE_GAP_EVT_SCAN_REQ_REPORT, { EVENT_TEMPLATE_HEADER, "rssi", "peer_addr" });
+#if NRF_SD_BLE_API_VERSION >= 5
+    EventTemplate::Register(BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST, { EVENT_TEMPLATE_HEADER, "peer_params" });
+    EventTemplate::Register(BLE_GAP_EVT_DATA_LENGTH_UPDATE, { EVENT_TEMPLATE_HEADER, "effective_params" });
+    EventTemplate::Register(BLE_GAP_EVT_PHY_UPDATE_REQUEST, { EVENT_TEMPLATE_HEADER, "peer_preferred_phys" });
+    EventTemplate::Register(BLE_GAP_EVT_PHY_UPDATE, { EVENT_TEMPLATE_HEADER, "status", "tx_phy", "rx_phy" });
+#endif // NRF_SD_BLE_API_VERSION >= 5
+}
+
 extern "C" {
     void init_gap(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target)
     {
+        init_gap_event_templates();
+
         // Constants from ble_gap.h
 
         /* GAP Event IDs.
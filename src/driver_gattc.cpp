@@ -34,11 +34,15 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <sstream>
+
 #include "driver_gattc.h"
 #include "ble_err.h"
 
 #include "driver.h"
 #include "driver_gatt.h"
+#include "struct_schema.h"
 
 static name_map_t gattc_svcs_type_map =
 {
@@ -58,14 +62,20 @@ static name_map_t gattc_svcs_type_map =
 // GattcHandleRange -- START --
 //
 
-v8::Local<v8::Object> GattcHandleRange::ToJs()
+template<>
+struct StructSchema<ble_gattc_handle_range_t>
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-    Utility::Set(obj, "start_handle", native->start_handle);
-    Utility::Set(obj, "end_handle", native->end_handle);
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("start_handle", &ble_gattc_handle_range_t::start_handle),
+            schemaField("end_handle", &ble_gattc_handle_range_t::end_handle));
+    }
+};
 
-    return scope.Escape(obj);
+v8::Local<v8::Object> GattcHandleRange::ToJs()
+{
+    return StructMarshaller<ble_gattc_handle_range_t>::toJs(*native);
 }
 
 ble_gattc_handle_range_t *GattcHandleRange::ToNative()
@@ -75,12 +85,7 @@ ble_gattc_handle_range_t *GattcHandleRange::ToNative()
         return nullptr;
     }
 
-    auto handleRange = new ble_gattc_handle_range_t();
-
-    handleRange->start_handle = ConversionUtility::getNativeUint16(jsobj, "start_handle");
-    handleRange->end_handle = ConversionUtility::getNativeUint16(jsobj, "end_handle");
-
-    return handleRange;
+    return StructMarshaller<ble_gattc_handle_range_t>::newNative(jsobj);
 }
 
 //
@@ -166,6 +171,21 @@ v8::Local<v8::Object> GattcDescriptor::ToJs()
 // GattcWriteParameters -- START --
 //
 
+template<>
+struct StructSchema<ble_gattc_write_params_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("write_op", &ble_gattc_write_params_t::write_op),
+            schemaField("flags", &ble_gattc_write_params_t::flags),
+            schemaField("handle", &ble_gattc_write_params_t::handle),
+            schemaField("offset", &ble_gattc_write_params_t::offset),
+            schemaField("len", &ble_gattc_write_params_t::len),
+            schemaField<SchemaConversion::ByteArray<ble_gattc_write_params_t, &ble_gattc_write_params_t::len>>("value", &ble_gattc_write_params_t::p_value));
+    }
+};
+
 ble_gattc_write_params_t *GattcWriteParameters::ToNative()
 {
     if (Utility::IsNull(jsobj))
@@ -173,30 +193,31 @@ ble_gattc_write_params_t *GattcWriteParameters::ToNative()
         return nullptr;
     }
 
-    auto writeparams = new ble_gattc_write_params_t();
+    auto writeparams = allocate<ble_gattc_write_params_t>();
+    const auto converted = read(jsobj, writeparams, arena);
+
+    if (!converted)
+    {
+        if (arena == nullptr)
+        {
+            free((char*)(writeparams->p_value));
+            delete writeparams;
+        }
 
-    writeparams->write_op = ConversionUtility::getNativeUint8(jsobj, "write_op");
-    writeparams->flags = ConversionUtility::getNativeUint8(jsobj, "flags");
-    writeparams->handle = ConversionUtility::getNativeUint16(jsobj, "handle");
-    writeparams->offset = ConversionUtility::getNativeUint16(jsobj, "offset");
-    writeparams->len = ConversionUtility::getNativeUint16(jsobj, "len");
-    writeparams->p_value = ConversionUtility::getNativePointerToUint8(jsobj, "value");
+        throw converted.error().message();
+    }
 
     return writeparams;
 }
 
-v8::Local<v8::Object> GattcWriteParameters::ToJs()
+Expected<ble_gattc_write_params_t *> GattcWriteParameters::read(v8::Local<v8::Object> js, ble_gattc_write_params_t *writeparams, ConversionArena *arena)
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-    Utility::Set(obj, "write_op", native->write_op);
-    Utility::Set(obj, "flags", native->flags);
-    Utility::Set(obj, "handle", native->handle);
-    Utility::Set(obj, "offset", native->offset);
-    Utility::Set(obj, "len", native->len);
-    Utility::Set(obj, "value", ConversionUtility::toJsValueArray(native->p_value, native->len));
+    return StructMarshaller<ble_gattc_write_params_t>::toNative(js, writeparams, arena);
+}
 
-    return scope.Escape(obj);
+v8::Local<v8::Object> GattcWriteParameters::ToJs()
+{
+    return StructMarshaller<ble_gattc_write_params_t>::toJs(*native);
 }
 
 //
@@ -206,7 +227,7 @@ v8::Local<v8::Object> GattcWriteParameters::ToJs()
 v8::Local<v8::Object> GattcPrimaryServiceDiscoveryEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "count", evt->count);
@@ -226,7 +247,7 @@ v8::Local<v8::Object> GattcPrimaryServiceDiscoveryEvent::ToJs()
 v8::Local<v8::Object> GattcRelationshipDiscoveryEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "count", evt->count);
@@ -246,7 +267,7 @@ v8::Local<v8::Object> GattcRelationshipDiscoveryEvent::ToJs()
 v8::Local<v8::Object> GattcCharacteristicDiscoveryEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "count", evt->count);
@@ -266,7 +287,7 @@ v8::Local<v8::Object> GattcCharacteristicDiscoveryEvent::ToJs()
 v8::Local<v8::Object> GattcDescriptorDiscoveryEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "count", evt->count);
@@ -296,7 +317,7 @@ v8::Local<v8::Object> GattcHandleValue::ToJs()
 v8::Local<v8::Object> GattcCharacteristicValueReadByUUIDEvent::ToJs()
 {
 	Nan::EscapableHandleScope scope;
-	v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+	v8::Local<v8::Object> obj = NewEventObject();
 	BleDriverGattcEvent::ToJs(obj);
 	Utility::Set(obj, "count", evt->count);
 	Utility::Set(obj, "value_len", evt->value_len);
@@ -321,7 +342,7 @@ v8::Local<v8::Object> GattcCharacteristicValueReadByUUIDEvent::ToJs()
 v8::Local<v8::Object> GattcReadEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "handle", evt->handle);
@@ -335,7 +356,7 @@ v8::Local<v8::Object> GattcReadEvent::ToJs()
 v8::Local<v8::Object> GattcCharacteristicValueReadEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "len", evt->len);
@@ -347,7 +368,7 @@ v8::Local<v8::Object> GattcCharacteristicValueReadEvent::ToJs()
 v8::Local<v8::Object> GattcWriteEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "handle", evt->handle);
@@ -362,7 +383,7 @@ v8::Local<v8::Object> GattcWriteEvent::ToJs()
 v8::Local<v8::Object> GattcHandleValueNotificationEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "handle", evt->handle);
@@ -376,7 +397,7 @@ v8::Local<v8::Object> GattcHandleValueNotificationEvent::ToJs()
 v8::Local<v8::Object> GattcTimeoutEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "src", evt->src);
@@ -388,7 +409,7 @@ v8::Local<v8::Object> GattcTimeoutEvent::ToJs()
 v8::Local<v8::Object> GattcExchangeMtuResponseEvent::ToJs()
 {
 	Nan::EscapableHandleScope scope;
-	v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+	v8::Local<v8::Object> obj = NewEventObject();
 	BleDriverGattcEvent::ToJs(obj);
 
 	Utility::Set(obj, "server_rx_mtu", evt->server_rx_mtu);
@@ -399,7 +420,7 @@ v8::Local<v8::Object> GattcExchangeMtuResponseEvent::ToJs()
 v8::Local<v8::Object> GattcWriteCmdTxCompleteEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattcEvent::ToJs(obj);
 
     Utility::Set(obj, "count", ConversionUtility::toJsNumber(evt->count));
@@ -454,7 +475,7 @@ NAN_METHOD(Adapter::GattcDiscoverPrimaryServices)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcDiscoverPrimaryServices, reinterpret_cast<uv_after_work_cb>(AfterGattcDiscoverPrimaryServices));
+    QUEUE_BATON_WORK(baton, GattcDiscoverPrimaryServices);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -528,7 +549,7 @@ NAN_METHOD(Adapter::GattcDiscoverRelationship)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcDiscoverRelationship, reinterpret_cast<uv_after_work_cb>(AfterGattcDiscoverRelationship));
+    QUEUE_BATON_WORK(baton, GattcDiscoverRelationship);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -602,7 +623,7 @@ NAN_METHOD(Adapter::GattcDiscoverCharacteristics)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcDiscoverCharacteristics, reinterpret_cast<uv_after_work_cb>(AfterGattcDiscoverCharacteristics));
+    QUEUE_BATON_WORK(baton, GattcDiscoverCharacteristics);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -676,7 +697,7 @@ NAN_METHOD(Adapter::GattcDiscoverDescriptors)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcDiscoverDescriptors, reinterpret_cast<uv_after_work_cb>(AfterGattcDiscoverDescriptors));
+    QUEUE_BATON_WORK(baton, GattcDiscoverDescriptors);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -765,7 +786,7 @@ NAN_METHOD(Adapter::GattcReadCharacteristicValueByUUID)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcReadCharacteristicValueByUUID, reinterpret_cast<uv_after_work_cb>(AfterGattcReadCharacteristicValueByUUID));
+    QUEUE_BATON_WORK(baton, GattcReadCharacteristicValueByUUID);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -834,7 +855,7 @@ NAN_METHOD(Adapter::GattcRead)
     baton->handle = handle;
     baton->offset = offset;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcRead, reinterpret_cast<uv_after_work_cb>(AfterGattcRead));
+    QUEUE_BATON_WORK(baton, GattcRead);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -906,6 +927,7 @@ NAN_METHOD(Adapter::GattcReadCharacteristicValues)
     }
     catch (std::string error)
     {
+        free(p_handles);
         v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("handles", error);
         Nan::ThrowTypeError(message);
         return;
@@ -918,7 +940,7 @@ NAN_METHOD(Adapter::GattcReadCharacteristicValues)
     baton->p_handles = p_handles;
     baton->handle_count = handle_count;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcReadCharacteristicValues, reinterpret_cast<uv_after_work_cb>(AfterGattcReadCharacteristicValues));
+    QUEUE_BATON_WORK(baton, GattcReadCharacteristicValues);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -951,28 +973,17 @@ void Adapter::AfterGattcReadCharacteristicValues(uv_work_t *req)
 }
 
 
+// Called for every write, arguments are converted without exceptions
 NAN_METHOD(Adapter::GattcWrite)
 {
-    uint16_t conn_handle;
-    v8::Local<v8::Object> p_write_params;
-    v8::Local<v8::Function> callback;
-    auto argumentcount = 0;
+    ArgumentReader arguments(info);
+    const auto conn_handle = arguments.next<uint16_t>();
+    const auto p_write_params = arguments.next<v8::Local<v8::Object>>();
+    const auto callback = arguments.next<v8::Local<v8::Function>>();
 
-    try
+    if (!arguments.ok())
     {
-        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
-        argumentcount++;
-
-        p_write_params = ConversionUtility::getJsObject(info[argumentcount]);
-        argumentcount++;
-
-        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
-        argumentcount++;
-    }
-    catch (std::string error)
-    {
-        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
-        Nan::ThrowTypeError(message);
+        arguments.throwTypeError();
         return;
     }
 
@@ -980,19 +991,18 @@ NAN_METHOD(Adapter::GattcWrite)
     auto baton = new GattcWriteBaton(callback);
     baton->adapter = obj->adapter;
     baton->conn_handle = conn_handle;
+    baton->p_write_params = baton->arena.create<ble_gattc_write_params_t>();
 
-    try
-    {
-        baton->p_write_params = GattcWriteParameters(p_write_params);
-    }
-    catch (std::string error)
+    const auto converted = GattcWriteParameters::read(p_write_params, baton->p_write_params, &baton->arena);
+
+    if (!converted)
     {
-        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("write_params", error);
-        Nan::ThrowTypeError(message);
+        Nan::ThrowTypeError(ErrorMessage::getStructErrorMessage("write_params", converted.error().message()));
+        delete baton;
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcWrite, reinterpret_cast<uv_after_work_cb>(AfterGattcWrite));
+    QUEUE_BATON_WORK(baton, GattcWrite);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1055,7 +1065,7 @@ NAN_METHOD(Adapter::GattcConfirmHandleValue)
     baton->conn_handle = conn_handle;
     baton->handle = handle;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcConfirmHandleValue, reinterpret_cast<uv_after_work_cb>(AfterGattcConfirmHandleValue));
+    QUEUE_BATON_WORK(baton, GattcConfirmHandleValue);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1119,7 +1129,7 @@ NAN_METHOD(Adapter::GattcExchangeMtuRequest)
     baton->conn_handle = conn_handle;
     baton->client_rx_mtu = client_rx_mtu;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcExchangeMtuRequest, reinterpret_cast<uv_after_work_cb>(AfterGattcExchangeMtuRequest));
+    QUEUE_BATON_WORK(baton, GattcExchangeMtuRequest);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1152,9 +1162,698 @@ void Adapter::AfterGattcExchangeMtuRequest(uv_work_t *req)
 }
 #endif
 
+NAN_METHOD(Adapter::GattcDiscoverAll)
+{
+    uint16_t conn_handle;
+    bool read_values;
+    v8::Local<v8::Object> options;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+    uint16_t att_mtu = 0;
+
+    try
+    {
+        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        read_values = ConversionUtility::getBool(info[argumentcount]);
+        argumentcount++;
+
+        options = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    try
+    {
+        if (Utility::Has(options, "att_mtu"))
+        {
+            att_mtu = ConversionUtility::getNativeUint16(options, "att_mtu");
+        }
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("options", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    auto baton = new GattcDiscoverAllBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->conn_handle = conn_handle;
+
+    auto discovery = std::make_shared<GattcDiscovery>(obj->adapter, conn_handle, read_values, att_mtu, callback);
+
+    if (obj->addGattcProcedure(discovery))
+    {
+        baton->procedure = discovery;
+    }
+
+    QUEUE_BATON_WORK(baton, GattcDiscoverAll);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattcDiscoverAll(uv_work_t *req)
+{
+    auto baton = static_cast<GattcDiscoverAllBaton *>(req->data);
+
+    if (baton->procedure == nullptr)
+    {
+        baton->result = NRF_ERROR_BUSY;
+        return;
+    }
+
+    baton->result = baton->mainObject->startGattcProcedure(baton->procedure.get());
+}
+
+// This runs in Main Thread
+void Adapter::AfterGattcDiscoverAll(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GattcDiscoverAllBaton *>(req->data);
+
+    // The discovery result is sent to the callback by Adapter::completeGattcProcedures when the procedure is done
+    if (baton->result != NRF_SUCCESS)
+    {
+        if (baton->procedure != nullptr)
+        {
+            baton->mainObject->removeGattcProcedure(baton->procedure);
+        }
+
+        v8::Local<v8::Value> argv[1];
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "starting attribute discovery");
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        baton->callback->Call(1, argv, &resource);
+    }
+
+    delete baton;
+}
+
+NAN_METHOD(Adapter::GattcReadLong)
+{
+    uint16_t conn_handle;
+    uint16_t handle;
+    v8::Local<v8::Object> options;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+    uint16_t att_mtu = 0;
+
+    try
+    {
+        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        options = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    try
+    {
+        if (Utility::Has(options, "att_mtu"))
+        {
+            att_mtu = ConversionUtility::getNativeUint16(options, "att_mtu");
+        }
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("options", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    auto baton = new GattcReadLongBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->conn_handle = conn_handle;
+
+    auto readLong = std::make_shared<::GattcReadLong>(obj->adapter, conn_handle, handle, att_mtu, callback);
+
+    if (obj->addGattcProcedure(readLong))
+    {
+        baton->procedure = readLong;
+    }
+
+    QUEUE_BATON_WORK(baton, GattcReadLong);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattcReadLong(uv_work_t *req)
+{
+    auto baton = static_cast<GattcReadLongBaton *>(req->data);
+
+    if (baton->procedure == nullptr)
+    {
+        baton->result = NRF_ERROR_BUSY;
+        return;
+    }
+
+    baton->result = baton->mainObject->startGattcProcedure(baton->procedure.get());
+}
+
+// This runs in Main Thread
+void Adapter::AfterGattcReadLong(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GattcReadLongBaton *>(req->data);
+
+    // The value is sent to the callback by Adapter::completeGattcProcedures when the procedure is done
+    if (baton->result != NRF_SUCCESS)
+    {
+        if (baton->procedure != nullptr)
+        {
+            baton->mainObject->removeGattcProcedure(baton->procedure);
+        }
+
+        v8::Local<v8::Value> argv[1];
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "starting long read");
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        baton->callback->Call(1, argv, &resource);
+    }
+
+    delete baton;
+}
+
+NAN_METHOD(Adapter::GattcWriteLong)
+{
+    uint16_t conn_handle;
+    uint16_t handle;
+    std::vector<uint8_t> value;
+    v8::Local<v8::Object> options;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+    auto reliable = false;
+    uint16_t att_mtu = 0;
+
+    try
+    {
+        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        if (!node::Buffer::HasInstance(info[argumentcount]))
+        {
+            throw std::string("buffer");
+        }
+
+        // The offset of a Prepare Write Request is 16 bits, longer values can not be written
+        const auto length = node::Buffer::Length(info[argumentcount]);
+
+        if (length > ATTRIBUTE_VALUE_MAX_LENGTH)
+        {
+            throw std::string("buffer of at most 512 bytes");
+        }
+
+        const auto data = reinterpret_cast<const uint8_t *>(node::Buffer::Data(info[argumentcount]));
+        value.assign(data, data + length);
+        argumentcount++;
+
+        options = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    try
+    {
+        if (Utility::Has(options, "reliable"))
+        {
+            reliable = ConversionUtility::getBool(options, "reliable");
+        }
+
+        if (Utility::Has(options, "att_mtu"))
+        {
+            att_mtu = ConversionUtility::getNativeUint16(options, "att_mtu");
+        }
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("options", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    auto baton = new GattcWriteLongBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->conn_handle = conn_handle;
+
+    auto writeLong = std::make_shared<::GattcWriteLong>(obj->adapter, conn_handle, handle, std::move(value), att_mtu, reliable, callback);
+
+    if (obj->addGattcProcedure(writeLong))
+    {
+        baton->procedure = writeLong;
+    }
+
+    QUEUE_BATON_WORK(baton, GattcWriteLong);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattcWriteLong(uv_work_t *req)
+{
+    auto baton = static_cast<GattcWriteLongBaton *>(req->data);
+
+    if (baton->procedure == nullptr)
+    {
+        baton->result = NRF_ERROR_BUSY;
+        return;
+    }
+
+    baton->result = baton->mainObject->startGattcProcedure(baton->procedure.get());
+}
+
+// This runs in Main Thread
+void Adapter::AfterGattcWriteLong(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GattcWriteLongBaton *>(req->data);
+
+    // The result is sent to the callback by Adapter::completeGattcProcedures when the procedure is done
+    if (baton->result != NRF_SUCCESS)
+    {
+        if (baton->procedure != nullptr)
+        {
+            baton->mainObject->removeGattcProcedure(baton->procedure);
+        }
+
+        v8::Local<v8::Value> argv[1];
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "starting long write");
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        baton->callback->Call(1, argv, &resource);
+    }
+
+    delete baton;
+}
+
+#if NRF_SD_BLE_API_VERSION >= 5
+NAN_METHOD(Adapter::GattcWriteStream)
+{
+    uint16_t conn_handle;
+    uint16_t handle;
+    std::vector<std::vector<uint8_t>> chunks;
+    v8::Local<v8::Value> data;
+    v8::Local<v8::Object> options;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+    uint16_t att_mtu = BLE_GATT_ATT_MTU_DEFAULT;
+
+    try
+    {
+        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        data = info[argumentcount];
+
+        if (!data->IsArray() && !node::Buffer::HasInstance(data))
+        {
+            throw std::string("buffer or array of buffers");
+        }
+
+        argumentcount++;
+
+        options = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    try
+    {
+        if (Utility::Has(options, "att_mtu"))
+        {
+            att_mtu = std::max(ConversionUtility::getNativeUint16(options, "att_mtu"), static_cast<uint16_t>(BLE_GATT_ATT_MTU_DEFAULT));
+        }
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("options", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    if (data->IsArray())
+    {
+        // Each buffer is sent as one write command
+        auto array = data.As<v8::Array>();
+
+        for (uint32_t i = 0; i < array->Length(); i++)
+        {
+            auto chunk = Nan::Get(array, i).ToLocalChecked();
+
+            if (!node::Buffer::HasInstance(chunk))
+            {
+                Nan::ThrowTypeError(ErrorMessage::getStructErrorMessage("chunks", "buffer"));
+                return;
+            }
+
+            const auto bytes = reinterpret_cast<const uint8_t *>(node::Buffer::Data(chunk));
+            chunks.emplace_back(bytes, bytes + node::Buffer::Length(chunk));
+        }
+    }
+    else
+    {
+        // Split the buffer into the largest write commands the ATT_MTU allows, opcode (1 byte) and handle (2 bytes)
+        const size_t chunkSize = att_mtu - 3;
+        const auto bytes = reinterpret_cast<const uint8_t *>(node::Buffer::Data(data));
+        const auto length = node::Buffer::Length(data);
+
+        for (size_t offset = 0; offset < length; offset += chunkSize)
+        {
+            chunks.emplace_back(bytes + offset, bytes + std::min(length, offset + chunkSize));
+        }
+    }
+
+    // The procedure finishes when a TX complete event arrives, there has to be something to send
+    if (chunks.empty())
+    {
+        Nan::ThrowTypeError(ErrorMessage::getTypeErrorMessage(2, "non-empty buffer or array of buffers"));
+        return;
+    }
+
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    auto baton = new GattcWriteStreamBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->conn_handle = conn_handle;
+
+    auto writeStream = std::make_shared<::GattcWriteStream>(obj->adapter, conn_handle, handle, std::move(chunks), callback);
+
+    if (obj->addGattcProcedure(writeStream))
+    {
+        baton->procedure = writeStream;
+    }
+
+    QUEUE_BATON_WORK(baton, GattcWriteStream);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattcWriteStream(uv_work_t *req)
+{
+    auto baton = static_cast<GattcWriteStreamBaton *>(req->data);
+
+    if (baton->procedure == nullptr)
+    {
+        baton->result = NRF_ERROR_BUSY;
+        return;
+    }
+
+    baton->result = baton->mainObject->startGattcProcedure(baton->procedure.get());
+}
+
+// This runs in Main Thread
+void Adapter::AfterGattcWriteStream(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GattcWriteStreamBaton *>(req->data);
+
+    // The result is sent to the callback by Adapter::completeGattcProcedures when the procedure is done
+    if (baton->result != NRF_SUCCESS)
+    {
+        if (baton->procedure != nullptr)
+        {
+            baton->mainObject->removeGattcProcedure(baton->procedure);
+        }
+
+        v8::Local<v8::Value> argv[1];
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "starting write stream");
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        baton->callback->Call(1, argv, &resource);
+    }
+
+    delete baton;
+}
+#endif
+
+bool Adapter::addGattcProcedure(std::shared_ptr<GattcProcedure> procedure)
+{
+    uv_mutex_lock(&gattcProcedureMutex);
+
+    const auto added = gattcProcedures.emplace(procedure->getConnHandle(), procedure).second;
+    gattcProcedureCount = static_cast<uint32_t>(gattcProcedures.size());
+
+    uv_mutex_unlock(&gattcProcedureMutex);
+
+    return added;
+}
+
+void Adapter::removeGattcProcedure(const std::shared_ptr<GattcProcedure> &procedure)
+{
+    uv_mutex_lock(&gattcProcedureMutex);
+
+    const auto it = gattcProcedures.find(procedure->getConnHandle());
+
+    if (it != gattcProcedures.end() && it->second == procedure)
+    {
+        gattcProcedures.erase(it);
+    }
+
+    gattcProcedureCount = static_cast<uint32_t>(gattcProcedures.size());
+
+    uv_mutex_unlock(&gattcProcedureMutex);
+}
+
+// This runs in a worker thread (not Main Thread)
+uint32_t Adapter::startGattcProcedure(GattcProcedure *procedure)
+{
+    // Hold the lock while sending the first request so the response is not handled before the procedure has started
+    uv_mutex_lock(&gattcProcedureMutex);
+    const auto err_code = procedure->start();
+    uv_mutex_unlock(&gattcProcedureMutex);
+
+    return err_code;
+}
+
+// This runs in thread SerializationTransport::eventThread
+bool Adapter::handleGattcProcedureEvent(ble_evt_t *event)
+{
+    if (gattcProcedureCount == 0)
+    {
+        return false;
+    }
+
+    uint16_t conn_handle;
+    const auto evt_id = event->header.evt_id;
+
+    if (evt_id == BLE_GAP_EVT_DISCONNECTED)
+    {
+        conn_handle = event->evt.gap_evt.conn_handle;
+    }
+    else if (evt_id >= BLE_GATTC_EVT_BASE && evt_id <= BLE_GATTC_EVT_LAST)
+    {
+        conn_handle = event->evt.gattc_evt.conn_handle;
+    }
+    else
+    {
+        return false;
+    }
+
+    auto consumed = false;
+    auto finished = false;
+
+    uv_mutex_lock(&gattcProcedureMutex);
+
+    const auto it = gattcProcedures.find(conn_handle);
+
+    if (it != gattcProcedures.end())
+    {
+        consumed = it->second->onEvent(event);
+        finished = it->second->isFinished();
+    }
+
+    uv_mutex_unlock(&gattcProcedureMutex);
+
+    if (finished)
+    {
+        uv_mutex_lock(&adapterCloseMutex);
+
+        if (asyncGattcProcedure != nullptr)
+        {
+            uv_async_send(asyncGattcProcedure.get());
+        }
+
+        uv_mutex_unlock(&adapterCloseMutex);
+    }
+
+    return consumed;
+}
+
+// Now we are in the NodeJS thread. Call callbacks.
+void Adapter::onGattcProcedureEvent(uv_async_t *handle)
+{
+    completeGattcProcedures();
+}
+
+void Adapter::abortGattcProcedures()
+{
+    uv_mutex_lock(&gattcProcedureMutex);
+
+    for (auto &entry : gattcProcedures)
+    {
+        // Procedures not started yet are reported by the After function of the method that started them
+        if (entry.second->isStarted())
+        {
+            entry.second->abort(NRF_ERROR_INVALID_STATE, "adapter closed");
+        }
+    }
+
+    uv_mutex_unlock(&gattcProcedureMutex);
+
+    completeGattcProcedures();
+}
+
+static v8::Local<v8::Value> gattcProcedureErrorToJs(const GattcProcedure &procedure)
+{
+    Nan::EscapableHandleScope scope;
+
+    if (procedure.getErrorCode() != NRF_SUCCESS)
+    {
+        return scope.Escape(ErrorMessage::getErrorMessage(procedure.getErrorCode(), procedure.getErrorOperation()));
+    }
+
+    if (procedure.getGattStatus() != BLE_GATT_STATUS_SUCCESS)
+    {
+        const auto gattStatus = procedure.getGattStatus();
+        const auto gattStatusName = ConversionUtility::valueToString(gattStatus, gatt_status_map, "Unknown GATT status");
+
+        std::ostringstream errorStringStream;
+        errorStringStream << "Error occured when " << procedure.getErrorOperation() << ". "
+            << "GATT status: " << gattStatusName << " (0x" << std::hex << gattStatus << ")";
+
+        v8::Local<v8::Value> error = Nan::Error(errorStringStream.str().c_str());
+        v8::Local<v8::Object> errorObject = error.As<v8::Object>();
+
+        Utility::Set(errorObject, "gatt_status", gattStatus);
+        Utility::Set(errorObject, "gatt_status_name", gattStatusName);
+        Utility::Set(errorObject, "erroperation", ConversionUtility::toJsString(procedure.getErrorOperation()));
+
+        return scope.Escape(error);
+    }
+
+    return scope.Escape(Nan::Undefined());
+}
+
+// This runs in Main Thread
+void Adapter::completeGattcProcedures()
+{
+    std::vector<std::shared_ptr<GattcProcedure>> finished;
+
+    uv_mutex_lock(&gattcProcedureMutex);
+
+    for (auto it = gattcProcedures.begin(); it != gattcProcedures.end();)
+    {
+        if (it->second->isFinished())
+        {
+            finished.push_back(it->second);
+            it = gattcProcedures.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    gattcProcedureCount = static_cast<uint32_t>(gattcProcedures.size());
+
+    uv_mutex_unlock(&gattcProcedureMutex);
+
+    for (auto &procedure : finished)
+    {
+        Nan::HandleScope scope;
+        v8::Local<v8::Value> argv[2];
+
+        argv[0] = gattcProcedureErrorToJs(*procedure);
+
+        if (argv[0]->IsUndefined())
+        {
+            argv[1] = procedure->resultToJs();
+        }
+        else
+        {
+            argv[1] = Nan::Undefined();
+        }
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        procedure->callback->Call(2, argv, &resource);
+    }
+}
+
+static void init_gattc_event_templates()
+{
+    EventTemplate::Register(BLE_GATTC_EVT_PRIM_SRVC_DISC_RSP, { GATTC_EVENT_TEMPLATE_HEADER, "count", "services" });
+    EventTemplate::Register(BLE_GATTC_EVT_REL_DISC_RSP, { GATTC_EVENT_TEMPLATE_HEADER, "count", "includes" });
+    EventTemplate::Register(BLE_GATTC_EVT_CHAR_DISC_RSP, { GATTC_EVENT_TEMPLATE_HEADER, "count", "chars" });
+    EventTemplate::Register(BLE_GATTC_EVT_DESC_DISC_RSP, { GATTC_EVENT_TEMPLATE_HEADER, "count", "descs" });
+    EventTemplate::Register(BLE_GATTC_EVT_CHAR_VAL_BY_UUID_READ_RSP, { GATTC_EVENT_TEMPLATE_HEADER, "count", "value_len"
+#if NRF_SD_BLE_API_VERSION <= 2
+        , "handle_values"
+#endif
+    });
+    EventTemplate::Register(BLE_GATTC_EVT_READ_RSP, { GATTC_EVENT_TEMPLATE_HEADER, "handle", "offset", "len", "data" });
+    EventTemplate::Register(BLE_GATTC_EVT_CHAR_VALS_READ_RSP, { GATTC_EVENT_TEMPLATE_HEADER, "len", "values" });
+    EventTemplate::Register(BLE_GATTC_EVT_WRITE_RSP, { GATTC_EVENT_TEMPLATE_HEADER, "handle", "write_op", "offset", "len", "data" });
+    EventTemplate::Register(BLE_GATTC_EVT_HVX, { GATTC_EVENT_TEMPLATE_HEADER, "handle", "type", "len", "data" });
+    EventTemplate::Register(BLE_GATTC_EVT_TIMEOUT, { GATTC_EVENT_TEMPLATE_HEADER, "src" });
+#if NRF_SD_BLE_API_VERSION >= 5
+    EventTemplate::Register(BLE_GATTC_EVT_EXCHANGE_MTU_RSP, { GATTC_EVENT_TEMPLATE_HEADER, "server_rx_mtu" });
+    EventTemplate::Register(BLE_GATTC_EVT_WRITE_CMD_TX_COMPLETE, { GATTC_EVENT_TEMPLATE_HEADER, "count" });
+#endif
+}
+
 extern "C" {
     void init_gattc(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target)
     {
+        init_gattc_event_templates();
+
         /* BLE_ERRORS_GATTC SVC return values specific to GATTC */
         NODE_DEFINE_CONSTANT(target, BLE_ERROR_GATTC_PROC_NOT_PERMITTED);
 
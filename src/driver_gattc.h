@@ -39,6 +39,9 @@
 
 #include "common.h"
 #include "ble_gattc.h"
+#include "gattc_procedure.h"
+
+class Adapter;
 
 extern name_map_t gatt_status_map;
 
@@ -105,11 +108,18 @@ class GattcWriteParameters : public BleToJs<ble_gattc_write_params_t>
 {
 public:
     GattcWriteParameters(ble_gattc_write_params_t *writeparameters) : BleToJs<ble_gattc_write_params_t>(writeparameters) {}
-    GattcWriteParameters(v8::Local<v8::Object> js) : BleToJs<ble_gattc_write_params_t>(js) {}
+    GattcWriteParameters(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_gattc_write_params_t>(js, arena) {}
     ble_gattc_write_params_t *ToNative();
     v8::Local<v8::Object> ToJs();
+
+    // Converts without throwing. p_value is allocated from the arena, or without one it is allocated and must be
+    // freed also when the conversion fails.
+    static Expected<ble_gattc_write_params_t *> read(v8::Local<v8::Object> js, ble_gattc_write_params_t *writeparams, ConversionArena *arena = nullptr);
 };
 
+// Properties every GATTC event object starts with, see BleDriverGattcEvent::ToJs
+#define GATTC_EVENT_TEMPLATE_HEADER EVENT_TEMPLATE_HEADER, "gatt_status", "gatt_status_name", "error_handle"
+
 template<typename EventType>
 class BleDriverGattcEvent : public BleDriverEvent<EventType>
 {
@@ -338,13 +348,8 @@ struct GattcWriteBaton : public Baton
 {
 public:
     BATON_CONSTRUCTOR(GattcWriteBaton);
-    BATON_DESTRUCTOR(GattcWriteBaton)
-    {
-        free((char*)(p_write_params->p_value));
-        delete p_write_params;
-    }
     uint16_t conn_handle;
-    ble_gattc_write_params_t *p_write_params;
+    ble_gattc_write_params_t *p_write_params; // Allocated from the arena
 };
 
 struct GattcConfirmHandleValueBaton : public Baton
@@ -355,6 +360,44 @@ public:
     uint16_t handle;
 };
 
+struct GattcDiscoverAllBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GattcDiscoverAllBaton);
+    Adapter *mainObject;
+    uint16_t conn_handle;
+    std::shared_ptr<GattcProcedure> procedure; // nullptr if a procedure is already running on the connection
+};
+
+struct GattcReadLongBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GattcReadLongBaton);
+    Adapter *mainObject;
+    uint16_t conn_handle;
+    std::shared_ptr<GattcProcedure> procedure; // nullptr if a procedure is already running on the connection
+};
+
+struct GattcWriteLongBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GattcWriteLongBaton);
+    Adapter *mainObject;
+    uint16_t conn_handle;
+    std::shared_ptr<GattcProcedure> procedure; // nullptr if a procedure is already running on the connection
+};
+
+#if NRF_SD_BLE_API_VERSION >= 5
+struct GattcWriteStreamBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GattcWriteStreamBaton);
+    Adapter *mainObject;
+    uint16_t conn_handle;
+    std::shared_ptr<GattcProcedure> procedure; // nullptr if a procedure is already running on the connection
+};
+#endif
+
 struct GattcExchangeMtuRequestBaton : public Baton
 {
 public:
@@ -40,6 +40,7 @@
 #include "driver.h"
 #include "driver_gap.h"
 #include "driver_gatt.h"
+#include "struct_schema.h"
 
 #include <iostream>
 
@@ -67,7 +68,7 @@ v8::Local<v8::Object> GattsEnableParameters::ToJs()
 
 ble_gatts_enable_params_t *GattsEnableParameters::ToNative()
 {
-    auto enableParams = new ble_gatts_enable_params_t();
+    auto enableParams = allocate<ble_gatts_enable_params_t>();
 
     enableParams->service_changed = ConversionUtility::getNativeBool(jsobj, "service_changed");
     enableParams->attr_tab_size = ConversionUtility::getNativeUint32(jsobj, "attr_tab_size");
@@ -83,7 +84,7 @@ ble_gatts_attr_md_t *GattsAttributeMetadata::ToNative()
         return nullptr;
     }
 
-    auto attributeMetadata = new ble_gatts_attr_md_t();
+    auto attributeMetadata = allocate<ble_gatts_attr_md_t>();
 
     attributeMetadata->read_perm = GapConnSecMode(ConversionUtility::getJsObject(jsobj, "read_perm"));
     attributeMetadata->write_perm = GapConnSecMode(ConversionUtility::getJsObject(jsobj, "write_perm"));
@@ -96,6 +97,20 @@ ble_gatts_attr_md_t *GattsAttributeMetadata::ToNative()
     return attributeMetadata;
 }
 
+template<>
+struct StructSchema<ble_gatts_char_pf_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("format", &ble_gatts_char_pf_t::format),
+            schemaField("exponent", &ble_gatts_char_pf_t::exponent),
+            schemaField("unit", &ble_gatts_char_pf_t::unit),
+            schemaField("name_space", &ble_gatts_char_pf_t::name_space),
+            schemaField("desc", &ble_gatts_char_pf_t::desc));
+    }
+};
+
 ble_gatts_char_pf_t *GattsCharacteristicPresentationFormat::ToNative()
 {
     if (Utility::IsNull(jsobj))
@@ -103,15 +118,7 @@ ble_gatts_char_pf_t *GattsCharacteristicPresentationFormat::ToNative()
         return nullptr;
     }
 
-    auto presentationformat = new ble_gatts_char_pf_t();
-
-    presentationformat->format = ConversionUtility::getNativeUint8(jsobj, "format");
-    presentationformat->exponent = ConversionUtility::getNativeInt8(jsobj, "exponent");
-    presentationformat->unit = ConversionUtility::getNativeUint16(jsobj, "unit");
-    presentationformat->name_space = ConversionUtility::getNativeUint8(jsobj, "name_space");
-    presentationformat->desc = ConversionUtility::getNativeUint16(jsobj, "desc");
-
-    return presentationformat;
+    return StructMarshaller<ble_gatts_char_pf_t>::newNative(jsobj, arena);
 }
 
 ble_gatts_char_md_t *GattsCharacteristicMetadata::ToNative()
@@ -121,7 +128,7 @@ ble_gatts_char_md_t *GattsCharacteristicMetadata::ToNative()
         return nullptr;
     }
 
-    auto metadata = new ble_gatts_char_md_t();
+    auto metadata = allocate<ble_gatts_char_md_t>();
 
     metadata->char_props = GattCharProps(ConversionUtility::getJsObject(jsobj, "char_props"));
     metadata->char_ext_props = GattCharExtProps(ConversionUtility::getJsObject(jsobj, "char_ext_props"));
@@ -130,10 +137,10 @@ ble_gatts_char_md_t *GattsCharacteristicMetadata::ToNative()
     metadata->char_user_desc_max_size = ConversionUtility::getNativeUint16(jsobj, "char_user_desc_max_size");
     metadata->char_user_desc_size = ConversionUtility::getNativeUint16(jsobj, "char_user_desc_size");
 
-    metadata->p_char_pf = GattsCharacteristicPresentationFormat(ConversionUtility::getJsObjectOrNull(jsobj, "char_pf"));
-    metadata->p_user_desc_md = GattsAttributeMetadata(ConversionUtility::getJsObjectOrNull(jsobj, "user_desc_md"));
-    metadata->p_cccd_md = GattsAttributeMetadata(ConversionUtility::getJsObjectOrNull(jsobj, "cccd_md"));
-    metadata->p_sccd_md = GattsAttributeMetadata(ConversionUtility::getJsObjectOrNull(jsobj, "sccd_md"));
+    metadata->p_char_pf = GattsCharacteristicPresentationFormat(ConversionUtility::getJsObjectOrNull(jsobj, "char_pf"), arena);
+    metadata->p_user_desc_md = GattsAttributeMetadata(ConversionUtility::getJsObjectOrNull(jsobj, "user_desc_md"), arena);
+    metadata->p_cccd_md = GattsAttributeMetadata(ConversionUtility::getJsObjectOrNull(jsobj, "cccd_md"), arena);
+    metadata->p_sccd_md = GattsAttributeMetadata(ConversionUtility::getJsObjectOrNull(jsobj, "sccd_md"), arena);
 
     return metadata;
 }
@@ -145,30 +152,35 @@ ble_gatts_attr_t *GattsAttribute::ToNative()
         return nullptr;
     }
 
-    auto attribute = new ble_gatts_attr_t();
+    auto attribute = allocate<ble_gatts_attr_t>();
 
-    attribute->p_uuid = BleUUID(ConversionUtility::getJsObject(jsobj, "uuid"));
-    attribute->p_attr_md = GattsAttributeMetadata(ConversionUtility::getJsObject(jsobj, "attr_md"));
+    attribute->p_uuid = BleUUID(ConversionUtility::getJsObject(jsobj, "uuid"), arena);
+    attribute->p_attr_md = GattsAttributeMetadata(ConversionUtility::getJsObject(jsobj, "attr_md"), arena);
 
     attribute->init_len = ConversionUtility::getNativeUint16(jsobj, "init_len");
     attribute->init_offs = ConversionUtility::getNativeUint16(jsobj, "init_offs");
     attribute->max_len = ConversionUtility::getNativeUint16(jsobj, "max_len");
-    attribute->p_value = ConversionUtility::getNativePointerToUint8(jsobj, "value");
+    attribute->p_value = ConversionUtility::getNativePointerToUint8(jsobj, "value", arena);
 
     return attribute;
 }
 
-v8::Local<v8::Object> GattsCharacteristicDefinitionHandles::ToJs()
+template<>
+struct StructSchema<ble_gatts_char_handles_t>
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-
-    Utility::Set(obj, "value_handle", ConversionUtility::toJsNumber(native->value_handle));
-    Utility::Set(obj, "user_desc_handle", ConversionUtility::toJsNumber(native->user_desc_handle));
-    Utility::Set(obj, "cccd_handle", ConversionUtility::toJsNumber(native->cccd_handle));
-    Utility::Set(obj, "sccd_handle", ConversionUtility::toJsNumber(native->sccd_handle));
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("value_handle", &ble_gatts_char_handles_t::value_handle),
+            schemaField("user_desc_handle", &ble_gatts_char_handles_t::user_desc_handle),
+            schemaField("cccd_handle", &ble_gatts_char_handles_t::cccd_handle),
+            schemaField("sccd_handle", &ble_gatts_char_handles_t::sccd_handle));
+    }
+};
 
-    return scope.Escape(obj);
+v8::Local<v8::Object> GattsCharacteristicDefinitionHandles::ToJs()
+{
+    return StructMarshaller<ble_gatts_char_handles_t>::toJs(*native);
 }
 
 ble_gatts_hvx_params_t *GattsHVXParams::ToNative()
@@ -178,19 +190,51 @@ ble_gatts_hvx_params_t *GattsHVXParams::ToNative()
         return nullptr;
     }
 
-    auto hvxparams = new ble_gatts_hvx_params_t();
+    auto hvxparams = allocate<ble_gatts_hvx_params_t>();
+    const auto converted = read(jsobj, hvxparams, arena);
 
-    hvxparams->p_len = static_cast<uint16_t*>(malloc(sizeof(uint16_t)));
+    if (!converted)
+    {
+        if (arena == nullptr)
+        {
+            free((char*)(hvxparams->p_len));
+            free((char*)(hvxparams->p_data));
+            delete hvxparams;
+        }
 
-    hvxparams->handle = ConversionUtility::getNativeUint16(jsobj, "handle");
-    hvxparams->type = ConversionUtility::getNativeUint8(jsobj, "type");
-    hvxparams->offset = ConversionUtility::getNativeUint16(jsobj, "offset");
-    *(hvxparams->p_len) = ConversionUtility::getNativeUint16(jsobj, "len");
-    hvxparams->p_data = ConversionUtility::getNativePointerToUint8(jsobj, "data");
+        throw converted.error().message();
+    }
 
     return hvxparams;
 }
 
+Expected<ble_gatts_hvx_params_t *> GattsHVXParams::read(v8::Local<v8::Object> js, ble_gatts_hvx_params_t *hvxparams, ConversionArena *arena)
+{
+    hvxparams->p_len = arena != nullptr
+        ? arena->create<uint16_t>()
+        : static_cast<uint16_t*>(malloc(sizeof(uint16_t)));
+
+    return FieldReader<ble_gatts_hvx_params_t>(js, hvxparams, arena)
+        .read("handle", &ble_gatts_hvx_params_t::handle)
+        .read("type", &ble_gatts_hvx_params_t::type)
+        .read("offset", &ble_gatts_hvx_params_t::offset)
+        .read("len", hvxparams->p_len)
+        .read("data", &ble_gatts_hvx_params_t::p_data)
+        .result();
+}
+
+template<>
+struct StructSchema<ble_gatts_value_t>
+{
+    static auto fields()
+    {
+        return std::make_tuple(
+            schemaField("len", &ble_gatts_value_t::len),
+            schemaField("offset", &ble_gatts_value_t::offset),
+            schemaField<SchemaConversion::ByteArray<ble_gatts_value_t, &ble_gatts_value_t::len>>("value", &ble_gatts_value_t::p_value));
+    }
+};
+
 ble_gatts_value_t *GattsValue::ToNative()
 {
     if (Utility::IsNull(jsobj))
@@ -198,25 +242,12 @@ ble_gatts_value_t *GattsValue::ToNative()
         return nullptr;
     }
 
-    auto value = new ble_gatts_value_t();
-
-    value->len = ConversionUtility::getNativeUint16(jsobj, "len");
-    value->offset = ConversionUtility::getNativeUint16(jsobj, "offset");
-    value->p_value = ConversionUtility::getNativePointerToUint8(jsobj, "value");
-
-    return value;
+    return StructMarshaller<ble_gatts_value_t>::newNative(jsobj);
 }
 
 v8::Local<v8::Object> GattsValue::ToJs()
 {
-    Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
-
-    Utility::Set(obj, "len", ConversionUtility::toJsNumber(native->len));
-    Utility::Set(obj, "offset", ConversionUtility::toJsNumber(native->offset));
-    Utility::Set(obj, "value", ConversionUtility::toJsValueArray(native->p_value, native->len));
-
-    return scope.Escape(obj);
+    return StructMarshaller<ble_gatts_value_t>::toJs(*native);
 }
 
 v8::Local<v8::Object> GattsAuthorizeParameters::ToJs()
@@ -277,7 +308,7 @@ ble_gatts_rw_authorize_reply_params_t *GattGattsReplyReadWriteAuthorizeParams::T
 v8::Local<v8::Object> GattsWriteEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattsEvent::ToJs(obj);
 
     Utility::Set(obj, "handle", ConversionUtility::toJsNumber(evt->handle));
@@ -307,7 +338,7 @@ v8::Local<v8::Object> GattsReadEvent::ToJs()
 v8::Local<v8::Object> GattsRWAuthorizeRequestEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattsEvent::ToJs(obj);
 
     Utility::Set(obj, "type", ConversionUtility::toJsNumber(evt->type));
@@ -334,7 +365,7 @@ v8::Local<v8::Object> GattsRWAuthorizeRequestEvent::ToJs()
 v8::Local<v8::Object> GattsSystemAttributeMissingEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattsEvent::ToJs(obj);
 
     Utility::Set(obj, "hint", ConversionUtility::toJsNumber(evt->hint));
@@ -345,7 +376,7 @@ v8::Local<v8::Object> GattsSystemAttributeMissingEvent::ToJs()
 v8::Local<v8::Object> GattsHVCEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattsEvent::ToJs(obj);
 
     Utility::Set(obj, "handle", ConversionUtility::toJsNumber(evt->handle));
@@ -356,7 +387,7 @@ v8::Local<v8::Object> GattsHVCEvent::ToJs()
 v8::Local<v8::Object> GattsSCConfirmEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattsEvent::ToJs(obj);
 
     return scope.Escape(obj);
@@ -365,7 +396,7 @@ v8::Local<v8::Object> GattsSCConfirmEvent::ToJs()
 v8::Local<v8::Object> GattsTimeoutEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattsEvent::ToJs(obj);
 
     Utility::Set(obj, "src", ConversionUtility::toJsNumber(evt->src));
@@ -377,7 +408,7 @@ v8::Local<v8::Object> GattsTimeoutEvent::ToJs()
 v8::Local<v8::Object> GattsExchangeMtuRequestEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattsEvent::ToJs(obj);
 
     Utility::Set(obj, "client_rx_mtu", ConversionUtility::toJsNumber(evt->client_rx_mtu));
@@ -388,7 +419,7 @@ v8::Local<v8::Object> GattsExchangeMtuRequestEvent::ToJs()
 v8::Local<v8::Object> GattsHvnTxCompleteEvent::ToJs()
 {
     Nan::EscapableHandleScope scope;
-    v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+    v8::Local<v8::Object> obj = NewEventObject();
     BleDriverGattsEvent::ToJs(obj);
 
     Utility::Set(obj, "count", ConversionUtility::toJsNumber(evt->count));
@@ -430,16 +461,17 @@ NAN_METHOD(Adapter::GattsAddService)
 
     try
     {
-        baton->p_uuid = BleUUID(uuid);
+        baton->p_uuid = BleUUID(uuid, &baton->arena);
     }
     catch (std::string error)
     {
         v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("uuid", error);
         Nan::ThrowTypeError(message);
+        delete baton;
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsAddService, reinterpret_cast<uv_after_work_cb>(AfterGattsAddService));
+    QUEUE_BATON_WORK(baton, GattsAddService);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -505,31 +537,34 @@ NAN_METHOD(Adapter::GattsAddCharacteristic)
 
     auto baton = new GattsAddCharacteristicBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->service_handle = serviceHandle;
 
     try
     {
-        baton->p_char_md = GattsCharacteristicMetadata(metadata);
+        baton->p_char_md = GattsCharacteristicMetadata(metadata, &baton->arena);
     }
     catch (std::string err)
     {
         Nan::ThrowTypeError(ErrorMessage::getStructErrorMessage("char_md", err));
+        delete baton;
         return;
     }
 
     try
     {
-        baton->p_attr_char_value = GattsAttribute(attributeStructure);
+        baton->p_attr_char_value = GattsAttribute(attributeStructure, &baton->arena);
     }
     catch (std::string err)
     {
         Nan::ThrowTypeError(ErrorMessage::getStructErrorMessage("attr_char_value", err));
+        delete baton;
         return;
     }
 
-    baton->p_handles = new ble_gatts_char_handles_t();
+    baton->p_handles = baton->arena.create<ble_gatts_char_handles_t>();
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsAddCharacteristic, reinterpret_cast<uv_after_work_cb>(AfterGattsAddCharacteristic));
+    QUEUE_BATON_WORK(baton, GattsAddCharacteristic);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -554,6 +589,11 @@ void Adapter::AfterGattsAddCharacteristic(uv_work_t *req)
     }
     else
     {
+        if (baton->p_handles->cccd_handle != BLE_GATT_HANDLE_INVALID)
+        {
+            baton->mainObject->addGattsCccd(baton->p_handles->value_handle, baton->p_handles->cccd_handle);
+        }
+
         argv[0] = Nan::Undefined();
         argv[1] = GattsCharacteristicDefinitionHandles(baton->p_handles).ToJs();
     }
@@ -595,16 +635,17 @@ NAN_METHOD(Adapter::GattsAddDescriptor)
 
     try
     {
-        baton->p_attr = GattsAttribute(attributeStructure);
+        baton->p_attr = GattsAttribute(attributeStructure, &baton->arena);
     }
     catch (std::string error)
     {
         v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("attr", error);
         Nan::ThrowTypeError(message);
+        delete baton;
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsAddDescriptor, reinterpret_cast<uv_after_work_cb>(AfterGattsAddDescriptor));
+    QUEUE_BATON_WORK(baton, GattsAddDescriptor);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -638,20 +679,124 @@ void Adapter::AfterGattsAddDescriptor(uv_work_t *req)
     delete baton;
 }
 
+// Called for every notification, arguments are converted without exceptions
 NAN_METHOD(Adapter::GattsHVX)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
-    uint16_t conn_handle;
-    v8::Local<v8::Object> hvx_params;
+    ArgumentReader arguments(info);
+    const auto conn_handle = arguments.next<uint16_t>();
+    const auto hvx_params = arguments.next<v8::Local<v8::Object>>();
+    const auto callback = arguments.next<v8::Local<v8::Function>>();
+
+    if (!arguments.ok())
+    {
+        arguments.throwTypeError();
+        return;
+    }
+
+    auto baton = new GattsHVXBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->conn_handle = conn_handle;
+    baton->p_hvx_params = baton->arena.create<ble_gatts_hvx_params_t>();
+
+    const auto converted = GattsHVXParams::read(hvx_params, baton->p_hvx_params, &baton->arena);
+
+    if (!converted)
+    {
+        Nan::ThrowTypeError(ErrorMessage::getStructErrorMessage("hvx_params", converted.error().message()));
+        delete baton;
+        return;
+    }
+
+    QUEUE_BATON_WORK(baton, GattsHVX);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattsHVX(uv_work_t *req)
+{
+    auto baton = static_cast<GattsHVXBaton *>(req->data);
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    // Notifications use the TX credits of the connection and are queued natively while the SoftDevice queue is full
+    if (baton->p_hvx_params->type == BLE_GATT_HVX_NOTIFICATION)
+    {
+        auto entry = std::make_unique<GattsHvnTxEntry>();
+        entry->conn_handle = baton->conn_handle;
+        entry->handle = baton->p_hvx_params->handle;
+        entry->offset = baton->p_hvx_params->offset;
+        entry->callback = nullptr;
+
+        if (baton->p_hvx_params->p_data != nullptr)
+        {
+            entry->data.assign(baton->p_hvx_params->p_data, baton->p_hvx_params->p_data + *baton->p_hvx_params->p_len);
+        }
+
+        uint32_t result;
+
+        if (baton->mainObject->sendGattsHvn(std::move(entry), &baton->callback, &result, baton->p_hvx_params->p_len))
+        {
+            baton->result = result;
+        }
+
+        return;
+    }
+#endif
+
+    baton->result = sd_ble_gatts_hvx(baton->adapter, baton->conn_handle, baton->p_hvx_params);
+}
+
+// This runs in Main Thread
+void Adapter::AfterGattsHVX(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GattsHVXBaton *>(req->data);
+    v8::Local<v8::Value> argv[2];
+
+    // The notification was queued, the callback is called when it is handed to the SoftDevice
+    if (baton->callback == nullptr)
+    {
+        delete baton;
+        return;
+    }
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "hvx");
+        argv[1] = Nan::Undefined();
+    }
+    else
+    {
+        argv[0] = Nan::Undefined();
+        argv[1] = ConversionUtility::toJsNumber(*baton->p_hvx_params->p_len);
+    }
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    baton->callback->Call(1, argv, &resource);
+    delete baton;
+}
+
+NAN_METHOD(Adapter::GattsNotifyAll)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t handle;
+    std::vector<uint8_t> value;
     v8::Local<v8::Function> callback;
     auto argumentcount = 0;
 
     try
     {
-        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        handle = ConversionUtility::getNativeUint16(info[argumentcount]);
         argumentcount++;
 
-        hvx_params = ConversionUtility::getJsObject(info[argumentcount]);
+        if (!node::Buffer::HasInstance(info[argumentcount]))
+        {
+            throw std::string("buffer");
+        }
+
+        const auto data = reinterpret_cast<const uint8_t *>(node::Buffer::Data(info[argumentcount]));
+        value.assign(data, data + node::Buffer::Length(info[argumentcount]));
         argumentcount++;
 
         callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
@@ -664,52 +809,119 @@ NAN_METHOD(Adapter::GattsHVX)
         return;
     }
 
-    auto baton = new GattsHVXBaton(callback);
+    auto baton = new GattsNotifyAllBaton(callback);
     baton->adapter = obj->adapter;
-    baton->conn_handle = conn_handle;
+    baton->mainObject = obj;
+    baton->handle = handle;
+    baton->value = std::move(value);
 
-    try
-    {
-        baton->p_hvx_params = GattsHVXParams(hvx_params);
-    }
-    catch (std::string error)
+    QUEUE_BATON_WORK(baton, GattsNotifyAll);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattsNotifyAll(uv_work_t *req)
+{
+    auto baton = static_cast<GattsNotifyAllBaton *>(req->data);
+    const auto subscribers = baton->mainObject->getGattsSubscribers(baton->handle);
+
+    // Nobody to notify, the value still has to be stored in the attribute table
+    if (subscribers.empty())
     {
-        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("hvx_params", error);
-        Nan::ThrowTypeError(message);
+        ble_gatts_value_t gatts_value;
+        memset(&gatts_value, 0, sizeof(gatts_value));
+        gatts_value.len = static_cast<uint16_t>(baton->value.size());
+        gatts_value.p_value = baton->value.data();
+
+        baton->result = sd_ble_gatts_value_set(baton->adapter, BLE_CONN_HANDLE_INVALID, baton->handle, &gatts_value);
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsHVX, reinterpret_cast<uv_after_work_cb>(AfterGattsHVX));
-}
+    for (const auto &subscriber : subscribers)
+    {
+        GattsNotifyAllResult result;
+        result.conn_handle = subscriber.first;
+        result.type = (subscriber.second & BLE_GATT_HVX_INDICATION) ? BLE_GATT_HVX_INDICATION : BLE_GATT_HVX_NOTIFICATION;
+        result.len = static_cast<uint16_t>(baton->value.size());
 
-// This runs in a worker thread (not Main Thread)
-void Adapter::GattsHVX(uv_work_t *req)
-{
-    auto baton = static_cast<GattsHVXBaton *>(req->data);
-    baton->result = sd_ble_gatts_hvx(baton->adapter, baton->conn_handle, baton->p_hvx_params);
+#if NRF_SD_BLE_API_VERSION >= 5
+        // Notifications are queued while the connection is out of TX credits, that is reported as success
+        if (result.type == BLE_GATT_HVX_NOTIFICATION)
+        {
+            auto entry = std::make_unique<GattsHvnTxEntry>();
+            entry->conn_handle = result.conn_handle;
+            entry->handle = baton->handle;
+            entry->offset = 0;
+            entry->data = baton->value;
+            entry->callback = nullptr;
+
+            Nan::Callback *callback = nullptr;
+
+            if (!baton->mainObject->sendGattsHvn(std::move(entry), &callback, &result.result, &result.len))
+            {
+                result.result = NRF_SUCCESS;
+            }
+
+            baton->results.push_back(result);
+            continue;
+        }
+#endif
+
+        // All connections are sent the same payload, only the length is written back per connection
+        ble_gatts_hvx_params_t hvx_params;
+        memset(&hvx_params, 0, sizeof(hvx_params));
+        hvx_params.handle = baton->handle;
+        hvx_params.type = result.type;
+        hvx_params.p_len = &result.len;
+        hvx_params.p_data = baton->value.data();
+
+        result.result = sd_ble_gatts_hvx(baton->adapter, result.conn_handle, &hvx_params);
+        baton->results.push_back(result);
+    }
 }
 
 // This runs in Main Thread
-void Adapter::AfterGattsHVX(uv_work_t *req)
+void Adapter::AfterGattsNotifyAll(uv_work_t *req)
 {
     Nan::HandleScope scope;
 
-    auto baton = static_cast<GattsHVXBaton *>(req->data);
+    auto baton = static_cast<GattsNotifyAllBaton *>(req->data);
     v8::Local<v8::Value> argv[2];
 
     if (baton->result != NRF_SUCCESS)
     {
-        argv[0] = ErrorMessage::getErrorMessage(baton->result, "hvx");
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "setting value");
         argv[1] = Nan::Undefined();
     }
     else
     {
+        v8::Local<v8::Array> result_array = Nan::New<v8::Array>();
+
+        for (size_t i = 0; i < baton->results.size(); ++i)
+        {
+            const auto &result = baton->results[i];
+            v8::Local<v8::Object> result_obj = Nan::New<v8::Object>();
+
+            Utility::Set(result_obj, "conn_handle", result.conn_handle);
+            Utility::Set(result_obj, "type", result.type);
+
+            if (result.result != NRF_SUCCESS)
+            {
+                Utility::Set(result_obj, "error", ErrorMessage::getErrorMessage(result.result, "hvx"));
+            }
+            else
+            {
+                Utility::Set(result_obj, "len", result.len);
+            }
+
+            Nan::Set(result_array, static_cast<uint32_t>(i), result_obj);
+        }
+
         argv[0] = Nan::Undefined();
-        argv[1] = ConversionUtility::toJsNumber(*baton->p_hvx_params->p_len);
+        argv[1] = result_array;
     }
 
     Nan::AsyncResource resource("pc-ble-driver-js:callback");
-    baton->callback->Call(1, argv, &resource);
+    baton->callback->Call(2, argv, &resource);
     delete baton;
 }
 
@@ -757,6 +969,7 @@ NAN_METHOD(Adapter::GattsSystemAttributeSet)
 
     auto baton = new GattsSystemAttributeSetBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->conn_handle = conn_handle;
 
     if (!sys_attr_data_isNullPointer)
@@ -771,14 +984,80 @@ NAN_METHOD(Adapter::GattsSystemAttributeSet)
     baton->len = len;
     baton->flags = flags;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsSystemAttributeSet, reinterpret_cast<uv_after_work_cb>(AfterGattsSystemAttributeSet));
+    QUEUE_BATON_WORK(baton, GattsSystemAttributeSet);
 }
 
 // This runs in a worker thread (not Main Thread)
 void Adapter::GattsSystemAttributeSet(uv_work_t *req)
 {
     auto baton = static_cast<GattsSystemAttributeSetBaton *>(req->data);
+
+    // Track the restored CCCD values before the SoftDevice can report writes to them,
+    // so a write arriving right after the set is not overwritten by the stored value
+    std::map<uint16_t, uint16_t> restored;
+    std::map<uint16_t, uint16_t> previous;
+    const auto tracked = baton->mainObject->restoreGattsCccds(baton->conn_handle, baton->p_sys_attr_data, baton->len, baton->flags, &restored, &previous);
+
     baton->result = sd_ble_gatts_sys_attr_set(baton->adapter, baton->conn_handle, baton->p_sys_attr_data, baton->len, baton->flags);
+
+    if (tracked && baton->result != NRF_SUCCESS)
+    {
+        baton->mainObject->revertGattsCccds(baton->conn_handle, restored, previous);
+    }
+}
+
+NAN_METHOD(Adapter::GattsGetCccdValues)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t conn_handle;
+    auto argumentcount = 0;
+
+    try
+    {
+        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    // Copy the state out so no JavaScript objects are created while the event thread is kept waiting
+    std::vector<std::pair<uint16_t, uint16_t>> cccdHandles;
+    std::map<uint16_t, uint16_t> cccdValues;
+
+    uv_mutex_lock(&obj->gattsCccdMutex);
+
+    cccdHandles.assign(obj->gattsCccdValueHandles.begin(), obj->gattsCccdValueHandles.end());
+
+    const auto connection = obj->gattsCccdValues.find(conn_handle);
+
+    if (connection != obj->gattsCccdValues.end())
+    {
+        cccdValues = connection->second;
+    }
+
+    uv_mutex_unlock(&obj->gattsCccdMutex);
+
+    v8::Local<v8::Array> cccd_array = Nan::New<v8::Array>();
+
+    for (size_t i = 0; i < cccdHandles.size(); ++i)
+    {
+        const auto cccd_handle = cccdHandles[i].first;
+        const auto value_handle = cccdHandles[i].second;
+        const auto value = cccdValues.find(value_handle);
+
+        v8::Local<v8::Object> cccd_obj = Nan::New<v8::Object>();
+        Utility::Set(cccd_obj, "value_handle", value_handle);
+        Utility::Set(cccd_obj, "cccd_handle", cccd_handle);
+        Utility::Set(cccd_obj, "value", value != cccdValues.end() ? value->second : static_cast<uint16_t>(0));
+
+        Nan::Set(cccd_array, static_cast<uint32_t>(i), cccd_obj);
+    }
+
+    info.GetReturnValue().Set(cccd_array);
 }
 
 // This runs in Main Thread
@@ -849,7 +1128,7 @@ NAN_METHOD(Adapter::GattsSetValue)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsSetValue, reinterpret_cast<uv_after_work_cb>(AfterGattsSetValue));
+    QUEUE_BATON_WORK(baton, GattsSetValue);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -929,7 +1208,7 @@ NAN_METHOD(Adapter::GattsGetValue)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsGetValue, reinterpret_cast<uv_after_work_cb>(AfterGattsGetValue));
+    QUEUE_BATON_WORK(baton, GattsGetValue);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -991,6 +1270,7 @@ NAN_METHOD(Adapter::GattsReplyReadWriteAuthorize)
 
     auto baton = new GattsReplyReadWriteAuthorizeBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->conn_handle = conn_handle;
 
     try
@@ -1004,7 +1284,7 @@ NAN_METHOD(Adapter::GattsReplyReadWriteAuthorize)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsReplyReadWriteAuthorize, reinterpret_cast<uv_after_work_cb>(AfterGattsReplyReadWriteAuthorize));
+    QUEUE_BATON_WORK(baton, GattsReplyReadWriteAuthorize);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1012,6 +1292,11 @@ void Adapter::GattsReplyReadWriteAuthorize(uv_work_t *req)
 {
     auto baton = static_cast<GattsReplyReadWriteAuthorizeBaton *>(req->data);
     baton->result = sd_ble_gatts_rw_authorize_reply(baton->adapter, baton->conn_handle, baton->p_rw_authorize_reply_params);
+
+    if (baton->result == NRF_SUCCESS)
+    {
+        baton->mainObject->trackGattsCccdAuthorizeReply(baton->conn_handle, baton->p_rw_authorize_reply_params);
+    }
 }
 
 // This runs in Main Thread
@@ -1068,7 +1353,7 @@ NAN_METHOD(Adapter::GattsExchangeMtuReply)
     baton->conn_handle = conn_handle;
     baton->server_rx_mtu = server_rx_mtu;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsExchangeMtuReply, reinterpret_cast<uv_after_work_cb>(AfterGattsExchangeMtuReply));
+    QUEUE_BATON_WORK(baton, GattsExchangeMtuReply);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1101,9 +1386,387 @@ void Adapter::AfterGattsExchangeMtuReply(uv_work_t *req)
 }
 #endif
 
+void Adapter::addGattsCccd(const uint16_t value_handle, const uint16_t cccd_handle)
+{
+    uv_mutex_lock(&gattsCccdMutex);
+    gattsCccdValueHandles[cccd_handle] = value_handle;
+    uv_mutex_unlock(&gattsCccdMutex);
+}
+
+void Adapter::clearGattsCccds()
+{
+    uv_mutex_lock(&gattsCccdMutex);
+    gattsCccdValueHandles.clear();
+    gattsCccdValues.clear();
+    gattsCccdAuthorizeWrites.clear();
+    uv_mutex_unlock(&gattsCccdMutex);
+}
+
+// Replace the CCCD values of a connection with the ones in the system attributes given to sd_ble_gatts_sys_attr_set.
+// The data is a list of entries with a 16-bit handle, a 16-bit length and the value, followed by a 16-bit CRC.
+// Called before the system attributes are set, returns false if the flags leave the tracked CCCDs untouched.
+bool Adapter::restoreGattsCccds(const uint16_t conn_handle, const uint8_t *p_sys_attr_data, const uint16_t len, const uint32_t flags, std::map<uint16_t, uint16_t> *restored, std::map<uint16_t, uint16_t> *previous)
+{
+    // Only CCCDs in user services are tracked
+    if (flags == BLE_GATTS_SYS_ATTR_FLAG_SYS_SRVCS)
+    {
+        return false;
+    }
+
+    uv_mutex_lock(&gattsCccdMutex);
+
+    if (p_sys_attr_data != nullptr && len >= 2)
+    {
+        const auto end = static_cast<uint16_t>(len - 2);
+        uint16_t offset = 0;
+
+        while (offset + 4 <= end)
+        {
+            const auto handle = uint16_decode(&p_sys_attr_data[offset]);
+            const auto value_len = uint16_decode(&p_sys_attr_data[offset + 2]);
+            offset += 4;
+
+            if (offset + value_len > end)
+            {
+                break;
+            }
+
+            const auto it = gattsCccdValueHandles.find(handle);
+
+            if (it != gattsCccdValueHandles.end() && value_len == 2)
+            {
+                (*restored)[it->second] = uint16_decode(&p_sys_attr_data[offset]);
+            }
+
+            offset += value_len;
+        }
+    }
+
+    // No data resets the system attributes of the connection
+    auto &values = gattsCccdValues[conn_handle];
+    *previous = values;
+    values = *restored;
+
+    uv_mutex_unlock(&gattsCccdMutex);
+
+    return true;
+}
+
+// Put back the CCCD values replaced by restoreGattsCccds when sd_ble_gatts_sys_attr_set failed,
+// unless a CCCD write has been tracked for the connection in the meantime.
+void Adapter::revertGattsCccds(const uint16_t conn_handle, const std::map<uint16_t, uint16_t> &restored, const std::map<uint16_t, uint16_t> &previous)
+{
+    uv_mutex_lock(&gattsCccdMutex);
+
+    const auto connection = gattsCccdValues.find(conn_handle);
+
+    if (connection != gattsCccdValues.end() && connection->second == restored)
+    {
+        connection->second = previous;
+    }
+
+    uv_mutex_unlock(&gattsCccdMutex);
+}
+
+// Connection handles and CCCD values of the connections subscribed to a characteristic value
+std::vector<std::pair<uint16_t, uint16_t>> Adapter::getGattsSubscribers(const uint16_t value_handle)
+{
+    std::vector<std::pair<uint16_t, uint16_t>> subscribers;
+
+    uv_mutex_lock(&gattsCccdMutex);
+
+    for (const auto &connection : gattsCccdValues)
+    {
+        const auto it = connection.second.find(value_handle);
+
+        if (it != connection.second.end() && (it->second & (BLE_GATT_HVX_NOTIFICATION | BLE_GATT_HVX_INDICATION)))
+        {
+            subscribers.emplace_back(connection.first, it->second);
+        }
+    }
+
+    uv_mutex_unlock(&gattsCccdMutex);
+
+    return subscribers;
+}
+
+// Keep the CCCD values of each connection up to date, also when the write events are masked. A CCCD write in a
+// write authorize request is held until the application replies, see trackGattsCccdAuthorizeReply.
+// This runs in thread SerializationTransport::eventThread
+void Adapter::trackGattsCccdEvent(ble_evt_t *event)
+{
+    const auto evt_id = event->header.evt_id;
+
+    if (evt_id == BLE_GAP_EVT_DISCONNECTED)
+    {
+        uv_mutex_lock(&gattsCccdMutex);
+        gattsCccdValues.erase(event->evt.gap_evt.conn_handle);
+        gattsCccdAuthorizeWrites.erase(event->evt.gap_evt.conn_handle);
+        uv_mutex_unlock(&gattsCccdMutex);
+        return;
+    }
+
+    const auto authorize = evt_id == BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST
+        && event->evt.gatts_evt.params.authorize_request.type == BLE_GATTS_AUTHORIZE_TYPE_WRITE;
+
+    if (evt_id != BLE_GATTS_EVT_WRITE && !authorize)
+    {
+        return;
+    }
+
+    const auto conn_handle = event->evt.gatts_evt.conn_handle;
+    const auto &write = authorize ? event->evt.gatts_evt.params.authorize_request.request.write : event->evt.gatts_evt.params.write;
+
+    if ((write.op != BLE_GATTS_OP_WRITE_REQ && write.op != BLE_GATTS_OP_WRITE_CMD) || write.offset != 0 || write.len != 2)
+    {
+        return;
+    }
+
+    uv_mutex_lock(&gattsCccdMutex);
+
+    const auto it = gattsCccdValueHandles.find(write.handle);
+
+    if (it != gattsCccdValueHandles.end() && authorize)
+    {
+        gattsCccdAuthorizeWrites[conn_handle] = std::make_pair(it->second, uint16_decode(write.data));
+    }
+    else if (it != gattsCccdValueHandles.end())
+    {
+        gattsCccdValues[conn_handle][it->second] = uint16_decode(write.data);
+    }
+
+    uv_mutex_unlock(&gattsCccdMutex);
+}
+
+// Track the CCCD write of a write authorize request once the application has accepted it. The SoftDevice writes the
+// value of the reply when it has one, the value of the request otherwise.
+// This runs in a worker thread (not Main Thread)
+void Adapter::trackGattsCccdAuthorizeReply(const uint16_t conn_handle, const ble_gatts_rw_authorize_reply_params_t *params)
+{
+    if (params == nullptr || params->type != BLE_GATTS_AUTHORIZE_TYPE_WRITE)
+    {
+        return;
+    }
+
+    uv_mutex_lock(&gattsCccdMutex);
+
+    const auto pending = gattsCccdAuthorizeWrites.find(conn_handle);
+
+    if (pending != gattsCccdAuthorizeWrites.end())
+    {
+        const auto &write = params->params.write;
+
+        if (write.gatt_status == BLE_GATT_STATUS_SUCCESS)
+        {
+            const auto value = (write.update && write.len == 2 && write.p_data != nullptr)
+                ? uint16_decode(write.p_data)
+                : pending->second.second;
+
+            gattsCccdValues[conn_handle][pending->second.first] = value;
+        }
+
+        gattsCccdAuthorizeWrites.erase(pending);
+    }
+
+    uv_mutex_unlock(&gattsCccdMutex);
+}
+
+#if NRF_SD_BLE_API_VERSION >= 5
+// Called from the NodeJS thread and from worker threads, the size is read in the SerializationTransport event thread
+void Adapter::setGattsHvnTxQueueSize(const ble_cfg_t *gatts_conn_cfg)
+{
+    uv_mutex_lock(&gattsHvnTxMutex);
+    gattsHvnTxQueueSize = (gatts_conn_cfg != nullptr) ? gatts_conn_cfg->conn_cfg.params.gatts_conn_cfg.hvn_tx_queue_size : BLE_GATTS_HVN_TX_QUEUE_SIZE_DEFAULT;
+    uv_mutex_unlock(&gattsHvnTxMutex);
+}
+
+// Returns true if the notification was handed to the SoftDevice, with its result and length.
+// Otherwise it was queued and the callback, if any, has been moved to the queued notification.
+// This runs in a worker thread (not Main Thread)
+bool Adapter::sendGattsHvn(std::unique_ptr<GattsHvnTxEntry> entry, Nan::Callback **callback, uint32_t *result, uint16_t *len)
+{
+    const auto conn_handle = entry->conn_handle;
+    const auto queued = entry.get();
+    auto sentNow = false;
+    auto signal = false;
+    GattsHvnTxEntries sent;
+
+    uv_mutex_lock(&gattsHvnTxMutex);
+
+    gattsHvnTxQueue.push(std::move(entry), gattsHvnTxQueueSize);
+    gattsHvnTxQueue.drain(adapter, conn_handle, sent);
+
+    for (auto &sentEntry : sent)
+    {
+        if (sentEntry.get() == queued)
+        {
+            sentNow = true;
+            *result = sentEntry->result;
+            *len = sentEntry->len;
+        }
+        else if (sentEntry->callback != nullptr)
+        {
+            gattsHvnTxCompleted.push_back(std::move(sentEntry));
+            signal = true;
+        }
+    }
+
+    if (!sentNow)
+    {
+        queued->callback = *callback;
+        *callback = nullptr;
+    }
+
+    uv_mutex_unlock(&gattsHvnTxMutex);
+
+    if (signal)
+    {
+        uv_mutex_lock(&adapterCloseMutex);
+
+        if (asyncGattsHvnTx != nullptr)
+        {
+            uv_async_send(asyncGattsHvnTx.get());
+        }
+
+        uv_mutex_unlock(&adapterCloseMutex);
+    }
+
+    return sentNow;
+}
+
+// Track the TX credits of each connection and send queued notifications when credits return.
+// This runs in thread SerializationTransport::eventThread
+void Adapter::handleGattsHvnTxEvent(ble_evt_t *event)
+{
+    const auto evt_id = event->header.evt_id;
+
+    if (evt_id != BLE_GAP_EVT_CONNECTED && evt_id != BLE_GAP_EVT_DISCONNECTED && evt_id != BLE_GATTS_EVT_HVN_TX_COMPLETE)
+    {
+        return;
+    }
+
+    auto signal = false;
+    GattsHvnTxEntries completed;
+
+    uv_mutex_lock(&gattsHvnTxMutex);
+
+    if (evt_id == BLE_GAP_EVT_CONNECTED)
+    {
+        gattsHvnTxQueue.connect(event->evt.gap_evt.conn_handle, gattsHvnTxQueueSize);
+    }
+    else if (evt_id == BLE_GAP_EVT_DISCONNECTED)
+    {
+        gattsHvnTxQueue.disconnect(event->evt.gap_evt.conn_handle, completed);
+    }
+    else
+    {
+        const auto conn_handle = event->evt.gatts_evt.conn_handle;
+        gattsHvnTxQueue.complete(conn_handle, event->evt.gatts_evt.params.hvn_tx_complete.count);
+        gattsHvnTxQueue.drain(adapter, conn_handle, completed);
+    }
+
+    for (auto &entry : completed)
+    {
+        if (entry->callback != nullptr)
+        {
+            gattsHvnTxCompleted.push_back(std::move(entry));
+            signal = true;
+        }
+    }
+
+    uv_mutex_unlock(&gattsHvnTxMutex);
+
+    if (signal)
+    {
+        uv_mutex_lock(&adapterCloseMutex);
+
+        if (asyncGattsHvnTx != nullptr)
+        {
+            uv_async_send(asyncGattsHvnTx.get());
+        }
+
+        uv_mutex_unlock(&adapterCloseMutex);
+    }
+}
+
+// Now we are in the NodeJS thread. Call callbacks.
+void Adapter::onGattsHvnTxEvent(uv_async_t *handle)
+{
+    completeGattsHvnTx();
+}
+
+// Call the callbacks of the queued notifications that have been handed to the SoftDevice or have failed
+void Adapter::completeGattsHvnTx()
+{
+    Nan::HandleScope scope;
+    GattsHvnTxEntries completed;
+
+    uv_mutex_lock(&gattsHvnTxMutex);
+    completed.swap(gattsHvnTxCompleted);
+    uv_mutex_unlock(&gattsHvnTxMutex);
+
+    for (auto &entry : completed)
+    {
+        v8::Local<v8::Value> argv[2];
+
+        if (entry->result != NRF_SUCCESS)
+        {
+            argv[0] = ErrorMessage::getErrorMessage(entry->result, "hvx");
+            argv[1] = Nan::Undefined();
+        }
+        else
+        {
+            argv[0] = Nan::Undefined();
+            argv[1] = ConversionUtility::toJsNumber(entry->len);
+        }
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        entry->callback->Call(2, argv, &resource);
+        delete entry->callback;
+    }
+}
+
+// Fail the notifications still queued, the connection to the SoftDevice is closing
+void Adapter::abortGattsHvnTx()
+{
+    uv_mutex_lock(&gattsHvnTxMutex);
+
+    GattsHvnTxEntries failed;
+    gattsHvnTxQueue.clear(failed);
+
+    for (auto &entry : failed)
+    {
+        if (entry->callback != nullptr)
+        {
+            gattsHvnTxCompleted.push_back(std::move(entry));
+        }
+    }
+
+    uv_mutex_unlock(&gattsHvnTxMutex);
+
+    completeGattsHvnTx();
+}
+#endif
+
+static void init_gatts_event_templates()
+{
+    EventTemplate::Register(BLE_GATTS_EVT_WRITE, { EVENT_TEMPLATE_HEADER, "handle", "op", "op_name", "auth_required", "uuid", "offset", "len", "data" });
+    EventTemplate::Register(BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST, { EVENT_TEMPLATE_HEADER, "type", "read", "write" });
+    EventTemplate::Register(BLE_GATTS_EVT_SYS_ATTR_MISSING, { EVENT_TEMPLATE_HEADER, "hint" });
+    EventTemplate::Register(BLE_GATTS_EVT_HVC, { EVENT_TEMPLATE_HEADER, "handle" });
+    EventTemplate::Register(BLE_GATTS_EVT_SC_CONFIRM, { EVENT_TEMPLATE_HEADER });
+    EventTemplate::Register(BLE_GATTS_EVT_TIMEOUT, { EVENT_TEMPLATE_HEADER, "src" });
+#if NRF_SD_BLE_API_VERSION >= 5
+    EventTemplate::Register(BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST, { EVENT_TEMPLATE_HEADER, "client_rx_mtu" });
+    EventTemplate::Register(BLE_GATTS_EVT_HVN_TX_COMPLETE, { EVENT_TEMPLATE_HEADER, "count" });
+#endif
+}
+
 extern "C" {
     void init_gatts(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target)
     {
+        init_gatts_event_templates();
+
         /* BLE_ERRORS_GATTS SVC return values specific to GATTS */
         NODE_DEFINE_CONSTANT(target, BLE_ERROR_GATTS_INVALID_ATTR_TYPE); /* Invalid attribute type. */
         NODE_DEFINE_CONSTANT(target, BLE_ERROR_GATTS_SYS_ATTR_MISSING); /* System Attributes missing. */
@@ -40,6 +40,8 @@
 #include "common.h"
 #include "ble_gatts.h"
 
+#include <vector>
+
 static name_map_t gatts_event_name_map =
 {
 #if NRF_SD_BLE_API_VERSION >= 5
@@ -58,7 +60,7 @@ class GattsEnableParameters : public BleToJs<ble_gatts_enable_params_t>
 {
 public:
     GattsEnableParameters(ble_gatts_enable_params_t *enableParamters) : BleToJs<ble_gatts_enable_params_t>(enableParamters) {}
-    GattsEnableParameters(v8::Local<v8::Object> js) : BleToJs<ble_gatts_enable_params_t>(js) {}
+    GattsEnableParameters(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_gatts_enable_params_t>(js, arena) {}
     v8::Local<v8::Object> ToJs() override;
     ble_gatts_enable_params_t *ToNative() override;
 };
@@ -68,7 +70,7 @@ class GattsAttributeMetadata : public BleToJs<ble_gatts_attr_md_t>
 {
 public:
     GattsAttributeMetadata(ble_gatts_attr_md_t *attributeMetadata) : BleToJs<ble_gatts_attr_md_t>(attributeMetadata) {}
-    GattsAttributeMetadata(v8::Local<v8::Object> js) : BleToJs<ble_gatts_attr_md_t>(js) {}
+    GattsAttributeMetadata(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_gatts_attr_md_t>(js, arena) {}
     ble_gatts_attr_md_t *ToNative() override;
 };
 
@@ -76,7 +78,7 @@ class GattsCharacteristicPresentationFormat : public BleToJs<ble_gatts_char_pf_t
 {
 public:
     GattsCharacteristicPresentationFormat(ble_gatts_char_pf_t *presentationformat) : BleToJs<ble_gatts_char_pf_t>(presentationformat) {}
-    GattsCharacteristicPresentationFormat(v8::Local<v8::Object> js) : BleToJs<ble_gatts_char_pf_t>(js) {}
+    GattsCharacteristicPresentationFormat(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_gatts_char_pf_t>(js, arena) {}
     ble_gatts_char_pf_t *ToNative() override;
 };
 
@@ -84,7 +86,7 @@ class GattsCharacteristicMetadata : public BleToJs<ble_gatts_char_md_t>
 {
 public:
     GattsCharacteristicMetadata(ble_gatts_char_md_t *metadata) : BleToJs<ble_gatts_char_md_t>(metadata) {}
-    GattsCharacteristicMetadata(v8::Local<v8::Object> js) : BleToJs<ble_gatts_char_md_t>(js) {}
+    GattsCharacteristicMetadata(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_gatts_char_md_t>(js, arena) {}
     ble_gatts_char_md_t *ToNative() override;
 };
 
@@ -92,7 +94,7 @@ class GattsAttribute : public BleToJs<ble_gatts_attr_t>
 {
 public:
     GattsAttribute(ble_gatts_attr_t *attribute) : BleToJs<ble_gatts_attr_t>(attribute) {}
-    GattsAttribute(v8::Local<v8::Object> js) : BleToJs<ble_gatts_attr_t>(js) {}
+    GattsAttribute(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_gatts_attr_t>(js, arena) {}
     ble_gatts_attr_t *ToNative() override ;
 };
 
@@ -108,8 +110,12 @@ class GattsHVXParams : public BleToJs<ble_gatts_hvx_params_t>
 {
 public:
     GattsHVXParams(ble_gatts_hvx_params_t *hvx_params) : BleToJs<ble_gatts_hvx_params_t>(hvx_params) {}
-    GattsHVXParams(v8::Local<v8::Object> js) : BleToJs<ble_gatts_hvx_params_t>(js) {}
+    GattsHVXParams(v8::Local<v8::Object> js, ConversionArena *arena = nullptr) : BleToJs<ble_gatts_hvx_params_t>(js, arena) {}
     ble_gatts_hvx_params_t *ToNative() override;
+
+    // Converts without throwing. p_len and p_data are allocated from the arena, or without one they are allocated
+    // and must be freed also when the conversion fails.
+    static Expected<ble_gatts_hvx_params_t *> read(v8::Local<v8::Object> js, ble_gatts_hvx_params_t *hvxparams, ConversionArena *arena = nullptr);
 };
 
 class GattsValue : public BleToJs<ble_gatts_value_t>
@@ -247,9 +253,8 @@ struct GattsAddServiceBaton : public Baton
 {
 public:
     BATON_CONSTRUCTOR(GattsAddServiceBaton);
-    BATON_DESTRUCTOR(GattsAddServiceBaton) { delete p_uuid; }
     uint8_t type;
-    ble_uuid_t *p_uuid;
+    ble_uuid_t *p_uuid; // Allocated from the arena
     uint16_t p_handle;
 };
 
@@ -257,14 +262,9 @@ struct GattsAddCharacteristicBaton : public Baton
 {
 public:
     BATON_CONSTRUCTOR(GattsAddCharacteristicBaton);
-    BATON_DESTRUCTOR(GattsAddCharacteristicBaton)
-    {
-        delete p_char_md;
-        free((char*)(p_attr_char_value->p_value));
-        delete p_attr_char_value;
-        delete p_handles;
-    }
+    Adapter *mainObject;
     uint16_t service_handle;
+    // Allocated from the arena
     ble_gatts_char_md_t *p_char_md;
     ble_gatts_attr_t *p_attr_char_value;
     ble_gatts_char_handles_t *p_handles;
@@ -274,13 +274,8 @@ struct GattsAddDescriptorBaton : public Baton
 {
 public:
     BATON_CONSTRUCTOR(GattsAddDescriptorBaton);
-    BATON_DESTRUCTOR(GattsAddDescriptorBaton)
-    {
-        free((char*)(p_attr->p_value));
-        delete p_attr;
-    }
     uint16_t char_handle;
-    ble_gatts_attr_t *p_attr;
+    ble_gatts_attr_t *p_attr; // Allocated from the arena
     uint16_t p_handle;
 };
 
@@ -288,14 +283,28 @@ struct GattsHVXBaton : public Baton
 {
 public:
     BATON_CONSTRUCTOR(GattsHVXBaton);
-    BATON_DESTRUCTOR(GattsHVXBaton)
-    {
-        free((char*)(p_hvx_params->p_len));
-        free((char*)(p_hvx_params->p_data));
-        delete p_hvx_params;
-    }
+    Adapter *mainObject;
     uint16_t conn_handle;
-    ble_gatts_hvx_params_t *p_hvx_params;
+    ble_gatts_hvx_params_t *p_hvx_params; // Allocated from the arena
+};
+
+// Handle Value Notification or Indication sent to one subscribed connection
+struct GattsNotifyAllResult
+{
+    uint16_t conn_handle;
+    uint8_t type;
+    uint16_t len;
+    uint32_t result;
+};
+
+struct GattsNotifyAllBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GattsNotifyAllBaton);
+    Adapter *mainObject;
+    uint16_t handle;
+    std::vector<uint8_t> value;
+    std::vector<GattsNotifyAllResult> results;
 };
 
 struct GattsSystemAttributeSetBaton : public Baton
@@ -303,6 +312,7 @@ struct GattsSystemAttributeSetBaton : public Baton
 public:
     BATON_CONSTRUCTOR(GattsSystemAttributeSetBaton);
     BATON_DESTRUCTOR(GattsSystemAttributeSetBaton) { free(p_sys_attr_data); }
+    Adapter *mainObject;
     uint16_t conn_handle;
     uint8_t *p_sys_attr_data;
     uint16_t len;
@@ -342,6 +352,7 @@ struct GattsReplyReadWriteAuthorizeBaton : public Baton
 public:
     BATON_CONSTRUCTOR(GattsReplyReadWriteAuthorizeBaton);
     BATON_DESTRUCTOR(GattsReplyReadWriteAuthorizeBaton) { delete p_rw_authorize_reply_params; }
+    Adapter *mainObject;
     uint16_t conn_handle;
     ble_gatts_rw_authorize_reply_params_t *p_rw_authorize_reply_params;
 };
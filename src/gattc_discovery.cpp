@@ -0,0 +1,473 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "gattc_discovery.h"
+#include "driver_gattc.h"
+
+namespace
+{
+    // Default ATT_MTU, the same for all SoftDevice API versions
+    constexpr uint16_t ATT_MTU_DEFAULT = 23;
+
+    // Read and Read Blob Responses have a 1 byte header
+    constexpr uint16_t READ_RESPONSE_HEADER_SIZE = 1;
+
+    bool isDeclaration(const ble_uuid_t &uuid)
+    {
+        if (uuid.type != BLE_UUID_TYPE_BLE)
+        {
+            return false;
+        }
+
+        return uuid.uuid == BLE_UUID_SERVICE_PRIMARY
+            || uuid.uuid == BLE_UUID_SERVICE_SECONDARY
+            || uuid.uuid == BLE_UUID_SERVICE_INCLUDE
+            || uuid.uuid == BLE_UUID_CHARACTERISTIC;
+    }
+}
+
+GattcDiscovery::GattcDiscovery(adapter_t *adapter, const uint16_t connHandle, const bool readValues, const uint16_t attMtu, v8::Local<v8::Function> callback) :
+    GattcProcedure(adapter, connHandle, "discovering attributes", callback),
+    readValues(readValues),
+    partSize(std::max(attMtu, ATT_MTU_DEFAULT) - READ_RESPONSE_HEADER_SIZE),
+    step(Step::PrimaryServices),
+    readHandle(0),
+    readOffset(0),
+    servicesDiscovered(false),
+    nextServiceHandle(1),
+    serviceIndex(0),
+    characteristicIndex(0),
+    descriptorIndex(0)
+{
+}
+
+const std::vector<GattcDiscoveredService> &GattcDiscovery::getServices() const
+{
+    return services;
+}
+
+v8::Local<v8::Value> GattcDiscovery::resultToJs() const
+{
+    Nan::EscapableHandleScope scope;
+    v8::Local<v8::Array> service_array = Nan::New<v8::Array>();
+
+    for (size_t i = 0; i < services.size(); ++i)
+    {
+        const auto &service = services[i];
+        auto native_service = service.service;
+        auto service_obj = GattcService(&native_service).ToJs();
+
+        if (!service.uuid128.empty())
+        {
+            Utility::Set(service_obj, "uuid128", ConversionUtility::toJsValueArray(service.uuid128.data(), static_cast<uint16_t>(service.uuid128.size())));
+        }
+
+        v8::Local<v8::Array> characteristic_array = Nan::New<v8::Array>();
+
+        for (size_t j = 0; j < service.characteristics.size(); ++j)
+        {
+            const auto &characteristic = service.characteristics[j];
+            auto native_characteristic = characteristic.characteristic;
+            auto characteristic_obj = GattcCharacteristic(&native_characteristic).ToJs();
+
+            if (!characteristic.uuid128.empty())
+            {
+                Utility::Set(characteristic_obj, "uuid128", ConversionUtility::toJsValueArray(characteristic.uuid128.data(), static_cast<uint16_t>(characteristic.uuid128.size())));
+            }
+
+            Utility::Set(characteristic_obj, "value", ConversionUtility::toJsValueArray(characteristic.value.data(), static_cast<uint16_t>(characteristic.value.size())));
+
+            v8::Local<v8::Array> descriptor_array = Nan::New<v8::Array>();
+
+            for (size_t k = 0; k < characteristic.descriptors.size(); ++k)
+            {
+                const auto &descriptor = characteristic.descriptors[k];
+                auto native_descriptor = descriptor.descriptor;
+                auto descriptor_obj = GattcDescriptor(&native_descriptor).ToJs();
+
+                Utility::Set(descriptor_obj, "value", ConversionUtility::toJsValueArray(descriptor.value.data(), static_cast<uint16_t>(descriptor.value.size())));
+                Nan::Set(descriptor_array, static_cast<uint32_t>(k), descriptor_obj);
+            }
+
+            Utility::Set(characteristic_obj, "descriptors", descriptor_array);
+            Nan::Set(characteristic_array, static_cast<uint32_t>(j), characteristic_obj);
+        }
+
+        Utility::Set(service_obj, "characteristics", characteristic_array);
+        Nan::Set(service_array, static_cast<uint32_t>(i), service_obj);
+    }
+
+    return scope.Escape(service_array);
+}
+
+bool GattcDiscovery::onResponse(const uint16_t evtId, ble_gattc_evt_t &event)
+{
+    switch (evtId)
+    {
+        case BLE_GATTC_EVT_PRIM_SRVC_DISC_RSP:
+            if (step != Step::PrimaryServices) return false;
+            onPrimaryServiceDiscoveryResponse(event);
+            return true;
+        case BLE_GATTC_EVT_CHAR_DISC_RSP:
+            if (step != Step::Characteristics) return false;
+            onCharacteristicDiscoveryResponse(event);
+            return true;
+        case BLE_GATTC_EVT_DESC_DISC_RSP:
+            if (step != Step::Descriptors) return false;
+            onDescriptorDiscoveryResponse(event);
+            return true;
+        case BLE_GATTC_EVT_READ_RSP:
+            if (step != Step::ServiceUuid && step != Step::CharacteristicUuid
+                && step != Step::CharacteristicValue && step != Step::DescriptorValue)
+            {
+                return false;
+            }
+
+            if (event.params.read_rsp.handle != readHandle) return false;
+            onReadResponse(event);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Issues the request for the first attribute in the tree that is not complete yet.
+// The tree is walked depth first so that only one GATT procedure is running at a time.
+uint32_t GattcDiscovery::requestNext()
+{
+    if (!servicesDiscovered)
+    {
+        step = Step::PrimaryServices;
+        operation = "discovering primary services";
+        return sd_ble_gattc_primary_services_discover(adapter, connHandle, static_cast<uint16_t>(nextServiceHandle), nullptr);
+    }
+
+    while (serviceIndex < services.size())
+    {
+        auto &service = services[serviceIndex];
+
+        if (service.uuidPending)
+        {
+            step = Step::ServiceUuid;
+            return read(service.service.handle_range.start_handle);
+        }
+
+        if (!service.characteristicsDiscovered)
+        {
+            if (service.nextHandle <= service.service.handle_range.end_handle)
+            {
+                ble_gattc_handle_range_t handleRange;
+                handleRange.start_handle = static_cast<uint16_t>(service.nextHandle);
+                handleRange.end_handle = service.service.handle_range.end_handle;
+
+                step = Step::Characteristics;
+                operation = "discovering characteristics";
+                return sd_ble_gattc_characteristics_discover(adapter, connHandle, &handleRange);
+            }
+
+            service.characteristicsDiscovered = true;
+        }
+
+        while (characteristicIndex < service.characteristics.size())
+        {
+            auto &characteristic = service.characteristics[characteristicIndex];
+
+            if (characteristic.uuidPending)
+            {
+                step = Step::CharacteristicUuid;
+                return read(characteristic.characteristic.handle_decl);
+            }
+
+            if (characteristic.valuePending)
+            {
+                step = Step::CharacteristicValue;
+                return read(characteristic.characteristic.handle_value);
+            }
+
+            if (!characteristic.descriptorsDiscovered)
+            {
+                if (characteristic.nextHandle <= characteristic.endHandle)
+                {
+                    ble_gattc_handle_range_t handleRange;
+                    handleRange.start_handle = static_cast<uint16_t>(characteristic.nextHandle);
+                    handleRange.end_handle = characteristic.endHandle;
+
+                    step = Step::Descriptors;
+                    operation = "discovering descriptors";
+                    return sd_ble_gattc_descriptors_discover(adapter, connHandle, &handleRange);
+                }
+
+                characteristic.descriptorsDiscovered = true;
+            }
+
+            while (descriptorIndex < characteristic.descriptors.size())
+            {
+                auto &descriptor = characteristic.descriptors[descriptorIndex];
+
+                if (descriptor.valuePending)
+                {
+                    step = Step::DescriptorValue;
+                    return read(descriptor.descriptor.handle);
+                }
+
+                descriptorIndex++;
+            }
+
+            descriptorIndex = 0;
+            characteristicIndex++;
+        }
+
+        characteristicIndex = 0;
+        serviceIndex++;
+    }
+
+    finish(NRF_SUCCESS, BLE_GATT_STATUS_SUCCESS, "");
+    return NRF_SUCCESS;
+}
+
+// The SoftDevice sends a Read Request for offset 0 and Read Blob Requests for the rest of a long value
+uint32_t GattcDiscovery::read(const uint16_t handle)
+{
+    readHandle = handle;
+    operation = "reading attribute";
+    return sd_ble_gattc_read(adapter, connHandle, handle, readOffset);
+}
+
+void GattcDiscovery::onPrimaryServiceDiscoveryResponse(const ble_gattc_evt_t &event)
+{
+    const auto &response = event.params.prim_srvc_disc_rsp;
+
+    if (event.gatt_status == BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_FOUND || response.count == 0)
+    {
+        servicesDiscovered = true;
+        return;
+    }
+
+    if (event.gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        finish(NRF_SUCCESS, event.gatt_status, operation);
+        return;
+    }
+
+    for (auto i = 0; i < response.count; i++)
+    {
+        GattcDiscoveredService service;
+        service.service = response.services[i];
+        service.uuidPending = service.service.uuid.type == BLE_UUID_TYPE_UNKNOWN;
+        service.characteristicsDiscovered = false;
+        service.nextHandle = service.service.handle_range.start_handle;
+
+        services.push_back(std::move(service));
+    }
+
+    nextServiceHandle = static_cast<uint32_t>(response.services[response.count - 1].handle_range.end_handle) + 1;
+
+    if (nextServiceHandle > BLE_GATT_HANDLE_END)
+    {
+        servicesDiscovered = true;
+    }
+}
+
+void GattcDiscovery::onCharacteristicDiscoveryResponse(const ble_gattc_evt_t &event)
+{
+    const auto &response = event.params.char_disc_rsp;
+    auto &service = services[serviceIndex];
+
+    if (event.gatt_status == BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_FOUND || response.count == 0)
+    {
+        service.nextHandle = static_cast<uint32_t>(service.service.handle_range.end_handle) + 1;
+    }
+    else if (event.gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        finish(NRF_SUCCESS, event.gatt_status, operation);
+        return;
+    }
+    else
+    {
+        for (auto i = 0; i < response.count; i++)
+        {
+            GattcDiscoveredCharacteristic characteristic;
+            characteristic.characteristic = response.chars[i];
+            characteristic.endHandle = service.service.handle_range.end_handle;
+            characteristic.uuidPending = characteristic.characteristic.uuid.type == BLE_UUID_TYPE_UNKNOWN;
+            characteristic.valuePending = readValues && characteristic.characteristic.char_props.read;
+            characteristic.descriptorsDiscovered = false;
+            characteristic.nextHandle = static_cast<uint32_t>(characteristic.characteristic.handle_value) + 1;
+
+            service.characteristics.push_back(std::move(characteristic));
+        }
+
+        service.nextHandle = static_cast<uint32_t>(response.chars[response.count - 1].handle_decl) + 1;
+    }
+
+    if (service.nextHandle <= service.service.handle_range.end_handle)
+    {
+        return;
+    }
+
+    // Descriptors of a characteristic are located between its value and the next declaration
+    for (size_t i = 0; i + 1 < service.characteristics.size(); i++)
+    {
+        service.characteristics[i].endHandle = service.characteristics[i + 1].characteristic.handle_decl - 1;
+    }
+
+    service.characteristicsDiscovered = true;
+}
+
+void GattcDiscovery::onDescriptorDiscoveryResponse(const ble_gattc_evt_t &event)
+{
+    const auto &response = event.params.desc_disc_rsp;
+    auto &characteristic = services[serviceIndex].characteristics[characteristicIndex];
+
+    if (event.gatt_status == BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_FOUND || response.count == 0)
+    {
+        characteristic.descriptorsDiscovered = true;
+        return;
+    }
+
+    if (event.gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        finish(NRF_SUCCESS, event.gatt_status, operation);
+        return;
+    }
+
+    for (auto i = 0; i < response.count; i++)
+    {
+        const auto &desc = response.descs[i];
+
+        if (desc.handle > characteristic.endHandle || isDeclaration(desc.uuid))
+        {
+            characteristic.descriptorsDiscovered = true;
+            return;
+        }
+
+        GattcDiscoveredDescriptor descriptor;
+        descriptor.descriptor = desc;
+        descriptor.valuePending = readValues;
+
+        characteristic.descriptors.push_back(std::move(descriptor));
+    }
+
+    characteristic.nextHandle = static_cast<uint32_t>(response.descs[response.count - 1].handle) + 1;
+
+    if (characteristic.nextHandle > characteristic.endHandle)
+    {
+        characteristic.descriptorsDiscovered = true;
+    }
+}
+
+// Failed reads are not fatal, the attribute is reported without the UUID or value
+void GattcDiscovery::onReadResponse(const ble_gattc_evt_t &event)
+{
+    const auto &response = event.params.read_rsp;
+    const auto success = event.gatt_status == BLE_GATT_STATUS_SUCCESS;
+    auto &service = services[serviceIndex];
+
+    switch (step)
+    {
+        case Step::ServiceUuid:
+            // Service declaration value is the 128-bit service UUID
+            if (success && response.len == 16)
+            {
+                service.uuid128.assign(response.data, response.data + response.len);
+            }
+
+            service.uuidPending = false;
+            break;
+        case Step::CharacteristicUuid:
+        {
+            // Characteristic declaration value is properties (1 byte), value handle (2 bytes) and the 128-bit UUID
+            auto &characteristic = service.characteristics[characteristicIndex];
+
+            if (success && response.len == 19)
+            {
+                characteristic.uuid128.assign(response.data + 3, response.data + response.len);
+            }
+
+            characteristic.uuidPending = false;
+            break;
+        }
+        case Step::CharacteristicValue:
+        {
+            auto &characteristic = service.characteristics[characteristicIndex];
+            characteristic.valuePending = !readValuePart(event, characteristic.value);
+            break;
+        }
+        case Step::DescriptorValue:
+        {
+            auto &descriptor = service.characteristics[characteristicIndex].descriptors[descriptorIndex];
+            descriptor.valuePending = !readValuePart(event, descriptor.value);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Appends a part of a long value, returns false while there is more of the value to read. A value that fails
+// to read completely is reported without a value, so a truncated value is never cached.
+bool GattcDiscovery::readValuePart(const ble_gattc_evt_t &event, std::vector<uint8_t> &value)
+{
+    const auto &response = event.params.read_rsp;
+    const auto offset = readOffset;
+
+    readOffset = 0;
+
+    if (event.gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        // The previous part ended exactly at the end of the value
+        if (offset == 0 || (event.gatt_status != BLE_GATT_STATUS_ATTERR_INVALID_OFFSET
+            && event.gatt_status != BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_LONG))
+        {
+            value.clear();
+        }
+
+        return true;
+    }
+
+    value.insert(value.end(), response.data, response.data + response.len);
+
+    // A response shorter than the ATT_MTU allows holds the end of the value
+    if (response.len < partSize || response.len == 0 || value.size() >= ATTRIBUTE_VALUE_MAX_LENGTH)
+    {
+        return true;
+    }
+
+    readOffset = static_cast<uint16_t>(value.size());
+    return false;
+}
@@ -0,0 +1,133 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GATTC_DISCOVERY_H
+#define GATTC_DISCOVERY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "gattc_procedure.h"
+
+struct GattcDiscoveredDescriptor
+{
+public:
+    ble_gattc_desc_t descriptor;
+    bool valuePending;
+    std::vector<uint8_t> value;
+};
+
+struct GattcDiscoveredCharacteristic
+{
+public:
+    ble_gattc_char_t characteristic;
+    uint16_t endHandle;                 // Last handle that may hold a descriptor of this characteristic
+
+    bool uuidPending;                   // 128-bit UUID unknown to the SoftDevice, read from the declaration
+    std::vector<uint8_t> uuid128;
+    bool valuePending;
+    std::vector<uint8_t> value;
+
+    bool descriptorsDiscovered;
+    uint32_t nextHandle;
+    std::vector<GattcDiscoveredDescriptor> descriptors;
+};
+
+struct GattcDiscoveredService
+{
+public:
+    ble_gattc_service_t service;
+
+    bool uuidPending;                   // 128-bit UUID unknown to the SoftDevice, read from the declaration
+    std::vector<uint8_t> uuid128;
+
+    bool characteristicsDiscovered;
+    uint32_t nextHandle;
+    std::vector<GattcDiscoveredCharacteristic> characteristics;
+};
+
+// Walks the complete attribute tree of a peer GATT server.
+class GattcDiscovery : public GattcProcedure
+{
+public:
+    // Values longer than a Read Response for attMtu are read in parts with Read Blob Requests, like GattcReadLong
+    GattcDiscovery(adapter_t *adapter, const uint16_t connHandle, const bool readValues, const uint16_t attMtu, v8::Local<v8::Function> callback);
+
+    const std::vector<GattcDiscoveredService> &getServices() const;
+
+    v8::Local<v8::Value> resultToJs() const override;
+
+protected:
+    uint32_t requestNext() override;
+    bool onResponse(const uint16_t evtId, ble_gattc_evt_t &event) override;
+
+private:
+    enum class Step
+    {
+        PrimaryServices,
+        ServiceUuid,
+        Characteristics,
+        CharacteristicUuid,
+        CharacteristicValue,
+        Descriptors,
+        DescriptorValue
+    };
+
+    uint32_t read(const uint16_t handle);
+
+    void onPrimaryServiceDiscoveryResponse(const ble_gattc_evt_t &event);
+    void onCharacteristicDiscoveryResponse(const ble_gattc_evt_t &event);
+    void onDescriptorDiscoveryResponse(const ble_gattc_evt_t &event);
+    void onReadResponse(const ble_gattc_evt_t &event);
+    bool readValuePart(const ble_gattc_evt_t &event, std::vector<uint8_t> &value);
+
+    const bool readValues;
+    const uint16_t partSize;
+
+    Step step;
+    uint16_t readHandle;
+    uint16_t readOffset;
+
+    bool servicesDiscovered;
+    uint32_t nextServiceHandle;
+    size_t serviceIndex;
+    size_t characteristicIndex;
+    size_t descriptorIndex;
+
+    std::vector<GattcDiscoveredService> services;
+};
+
+#endif // GATTC_DISCOVERY_H
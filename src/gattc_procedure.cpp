@@ -0,0 +1,178 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gattc_procedure.h"
+#include "ble_err.h"
+
+GattcProcedure::GattcProcedure(adapter_t *adapter, const uint16_t connHandle, const std::string &description, v8::Local<v8::Function> callback) :
+    callback(std::make_unique<Nan::Callback>(callback)),
+    adapter(adapter),
+    connHandle(connHandle),
+    shared(false),
+    description(description),
+    state(State::Idle),
+    errorCode(NRF_SUCCESS),
+    gattStatus(BLE_GATT_STATUS_SUCCESS)
+{
+}
+
+uint32_t GattcProcedure::start()
+{
+    if (state != State::Idle)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    state = State::Running;
+
+    const auto err_code = requestNext();
+
+    if (err_code != NRF_SUCCESS)
+    {
+        // Let the caller report the error, the procedure can not be continued
+        state = State::Idle;
+    }
+
+    return err_code;
+}
+
+bool GattcProcedure::onEvent(ble_evt_t *event)
+{
+    if (!isStarted() || isFinished())
+    {
+        return false;
+    }
+
+    const auto evt_id = event->header.evt_id;
+
+    if (evt_id == BLE_GAP_EVT_DISCONNECTED)
+    {
+        if (event->evt.gap_evt.conn_handle == connHandle)
+        {
+            finish(BLE_ERROR_INVALID_CONN_HANDLE, BLE_GATT_STATUS_SUCCESS, description + ", peer disconnected");
+        }
+
+        // The application must be told about the disconnect
+        return false;
+    }
+
+    if (evt_id < BLE_GATTC_EVT_BASE || evt_id > BLE_GATTC_EVT_LAST)
+    {
+        return false;
+    }
+
+    auto &gattc_evt = event->evt.gattc_evt;
+
+    if (gattc_evt.conn_handle != connHandle)
+    {
+        return false;
+    }
+
+    if (evt_id == BLE_GATTC_EVT_TIMEOUT)
+    {
+        finish(NRF_ERROR_TIMEOUT, BLE_GATT_STATUS_SUCCESS, description + ", GATT procedure timed out");
+
+        // The application must be told about the timeout, no more GATT procedures are allowed on the link
+        return false;
+    }
+
+    shared = false;
+
+    if (!onResponse(evt_id, gattc_evt))
+    {
+        return false;
+    }
+
+    if (!isFinished())
+    {
+        const auto err_code = requestNext();
+
+        if (err_code != NRF_SUCCESS)
+        {
+            finish(err_code, BLE_GATT_STATUS_SUCCESS, operation);
+        }
+    }
+
+    return !shared;
+}
+
+void GattcProcedure::abort(const uint32_t errorCode, const std::string &reason)
+{
+    if (isFinished())
+    {
+        return;
+    }
+
+    finish(errorCode, BLE_GATT_STATUS_SUCCESS, description + ", " + reason);
+}
+
+bool GattcProcedure::isStarted() const
+{
+    return state != State::Idle;
+}
+
+bool GattcProcedure::isFinished() const
+{
+    return state == State::Finished;
+}
+
+uint16_t GattcProcedure::getConnHandle() const
+{
+    return connHandle;
+}
+
+uint32_t GattcProcedure::getErrorCode() const
+{
+    return errorCode;
+}
+
+uint16_t GattcProcedure::getGattStatus() const
+{
+    return gattStatus;
+}
+
+const std::string &GattcProcedure::getErrorOperation() const
+{
+    return errorOperation;
+}
+
+void GattcProcedure::finish(const uint32_t errorCode, const uint16_t gattStatus, const std::string &operation)
+{
+    state = State::Finished;
+    this->errorCode = errorCode;
+    this->gattStatus = gattStatus;
+    this->errorOperation = operation;
+}
@@ -0,0 +1,117 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GATTC_PROCEDURE_H
+#define GATTC_PROCEDURE_H
+
+#include <nan.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "sd_rpc.h"
+
+// Maximum length of an attribute value, Core specification Vol 3, Part F, 3.2.9
+constexpr uint16_t ATTRIBUTE_VALUE_MAX_LENGTH = 512;
+
+// A GATT client procedure made of several requests. The requests are issued from the responses
+// arriving in thread SerializationTransport::eventThread, so the NodeJS thread is only involved
+// when the procedure is started and when the result is ready.
+//
+// The object is not thread safe, the owner must serialize calls to start, onEvent and abort.
+class GattcProcedure
+{
+public:
+    GattcProcedure(adapter_t *adapter, const uint16_t connHandle, const std::string &description, v8::Local<v8::Function> callback);
+    virtual ~GattcProcedure() = default;
+
+    uint32_t start();
+
+    // Returns true if the event was a response to a request issued by this procedure and is consumed.
+    // An event only partly used by the procedure is left with what belongs to the application.
+    bool onEvent(ble_evt_t *event);
+    void abort(const uint32_t errorCode, const std::string &reason);
+
+    bool isStarted() const;
+    bool isFinished() const;
+
+    uint16_t getConnHandle() const;
+    uint32_t getErrorCode() const;
+    uint16_t getGattStatus() const;
+    const std::string &getErrorOperation() const;
+
+    // Result of a successful procedure, only called in the NodeJS thread
+    virtual v8::Local<v8::Value> resultToJs() const = 0;
+
+    // Only accessed in the NodeJS thread
+    std::unique_ptr<Nan::Callback> callback;
+
+protected:
+    // Issues the next request, or finishes the procedure if there is nothing left to request
+    virtual uint32_t requestNext() = 0;
+
+    // Returns true if the GATTC event is a response to the request in progress. A procedure that
+    // only uses part of the event removes that part from it and sets shared.
+    virtual bool onResponse(const uint16_t evtId, ble_gattc_evt_t &event) = 0;
+
+    void finish(const uint32_t errorCode, const uint16_t gattStatus, const std::string &operation);
+
+    adapter_t *adapter;
+    const uint16_t connHandle;
+
+    // Request in progress, reported if it fails
+    std::string operation;
+
+    // Set by onResponse when the rest of the event must still be passed to the application
+    bool shared;
+
+private:
+    enum class State
+    {
+        Idle,
+        Running,
+        Finished
+    };
+
+    const std::string description;
+    State state;
+
+    uint32_t errorCode;
+    uint16_t gattStatus;
+    std::string errorOperation;
+};
+
+#endif // GATTC_PROCEDURE_H
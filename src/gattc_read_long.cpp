@@ -0,0 +1,111 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "gattc_read_long.h"
+
+namespace
+{
+    // Default ATT_MTU, the same for all SoftDevice API versions
+    constexpr uint16_t ATT_MTU_DEFAULT = 23;
+
+    // Read and Read Blob Responses have a 1 byte header
+    constexpr uint16_t READ_RESPONSE_HEADER_SIZE = 1;
+}
+
+GattcReadLong::GattcReadLong(adapter_t *adapter, const uint16_t connHandle, const uint16_t handle, const uint16_t attMtu, v8::Local<v8::Function> callback) :
+    GattcProcedure(adapter, connHandle, "reading long attribute", callback),
+    handle(handle),
+    partSize(std::max(attMtu, ATT_MTU_DEFAULT) - READ_RESPONSE_HEADER_SIZE),
+    complete(false)
+{
+    value.reserve(ATTRIBUTE_VALUE_MAX_LENGTH);
+}
+
+const std::vector<uint8_t> &GattcReadLong::getValue() const
+{
+    return value;
+}
+
+v8::Local<v8::Value> GattcReadLong::resultToJs() const
+{
+    Nan::EscapableHandleScope scope;
+    return scope.Escape(Nan::CopyBuffer(reinterpret_cast<const char *>(value.data()), static_cast<uint32_t>(value.size())).ToLocalChecked());
+}
+
+uint32_t GattcReadLong::requestNext()
+{
+    if (complete)
+    {
+        finish(NRF_SUCCESS, BLE_GATT_STATUS_SUCCESS, "");
+        return NRF_SUCCESS;
+    }
+
+    // The SoftDevice sends a Read Request for offset 0 and Read Blob Requests for the rest
+    operation = "reading attribute";
+    return sd_ble_gattc_read(adapter, connHandle, handle, static_cast<uint16_t>(value.size()));
+}
+
+bool GattcReadLong::onResponse(const uint16_t evtId, ble_gattc_evt_t &event)
+{
+    if (evtId != BLE_GATTC_EVT_READ_RSP || event.params.read_rsp.handle != handle)
+    {
+        return false;
+    }
+
+    const auto &response = event.params.read_rsp;
+
+    if (event.gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        // The previous part ended exactly at the end of the value
+        if (!value.empty() && (event.gatt_status == BLE_GATT_STATUS_ATTERR_INVALID_OFFSET
+            || event.gatt_status == BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_LONG))
+        {
+            complete = true;
+            return true;
+        }
+
+        finish(NRF_SUCCESS, event.gatt_status, operation);
+        return true;
+    }
+
+    value.insert(value.end(), response.data, response.data + response.len);
+
+    // A response shorter than the ATT_MTU allows holds the end of the value
+    complete = response.len < partSize || response.len == 0 || value.size() >= ATTRIBUTE_VALUE_MAX_LENGTH;
+    return true;
+}
@@ -0,0 +1,180 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "gattc_write_long.h"
+
+namespace
+{
+    // Prepare Write Request header: opcode (1 byte), handle (2 bytes) and offset (2 bytes)
+    constexpr uint16_t PREPARE_WRITE_HEADER_SIZE = 5;
+
+    // Default ATT_MTU, the same for all SoftDevice API versions
+    constexpr uint16_t ATT_MTU_DEFAULT = 23;
+}
+
+GattcWriteLong::GattcWriteLong(adapter_t *adapter, const uint16_t connHandle, const uint16_t handle, std::vector<uint8_t> value, const uint16_t attMtu, const bool reliable, v8::Local<v8::Function> callback) :
+    GattcProcedure(adapter, connHandle, "writing long attribute", callback),
+    handle(handle),
+    value(std::move(value)),
+    partSize(std::max(attMtu, ATT_MTU_DEFAULT) - PREPARE_WRITE_HEADER_SIZE),
+    reliable(reliable),
+    step(Step::Prepare),
+    offset(0),
+    partLength(0),
+    cancelErrorCode(NRF_SUCCESS),
+    cancelGattStatus(BLE_GATT_STATUS_SUCCESS)
+{
+}
+
+v8::Local<v8::Value> GattcWriteLong::resultToJs() const
+{
+    Nan::EscapableHandleScope scope;
+    return scope.Escape(Nan::Undefined());
+}
+
+uint32_t GattcWriteLong::requestNext()
+{
+    switch (step)
+    {
+        case Step::Prepare:
+            if (offset < value.size())
+            {
+                partLength = static_cast<uint16_t>(std::min<size_t>(partSize, value.size() - offset));
+                operation = "preparing write";
+                return write(BLE_GATT_OP_PREP_WRITE_REQ, 0, partLength);
+            }
+
+            step = Step::Execute;
+            operation = "executing write";
+            return write(BLE_GATT_OP_EXEC_WRITE_REQ, BLE_GATT_EXEC_WRITE_FLAG_PREPARED_WRITE, 0);
+        case Step::Cancel:
+            operation = "cancelling prepared write";
+            return write(BLE_GATT_OP_EXEC_WRITE_REQ, BLE_GATT_EXEC_WRITE_FLAG_PREPARED_CANCEL, 0);
+        default:
+            finish(cancelErrorCode, cancelGattStatus, cancelOperation);
+            return NRF_SUCCESS;
+    }
+}
+
+bool GattcWriteLong::onResponse(const uint16_t evtId, ble_gattc_evt_t &event)
+{
+    if (evtId != BLE_GATTC_EVT_WRITE_RSP)
+    {
+        return false;
+    }
+
+    const auto &response = event.params.write_rsp;
+
+    switch (step)
+    {
+        case Step::Prepare:
+            if (response.write_op != BLE_GATT_OP_PREP_WRITE_REQ) return false;
+            onPrepareWriteResponse(event);
+            return true;
+        case Step::Execute:
+            if (response.write_op != BLE_GATT_OP_EXEC_WRITE_REQ) return false;
+
+            if (event.gatt_status != BLE_GATT_STATUS_SUCCESS)
+            {
+                finish(NRF_SUCCESS, event.gatt_status, operation);
+                return true;
+            }
+
+            step = Step::Done;
+            return true;
+        case Step::Cancel:
+            if (response.write_op != BLE_GATT_OP_EXEC_WRITE_REQ) return false;
+
+            // The error that caused the cancel is reported, not the result of the cancel
+            step = Step::Done;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void GattcWriteLong::onPrepareWriteResponse(const ble_gattc_evt_t &event)
+{
+    const auto &response = event.params.write_rsp;
+
+    if (event.gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        cancel(NRF_SUCCESS, event.gatt_status, operation);
+        return;
+    }
+
+    if (reliable)
+    {
+        const auto echoed = response.handle == handle
+            && response.offset == offset
+            && response.len == partLength
+            && std::memcmp(response.data, value.data() + offset, partLength) == 0;
+
+        if (!echoed)
+        {
+            cancel(NRF_ERROR_INVALID_DATA, BLE_GATT_STATUS_SUCCESS, "verifying prepared write");
+            return;
+        }
+    }
+
+    offset += partLength;
+}
+
+uint32_t GattcWriteLong::write(const uint8_t writeOp, const uint8_t flags, const uint16_t length)
+{
+    ble_gattc_write_params_t writeParams;
+    std::memset(&writeParams, 0, sizeof(writeParams));
+
+    writeParams.write_op = writeOp;
+    writeParams.flags = flags;
+    writeParams.handle = handle;
+    writeParams.offset = writeOp == BLE_GATT_OP_PREP_WRITE_REQ ? offset : 0;
+    writeParams.len = length;
+    writeParams.p_value = length > 0 ? value.data() + offset : nullptr;
+
+    return sd_ble_gattc_write(adapter, connHandle, &writeParams);
+}
+
+void GattcWriteLong::cancel(const uint32_t errorCode, const uint16_t gattStatus, const std::string &operation)
+{
+    step = Step::Cancel;
+    cancelErrorCode = errorCode;
+    cancelGattStatus = gattStatus;
+    cancelOperation = operation;
+}
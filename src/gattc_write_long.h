@@ -0,0 +1,89 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GATTC_WRITE_LONG_H
+#define GATTC_WRITE_LONG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gattc_procedure.h"
+
+// Writes a value longer than a single Write Request allows with Prepare Write Requests followed by
+// an Execute Write Request. For reliable writes the value echoed in each Prepare Write Response is
+// verified, and the prepared writes are cancelled if it differs.
+class GattcWriteLong : public GattcProcedure
+{
+public:
+    GattcWriteLong(adapter_t *adapter, const uint16_t connHandle, const uint16_t handle, std::vector<uint8_t> value, const uint16_t attMtu, const bool reliable, v8::Local<v8::Function> callback);
+
+    v8::Local<v8::Value> resultToJs() const override;
+
+protected:
+    uint32_t requestNext() override;
+    bool onResponse(const uint16_t evtId, ble_gattc_evt_t &event) override;
+
+private:
+    enum class Step
+    {
+        Prepare,
+        Execute,
+        Cancel,
+        Done
+    };
+
+    uint32_t write(const uint8_t writeOp, const uint8_t flags, const uint16_t length);
+    void cancel(const uint32_t errorCode, const uint16_t gattStatus, const std::string &operation);
+
+    void onPrepareWriteResponse(const ble_gattc_evt_t &event);
+
+    const uint16_t handle;
+    const std::vector<uint8_t> value;
+    const uint16_t partSize;
+    const bool reliable;
+
+    Step step;
+    uint16_t offset;
+    uint16_t partLength;
+
+    // Error that made the procedure cancel the prepared writes, reported when the cancel has completed
+    uint32_t cancelErrorCode;
+    uint16_t cancelGattStatus;
+    std::string cancelOperation;
+};
+
+#endif // GATTC_WRITE_LONG_H
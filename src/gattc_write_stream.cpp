@@ -0,0 +1,138 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "gattc_write_stream.h"
+#include "common.h"
+
+#if NRF_SD_BLE_API_VERSION >= 5
+
+GattcWriteStream::GattcWriteStream(adapter_t *adapter, const uint16_t connHandle, const uint16_t handle, std::vector<std::vector<uint8_t>> chunks, v8::Local<v8::Function> callback) :
+    GattcProcedure(adapter, connHandle, "streaming write commands", callback),
+    handle(handle),
+    chunks(std::move(chunks)),
+    next(0),
+    inFlight(0),
+    bytesWritten(0)
+{
+}
+
+v8::Local<v8::Value> GattcWriteStream::resultToJs() const
+{
+    Nan::EscapableHandleScope scope;
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+
+    const auto duration = std::chrono::duration<double, std::milli>(completed - started).count();
+
+    Utility::Set(result, "bytes", static_cast<double>(bytesWritten));
+    Utility::Set(result, "packets", static_cast<double>(next));
+    Utility::Set(result, "duration", duration);
+    Utility::Set(result, "bytesPerSecond", duration > 0 ? bytesWritten * 1000.0 / duration : 0.0);
+
+    return scope.Escape(result);
+}
+
+uint32_t GattcWriteStream::requestNext()
+{
+    if (next == 0 && inFlight == 0)
+    {
+        started = std::chrono::steady_clock::now();
+    }
+
+    operation = "writing command";
+
+    while (next < chunks.size())
+    {
+        const auto &chunk = chunks[next];
+
+        ble_gattc_write_params_t writeParams;
+        std::memset(&writeParams, 0, sizeof(writeParams));
+
+        writeParams.write_op = BLE_GATT_OP_WRITE_CMD;
+        writeParams.handle = handle;
+        writeParams.len = static_cast<uint16_t>(chunk.size());
+        writeParams.p_value = chunk.data();
+
+        const auto err_code = sd_ble_gattc_write(adapter, connHandle, &writeParams);
+
+        // The TX queue is full, continue when BLE_GATTC_EVT_WRITE_CMD_TX_COMPLETE frees buffers
+        if (err_code == NRF_ERROR_RESOURCES)
+        {
+            return NRF_SUCCESS;
+        }
+
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+
+        bytesWritten += chunk.size();
+        next++;
+        inFlight++;
+    }
+
+    if (inFlight == 0)
+    {
+        completed = std::chrono::steady_clock::now();
+        finish(NRF_SUCCESS, BLE_GATT_STATUS_SUCCESS, operation);
+    }
+
+    return NRF_SUCCESS;
+}
+
+bool GattcWriteStream::onResponse(const uint16_t evtId, ble_gattc_evt_t &event)
+{
+    if (evtId != BLE_GATTC_EVT_WRITE_CMD_TX_COMPLETE)
+    {
+        return false;
+    }
+
+    // Write commands sent by the application on the same connection are counted as well,
+    // completions beyond the ones in flight for this stream are passed on to the application
+    auto &count = event.params.write_cmd_tx_complete.count;
+    const auto owned = static_cast<uint8_t>(std::min<size_t>(inFlight, count));
+
+    inFlight -= owned;
+    count -= owned;
+    shared = count > 0;
+
+    // Buffers freed by the application's commands are used for the next writes as well
+    return true;
+}
+
+#endif // NRF_SD_BLE_API_VERSION >= 5
@@ -0,0 +1,153 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gatts_hvn_tx_queue.h"
+#include "ble_err.h"
+
+#include <cstring>
+
+#if NRF_SD_BLE_API_VERSION >= 5
+
+void GattsHvnTxQueue::connect(const uint16_t connHandle, const uint8_t credits)
+{
+    auto &connection = connections[connHandle];
+    connection.credits = credits;
+}
+
+void GattsHvnTxQueue::disconnect(const uint16_t connHandle, GattsHvnTxEntries &failed)
+{
+    const auto it = connections.find(connHandle);
+
+    if (it == connections.end())
+    {
+        return;
+    }
+
+    for (auto &entry : it->second.pending)
+    {
+        entry->result = BLE_ERROR_INVALID_CONN_HANDLE;
+        entry->len = 0;
+        failed.push_back(std::move(entry));
+    }
+
+    connections.erase(it);
+}
+
+void GattsHvnTxQueue::push(std::unique_ptr<GattsHvnTxEntry> entry, const uint8_t credits)
+{
+    // A connection established before the queue existed starts with all credits
+    const auto it = connections.find(entry->conn_handle);
+
+    if (it == connections.end())
+    {
+        connect(entry->conn_handle, credits);
+    }
+
+    connections[entry->conn_handle].pending.push_back(std::move(entry));
+}
+
+void GattsHvnTxQueue::complete(const uint16_t connHandle, const uint8_t count)
+{
+    const auto it = connections.find(connHandle);
+
+    if (it == connections.end())
+    {
+        return;
+    }
+
+    it->second.credits = static_cast<uint8_t>(it->second.credits + count);
+}
+
+void GattsHvnTxQueue::drain(adapter_t *adapter, const uint16_t connHandle, GattsHvnTxEntries &sent)
+{
+    const auto it = connections.find(connHandle);
+
+    if (it == connections.end())
+    {
+        return;
+    }
+
+    auto &connection = it->second;
+
+    while (connection.credits > 0 && !connection.pending.empty())
+    {
+        auto &entry = connection.pending.front();
+
+        ble_gatts_hvx_params_t hvx_params;
+        memset(&hvx_params, 0, sizeof(hvx_params));
+        hvx_params.handle = entry->handle;
+        hvx_params.type = BLE_GATT_HVX_NOTIFICATION;
+        hvx_params.offset = entry->offset;
+        entry->len = static_cast<uint16_t>(entry->data.size());
+        hvx_params.p_len = &entry->len;
+        hvx_params.p_data = entry->data.data();
+
+        entry->result = sd_ble_gatts_hvx(adapter, connHandle, &hvx_params);
+
+        // The SoftDevice queue is full even though credits are left, notifications have been sent
+        // without going through this queue. Wait for them to complete.
+        if (entry->result == NRF_ERROR_RESOURCES)
+        {
+            connection.credits = 0;
+            break;
+        }
+
+        if (entry->result == NRF_SUCCESS)
+        {
+            connection.credits--;
+        }
+
+        sent.push_back(std::move(entry));
+        connection.pending.pop_front();
+    }
+}
+
+void GattsHvnTxQueue::clear(GattsHvnTxEntries &failed)
+{
+    for (auto &connection : connections)
+    {
+        for (auto &entry : connection.second.pending)
+        {
+            entry->result = NRF_ERROR_INVALID_STATE;
+            entry->len = 0;
+            failed.push_back(std::move(entry));
+        }
+    }
+
+    connections.clear();
+}
+
+#endif // NRF_SD_BLE_API_VERSION >= 5
@@ -0,0 +1,106 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GATTS_HVN_TX_QUEUE_H
+#define GATTS_HVN_TX_QUEUE_H
+
+#include <nan.h>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "sd_rpc.h"
+
+#if NRF_SD_BLE_API_VERSION >= 5
+
+// A Handle Value Notification waiting for, or handed to, the SoftDevice
+struct GattsHvnTxEntry
+{
+    uint16_t conn_handle;
+    uint16_t handle;
+    uint16_t offset;
+    std::vector<uint8_t> data;
+
+    uint16_t len;    // Number of bytes sent, written back by the SoftDevice
+    uint32_t result;
+
+    // Only called and deleted in the NodeJS thread, nullptr if nobody waits for the result
+    Nan::Callback *callback;
+};
+
+typedef std::vector<std::unique_ptr<GattsHvnTxEntry>> GattsHvnTxEntries;
+
+// Notifications per connection, sent while the connection has TX credits left.
+// A connection starts with hvn_tx_queue_size credits from the GATTS connection configuration,
+// one credit is used per notification handed to the SoftDevice and BLE_GATTS_EVT_HVN_TX_COMPLETE
+// returns them. Notifications sent without credits are queued until credits return.
+//
+// The object is not thread safe, the owner must serialize all calls.
+class GattsHvnTxQueue
+{
+public:
+    GattsHvnTxQueue() = default;
+
+    void connect(const uint16_t connHandle, const uint8_t credits);
+
+    // Notifications still queued for the connection are moved to failed
+    void disconnect(const uint16_t connHandle, GattsHvnTxEntries &failed);
+
+    void push(std::unique_ptr<GattsHvnTxEntry> entry, const uint8_t credits);
+    void complete(const uint16_t connHandle, const uint8_t count);
+
+    // Send queued notifications while the connection has credits, the ones handed to the SoftDevice
+    // (successfully or not) are moved to sent.
+    void drain(adapter_t *adapter, const uint16_t connHandle, GattsHvnTxEntries &sent);
+
+    // Move every queued notification to failed
+    void clear(GattsHvnTxEntries &failed);
+
+private:
+    struct Connection
+    {
+        uint8_t credits;
+        std::deque<std::unique_ptr<GattsHvnTxEntry>> pending;
+    };
+
+    std::map<uint16_t, Connection> connections;
+};
+
+#endif // NRF_SD_BLE_API_VERSION >= 5
+
+#endif // GATTS_HVN_TX_QUEUE_H
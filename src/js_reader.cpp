@@ -0,0 +1,84 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "js_reader.h"
+#include "common.h"
+#include "conversion_arena.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <sstream>
+
+std::string ConversionError::message() const
+{
+    if (property == nullptr)
+    {
+        return expected;
+    }
+
+    std::stringstream stream;
+    stream << "Failed to get property " << property << ": " << expected;
+    return stream.str();
+}
+
+Expected<uint8_t *> JsValue<uint8_t *>::read(v8::Local<v8::Value> js, ConversionArena *arena)
+{
+    if (!js->IsArray())
+    {
+        return ConversionError("array");
+    }
+
+    v8::Local<v8::Array> jsarray = v8::Local<v8::Array>::Cast(js);
+    auto length = jsarray->Length();
+    auto buffer = arena != nullptr
+        ? arena->createArray<uint8_t>(length)
+        : static_cast<uint8_t *>(malloc(sizeof(uint8_t) * length));
+
+    assert(buffer != nullptr);
+
+    for (uint32_t i = 0; i < length; ++i)
+    {
+        buffer[i] = static_cast<uint8_t>(
+            Nan::Get(jsarray, i).ToLocalChecked()->Uint32Value(Nan::GetCurrentContext()).FromJust());
+    }
+
+    return buffer;
+}
+
+void ArgumentReader::throwTypeError() const
+{
+    Nan::ThrowTypeError(ErrorMessage::getTypeErrorMessage(index, error.message()));
+}
@@ -0,0 +1,347 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JS_READER_H
+#define JS_READER_H
+
+#include <nan.h>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+class ConversionArena;
+
+// Argument and property conversion without exceptions.
+//
+// A failed conversion is returned as a ConversionError holding string literals, so nothing is allocated and no
+// exception is thrown unless the error is reported to JavaScript. ConversionUtility throws these errors as
+// std::string for the code that converts inside try/catch.
+
+struct ConversionError
+{
+    ConversionError() : expected(nullptr), property(nullptr) {}
+    ConversionError(const char *expected, const char *property = nullptr) : expected(expected), property(property) {}
+
+    const char *expected; // What the value should have been, like "number"
+    const char *property; // The property that failed, nullptr for a value
+
+    // The same text ConversionUtility throws, "Failed to get property <property>: <expected>" for properties
+    std::string message() const;
+};
+
+template<typename T>
+class Expected
+{
+public:
+    Expected(T value) : value_(value), valid(true) {}
+    Expected(ConversionError error) : value_(), error_(error), valid(false) {}
+
+    explicit operator bool() const { return valid; }
+    const T &value() const { return value_; }
+    const ConversionError &error() const { return error_; }
+
+    T valueOrThrow() const
+    {
+        if (!valid)
+        {
+            throw error_.message();
+        }
+
+        return value_;
+    }
+
+private:
+    T value_;
+    ConversionError error_;
+    bool valid;
+};
+
+// Conversion of a JavaScript value to T, specialized for the types the NAN layer reads
+template<typename T, typename Enable = void>
+struct JsValue;
+
+template<typename T>
+struct JsValue<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value>::type>
+{
+    static Expected<T> read(v8::Local<v8::Value> js)
+    {
+        if (!js->IsNumber())
+        {
+            return ConversionError("number");
+        }
+
+        return static_cast<T>(Nan::To<uint32_t>(js).FromJust());
+    }
+};
+
+template<typename T>
+struct JsValue<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>
+{
+    static Expected<T> read(v8::Local<v8::Value> js)
+    {
+        if (!js->IsNumber())
+        {
+            return ConversionError("number");
+        }
+
+        return static_cast<T>(Nan::To<int32_t>(js).FromJust());
+    }
+};
+
+template<>
+struct JsValue<double>
+{
+    static Expected<double> read(v8::Local<v8::Value> js)
+    {
+        if (!js->IsNumber())
+        {
+            return ConversionError("number");
+        }
+
+        return Nan::To<double>(js).FromJust();
+    }
+};
+
+template<>
+struct JsValue<bool>
+{
+    static Expected<bool> read(v8::Local<v8::Value> js)
+    {
+        if (!js->IsBoolean())
+        {
+            return ConversionError("bool");
+        }
+
+        return Nan::To<bool>(js).FromJust();
+    }
+};
+
+template<>
+struct JsValue<v8::Local<v8::Object>>
+{
+    static Expected<v8::Local<v8::Object>> read(v8::Local<v8::Value> js)
+    {
+        if (!js->IsObject())
+        {
+            return ConversionError("object");
+        }
+
+        return Nan::To<v8::Object>(js).ToLocalChecked();
+    }
+};
+
+template<>
+struct JsValue<v8::Local<v8::Function>>
+{
+    static Expected<v8::Local<v8::Function>> read(v8::Local<v8::Value> js)
+    {
+        if (!js->IsFunction())
+        {
+            return ConversionError("function");
+        }
+
+        return js.As<v8::Function>();
+    }
+};
+
+// An array of numbers copied to a buffer from the arena, or from malloc without one and then the caller frees it
+template<>
+struct JsValue<uint8_t *>
+{
+    static Expected<uint8_t *> read(v8::Local<v8::Value> js, ConversionArena *arena = nullptr);
+};
+
+template<>
+struct JsValue<const uint8_t *>
+{
+    static Expected<const uint8_t *> read(v8::Local<v8::Value> js, ConversionArena *arena = nullptr)
+    {
+        const auto array = JsValue<uint8_t *>::read(js, arena);
+
+        if (!array)
+        {
+            return array.error();
+        }
+
+        return static_cast<const uint8_t *>(array.value());
+    }
+};
+
+// JsValue for a field of a struct, the buffers of byte array fields are allocated from the arena if there is one
+template<typename T>
+struct JsFieldValue
+{
+    static Expected<T> read(v8::Local<v8::Value> js, ConversionArena *)
+    {
+        return JsValue<T>::read(js);
+    }
+};
+
+template<>
+struct JsFieldValue<uint8_t *>
+{
+    static Expected<uint8_t *> read(v8::Local<v8::Value> js, ConversionArena *arena)
+    {
+        return JsValue<uint8_t *>::read(js, arena);
+    }
+};
+
+template<>
+struct JsFieldValue<const uint8_t *>
+{
+    static Expected<const uint8_t *> read(v8::Local<v8::Value> js, ConversionArena *arena)
+    {
+        return JsValue<const uint8_t *>::read(js, arena);
+    }
+};
+
+// Reads properties of a JavaScript object into a native struct. The conversion of each field is picked from the
+// member type at compile time. Reading stops at the first property that fails to convert, fields read until then
+// keep their values, so pointers already allocated can be freed by the caller. With an arena, the buffers the
+// struct points to are allocated from it and there is nothing to free.
+template<typename Struct>
+class FieldReader
+{
+public:
+    FieldReader(v8::Local<v8::Object> js, Struct *native, ConversionArena *arena = nullptr)
+        : js(js), native(native), arena(arena), failed(false) {}
+
+    template<typename Member>
+    FieldReader &read(const char *name, Member Struct::*member)
+    {
+        if (!failed)
+        {
+            const auto value = JsFieldValue<Member>::read(Nan::Get(js, Nan::New(name).ToLocalChecked()).ToLocalChecked(), arena);
+
+            if (value)
+            {
+                native->*member = value.value();
+            }
+            else
+            {
+                fail(value.error(), name);
+            }
+        }
+
+        return *this;
+    }
+
+    // For fields the struct points to, like p_len of ble_gatts_hvx_params_t
+    template<typename Value>
+    FieldReader &read(const char *name, Value *target)
+    {
+        if (!failed)
+        {
+            const auto value = JsFieldValue<Value>::read(Nan::Get(js, Nan::New(name).ToLocalChecked()).ToLocalChecked(), arena);
+
+            if (value)
+            {
+                *target = value.value();
+            }
+            else
+            {
+                fail(value.error(), name);
+            }
+        }
+
+        return *this;
+    }
+
+    Expected<Struct *> result() const
+    {
+        if (failed)
+        {
+            return error;
+        }
+
+        return native;
+    }
+
+private:
+    void fail(const ConversionError &valueError, const char *name)
+    {
+        failed = true;
+        error = ConversionError(valueError.expected, name);
+    }
+
+    v8::Local<v8::Object> js;
+    Struct *native;
+    ConversionArena *arena;
+    bool failed;
+    ConversionError error;
+};
+
+// Reads the arguments of a NAN_METHOD in order. After the first argument that fails to convert, the remaining
+// reads return default values and ok() is false.
+class ArgumentReader
+{
+public:
+    explicit ArgumentReader(Nan::NAN_METHOD_ARGS_TYPE info) : info(info), index(0), failed(false) {}
+
+    template<typename T>
+    T next()
+    {
+        if (failed)
+        {
+            return T();
+        }
+
+        const auto value = JsValue<T>::read(info[index]);
+
+        if (!value)
+        {
+            failed = true;
+            error = value.error();
+            return T();
+        }
+
+        index++;
+        return value.value();
+    }
+
+    bool ok() const { return !failed; }
+
+    // Throws the TypeError of the argument that failed, the message of ErrorMessage::getTypeErrorMessage
+    void throwTypeError() const;
+
+private:
+    Nan::NAN_METHOD_ARGS_TYPE info;
+    int index;
+    bool failed;
+    ConversionError error;
+};
+
+#endif // JS_READER_H
@@ -0,0 +1,168 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "latency_histogram.h"
+
+#include <cmath>
+#include <limits>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record(const uint64_t valueUs)
+{
+    const uint64_t maxValue = bucketHighestValue(LATENCY_HISTOGRAM_BUCKET_COUNT - 1);
+    const auto value = valueUs > maxValue ? maxValue : valueUs;
+
+    buckets[bucketIndex(value)] += 1;
+
+    count += 1;
+    total += value;
+
+    if (value < min)
+    {
+        min = value;
+    }
+
+    if (value > max)
+    {
+        max = value;
+    }
+}
+
+void LatencyHistogram::record(const std::chrono::nanoseconds duration)
+{
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    record(us > 0 ? static_cast<uint64_t>(us) : 0);
+}
+
+void LatencyHistogram::reset()
+{
+    buckets.fill(0);
+    count = 0;
+    total = 0;
+    min = std::numeric_limits<uint64_t>::max();
+    max = 0;
+}
+
+uint64_t LatencyHistogram::getCount() const
+{
+    return count;
+}
+
+uint64_t LatencyHistogram::getMin() const
+{
+    return count == 0 ? 0 : min;
+}
+
+uint64_t LatencyHistogram::getMax() const
+{
+    return max;
+}
+
+double LatencyHistogram::getMean() const
+{
+    return count == 0 ? 0.0 : static_cast<double>(total) / static_cast<double>(count);
+}
+
+uint64_t LatencyHistogram::getValueAtPercentile(const double percentile) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    const auto clamped = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+    auto target = static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(count)));
+
+    if (target == 0)
+    {
+        target = 1;
+    }
+
+    uint64_t accumulated = 0;
+
+    for (size_t i = 0; i < buckets.size(); i++)
+    {
+        accumulated += buckets[i];
+
+        if (accumulated >= target)
+        {
+            // Do not report more than what has actually been recorded
+            const auto value = bucketHighestValue(i);
+            return value > max ? max : value;
+        }
+    }
+
+    return max;
+}
+
+size_t LatencyHistogram::bucketIndex(const uint64_t value)
+{
+    if (value < LATENCY_HISTOGRAM_SUB_BUCKETS)
+    {
+        return static_cast<size_t>(value);
+    }
+
+    auto highestBit = 0;
+
+    for (auto v = value; v > 1; v >>= 1)
+    {
+        highestBit++;
+    }
+
+    // value >> shift is in the range [SUB_BUCKETS, 2 * SUB_BUCKETS)
+    const auto shift = highestBit - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    const auto subBucket = static_cast<size_t>(value >> shift) - LATENCY_HISTOGRAM_SUB_BUCKETS;
+
+    return LATENCY_HISTOGRAM_SUB_BUCKETS + shift * LATENCY_HISTOGRAM_SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketHighestValue(const size_t index)
+{
+    if (index < LATENCY_HISTOGRAM_SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    const auto shift = (index - LATENCY_HISTOGRAM_SUB_BUCKETS) / LATENCY_HISTOGRAM_SUB_BUCKETS;
+    const auto subBucket = (index - LATENCY_HISTOGRAM_SUB_BUCKETS) % LATENCY_HISTOGRAM_SUB_BUCKETS;
+    const uint64_t lowestValue = static_cast<uint64_t>(LATENCY_HISTOGRAM_SUB_BUCKETS + subBucket) << shift;
+
+    return lowestValue + (static_cast<uint64_t>(1) << shift) - 1;
+}
@@ -0,0 +1,89 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// Log-linear latency histogram in the style of HdrHistogram.
+//
+// Values are recorded in microseconds. Every power of two range is split into
+// LATENCY_HISTOGRAM_SUB_BUCKETS linear buckets, which keeps the relative error
+// below 1/LATENCY_HISTOGRAM_SUB_BUCKETS (~6%) while using a fixed amount of memory.
+// Values below LATENCY_HISTOGRAM_SUB_BUCKETS are recorded exactly. Recording is
+// not synchronized, all access must be done from the same thread.
+
+const auto LATENCY_HISTOGRAM_SUB_BUCKET_BITS = 4;
+const auto LATENCY_HISTOGRAM_SUB_BUCKETS = 1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+
+// Highest bit of a recordable value, larger values (> ~9.5 hours) are clamped
+const auto LATENCY_HISTOGRAM_MAX_BIT = 35;
+
+const auto LATENCY_HISTOGRAM_BUCKET_COUNT =
+    LATENCY_HISTOGRAM_SUB_BUCKETS + (LATENCY_HISTOGRAM_MAX_BIT - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * LATENCY_HISTOGRAM_SUB_BUCKETS;
+
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(const uint64_t valueUs);
+    void record(const std::chrono::nanoseconds duration);
+    void reset();
+
+    uint64_t getCount() const;
+    uint64_t getMin() const;
+    uint64_t getMax() const;
+    double getMean() const;
+
+    // Highest value equivalent to the value at the given percentile, percentile is in the range [0, 100]
+    uint64_t getValueAtPercentile(const double percentile) const;
+
+private:
+    static size_t bucketIndex(const uint64_t value);
+    static uint64_t bucketHighestValue(const size_t index);
+
+    std::array<uint32_t, LATENCY_HISTOGRAM_BUCKET_COUNT> buckets;
+    uint64_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,323 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STRUCT_SCHEMA_H
+#define STRUCT_SCHEMA_H
+
+#include <nan.h>
+#include <array>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "common.h"
+#include "conversion_arena.h"
+#include "js_reader.h"
+
+// Marshalling of SoftDevice structs derived from one field schema per struct.
+//
+// A schema lists, for each field, the JavaScript property, the struct member and how the value is converted:
+//
+//     template<>
+//     struct StructSchema<ble_gap_phys_t>
+//     {
+//         static auto fields()
+//         {
+//             return std::make_tuple(
+//                 schemaField("tx_phys", &ble_gap_phys_t::tx_phys),
+//                 schemaField("rx_phys", &ble_gap_phys_t::rx_phys));
+//         }
+//     };
+//
+// StructMarshaller<Struct> converts in both directions from the schema. Property keys are created once and cached,
+// and objects are created from an ObjectTemplate with every property of the schema, so they share one hidden class.
+// Schemas are declared next to the converter class of the struct, inside its NRF_SD_BLE_API_VERSION branch, so each
+// SoftDevice API build compiles the marshalling of its own struct layout.
+
+template<typename Struct>
+struct StructSchema;
+
+namespace SchemaConversion
+{
+    // The value as is, the JavaScript type is picked from the member type
+    struct Plain
+    {
+        template<typename Struct, typename Member>
+        static Expected<Member> toNative(v8::Local<v8::Value> js, ConversionArena *)
+        {
+            return JsValue<Member>::read(js);
+        }
+
+        template<typename Struct, typename Member>
+        static typename std::enable_if<std::is_same<Member, bool>::value, v8::Local<v8::Value>>::type
+        toJs(const Struct &, const Member value)
+        {
+            return Nan::New(value);
+        }
+
+        template<typename Struct, typename Member>
+        static typename std::enable_if<std::is_integral<Member>::value && std::is_unsigned<Member>::value && !std::is_same<Member, bool>::value, v8::Local<v8::Value>>::type
+        toJs(const Struct &, const Member value)
+        {
+            return Nan::New<v8::Integer>(static_cast<uint32_t>(value));
+        }
+
+        template<typename Struct, typename Member>
+        static typename std::enable_if<std::is_integral<Member>::value && std::is_signed<Member>::value, v8::Local<v8::Value>>::type
+        toJs(const Struct &, const Member value)
+        {
+            return Nan::New<v8::Integer>(static_cast<int32_t>(value));
+        }
+    };
+
+    // As Plain, with Default in the struct when the property is missing
+    template<uint32_t Default>
+    struct WithDefault
+    {
+        template<typename Struct, typename Member>
+        static Expected<Member> toNative(v8::Local<v8::Value> js, ConversionArena *arena)
+        {
+            if (js->IsUndefined())
+            {
+                return static_cast<Member>(Default);
+            }
+
+            return Plain::toNative<Struct, Member>(js, arena);
+        }
+
+        template<typename Struct, typename Member>
+        static v8::Local<v8::Value> toJs(const Struct &native, const Member value)
+        {
+            return Plain::toJs<Struct, Member>(native, value);
+        }
+    };
+
+    // Milliseconds in JavaScript, a count of Unit microseconds in the struct, see ConversionUtility::msecsToUnitsUint16
+    template<ConversionUtility::ConversionUnits Unit>
+    struct Units
+    {
+        template<typename Struct, typename Member>
+        static Expected<Member> toNative(v8::Local<v8::Value> js, ConversionArena *)
+        {
+            const auto msecs = JsValue<double>::read(js);
+
+            if (!msecs)
+            {
+                return msecs.error();
+            }
+
+            return static_cast<Member>(msecs.value() * 1000 / Unit);
+        }
+
+        template<typename Struct, typename Member>
+        static v8::Local<v8::Value> toJs(const Struct &, const Member value)
+        {
+            return Nan::New<v8::Number>(value * Unit / 1000.0);
+        }
+    };
+
+    // An array of numbers in JavaScript, a buffer in the struct with its length in the member Length. The buffer is
+    // allocated from the arena of the conversion, or from malloc without one.
+    template<typename Struct, uint16_t Struct::*Length>
+    struct ByteArray
+    {
+        template<typename, typename Member>
+        static Expected<Member> toNative(v8::Local<v8::Value> js, ConversionArena *arena)
+        {
+            return JsFieldValue<Member>::read(js, arena);
+        }
+
+        template<typename, typename Member>
+        static v8::Local<v8::Value> toJs(const Struct &native, const Member value)
+        {
+            return ConversionUtility::toJsValueArray(value, native.*Length);
+        }
+    };
+}
+
+template<typename Struct, typename Member, typename Conversion>
+struct SchemaField
+{
+    using member_type = Member;
+    using conversion = Conversion;
+
+    const char *name;
+    Member Struct::*member;
+};
+
+template<typename Conversion = SchemaConversion::Plain, typename Struct, typename Member>
+SchemaField<Struct, Member, Conversion> schemaField(const char *name, Member Struct::*member)
+{
+    return { name, member };
+}
+
+namespace SchemaDetail
+{
+    template<typename Fields, typename Function, size_t... Index>
+    void forEachField(const Fields &fields, Function &&function, std::index_sequence<Index...>)
+    {
+        (void)std::initializer_list<int>{ (function(std::get<Index>(fields), Index), 0)... };
+    }
+
+    template<typename Fields, typename Function>
+    void forEachField(const Fields &fields, Function &&function)
+    {
+        forEachField(fields, std::forward<Function>(function), std::make_index_sequence<std::tuple_size<Fields>::value>());
+    }
+}
+
+template<typename Struct>
+class StructMarshaller
+{
+    using Fields = decltype(StructSchema<Struct>::fields());
+    using Keys = std::array<Nan::Persistent<v8::String>, std::tuple_size<Fields>::value>;
+
+public:
+    // Reads the properties of js into native. Reading stops at the first field that fails to convert, fields read
+    // until then keep their values, so pointers already allocated can be freed by the caller. With an arena, the
+    // buffers of byte array fields are allocated from it and there is nothing to free.
+    static Expected<Struct *> toNative(v8::Local<v8::Object> js, Struct *native, ConversionArena *arena = nullptr)
+    {
+        const auto &keys = cachedKeys();
+        ConversionError error;
+        auto failed = false;
+
+        SchemaDetail::forEachField(StructSchema<Struct>::fields(), [&](const auto &field, const size_t index) {
+            using Field = typename std::decay<decltype(field)>::type;
+
+            if (failed)
+            {
+                return;
+            }
+
+            const auto value = Field::conversion::template toNative<Struct, typename Field::member_type>(
+                Nan::Get(js, Nan::New(keys[index])).ToLocalChecked(), arena);
+
+            if (!value)
+            {
+                failed = true;
+                error = ConversionError(value.error().expected, field.name);
+                return;
+            }
+
+            native->*(field.member) = value.value();
+        });
+
+        if (failed)
+        {
+            return error;
+        }
+
+        return native;
+    }
+
+    // A new struct for the ToNative of the BleToJs classes, from the arena of the converter if it has one.
+    // Throws the conversion error like ConversionUtility.
+    static Struct *newNative(v8::Local<v8::Object> js, ConversionArena *arena = nullptr)
+    {
+        auto native = arena != nullptr ? arena->create<Struct>() : new Struct();
+        const auto converted = toNative(js, native, arena);
+
+        if (!converted)
+        {
+            if (arena == nullptr)
+            {
+                delete native;
+            }
+
+            throw converted.error().message();
+        }
+
+        return native;
+    }
+
+    static v8::Local<v8::Object> toJs(const Struct &native)
+    {
+        Nan::EscapableHandleScope scope;
+        const auto &keys = cachedKeys();
+        auto obj = Nan::NewInstance(Nan::New(objectTemplate())).ToLocalChecked();
+
+        SchemaDetail::forEachField(StructSchema<Struct>::fields(), [&](const auto &field, const size_t index) {
+            using Field = typename std::decay<decltype(field)>::type;
+
+            Nan::Set(obj, Nan::New(keys[index]),
+                Field::conversion::template toJs<Struct, typename Field::member_type>(native, native.*(field.member)));
+        });
+
+        return scope.Escape(obj);
+    }
+
+private:
+    // Created on first use in the NodeJS thread and kept for the lifetime of the AddOn, like the event templates
+    static const Keys &cachedKeys()
+    {
+        static const Keys *keys = createKeys();
+        return *keys;
+    }
+
+    static Keys *createKeys()
+    {
+        Nan::HandleScope scope;
+        auto keys = new Keys();
+
+        SchemaDetail::forEachField(StructSchema<Struct>::fields(), [keys](const auto &field, const size_t index) {
+            (*keys)[index].Reset(Nan::New(field.name).ToLocalChecked());
+        });
+
+        return keys;
+    }
+
+    static const Nan::Persistent<v8::ObjectTemplate> &objectTemplate()
+    {
+        static const Nan::Persistent<v8::ObjectTemplate> *objectTemplate = createObjectTemplate();
+        return *objectTemplate;
+    }
+
+    static Nan::Persistent<v8::ObjectTemplate> *createObjectTemplate()
+    {
+        Nan::HandleScope scope;
+        auto objectTemplate = Nan::New<v8::ObjectTemplate>();
+
+        SchemaDetail::forEachField(StructSchema<Struct>::fields(), [&objectTemplate](const auto &field, const size_t) {
+            Nan::SetTemplate(objectTemplate, field.name, Nan::Undefined());
+        });
+
+        return new Nan::Persistent<v8::ObjectTemplate>(objectTemplate);
+    }
+};
+
+#endif // STRUCT_SCHEMA_H
@@ -0,0 +1,333 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Behaviour of GattsHvnTxQueue with sd_ble_gatts_hvx stubbed, see the pc-ble-driver-js-native-test target.
+// Prints the failed checks and exits with the number of failed tests.
+
+#include "gatts_hvn_tx_queue.h"
+#include "ble_err.h"
+
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+namespace
+{
+    struct HvxCall
+    {
+        uint16_t connHandle;
+        uint16_t handle;
+        uint8_t type;
+        std::vector<uint8_t> data;
+    };
+
+    // Calls to the stub and the results it returns, NRF_SUCCESS once the results are used up
+    std::vector<HvxCall> hvxCalls;
+    std::deque<uint32_t> hvxResults;
+
+    auto failedChecks = 0;
+
+    void check(const bool condition, const char *expression, const int line)
+    {
+        if (!condition)
+        {
+            std::cerr << __FILE__ << ":" << line << ": check failed: " << expression << std::endl;
+            failedChecks++;
+        }
+    }
+
+    const uint16_t CONN_HANDLE = 0;
+    const uint16_t OTHER_CONN_HANDLE = 1;
+    const uint8_t CREDITS = 2;
+
+    std::unique_ptr<GattsHvnTxEntry> notification(const uint16_t connHandle, const uint16_t handle, const std::vector<uint8_t> &data = { 0x01, 0x02, 0x03 })
+    {
+        std::unique_ptr<GattsHvnTxEntry> entry(new GattsHvnTxEntry());
+        entry->conn_handle = connHandle;
+        entry->handle = handle;
+        entry->offset = 0;
+        entry->data = data;
+        entry->len = 0;
+        entry->result = NRF_ERROR_INTERNAL;
+        entry->callback = nullptr;
+        return entry;
+    }
+
+    void sendsWhileCreditsLast()
+    {
+        GattsHvnTxQueue queue;
+        GattsHvnTxEntries sent;
+
+        queue.connect(CONN_HANDLE, CREDITS);
+
+        for (uint16_t handle = 1; handle <= 3; handle++)
+        {
+            queue.push(notification(CONN_HANDLE, handle), CREDITS);
+        }
+
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(hvxCalls.size() == 2);
+        CHECK(sent.size() == 2);
+        CHECK(sent[0]->handle == 1 && sent[1]->handle == 2);
+        CHECK(sent[0]->result == NRF_SUCCESS && sent[0]->len == 3);
+        CHECK(hvxCalls[0].connHandle == CONN_HANDLE && hvxCalls[0].type == BLE_GATT_HVX_NOTIFICATION);
+        CHECK(hvxCalls[0].data == std::vector<uint8_t>({ 0x01, 0x02, 0x03 }));
+
+        // Without credits the third notification stays queued
+        sent.clear();
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(hvxCalls.size() == 2);
+        CHECK(sent.empty());
+    }
+
+    void completeReturnsCredits()
+    {
+        GattsHvnTxQueue queue;
+        GattsHvnTxEntries sent;
+
+        queue.connect(CONN_HANDLE, 1);
+        queue.push(notification(CONN_HANDLE, 1), 1);
+        queue.push(notification(CONN_HANDLE, 2), 1);
+        queue.push(notification(CONN_HANDLE, 3), 1);
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(sent.size() == 1);
+
+        sent.clear();
+        queue.complete(CONN_HANDLE, 2);
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(sent.size() == 2);
+        CHECK(sent[0]->handle == 2 && sent[1]->handle == 3);
+        CHECK(hvxCalls.size() == 3);
+
+        // Credits of a connection the queue does not know are ignored
+        queue.complete(OTHER_CONN_HANDLE, 1);
+        sent.clear();
+        queue.drain(nullptr, OTHER_CONN_HANDLE, sent);
+
+        CHECK(sent.empty());
+    }
+
+    void pushStartsUnknownConnectionWithAllCredits()
+    {
+        GattsHvnTxQueue queue;
+        GattsHvnTxEntries sent;
+
+        queue.push(notification(OTHER_CONN_HANDLE, 1), CREDITS);
+        queue.push(notification(OTHER_CONN_HANDLE, 2), CREDITS);
+        queue.push(notification(OTHER_CONN_HANDLE, 3), CREDITS);
+        queue.drain(nullptr, OTHER_CONN_HANDLE, sent);
+
+        CHECK(sent.size() == CREDITS);
+        CHECK(hvxCalls.size() == CREDITS);
+        CHECK(hvxCalls[0].connHandle == OTHER_CONN_HANDLE);
+    }
+
+    void resourcesErrorWaitsForCompletion()
+    {
+        GattsHvnTxQueue queue;
+        GattsHvnTxEntries sent;
+
+        queue.connect(CONN_HANDLE, CREDITS);
+        queue.push(notification(CONN_HANDLE, 1), CREDITS);
+        queue.push(notification(CONN_HANDLE, 2), CREDITS);
+
+        // Notifications sent around the queue have filled the SoftDevice queue
+        hvxResults.push_back(NRF_ERROR_RESOURCES);
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(hvxCalls.size() == 1);
+        CHECK(sent.empty());
+
+        // The connection has no credits until a notification completes
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(hvxCalls.size() == 1);
+
+        queue.complete(CONN_HANDLE, 1);
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(hvxCalls.size() == 2);
+        CHECK(sent.size() == 1);
+        CHECK(sent[0]->handle == 1 && sent[0]->result == NRF_SUCCESS);
+    }
+
+    void otherErrorsAreReportedWithoutUsingCredits()
+    {
+        GattsHvnTxQueue queue;
+        GattsHvnTxEntries sent;
+
+        queue.connect(CONN_HANDLE, 1);
+        queue.push(notification(CONN_HANDLE, 1), 1);
+        queue.push(notification(CONN_HANDLE, 2), 1);
+
+        hvxResults.push_back(BLE_ERROR_GATTS_SYS_ATTR_MISSING);
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(sent.size() == 2);
+        CHECK(sent[0]->handle == 1 && sent[0]->result == BLE_ERROR_GATTS_SYS_ATTR_MISSING);
+        CHECK(sent[1]->handle == 2 && sent[1]->result == NRF_SUCCESS);
+    }
+
+    void disconnectFailsQueuedNotifications()
+    {
+        GattsHvnTxQueue queue;
+        GattsHvnTxEntries sent;
+        GattsHvnTxEntries failed;
+
+        queue.connect(CONN_HANDLE, 1);
+        queue.connect(OTHER_CONN_HANDLE, 0);
+        queue.push(notification(CONN_HANDLE, 1), 1);
+        queue.push(notification(CONN_HANDLE, 2), 1);
+        queue.push(notification(OTHER_CONN_HANDLE, 3), 1);
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        queue.disconnect(CONN_HANDLE, failed);
+
+        CHECK(failed.size() == 1);
+        CHECK(failed[0]->handle == 2);
+        CHECK(failed[0]->result == BLE_ERROR_INVALID_CONN_HANDLE && failed[0]->len == 0);
+
+        // Nothing is left to send on the disconnected connection, the other one is untouched
+        sent.clear();
+        queue.complete(CONN_HANDLE, 1);
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(sent.empty());
+        CHECK(hvxCalls.size() == 1);
+
+        failed.clear();
+        queue.disconnect(CONN_HANDLE, failed);
+
+        CHECK(failed.empty());
+
+        queue.complete(OTHER_CONN_HANDLE, 1);
+        queue.drain(nullptr, OTHER_CONN_HANDLE, sent);
+
+        CHECK(sent.size() == 1 && sent[0]->handle == 3);
+    }
+
+    void clearFailsAllConnections()
+    {
+        GattsHvnTxQueue queue;
+        GattsHvnTxEntries sent;
+        GattsHvnTxEntries failed;
+
+        queue.connect(CONN_HANDLE, 0);
+        queue.connect(OTHER_CONN_HANDLE, 0);
+        queue.push(notification(CONN_HANDLE, 1), 0);
+        queue.push(notification(OTHER_CONN_HANDLE, 2), 0);
+
+        queue.clear(failed);
+
+        CHECK(failed.size() == 2);
+
+        for (const auto &entry : failed)
+        {
+            CHECK(entry->result == NRF_ERROR_INVALID_STATE && entry->len == 0);
+        }
+
+        queue.complete(CONN_HANDLE, 1);
+        queue.drain(nullptr, CONN_HANDLE, sent);
+
+        CHECK(sent.empty());
+        CHECK(hvxCalls.empty());
+    }
+}
+
+// Stub of the SoftDevice API function called by GattsHvnTxQueue::drain
+uint32_t sd_ble_gatts_hvx(adapter_t * /*adapter*/, uint16_t conn_handle, ble_gatts_hvx_params_t const *p_hvx_params)
+{
+    HvxCall call;
+    call.connHandle = conn_handle;
+    call.handle = p_hvx_params->handle;
+    call.type = p_hvx_params->type;
+    call.data.assign(p_hvx_params->p_data, p_hvx_params->p_data + *p_hvx_params->p_len);
+    hvxCalls.push_back(call);
+
+    if (hvxResults.empty())
+    {
+        return NRF_SUCCESS;
+    }
+
+    const auto result = hvxResults.front();
+    hvxResults.pop_front();
+    return result;
+}
+
+int main()
+{
+    const std::vector<std::pair<std::string, std::function<void()>>> tests =
+    {
+        { "sends while credits last", sendsWhileCreditsLast },
+        { "complete returns credits", completeReturnsCredits },
+        { "push starts an unknown connection with all credits", pushStartsUnknownConnectionWithAllCredits },
+        { "NRF_ERROR_RESOURCES waits for completion", resourcesErrorWaitsForCompletion },
+        { "other errors are reported without using credits", otherErrorsAreReportedWithoutUsingCredits },
+        { "disconnect fails queued notifications", disconnectFailsQueuedNotifications },
+        { "clear fails all connections", clearFailsAllConnections },
+    };
+
+    auto failedTests = 0;
+
+    for (const auto &test : tests)
+    {
+        hvxCalls.clear();
+        hvxResults.clear();
+
+        const auto failedBefore = failedChecks;
+        test.second();
+
+        const auto passed = failedChecks == failedBefore;
+        std::cout << (passed ? "PASS " : "FAIL ") << test.first << std::endl;
+
+        if (!passed)
+        {
+            failedTests++;
+        }
+    }
+
+    return failedTests;
+}
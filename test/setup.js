@@ -68,6 +68,10 @@ const deviceLister = new DeviceLister({
 });
 const grabbedAdapters = new Map();
 
+// Name of the virtual radio simulated adapters are opened on
+const SIMULATED_RADIO = 'ble-driver-test';
+let simulatedAdapterCount = 0;
+
 deviceLister.on('error', err => {
     if (err.usb) {
         const usbAddr = `${err.usb.busNumber}.${err.usb.deviceAddress}`;
@@ -193,6 +197,35 @@ function _filterAdapters(serialNumbers, options) {
     });
 }
 
+/**
+ * Grabs an adapter on the simulated driver. All simulated adapters share one virtual radio.
+ *
+ * @param {string} [serialNumber] serial number to give the adapter, one is made up if not specified
+ * @returns {Object} Information about the simulated device
+ * @private
+ */
+function _grabSimulatedAdapter(serialNumber) {
+    let sn = serialNumber;
+
+    if (sn == null) {
+        simulatedAdapterCount += 1;
+        sn = `SIM${simulatedAdapterCount}`;
+    }
+
+    if (grabbedAdapters.has(sn)) {
+        throw new Error(`Simulated adapter with serial number ${sn} is already grabbed.`);
+    }
+
+    grabbedAdapters.set(sn, null);
+
+    return {
+        serialNumber: sn,
+        port: SIMULATED_RADIO,
+        apiVersion: 'sim',
+        baudRate: 1000000,
+    };
+}
+
 /**
  * Grabs an adapter from the list of available adapters connected and programs it with the correct connectivity firmware.
  *
@@ -201,6 +234,10 @@ function _filterAdapters(serialNumbers, options) {
  * @returns {Promise<any>} Promise with information about programmed firmware and device
  */
 async function _grabAdapter(serialNumber, options) {
+    if (options.simulated) {
+        return _grabSimulatedAdapter(serialNumber);
+    }
+
     const foundAdapters = await getAdapters();
 
     const adapterToUse = () => {
@@ -345,6 +382,7 @@ function addAdapterListener(adapter, prefix) {
  * @param {string} [family] only use devices of a given family
  * @param {string} [blacklist] list of devices to not use in tests
  * @param {string} [logLevel] set log level that shall be used in pc-ble-driver. Can be "trace", "debug", "info", "error", "fatal".
+ * @param {boolean} [simulated] set to true to use adapters on the simulated driver instead of connected devices
  */
 
 /**
@@ -370,6 +408,10 @@ function mergeOptions(options) {
         newOptions.family = process.env.BLE_DRIVER_TEST_FAMILY;
     }
 
+    if (newOptions.simulated == null) {
+        newOptions.simulated = process.env.BLE_DRIVER_TEST_SIMULATED === 'true';
+    }
+
     if (newOptions.blacklist == null && process.env.BLE_DRIVER_TEST_BLACKLIST) {
         newOptions.blacklist = process.env.BLE_DRIVER_TEST_BLACKLIST.split(',');
     }
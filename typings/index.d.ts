@@ -10,10 +10,48 @@ export declare interface AdapterOpenOptions {
   parity?: string;
   flowControl?: string;
   eventInterval?: number;
+  eventMaxDelay?: number;
+  eventMaxBatchSize?: number;
   logLevel?: string;
   retransmissionInterval?: number;
   responseTimeout?: number;
   enableBLE?: boolean;
+  simulation?: SimulatedLinkOptions | boolean;
+}
+
+export declare interface SimulatedLinkOptions {
+  baudRate?: number;
+  parity?: string;
+  faults?: {
+    latency?: number;
+    jitter?: number;
+    loss?: number;
+    corruption?: number;
+    stallInterval?: number;
+    stallDuration?: number;
+  };
+  script?: any;
+  retransmissionInterval?: number;
+}
+
+export declare class SimulatedLink {
+  readonly path: string;
+  readonly emulator: any;
+  readonly stats: any;
+
+  floodAdvertisements(options?: {
+    count?: number;
+    dataLength?: number;
+    devices?: number;
+    rssi?: number;
+  }): number;
+  streamNotifications(options: {
+    connHandle?: number;
+    handle: number;
+    count?: number;
+    length?: number;
+  }): number;
+  close(): void;
 }
 
 export declare interface AdapterStatus {
@@ -136,6 +174,7 @@ export declare interface Device {
   slaveLatency: number;
   connectionSupervisionTimeout: number;
   paired: boolean;
+  encrypted: boolean;
   name: string;
   specificData: number[];
   rssi: number;
@@ -190,14 +229,41 @@ export declare interface Descriptor {
   value: Array<number>;
 }
 
+export declare interface GattOperationOptions {
+  priority?: number;
+  reliable?: boolean;
+}
+
+export declare interface WarmRestartTiming {
+  close: number;
+  open: number;
+  bleConfig: number;
+  enableBLE: number;
+  services: number;
+  total: number;
+}
+
+export declare interface WriteStreamStats {
+  bytes: number;
+  packets: number;
+  duration: number;
+  bytesPerSecond: number;
+}
+
 export declare class Adapter extends EventEmitter {
   instanceId: string;
   driver: any;
   state: AdapterState;
+  readonly simulatedLink: SimulatedLink | null;
 
   open(options?: AdapterOpenOptions, callback?: (err: any) => void): void;
   close(callback?: (err: any) => void): void;
+  warmRestart(callback?: (err: any, timing: WarmRestartTiming) => void): void;
   enableBLE(options: any, callback?: (err: any) => void): void; // FIXME: define options
+  setEventMask(
+    eventIds: Array<number>,
+    options?: { autoReply?: boolean; attMtu?: number }
+  ): void;
   startScan(options: ScanParameters, callback?: (err: any) => void): void;
   stopScan(callback?: (err: any) => void): void;
 
@@ -229,6 +295,7 @@ export declare class Adapter extends EventEmitter {
     callback?: (err: any, value: number) => void
   ): void;
   getCurrentAttMtu(deviceInstanceId: string): number | undefined;
+  getSubscriptions(deviceInstanceId: string): { [characteristicId: string]: number } | undefined;
 
   getService(serviceInstanceId: string): Service;
   getServices(
@@ -245,26 +312,48 @@ export declare class Adapter extends EventEmitter {
     characteristicId: string,
     callback?: (err?: any, descriptors?: Array<Descriptor>) => void
   ): void;
+  getAttributes(
+    deviceInstanceId: string,
+    callback?: (err: any, attributes: { services: { [instanceId: string]: Service } }) => void
+  ): void;
+  setGattCache(gattCache: GattCache | null): void;
   readCharacteristicValue(
     characteristicId: string,
-    callback?: (err: any, bytesRead: Array<number>) => void
+    callback?: (err: any, bytesRead: Array<number>) => void,
+    options?: GattOperationOptions
+  ): number | undefined;
+  readCharacteristicValues(
+    characteristicIds: Array<string>,
+    callback?: (err: any, values: Array<Array<number>>) => void,
+    options?: GattOperationOptions & { lengths?: { [characteristicId: string]: number } }
   ): void;
   writeCharacteristicValue(
     characteristicId: string,
     value: Array<number>,
     ack: boolean,
-    callback?: (error: Error) => void
-  ): void;
+    callback?: (error: Error) => void,
+    deviceNotifiedOrIndicated?: (...args: any[]) => void,
+    options?: GattOperationOptions
+  ): number | undefined;
+  writeCharacteristicValueStream(
+    characteristicId: string,
+    value: Array<number> | Array<Array<number>>,
+    callback?: (err: any, stats: WriteStreamStats) => void,
+    options?: GattOperationOptions
+  ): number;
   readDescriptorValue(
     descriptorId: string,
-    callback?: (err: any, value: Array<number>) => void
-  ): void;
+    callback?: (err: any, value: Array<number>) => void,
+    options?: GattOperationOptions
+  ): number | undefined;
   writeDescriptorValue(
     descriptorId: string,
     value: Array<number>,
     ack: boolean,
-    callback?: (error: Error) => void
-  ): void;
+    callback?: (error: Error) => void,
+    options?: GattOperationOptions
+  ): number | undefined;
+  cancelGattOperation(operationId: number): boolean;
 
   authenticate(
     deviceInstanceId: string,
@@ -432,19 +521,62 @@ export declare class Adapter extends EventEmitter {
     event: 'dataLengthChanged',
     listener: (remoteDevice: Device, maxTxOctets: number) => void
   ): this;
+  on(
+    event: 'gattDatabaseChanged',
+    listener: (device: Device, startHandle: number, endHandle: number) => void
+  ): this;
 }
 
 export declare class AdapterFactory extends EventEmitter {
   static getInstance(): AdapterFactory;
   getAdapters(callback?: (err: any, adapters: Adapter[]) => void): void;
   createAdapter(
-    sdVersion: 'v2' | 'v5',
+    sdVersion: 'v2' | 'v5' | 'sim',
     path: string,
     instanceId: string
   ): Adapter;
+  openMany(
+    adapters: Adapter[],
+    options?: any,
+    callback?: (err: any, results: Array<{ adapter: Adapter; error?: any; duration: number }>) => void
+  ): void;
   adapterList: Adapter[];
 }
 
+export declare class VirtualRadio {
+  static get(name: string, options?: { latency?: number; rssi?: number }): VirtualRadio;
+  configure(options: { latency?: number; rssi?: number }): void;
+  name: string;
+  latency: number;
+  rssi: number;
+  readonly links: Array<{ central: any; peripheral: any; mtu: number }>;
+  floodAdvertisements(options?: {
+    count?: number;
+    rate?: number;
+    dataLength?: number;
+    devices?: number;
+  }): Promise<{ count: number; duration: number }>;
+  streamNotifications(options: {
+    handle: number;
+    link?: any;
+    count?: number;
+    length?: number;
+    rate?: number;
+  }): Promise<{ count: number; bytes: number; duration: number }>;
+}
+
+export declare class GattCache {
+  constructor(options?: { path?: string });
+  lookup(device: Device): any;
+  store(device: Device, services: Array<any>, databaseHash?: Array<number>): void;
+  setIdentity(device: Device, idKey: any): void;
+  setBonded(device: Device, idKey?: any): void;
+  isBonded(device: Device): boolean;
+  invalidate(device: Device): void;
+  clear(): void;
+  flush(callback?: (err: Error | null) => void): void;
+}
+
 export declare class ServiceFactory {
   createService(uuid: string, serviceType: string): Service;
   createCharacteristic(